@@ -123,6 +123,16 @@ class ProcessGroup {
         "ProcessGroup%s does not support AllGather", GetBackendName()));
   }
 
+  // If sync_op is false, the backends which run the collectives on another
+  // thread may return before the task is done. Wait on the task before
+  // reading out_tensors then.
+  virtual std::shared_ptr<ProcessGroup::Task> AllGather(
+      std::vector<Tensor>& in_tensors,   // NOLINT
+      std::vector<Tensor>& out_tensors,  // NOLINT
+      bool sync_op) {
+    return AllGather(in_tensors, out_tensors);
+  }
+
   virtual std::shared_ptr<ProcessGroup::Task> AllToAll(
       std::vector<Tensor>& in /* tensors */,     // NOLINT
       std::vector<Tensor>& out /* tensors */) {  // NOLINT
@@ -30,6 +30,10 @@
 #include "paddle/fluid/distributed/collective/ProcessGroupGloo.h"
 #include "paddle/fluid/framework/fleet/gloo_wrapper.h"
 #include "paddle/fluid/platform/enforce.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+DECLARE_string(gloo_allreduce_comm_dtype);
 
 namespace paddle {
 namespace distributed {
@@ -105,6 +109,18 @@ reduce_func get_function(const ReduceOp& r) {
   exit(-1);
 }
 
+// Adds the partial sums casted to T in float32.
+template <typename T>
+void sum_in_float(void* c, const void* a, const void* b, size_t n) {
+  T* out = static_cast<T*>(c);
+  const T* x = static_cast<const T*>(a);
+  const T* y = static_cast<const T*>(b);
+  for (size_t i = 0; i < n; ++i) {
+    out[i] =
+        static_cast<T>(static_cast<float>(x[i]) + static_cast<float>(y[i]));
+  }
+}
+
 bool CheckTensorsInCPUPlace(const std::vector<Tensor>& tensors) {
   return std::all_of(tensors.cbegin(), tensors.cend(), [&](const Tensor& t) {
     return t.place() == PlaceType::kCPU;
@@ -171,6 +187,36 @@ ProcessGroupGloo::GlooTask::GlooTask(int rank,
                         "Only CPU place is supported for ProcessGroupGloo."));
 }
 
+void ProcessGroupGloo::GlooTask::RunAndNotify() {
+  std::exception_ptr exception;
+  try {
+    Run();
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exception_ = exception;
+    is_completed_ = true;
+  }
+  cv_.notify_all();
+}
+
+bool ProcessGroupGloo::GlooTask::Wait(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (timeout == kWaitTimeout) {
+    cv_.wait(lock, [this] { return is_completed_; });
+  } else if (!cv_.wait_for(lock, timeout, [this] { return is_completed_; })) {
+    return false;
+  }
+  if (exception_) {
+    std::rethrow_exception(exception_);
+  }
+  return true;
+}
+
+void ProcessGroupGloo::GlooTask::Synchronize() { Wait(kWaitTimeout); }
+
 ProcessGroupGloo::ProcessGroupGloo(
     const std::shared_ptr<paddle::distributed::Store>& store, int rank,
     int world_size, int gid, const std::shared_ptr<GlooOptions> options)
@@ -181,6 +227,41 @@ ProcessGroupGloo::ProcessGroupGloo(
   auto prefix_store =
       ::gloo::rendezvous::PrefixStore(std::to_string(0), *_store);
   _context->connectFullMesh(prefix_store, options->device);
+  _comm_thread = std::thread(&ProcessGroupGloo::CommLoop, this);
+}
+
+ProcessGroupGloo::~ProcessGroupGloo() {
+  {
+    std::lock_guard<std::mutex> lock(_queue_mutex);
+    _stop = true;
+  }
+  _queue_cv.notify_all();
+  _comm_thread.join();
+}
+
+void ProcessGroupGloo::Enqueue(const std::shared_ptr<GlooTask>& task) {
+  {
+    std::lock_guard<std::mutex> lock(_queue_mutex);
+    _queue.push_back(task);
+  }
+  _queue_cv.notify_one();
+}
+
+void ProcessGroupGloo::CommLoop() {
+  while (true) {
+    std::shared_ptr<GlooTask> task;
+    {
+      std::unique_lock<std::mutex> lock(_queue_mutex);
+      _queue_cv.wait(lock, [this] { return _stop || !_queue.empty(); });
+      // the queued tasks are still run on stop, since they may be waited
+      if (_queue.empty()) {
+        return;
+      }
+      task = std::move(_queue.front());
+      _queue.pop_front();
+    }
+    task->RunAndNotify();
+  }
 }
 
 class BroadcastGlooTask : public ProcessGroupGloo::GlooTask {
@@ -215,11 +296,12 @@ class BroadcastGlooTask : public ProcessGroupGloo::GlooTask {
 std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Broadcast(
     std::vector<Tensor>& inputs, const BroadcastOptions& opts) {
   auto root = opts.source_rank;
-  std::unique_ptr<BroadcastGlooTask> task;
+  std::shared_ptr<BroadcastGlooTask> task;
   auto tag = next_tag();
   auto context = get_context();
-  task = std::make_unique<BroadcastGlooTask>(context, inputs, rank_, root, tag);
-  task->Run();
+  task = std::make_shared<BroadcastGlooTask>(context, inputs, rank_, root, tag);
+  Enqueue(task);
+  task->Wait();
   return task;
 }
 
@@ -232,15 +314,36 @@ class AllreduceGlooTask : public ProcessGroupGloo::GlooTask {
         _context(context),
         _inputs(inputs),
         _reduce_op(reduce_op),
-        _tag(tag) {}
+        _tag(tag),
+        _comm_dtype(FLAGS_gloo_allreduce_comm_dtype) {
+    PADDLE_ENFORCE_EQ(
+        _comm_dtype.empty() || _comm_dtype == "float16" ||
+            _comm_dtype == "bfloat16",
+        true, platform::errors::InvalidArgument(
+                  "FLAGS_gloo_allreduce_comm_dtype should be empty, float16 "
+                  "or bfloat16, but got %s.",
+                  _comm_dtype));
+  }
 
-  void Run() override { _do_allreduce(_inputs); }
+  void Run() override {
+    if (_inputs[0].type() == experimental::DataType::FLOAT32 &&
+        _reduce_op == ReduceOp::SUM && !_comm_dtype.empty()) {
+      if (_comm_dtype == "float16") {
+        _do_casted_allreduce<phi::dtype::float16>(_inputs);
+      } else {
+        _do_casted_allreduce<phi::dtype::bfloat16>(_inputs);
+      }
+      return;
+    }
+    _do_allreduce(_inputs);
+  }
 
  private:
   std::shared_ptr<gloo::Context> _context;
   std::vector<Tensor> _inputs;
   const ReduceOp _reduce_op;
   uint32_t _tag;
+  const std::string _comm_dtype;
 
   gloo::AllreduceOptions::Func _get_function(const experimental::DataType type,
                                              const ReduceOp op) {
@@ -264,6 +367,33 @@ class AllreduceGlooTask : public ProcessGroupGloo::GlooTask {
     opts.setTag(_tag);
     gloo::allreduce(opts);
   }
+
+  // Sends the float32 tensors casted to T.
+  template <typename T>
+  void _do_casted_allreduce(std::vector<Tensor>& tensors) {  // NOLINT
+    const size_t numel = tensors[0].numel();
+    std::vector<std::vector<T>> buffers(tensors.size(), std::vector<T>(numel));
+    std::vector<T*> ptrs(tensors.size());
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      const float* data = get_data<float>(tensors[i]);
+      for (size_t j = 0; j < numel; ++j) {
+        buffers[i][j] = static_cast<T>(data[j]);
+      }
+      ptrs[i] = buffers[i].data();
+    }
+    gloo::AllreduceOptions opts(_context);
+    opts.setInputs(ptrs, numel);
+    opts.setOutputs(ptrs, numel);
+    opts.setReduceFunction(reduce_func(&sum_in_float<T>));
+    opts.setTag(_tag);
+    gloo::allreduce(opts);
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      float* data = get_data<float>(tensors[i]);
+      for (size_t j = 0; j < numel; ++j) {
+        data[j] = static_cast<float>(buffers[i][j]);
+      }
+    }
+  }
 };
 
 std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllReduce(
@@ -273,7 +403,9 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllReduce(
   auto context = get_context();
   task = std::make_shared<AllreduceGlooTask>(rank_, context, inputs,
                                              opts.reduce_op, tag);
-  task->Run();
+  // the callers, like EagerReducer, overlap it with their computation until
+  // they wait for the task
+  Enqueue(task);
   return task;
 }
 
@@ -300,7 +432,8 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Barrier(
   std::shared_ptr<BarrierGlooTask> task;
   auto context = get_context();
   task = std::make_shared<BarrierGlooTask>(rank_, context);
-  task->Run();
+  Enqueue(task);
+  task->Wait();
   return task;
 }
 
@@ -337,12 +470,21 @@ class AllgatherGlooTask : public ProcessGroupGloo::GlooTask {
 
 std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllGather(
     std::vector<Tensor>& in_tensors, std::vector<Tensor>& out_tensors) {
+  return AllGather(in_tensors, out_tensors, true);
+}
+
+std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllGather(
+    std::vector<Tensor>& in_tensors, std::vector<Tensor>& out_tensors,
+    bool sync_op) {
   std::shared_ptr<AllgatherGlooTask> task;
   auto tag = next_tag();
   auto context = get_context();
   task = std::make_shared<AllgatherGlooTask>(rank_, context, in_tensors,
                                              out_tensors, tag);
-  task->Run();
+  Enqueue(task);
+  if (sync_op) {
+    task->Wait();
+  }
   return task;
 }
 
@@ -399,7 +541,8 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Reduce(
   auto context = get_context();
   task = std::make_shared<ReduceGlooTask>(rank_, context, tensors,
                                           opts.reduce_op, opts.root_rank, tag);
-  task->Run();
+  Enqueue(task);
+  task->Wait();
   return task;
 }
 
@@ -449,7 +592,8 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Scatter(
   auto context = get_context();
   task = std::make_shared<ScatterGlooTask>(
       rank_, context, in_tensors, out_tensors, opts.root_rank, size_, tag);
-  task->Run();
+  Enqueue(task);
+  task->Wait();
   return task;
 }
 
@@ -14,8 +14,12 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <future>
 #include <mutex>
+#include <thread>
 
 #include "paddle/fluid/distributed/collective/ProcessGroup.h"
 
@@ -42,12 +46,19 @@ class ProcessGroupGloo : public ProcessGroup {
     ~GlooTask() = default;
 
     virtual void Run() = 0;
-    bool Wait(std::chrono::milliseconds timeout) override { return true; }
-    bool IsCompleted() override { return true; }
-    void Synchronize() override {}
+    // Blocks until the task is run by the communication thread, or timeout
+    // expires if it is not zero, and rethrows the error of the task.
+    bool Wait(std::chrono::milliseconds timeout = kWaitTimeout) override;
+    void Synchronize() override;
 
    protected:
     friend class ProcessGroupGloo;
+
+    // Runs the task and wakes up the waiters.
+    void RunAndNotify();
+
+    std::condition_variable cv_;
+    std::exception_ptr exception_;
   };
 
   class GlooStore : public ::gloo::rendezvous::Store {
@@ -103,7 +114,7 @@ class ProcessGroupGloo : public ProcessGroup {
       const std::shared_ptr<paddle::distributed::Store>& store, int rank,
       int world_size, int gid, std::shared_ptr<GlooOptions> options);
 
-  ~ProcessGroupGloo() = default;
+  ~ProcessGroupGloo();
 
   std::shared_ptr<ProcessGroup::Task> Broadcast(
       std::vector<Tensor>& inputs,
@@ -120,6 +131,10 @@ class ProcessGroupGloo : public ProcessGroup {
       std::vector<Tensor>& in_tensors,
       std::vector<Tensor>& out_tensors) override;
 
+  std::shared_ptr<ProcessGroup::Task> AllGather(
+      std::vector<Tensor>& in_tensors, std::vector<Tensor>& out_tensors,
+      bool sync_op) override;
+
   std::shared_ptr<ProcessGroup::Task> Reduce(
       std::vector<Tensor>& tensors, const ReduceOptions& opts) override;
 
@@ -142,9 +157,22 @@ class ProcessGroupGloo : public ProcessGroup {
   static std::shared_ptr<::gloo::transport::Device> createDefaultDevice();
 
  protected:
+  // Queues task to the communication thread, which runs the tasks one by one
+  // in the order they are queued, so that the collectives are issued in the
+  // same order on all the ranks while the caller goes on.
+  void Enqueue(const std::shared_ptr<GlooTask>& task);
+
+  void CommLoop();
+
   uint32_t _tag;
   std::shared_ptr<gloo::rendezvous::Context> _context;
   std::shared_ptr<::gloo::rendezvous::Store> _store;
+
+  std::thread _comm_thread;
+  std::mutex _queue_mutex;
+  std::condition_variable _queue_cv;
+  std::deque<std::shared_ptr<GlooTask>> _queue;
+  bool _stop{false};
 };
 
 }  // namespace distributed
@@ -14,6 +14,15 @@
 
 #include "paddle/fluid/distributed/collective/reducer.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+DECLARE_bool(eager_reducer_autotune_group_size);
+DECLARE_double(eager_reducer_topk_ratio);
+
 namespace paddle {
 namespace distributed {
 
@@ -293,6 +302,13 @@ EagerReducer::EagerReducer(
   // initialize groups
   InitializeGroups(group_indices);
 
+  // NOTE: The allreduce of the other backends is waited on their streams,
+  // which can not be timed on the host.
+  if (FLAGS_eager_reducer_autotune_group_size &&
+      platform::is_cpu_place(inner_place_)) {
+    AutotuneGroupSize();
+  }
+
   for (size_t global_var_index = 0; global_var_index < tensors_.size();
        ++global_var_index) {
     auto tensor = tensors_[global_var_index];
@@ -382,6 +398,62 @@ void EagerReducer::InitializeGroups(
   }
 }
 
+void EagerReducer::AutotuneGroupSize() {
+  constexpr int64_t kSmallNumel = 1024;
+  constexpr int64_t kLargeNumel = 4 * 1024 * 1024;
+  constexpr int kRepeatTimes = 5;
+  constexpr size_t kMinGroupSize = 1024 * 1024;
+  constexpr size_t kMaxGroupSize = 256 * 1024 * 1024;
+
+  distributed::AllreduceOptions opts;
+  opts.reduce_op = ReduceOp::SUM;
+  auto time_allreduce = [&](int64_t numel) {
+    std::vector<Tensor> tensors = {paddle::experimental::full(
+        IntArray({numel}), 0.0, DataType::FLOAT32, inner_place_)};
+    // the first allreduce warms up the connections
+    process_group_->AllReduce(tensors, opts)->Synchronize();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRepeatTimes; ++i) {
+      process_group_->AllReduce(tensors, opts)->Synchronize();
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / kRepeatTimes;
+  };
+  std::vector<double> times = {time_allreduce(kSmallNumel),
+                               time_allreduce(kLargeNumel)};
+
+  // the slowest rank decides, so that all the ranks regroup the same way
+  const auto *dev_ctx =
+      platform::DeviceContextPool::Instance().Get(inner_place_);
+  auto times_tensor = std::make_shared<phi::DenseTensor>();
+  framework::TensorFromVector<double>(times, *dev_ctx, times_tensor.get());
+  std::vector<Tensor> reduce_tensors = {Tensor(times_tensor)};
+  opts.reduce_op = ReduceOp::MAX;
+  process_group_->AllReduce(reduce_tensors, opts)->Synchronize();
+  framework::TensorToVector<double>(*times_tensor, *dev_ctx, &times);
+
+  // A group is sized so that the latency of its allreduce, which is about
+  // the time of the small one, is a tenth of the time of the whole.
+  const double latency = times[0];
+  const double bandwidth = (kLargeNumel - kSmallNumel) * sizeof(float) /
+                           (std::max)(times[1] - times[0], 1e-9);
+  size_t group_size = static_cast<size_t>(9 * latency * bandwidth);
+  group_size = (std::min)((std::max)(group_size, kMinGroupSize), kMaxGroupSize);
+  VLOG(0) << "[Rank " << process_group_->GetRank() << "]: "
+          << "The allreduce takes " << latency * 1e6 << " us of latency and "
+          << bandwidth / 1e6 << " MB/s of bandwidth, autotune the group size "
+          << "to " << group_size << " bytes.";
+
+  // the first group stays small, so that its allreduce starts early
+  group_size_limits_ = {(std::min)(group_size_limits_.front(), group_size),
+                        group_size};
+  auto group_indices = Eager_AssignGroupBySize(tensors_, is_sparse_gradient_,
+                                               group_size_limits_);
+  group_indices_.assign(group_indices.rbegin(), group_indices.rend());
+  InitializeGroups(group_indices_);
+}
+
 void EagerReducer::InitializeDenseGroups(
     const std::vector<size_t> &tensor_indices_, EagerGroup *p_group) {
   VLOG(3) << "InitializeDenseGroups.";
@@ -740,6 +812,9 @@ void EagerReducer::FinalizeBackward() {
   grad_need_hooks_ = false;
   for (auto &group : groups_) {
     group.task->Synchronize();
+    if (group.topk_indices_task_ != nullptr) {
+      SumTopKGradients(&group);
+    }
   }
 
   for (auto &group : groups_) {
@@ -771,6 +846,13 @@ void EagerReducer::FusedAllReduceSchedule(EagerGroup *group,
   paddle::experimental::scale_(group->dense_contents_, 1.0 / nranks_, 0.0,
                                false);
 
+  if (FLAGS_eager_reducer_topk_ratio > 0 &&
+      platform::is_cpu_place(inner_place_) &&
+      group->dtype_ == DataType::FLOAT32) {
+    TopKAllGather(group);
+    return;
+  }
+
   // all_reduce
   std::vector<Tensor> reduce_tensors = {group->dense_contents_};
   group->task = process_group_->AllReduce(reduce_tensors, opts);
@@ -778,6 +860,92 @@ void EagerReducer::FusedAllReduceSchedule(EagerGroup *group,
   // split in FinalizeBackward()
 }
 
+// The magnitude by which the top-k gradients are picked. NaN counts as the
+// largest, so that it reaches all the ranks as in the dense allreduce, and
+// the comparison stays a strict weak ordering for std::nth_element.
+static inline float TopKMagnitude(float value) {
+  return std::isnan(value) ? std::numeric_limits<float>::infinity()
+                           : std::fabs(value);
+}
+
+void EagerReducer::TopKAllGather(EagerGroup *group) {
+  PADDLE_ENFORCE_LT(FLAGS_eager_reducer_topk_ratio, 1.0,
+                    platform::errors::InvalidArgument(
+                        "FLAGS_eager_reducer_topk_ratio should be less than "
+                        "1, but got %f.",
+                        FLAGS_eager_reducer_topk_ratio));
+  const int64_t numel = group->all_length_;
+  PADDLE_ENFORCE_LE(numel, std::numeric_limits<int32_t>::max(),
+                    platform::errors::InvalidArgument(
+                        "The group of %d gradients is too large for the top-k "
+                        "sparsification.",
+                        numel));
+  const int64_t k = (std::min)(
+      numel, (std::max)(static_cast<int64_t>(1),
+                        static_cast<int64_t>(std::ceil(
+                            numel * FLAGS_eager_reducer_topk_ratio))));
+  float *data = group->dense_contents_.data<float>();
+
+  // error feedback
+  auto &residual = group->residual_;
+  if (residual.empty()) {
+    residual.resize(numel, 0.0f);
+  }
+  for (int64_t i = 0; i < numel; ++i) {
+    data[i] += residual[i];
+  }
+  std::vector<int32_t> order(numel);
+  std::iota(order.begin(), order.end(), 0);
+  std::nth_element(order.begin(), order.begin() + k, order.end(),
+                   [data](int32_t a, int32_t b) {
+                     return TopKMagnitude(data[a]) > TopKMagnitude(data[b]);
+                   });
+
+  Tensor indices = paddle::experimental::empty(
+      IntArray({k}), DataType::INT32, inner_place_);
+  Tensor values = paddle::experimental::empty(IntArray({k}),
+                                              DataType::FLOAT32, inner_place_);
+  int32_t *indices_data = indices.data<int32_t>();
+  float *values_data = values.data<float>();
+  // a non-finite gradient left out is not carried to the next steps
+  for (int64_t i = 0; i < numel; ++i) {
+    residual[i] = std::isfinite(data[i]) ? data[i] : 0.0f;
+  }
+  for (int64_t i = 0; i < k; ++i) {
+    indices_data[i] = order[i];
+    values_data[i] = data[order[i]];
+    residual[order[i]] = 0.0f;
+  }
+
+  // the gathers run while the backward goes on, see SumTopKGradients
+  std::vector<Tensor> in_tensors = {indices};
+  std::vector<Tensor> out_tensors = {paddle::experimental::empty(
+      IntArray({k * nranks_}), DataType::INT32, inner_place_)};
+  group->topk_indices_task_ =
+      process_group_->AllGather(in_tensors, out_tensors, false);
+  group->topk_indices_ = out_tensors[0];
+  in_tensors = {values};
+  out_tensors = {paddle::experimental::empty(
+      IntArray({k * nranks_}), DataType::FLOAT32, inner_place_)};
+  group->task = process_group_->AllGather(in_tensors, out_tensors, false);
+  group->topk_values_ = out_tensors[0];
+}
+
+void EagerReducer::SumTopKGradients(EagerGroup *group) {
+  group->topk_indices_task_->Synchronize();
+  float *data = group->dense_contents_.data<float>();
+  std::fill(data, data + group->all_length_, 0.0f);
+  const int32_t *indices = group->topk_indices_.data<int32_t>();
+  const float *values = group->topk_values_.data<float>();
+  const int64_t num = group->topk_values_.numel();
+  for (int64_t i = 0; i < num; ++i) {
+    data[indices[i]] += values[i];
+  }
+  group->topk_indices_task_.reset();
+  group->topk_indices_ = Tensor();
+  group->topk_values_ = Tensor();
+}
+
 std::ostream &operator<<(std::ostream &out, const EagerGroup &group) {
   const auto &tensors_ = group.tensor_indices_;
   out << "numel: " << group.all_length_ << " ;var number: " << tensors_.size()
@@ -67,6 +67,16 @@ class EagerGroup {
   // help to sync
   std::shared_ptr<ProcessGroup::Task> task;
 
+  // the gradients left out by the top-k sparsification, which are added to
+  // the ones of the next step
+  std::vector<float> residual_;
+
+  // the top-k gradients of all the ranks, gathered while the backward goes
+  // on and summed into dense_contents_ in FinalizeBackward
+  Tensor topk_indices_;
+  Tensor topk_values_;
+  std::shared_ptr<ProcessGroup::Task> topk_indices_task_;
+
   // context is used to select the stream for concat
   void ConcatTensors(const platform::Place &);
 
@@ -99,11 +109,19 @@ class EagerReducer {
   void InitializeGroups(const std::vector<std::vector<size_t>> &group_indices);
   void InitializeDenseGroups(const std::vector<size_t> &tensor_indices_,
                              EagerGroup *p_group);
+  // Times the allreduce of process_group_ and regroups the tensors by the
+  // group size that hides its latency.
+  void AutotuneGroupSize();
   void PrepareForBackward(const std::vector<Tensor> &outputs);
   void AddDistHook(size_t var_index);
   void MarkVarReady(const size_t var_index, const bool is_used_var);
   void MarkGroupReady(const size_t group_index);
   void FusedAllReduceSchedule(EagerGroup *group, const int curr_group_index);
+  // Starts to exchange the top-k gradients of group by allgather, with error
+  // feedback.
+  void TopKAllGather(EagerGroup *group);
+  // Sums the gathered top-k gradients of group into its dense contents.
+  void SumTopKGradients(EagerGroup *group);
   void FinalizeBackward();
   void TraverseBackwardGraph(const std::vector<Tensor> &outputs);
   void ProcessUnusedDenseVars();
@@ -116,6 +116,12 @@ void Carrier::CopyParameters(
 
 bool Carrier::EnqueueInterceptorMessage(
     const InterceptorMessage& interceptor_message) {
+  return EnqueueInterceptorMessage(
+      LocalInterceptorMessage(interceptor_message));
+}
+
+bool Carrier::EnqueueInterceptorMessage(
+    const LocalInterceptorMessage& interceptor_message) {
   PADDLE_ENFORCE_EQ(
       interceptor_message.ctrl_message(), false,
       platform::errors::Fatal(
@@ -152,7 +158,7 @@ void Carrier::Start() {
   for (int64_t id : source_interceptor_ids_) {
     VLOG(3) << "Carrier Start is sending start to source interceptor " << id
             << ".";
-    InterceptorMessage start_msg;
+    LocalInterceptorMessage start_msg;
     // source node data_is_ready is send by carrier, so set src_id=-1
     start_msg.set_src_id(-1);
     start_msg.set_dst_id(id);
@@ -184,7 +190,7 @@ int64_t Carrier::GetRank(int64_t interceptor_id) const {
   return interceptor_id_to_rank_.at(interceptor_id);
 }
 
-bool Carrier::Send(const InterceptorMessage& msg) {
+bool Carrier::Send(const LocalInterceptorMessage& msg) {
   int64_t src_id = (msg.src_id() == -1) ? msg.dst_id() : msg.src_id();
   int64_t dst_id = msg.dst_id();
   int64_t src_rank = GetRank(src_id);
@@ -202,7 +208,7 @@ bool Carrier::Send(const InterceptorMessage& msg) {
     VLOG(3) << "Send a message from interceptor " << src_id
             << " to interceptor " << dst_id
             << ", which are in different ranks.";
-    return GlobalVal<MessageBus>::Get()->Send(dst_rank, msg);
+    return GlobalVal<MessageBus>::Get()->Send(dst_rank, msg.ToProto());
   }
 }
 
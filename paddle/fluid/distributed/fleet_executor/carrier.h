@@ -69,6 +69,9 @@ class Carrier final {
   void WakeUp();
 
   // Enqueue a message to corresponding interceptor id
+  bool EnqueueInterceptorMessage(
+      const LocalInterceptorMessage& interceptor_message);
+  // Enqueue a message received from another rank
   bool EnqueueInterceptorMessage(const InterceptorMessage& interceptor_message);
 
   // get interceptor based on the interceptor id
@@ -82,7 +85,8 @@ class Carrier final {
 
   bool IsInit() const;
 
-  bool Send(const InterceptorMessage& msg);
+  // The message is only converted to protobuf if it is sent to another rank.
+  bool Send(const LocalInterceptorMessage& msg);
 
  private:
   DISABLE_COPY_AND_ASSIGN(Carrier);
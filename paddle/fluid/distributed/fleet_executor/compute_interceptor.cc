@@ -25,7 +25,8 @@ namespace distributed {
 ComputeInterceptor::ComputeInterceptor(int64_t interceptor_id, TaskNode* node)
     : Interceptor(interceptor_id, node) {
   PrepareDeps();
-  RegisterMsgHandle([this](const InterceptorMessage& msg) { Compute(msg); });
+  RegisterMsgHandle(
+      [this](const LocalInterceptorMessage& msg) { Compute(msg); });
 }
 
 void ComputeInterceptor::PrepareDeps() {
@@ -137,7 +138,7 @@ void ComputeInterceptor::SendDataReadyToDownStream() {
                                      down_id, used_size, max_buff_size));
     outs.second.second = used_size;
 
-    InterceptorMessage ready_msg;
+    LocalInterceptorMessage ready_msg;
     ready_msg.set_message_type(DATA_IS_READY);
     VLOG(3) << "ComputeInterceptor " << interceptor_id_
             << " Send data_is_ready msg to " << down_id
@@ -163,7 +164,7 @@ void ComputeInterceptor::ReplyCompletedToUpStream() {
             << " for step: " << step_;
     if (up_id == -1) return;
 
-    InterceptorMessage reply_msg;
+    LocalInterceptorMessage reply_msg;
     reply_msg.set_message_type(DATA_IS_USELESS);
     Send(up_id, reply_msg);
   }
@@ -236,14 +237,14 @@ void ComputeInterceptor::TryStop() {
   // send stop to downstream
   for (auto& out : out_buffs_) {
     auto down_id = out.first;
-    InterceptorMessage stop;
+    LocalInterceptorMessage stop;
     stop.set_message_type(STOP);
     Send(down_id, stop);
   }
   stop_ = true;
 }
 
-void ComputeInterceptor::Compute(const InterceptorMessage& msg) {
+void ComputeInterceptor::Compute(const LocalInterceptorMessage& msg) {
   if (msg.message_type() == DATA_IS_READY) {
     IncreaseReady(msg.src_id());
     Run();
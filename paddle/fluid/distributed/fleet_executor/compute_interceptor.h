@@ -41,7 +41,7 @@ class ComputeInterceptor : public Interceptor {
   bool CanWriteOutput();
 
   void Run();
-  void Compute(const InterceptorMessage& msg);
+  void Compute(const LocalInterceptorMessage& msg);
 
   void ReceivedStop(int64_t up_id);
   void TryStop();
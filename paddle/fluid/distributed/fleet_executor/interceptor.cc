@@ -25,37 +25,41 @@ Interceptor::Interceptor(int64_t interceptor_id, TaskNode* node)
 
 Interceptor::~Interceptor() {
   // FIXME(wangxi): throw in stop function
-  // std::lock_guard<std::mutex> lock(mutex_);
-  // PADDLE_ENFORCE_EQ(messages_.empty(), true,
+  // PADDLE_ENFORCE_EQ(pending_messages_.load(), 0,
   //                  platform::errors::PreconditionNotMet(
   //                      "Interceptor must destruct with messages empty"));
 }
 
 void Interceptor::RegisterMsgHandle(MsgHandle handle) { handle_ = handle; }
 
-void Interceptor::Handle(const InterceptorMessage& msg) {
+void Interceptor::Handle(const LocalInterceptorMessage& msg) {
   PADDLE_ENFORCE_NOT_NULL(handle_, platform::errors::PreconditionNotMet(
                                        "Message handle is not registered."));
   handle_(msg);
 }
 
 void Interceptor::LoopOnce() {
-  std::deque<InterceptorMessage> tmp_messages;
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    messages_.swap(tmp_messages);
-  }
-  PADDLE_ENFORCE_EQ(tmp_messages.empty(), false,
+  int64_t pending = pending_messages_.load(std::memory_order_acquire);
+  PADDLE_ENFORCE_GT(pending, 0,
                     platform::errors::PreconditionNotMet(
-                        "tmp_messages must not empty in task loop"));
-
-  for (auto& msg : tmp_messages) {
-    const MessageType message_type = msg.message_type();
-    VLOG(3) << "Interceptor " << interceptor_id_ << " has received a message"
-            << " from interceptor " << msg.src_id()
-            << " with message: " << message_type << ".";
-
-    Handle(msg);
+                        "The mailbox must not be empty in task loop."));
+  while (pending > 0) {
+    int64_t handled = 0;
+    LocalInterceptorMessage msg;
+    while (handled < pending) {
+      if (!messages_.Pop(&msg)) {
+        // the message is being enqueued
+        std::this_thread::yield();
+        continue;
+      }
+      VLOG(3) << "Interceptor " << interceptor_id_
+              << " has received a message from interceptor " << msg.src_id()
+              << " with message: " << msg.message_type() << ".";
+      Handle(msg);
+      ++handled;
+    }
+    pending = pending_messages_.fetch_sub(handled, std::memory_order_acq_rel) -
+              handled;
   }
 }
 
@@ -66,23 +70,21 @@ void Interceptor::StopCarrier() {
 }
 
 void Interceptor::EnqueueRemoteInterceptorMessage(
-    const InterceptorMessage& message) {
-  // Called by Carrier, enqueue an InterceptorMessage to remote mailbox
+    const LocalInterceptorMessage& message) {
+  // Called by Carrier, enqueue a message to remote mailbox
   VLOG(3) << "Enqueue message: " << message.message_type() << " into "
           << interceptor_id_ << "'s remote mailbox.";
 
-  bool empty = false;
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    empty = messages_.empty();
-    messages_.emplace_back(message);
-  }
+  // counts the message before it is pushed, so that LoopOnce waits for it
+  bool empty =
+      pending_messages_.fetch_add(1, std::memory_order_acq_rel) == 0;
+  messages_.Push(message);
   if (empty) {
     loop_->QueueInLoop([this]() { LoopOnce(); });
   }
 }
 
-bool Interceptor::Send(int64_t dst_id, InterceptorMessage& msg) {
+bool Interceptor::Send(int64_t dst_id, LocalInterceptorMessage& msg) {
   PADDLE_ENFORCE_NOT_NULL(carrier_, platform::errors::PreconditionNotMet(
                                         "Carrier is not registered."));
   msg.set_src_id(interceptor_id_);
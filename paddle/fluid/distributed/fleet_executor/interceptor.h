@@ -14,16 +14,15 @@
 
 #pragma once
 
-#include <condition_variable>
-#include <deque>
+#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
 #include <thread>
 #include <vector>
 
-#include "paddle/fluid/distributed/fleet_executor/interceptor_message.pb.h"
-#include "paddle/fluid/framework/blocking_queue.h"
+#include "paddle/fluid/distributed/fleet_executor/local_interceptor_message.h"
+#include "paddle/fluid/distributed/fleet_executor/mpsc_queue.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/errors.h"
 #include "paddle/fluid/platform/macros.h"
@@ -42,7 +41,7 @@ class TaskLoop;
 
 class Interceptor {
  public:
-  using MsgHandle = std::function<void(const InterceptorMessage&)>;
+  using MsgHandle = std::function<void(const LocalInterceptorMessage&)>;
 
  public:
   Interceptor() = delete;
@@ -54,16 +53,16 @@ class Interceptor {
   // register interceptor handle
   void RegisterMsgHandle(MsgHandle handle);
 
-  void Handle(const InterceptorMessage& msg);
+  void Handle(const LocalInterceptorMessage& msg);
 
   // return the interceptor id
   int64_t GetInterceptorId() const { return interceptor_id_; }
 
-  // Called by Carrier, enqueue an InterceptorMessage to remote mailbox
+  // Called by Carrier, enqueue a message to remote mailbox
   void EnqueueRemoteInterceptorMessage(
-      const InterceptorMessage& interceptor_message);
+      const LocalInterceptorMessage& interceptor_message);
 
-  bool Send(int64_t dst_id, InterceptorMessage& msg);  // NOLINT
+  bool Send(int64_t dst_id, LocalInterceptorMessage& msg);  // NOLINT
 
   void SetPlace(const platform::Place& place) { place_ = place; }
 
@@ -109,8 +108,12 @@ class Interceptor {
   // interceptor handle which process message
   MsgHandle handle_{nullptr};
 
-  std::mutex mutex_;
-  std::deque<InterceptorMessage> messages_;
+  // The mailbox is lock free, and the number of the messages enqueued but
+  // not handled yet decides who queues LoopOnce in the task loop: only the
+  // sender of the first message of a batch does, and LoopOnce handles all
+  // of the messages of the batch, including the ones sent meanwhile.
+  MpscQueue<LocalInterceptorMessage> messages_;
+  std::atomic<int64_t> pending_messages_{0};
 
   int64_t already_run_times_{0};
   int64_t used_slot_nums_{0};
@@ -0,0 +1,76 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddle/fluid/distributed/fleet_executor/interceptor_message.pb.h"
+
+namespace paddle {
+namespace distributed {
+
+// The form of InterceptorMessage the interceptors of one process pass to
+// each other, which is a plain struct with the accessors of the protobuf
+// message. The protobuf message is only built when a message is sent to
+// another rank.
+class LocalInterceptorMessage {
+ public:
+  LocalInterceptorMessage() = default;
+
+  explicit LocalInterceptorMessage(const InterceptorMessage& msg)
+      : src_id_(msg.src_id()),
+        dst_id_(msg.dst_id()),
+        message_type_(msg.message_type()),
+        ctrl_message_(msg.ctrl_message()),
+        scope_idx_(msg.scope_idx()) {}
+
+  InterceptorMessage ToProto() const {
+    InterceptorMessage msg;
+    msg.set_src_id(src_id_);
+    msg.set_dst_id(dst_id_);
+    msg.set_message_type(message_type_);
+    msg.set_ctrl_message(ctrl_message_);
+    msg.set_scope_idx(scope_idx_);
+    return msg;
+  }
+
+  int64_t src_id() const { return src_id_; }
+  void set_src_id(int64_t src_id) { src_id_ = src_id; }
+
+  int64_t dst_id() const { return dst_id_; }
+  void set_dst_id(int64_t dst_id) { dst_id_ = dst_id; }
+
+  MessageType message_type() const { return message_type_; }
+  void set_message_type(MessageType message_type) {
+    message_type_ = message_type;
+  }
+
+  bool ctrl_message() const { return ctrl_message_; }
+  void set_ctrl_message(bool ctrl_message) { ctrl_message_ = ctrl_message; }
+
+  int64_t scope_idx() const { return scope_idx_; }
+  void set_scope_idx(int64_t scope_idx) { scope_idx_ = scope_idx; }
+
+ private:
+  // the defaults of interceptor_message.proto
+  int64_t src_id_{0};
+  int64_t dst_id_{0};
+  MessageType message_type_{RESET};
+  bool ctrl_message_{false};
+  int64_t scope_idx_{0};
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,104 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace distributed {
+
+// An unbounded lock-free queue of many producers and one consumer, after
+// the intrusive MPSC queue of Dmitry Vyukov. Push takes one atomic exchange
+// and never waits, and the values of one producer are popped in the order
+// they are pushed.
+//
+// NOTE: Pop may miss a value whose Push is in progress, which the caller
+// should count on its own if it needs to wait for it.
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+  ~MpscQueue() {
+    T value;
+    while (Pop(&value)) {
+    }
+  }
+
+  // Called by any thread.
+  void Push(T value) {
+    Node* node = new Node(std::move(value));
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  // Called by the consumer thread only.
+  bool Pop(T* value) {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+      if (next == nullptr) {
+        return false;
+      }
+      tail_ = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+      tail_ = next;
+      *value = std::move(tail->value);
+      delete tail;
+      return true;
+    }
+    if (tail != head_.load(std::memory_order_acquire)) {
+      // a Push is in progress
+      return false;
+    }
+    // puts back the stub, so that the last node can be popped
+    stub_.next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = head_.exchange(&stub_, std::memory_order_acq_rel);
+    prev->next.store(&stub_, std::memory_order_release);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      tail_ = next;
+      *value = std::move(tail->value);
+      delete tail;
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(MpscQueue);
+
+  struct Node {
+    Node() = default;
+    explicit Node(T v) : value(std::move(v)) {}
+
+    std::atomic<Node*> next{nullptr};
+    T value;
+  };
+
+  Node stub_;
+  std::atomic<Node*> head_;
+  // only touched by the consumer
+  Node* tail_;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -24,7 +24,7 @@ SourceInterceptor::SourceInterceptor(int64_t interceptor_id, TaskNode* node)
   for (const auto& down : node->downstream()) {
     downstream_step_.emplace(down.first, 0);
   }
-  RegisterMsgHandle([this](const InterceptorMessage& msg) { Run(msg); });
+  RegisterMsgHandle([this](const LocalInterceptorMessage& msg) { Run(msg); });
 }
 
 void SourceInterceptor::SendDataReadyToDownStream(int64_t downstream_id) {
@@ -33,14 +33,14 @@ void SourceInterceptor::SendDataReadyToDownStream(int64_t downstream_id) {
     return;
   }
   int64_t scope_idx = micro_step % max_run_times_;
-  InterceptorMessage ready_msg;
+  LocalInterceptorMessage ready_msg;
   ready_msg.set_message_type(DATA_IS_READY);
   ready_msg.set_scope_idx(scope_idx);
   Send(downstream_id, ready_msg);
   downstream_step_.at(downstream_id) = micro_step + 1;
 }
 
-void SourceInterceptor::Run(const InterceptorMessage& msg) {
+void SourceInterceptor::Run(const LocalInterceptorMessage& msg) {
   if (msg.message_type() == START) {
     // start run in a new step, reset the previous running status
     for (const auto& down : downstream_step_) {
@@ -31,7 +31,7 @@ class SourceInterceptor : public Interceptor {
 
  private:
   void SendDataReadyToDownStream(int64_t down_id);
-  void Run(const InterceptorMessage& msg);
+  void Run(const LocalInterceptorMessage& msg);
   int64_t max_run_times_;
   // downstream_id->cur_step
   std::map<int64_t, int64_t> downstream_step_;
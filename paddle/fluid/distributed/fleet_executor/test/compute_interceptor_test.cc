@@ -30,13 +30,13 @@ class StartInterceptor : public Interceptor {
  public:
   StartInterceptor(int64_t interceptor_id, TaskNode* node)
       : Interceptor(interceptor_id, node) {
-    RegisterMsgHandle([this](const InterceptorMessage& msg) { NOP(msg); });
+    RegisterMsgHandle([this](const LocalInterceptorMessage& msg) { NOP(msg); });
   }
 
-  void NOP(const InterceptorMessage& msg) {
+  void NOP(const LocalInterceptorMessage& msg) {
     if (msg.message_type() == STOP) {
       stop_ = true;
-      InterceptorMessage stop;
+      LocalInterceptorMessage stop;
       stop.set_message_type(STOP);
       Send(1, stop);  // stop 1, compute
       return;
@@ -71,7 +71,7 @@ TEST(ComputeInterceptor, Compute) {
   carrier->SetInterceptor(1, InterceptorFactory::Create("Compute", 1, node_b));
   carrier->SetInterceptor(2, InterceptorFactory::Create("Compute", 2, node_c));
 
-  InterceptorMessage msg;
+  LocalInterceptorMessage msg;
   msg.set_message_type(DATA_IS_READY);
   // test run three times
   a->Send(1, msg);
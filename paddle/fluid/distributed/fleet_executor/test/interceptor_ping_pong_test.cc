@@ -29,10 +29,11 @@ class PingPongInterceptor : public Interceptor {
  public:
   PingPongInterceptor(int64_t interceptor_id, TaskNode* node)
       : Interceptor(interceptor_id, node) {
-    RegisterMsgHandle([this](const InterceptorMessage& msg) { PingPong(msg); });
+    RegisterMsgHandle(
+        [this](const LocalInterceptorMessage& msg) { PingPong(msg); });
   }
 
-  void PingPong(const InterceptorMessage& msg) {
+  void PingPong(const LocalInterceptorMessage& msg) {
     if (msg.message_type() == STOP) {
       stop_ = true;
       return;
@@ -41,7 +42,7 @@ class PingPongInterceptor : public Interceptor {
               << std::endl;
     ++count_;
     if (count_ == 20) {
-      InterceptorMessage stop;
+      LocalInterceptorMessage stop;
       stop.set_message_type(STOP);
       Send(0, stop);
       Send(1, stop);
@@ -49,7 +50,7 @@ class PingPongInterceptor : public Interceptor {
       return;
     }
 
-    InterceptorMessage resp;
+    LocalInterceptorMessage resp;
     Send(msg.src_id(), resp);
   }
 
@@ -72,7 +73,7 @@ TEST(InterceptorTest, PingPong) {
 
   carrier->SetInterceptor(1, std::make_unique<PingPongInterceptor>(1, nullptr));
 
-  InterceptorMessage msg;
+  LocalInterceptorMessage msg;
   a->Send(1, msg);
 
   carrier->Wait();
@@ -31,10 +31,11 @@ class PingPongInterceptor : public Interceptor {
  public:
   PingPongInterceptor(int64_t interceptor_id, TaskNode* node)
       : Interceptor(interceptor_id, node) {
-    RegisterMsgHandle([this](const InterceptorMessage& msg) { PingPong(msg); });
+    RegisterMsgHandle(
+        [this](const LocalInterceptorMessage& msg) { PingPong(msg); });
   }
 
-  void PingPong(const InterceptorMessage& msg) {
+  void PingPong(const LocalInterceptorMessage& msg) {
     if (msg.message_type() == STOP) {
       stop_ = true;
       StopCarrier();
@@ -44,14 +45,14 @@ class PingPongInterceptor : public Interceptor {
               << std::endl;
     ++count_;
     if (count_ == 20 && GetInterceptorId() == 0) {
-      InterceptorMessage stop;
+      LocalInterceptorMessage stop;
       stop.set_message_type(STOP);
       Send(0, stop);
       Send(1, stop);
       return;
     }
 
-    InterceptorMessage resp;
+    LocalInterceptorMessage resp;
     int64_t dst = GetInterceptorId() == 0 ? 1 : 0;
     Send(dst, resp);
   }
@@ -119,7 +120,7 @@ TEST(InterceptorTest, PingPong) {
     Interceptor* a = carrier->SetInterceptor(
         0, InterceptorFactory::Create("PingPong", 0, nullptr));
     msg_bus->Barrier();
-    InterceptorMessage msg;
+    LocalInterceptorMessage msg;
     a->Send(1, msg);
     carrier->Wait();
   } else {
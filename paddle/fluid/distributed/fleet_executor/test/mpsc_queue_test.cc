@@ -0,0 +1,89 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "paddle/fluid/distributed/fleet_executor/mpsc_queue.h"
+
+namespace paddle {
+namespace distributed {
+
+TEST(MpscQueue, PushPop) {
+  MpscQueue<int> queue;
+  int value = -1;
+  ASSERT_FALSE(queue.Pop(&value));
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 5; ++i) {
+      queue.Push(i);
+    }
+    for (int i = 0; i < 5; ++i) {
+      ASSERT_TRUE(queue.Pop(&value));
+      ASSERT_EQ(value, i);
+    }
+    ASSERT_FALSE(queue.Pop(&value));
+  }
+}
+
+TEST(MpscQueue, MoveOnly) {
+  MpscQueue<std::unique_ptr<int>> queue;
+  queue.Push(std::make_unique<int>(1));
+  queue.Push(std::make_unique<int>(2));
+  std::unique_ptr<int> value;
+  ASSERT_TRUE(queue.Pop(&value));
+  ASSERT_EQ(*value, 1);
+  // the rest is released by the queue
+}
+
+TEST(MpscQueue, MultiProducer) {
+  const int kThreadNum = 8;
+  const int kNumPerThread = 100000;
+  MpscQueue<int> queue;
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kThreadNum; ++i) {
+    producers.emplace_back([&queue, i] {
+      for (int j = 0; j < kNumPerThread; ++j) {
+        queue.Push(i * kNumPerThread + j);
+      }
+    });
+  }
+
+  // The values of one producer are popped in order.
+  std::vector<int> last(kThreadNum);
+  for (int i = 0; i < kThreadNum; ++i) {
+    last[i] = i * kNumPerThread - 1;
+  }
+  int popped = 0;
+  while (popped < kThreadNum * kNumPerThread) {
+    int value = 0;
+    if (!queue.Pop(&value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(value, last[value / kNumPerThread] + 1);
+    last[value / kNumPerThread] = value;
+    ++popped;
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  int value = 0;
+  ASSERT_FALSE(queue.Pop(&value));
+}
+
+}  // namespace distributed
+}  // namespace paddle
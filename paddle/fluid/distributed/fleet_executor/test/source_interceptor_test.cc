@@ -31,14 +31,14 @@ class FakeInterceptor : public Interceptor {
   FakeInterceptor(int64_t interceptor_id, TaskNode* node)
       : Interceptor(interceptor_id, node) {
     step_ = 0;
-    RegisterMsgHandle([this](const InterceptorMessage& msg) { NOP(msg); });
+    RegisterMsgHandle([this](const LocalInterceptorMessage& msg) { NOP(msg); });
   }
 
-  void NOP(const InterceptorMessage& msg) {
+  void NOP(const LocalInterceptorMessage& msg) {
     if (msg.message_type() == DATA_IS_READY) {
       std::cout << "FakeInterceptor run in scope " << msg.scope_idx()
                 << std::endl;
-      InterceptorMessage reply;
+      LocalInterceptorMessage reply;
       reply.set_message_type(DATA_IS_USELESS);
       Send(-1, reply);
       step_++;
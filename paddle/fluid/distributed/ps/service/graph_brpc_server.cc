@@ -179,6 +179,8 @@ int32_t GraphBrpcService::initialize() {
   _service_handler_map[PS_STOP_SERVER] = &GraphBrpcService::stop_server;
   _service_handler_map[PS_LOAD_ONE_TABLE] = &GraphBrpcService::load_one_table;
   _service_handler_map[PS_LOAD_ALL_TABLE] = &GraphBrpcService::load_all_table;
+  _service_handler_map[PS_SAVE_ONE_TABLE] = &GraphBrpcService::save_one_table;
+  _service_handler_map[PS_SAVE_ALL_TABLE] = &GraphBrpcService::save_all_table;
 
   _service_handler_map[PS_PRINT_TABLE_STAT] =
       &GraphBrpcService::print_table_stat;
@@ -325,6 +327,38 @@ int32_t GraphBrpcService::load_all_table(Table *table,
   return 0;
 }
 
+int32_t GraphBrpcService::save_one_table(Table *table,
+                                         const PsRequestMessage &request,
+                                         PsResponseMessage &response,
+                                         brpc::Controller *cntl) {
+  CHECK_TABLE_EXIST(table, request, response)
+  if (request.params_size() < 2) {
+    set_response_code(
+        response, -1,
+        "PsRequestMessage.datas is requeired at least 2 for path & mode");
+    return -1;
+  }
+  if (table->save(request.params(0), request.params(1)) != 0) {
+    set_response_code(response, -1, "table save failed");
+    return -1;
+  }
+  return 0;
+}
+
+int32_t GraphBrpcService::save_all_table(Table *table,
+                                         const PsRequestMessage &request,
+                                         PsResponseMessage &response,
+                                         brpc::Controller *cntl) {
+  auto &table_map = *(_server->table());
+  for (auto &itr : table_map) {
+    if (save_one_table(itr.second.get(), request, response, cntl) != 0) {
+      LOG(ERROR) << "save table[" << itr.first << "] failed";
+      return -1;
+    }
+  }
+  return 0;
+}
+
 int32_t GraphBrpcService::stop_server(Table *table,
                                       const PsRequestMessage &request,
                                       PsResponseMessage &response,
@@ -106,6 +106,10 @@ class GraphBrpcService : public PsBaseService {
                          PsResponseMessage &response, brpc::Controller *cntl);
   int32_t load_all_table(Table *table, const PsRequestMessage &request,
                          PsResponseMessage &response, brpc::Controller *cntl);
+  int32_t save_one_table(Table *table, const PsRequestMessage &request,
+                         PsResponseMessage &response, brpc::Controller *cntl);
+  int32_t save_all_table(Table *table, const PsRequestMessage &request,
+                         PsResponseMessage &response, brpc::Controller *cntl);
   int32_t stop_server(Table *table, const PsRequestMessage &request,
                       PsResponseMessage &response, brpc::Controller *cntl);
   int32_t start_profiler(Table *table, const PsRequestMessage &request,
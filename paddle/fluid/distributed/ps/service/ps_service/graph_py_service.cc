@@ -290,6 +290,23 @@ void GraphPyClient::load_node_file(std::string name, std::string filepath) {
   }
 }
 
+void GraphPyClient::save_frozen_graph(std::string name, std::string path) {
+  if (this->table_id_map.count(name)) {
+    uint32_t table_id = this->table_id_map[name];
+    auto status = get_ps_client()->save(table_id, path, std::string(""));
+    status.wait();
+  }
+}
+
+void GraphPyClient::load_frozen_graph(std::string name, std::string path) {
+  // 'f' means load the frozen CSR shards
+  if (this->table_id_map.count(name)) {
+    uint32_t table_id = this->table_id_map[name];
+    auto status = get_ps_client()->load(table_id, path, std::string("f"));
+    status.wait();
+  }
+}
+
 std::pair<std::vector<std::vector<int64_t>>, std::vector<float>>
 GraphPyClient::batch_sample_neighbors(std::string name,
                                       std::vector<int64_t> node_ids,
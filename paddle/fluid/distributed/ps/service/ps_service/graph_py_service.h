@@ -158,6 +158,9 @@ class GraphPyClient : public GraphPyService {
   void finalize_worker();
   void load_edge_file(std::string name, std::string filepath, bool reverse);
   void load_node_file(std::string name, std::string filepath);
+  // freezes the table and saves it as CSR shards under path
+  void save_frozen_graph(std::string name, std::string path);
+  void load_frozen_graph(std::string name, std::string path);
   void clear_nodes(std::string name);
   void add_graph_node(std::string name, std::vector<int64_t>& node_ids,
                       std::vector<bool>& weight_list);
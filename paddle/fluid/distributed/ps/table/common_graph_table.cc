@@ -20,6 +20,7 @@
 #include <sstream>
 #include "paddle/fluid/distributed/common/utils.h"
 #include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_text_file.h"
 #include "paddle/fluid/framework/generator.h"
 #include "paddle/fluid/string/printf.h"
 #include "paddle/fluid/string/string_helper.h"
@@ -318,6 +319,10 @@ size_t GraphShard::get_size() { return bucket.size(); }
 
 int32_t GraphTable::add_graph_node(std::vector<int64_t> &id_list,
                                    std::vector<bool> &is_weight_list) {
+  if (frozen) {
+    VLOG(0) << "graph table is frozen, add_graph_node is not allowed";
+    return -1;
+  }
   size_t node_size = id_list.size();
   std::vector<std::vector<std::pair<int64_t, bool>>> batch(task_pool_size_);
   for (size_t i = 0; i < node_size; i++) {
@@ -344,6 +349,10 @@ int32_t GraphTable::add_graph_node(std::vector<int64_t> &id_list,
 }
 
 int32_t GraphTable::remove_graph_node(std::vector<int64_t> &id_list) {
+  if (frozen) {
+    VLOG(0) << "graph table is frozen, remove_graph_node is not allowed";
+    return -1;
+  }
   size_t node_size = id_list.size();
   std::vector<std::vector<int64_t>> batch(task_pool_size_);
   for (size_t i = 0; i < node_size; i++) {
@@ -459,6 +468,10 @@ int32_t GraphTable::load(const std::string &path, const std::string &param) {
     std::string node_type = param.substr(1);
     return this->load_nodes(path, node_type);
   }
+  // 'f' means load the shards saved by save_frozen_graph
+  if (param[0] == 'f') {
+    return this->load_frozen_graph(path);
+  }
   return 0;
 }
 
@@ -468,7 +481,7 @@ int32_t GraphTable::get_nodes_ids_by_ranges(
   res.clear();
   std::vector<std::future<std::vector<int64_t>>> tasks;
   for (size_t i = 0; i < shards.size() && index < (int)ranges.size(); i++) {
-    end = total_size + shards[i]->get_size();
+    end = total_size + get_shard_size(i);
     start = total_size;
     while (start < end && index < (int)ranges.size()) {
       if (ranges[index].second <= start)
@@ -483,11 +496,16 @@ int32_t GraphTable::get_nodes_ids_by_ranges(
         second -= total_size;
         tasks.push_back(_shards_task_pool[i % task_pool_size_]->enqueue(
             [this, first, second, i]() -> std::vector<int64_t> {
-              return shards[i]->get_ids_by_range(first, second);
+              if (!frozen) return shards[i]->get_ids_by_range(first, second);
+              std::vector<int64_t> ids;
+              for (int j = first; j < second; j++) {
+                ids.push_back(csr_shards[i]->get_id(j));
+              }
+              return ids;
             }));
       }
     }
-    total_size += shards[i]->get_size();
+    total_size += get_shard_size(i);
   }
   for (size_t i = 0; i < tasks.size(); i++) {
     auto vec = tasks[i].get();
@@ -499,53 +517,133 @@ int32_t GraphTable::get_nodes_ids_by_ranges(
   return 0;
 }
 
-int32_t GraphTable::load_nodes(const std::string &path, std::string node_type) {
-  auto paths = paddle::string::split_string<std::string>(path, ";");
-  int64_t count = 0;
-  int64_t valid_count = 0;
-  for (auto path : paths) {
-    std::ifstream file(path);
-    std::string line;
-    while (std::getline(file, line)) {
-      auto values = paddle::string::split_string<std::string>(line, "\t");
-      if (values.size() < 2) continue;
-      auto id = std::stoull(values[1]);
+// Graph files are split into line-aligned blocks of at least this size,
+// each parsed by one task of the shard thread pools.
+static const size_t kGraphLoadBlockSize = 4 << 20;
+// The blocks are parsed and inserted in chunks of this many blocks per pool
+// thread, which bounds the records staged at a time.
+static const size_t kGraphLoadChunkBlocks = 2;
 
-      size_t shard_id = id % shard_num;
-      if (shard_id >= shard_end || shard_id < shard_start) {
-        VLOG(4) << "will not load " << id << " from " << path
-                << ", please check id distribution";
-        continue;
-      }
+struct GraphLoadBlock {
+  const GraphTextFile *file;
+  size_t begin;
+  size_t end;
+};
 
-      if (count % 1000000 == 0) {
-        VLOG(0) << count << " nodes are loaded from filepath";
-        VLOG(0) << line;
-      }
-      count++;
+static std::vector<GraphLoadBlock> split_graph_files(
+    const std::vector<std::string> &paths, int block_num,
+    std::vector<std::unique_ptr<GraphTextFile>> *files) {
+  std::vector<GraphLoadBlock> blocks;
+  for (auto &path : paths) {
+    files->emplace_back(new GraphTextFile());
+    auto &file = files->back();
+    if (file->open(path) != 0) {
+      VLOG(0) << "failed to open graph file " << path;
+      continue;
+    }
+    for (auto &range : file->split(block_num, kGraphLoadBlockSize)) {
+      blocks.push_back({file.get(), range.first, range.second});
+    }
+  }
+  return blocks;
+}
 
-      std::string nt = values[0];
-      if (nt != node_type) {
-        continue;
-      }
+int32_t GraphTable::load_nodes(const std::string &path, std::string node_type) {
+  auto paths = paddle::string::split_string<std::string>(path, ";");
+  std::vector<std::unique_ptr<GraphTextFile>> files;
+  auto blocks = split_graph_files(paths, task_pool_size_, &files);
 
-      size_t index = shard_id - shard_start;
+  // Each block is parsed into per-thread staging buffers, which are then
+  // drained by the thread that owns the corresponding shards, so no shard is
+  // touched by two threads. Only one chunk of blocks is staged at a time.
+  struct NodeRecord {
+    int64_t id;
+    std::vector<std::pair<int32_t, std::string>> feats;
+  };
+  struct BlockResult {
+    std::vector<std::vector<NodeRecord>> nodes;
+    int64_t count = 0;
+  };
+  int64_t count = 0, valid_count = 0;
+  size_t chunk_size = kGraphLoadChunkBlocks * task_pool_size_;
+  for (size_t chunk_begin = 0; chunk_begin < blocks.size();
+       chunk_begin += chunk_size) {
+    size_t chunk_end = std::min(blocks.size(), chunk_begin + chunk_size);
+    std::vector<BlockResult> results(chunk_end - chunk_begin);
+    std::vector<std::future<int>> tasks;
+    for (size_t b = chunk_begin; b < chunk_end; b++) {
+      tasks.push_back(_shards_task_pool[b % task_pool_size_]->enqueue(
+          [&, b, this]() -> int {
+            auto &block = blocks[b];
+            auto &result = results[b - chunk_begin];
+            result.nodes.resize(task_pool_size_);
+            const char *data = block.file->data();
+            TextSlice fields[2];
+            for_each_line(
+                data + block.begin, data + block.end, [&](TextSlice line) {
+                  if (split_fields(line, '\t', fields, 2) < 2) return;
+                  TextSlice id_field = fields[1];
+                  const char *tab = reinterpret_cast<const char *>(
+                      memchr(id_field.begin, '\t', id_field.size()));
+                  TextSlice feat_field{
+                      tab == nullptr ? id_field.end : tab + 1, id_field.end};
+                  if (tab != nullptr) id_field.end = tab;
+                  uint64_t id;
+                  if (!parse_uint64(id_field, &id)) return;
 
-      auto node = shards[index]->add_feature_node(id);
+                  size_t shard_id = id % shard_num;
+                  if (shard_id >= shard_end || shard_id < shard_start) {
+                    VLOG(4) << "will not load " << id
+                            << ", please check id distribution";
+                    return;
+                  }
+                  result.count++;
+                  if (!fields[0].equals(node_type)) return;
 
-      node->set_feature_size(feat_name.size());
+                  NodeRecord record;
+                  record.id = id;
+                  if (tab != nullptr) {
+                    auto feats = paddle::string::split_string<std::string>(
+                        feat_field.to_string(), "\t");
+                    for (auto &feat_str : feats) {
+                      auto feat = this->parse_feature(feat_str);
+                      if (feat.first >= 0) {
+                        record.feats.push_back(std::move(feat));
+                      } else {
+                        VLOG(4) << "Node feature:  " << feat_str
+                                << " not in feature_map.";
+                      }
+                    }
+                  }
+                  result.nodes[get_thread_pool_index(id)].push_back(
+                      std::move(record));
+                });
+            return 0;
+          }));
+    }
+    for (auto &task : tasks) task.get();
+    tasks.clear();
 
-      for (size_t slice = 2; slice < values.size(); slice++) {
-        auto feat = this->parse_feature(values[slice]);
-        if (feat.first >= 0) {
-          node->set_feature(feat.first, feat.second);
-        } else {
-          VLOG(4) << "Node feature:  " << values[slice]
-                  << " not in feature_map.";
+    for (int i = 0; i < task_pool_size_; i++) {
+      tasks.push_back(_shards_task_pool[i]->enqueue([&, i, this]() -> int {
+        int valid_count = 0;
+        for (auto &result : results) {
+          for (auto &record : result.nodes[i]) {
+            size_t index = record.id % this->shard_num - this->shard_start;
+            auto node = this->shards[index]->add_feature_node(record.id);
+            node->set_feature_size(this->feat_name.size());
+            for (auto &feat : record.feats) {
+              node->set_feature(feat.first, feat.second);
+            }
+            valid_count++;
+          }
+          std::vector<NodeRecord>().swap(result.nodes[i]);
         }
-      }
-      valid_count++;
+        return valid_count;
+      }));
     }
+    for (auto &task : tasks) valid_count += task.get();
+    for (auto &result : results) count += result.count;
   }
 
   VLOG(0) << valid_count << "/" << count << " nodes in type " << node_type
@@ -554,43 +652,138 @@ int32_t GraphTable::load_nodes(const std::string &path, std::string node_type) {
 }
 
 int32_t GraphTable::load_edges(const std::string &path, bool reverse_edge) {
+  if (frozen) {
+    VLOG(0) << "graph table is frozen, call clear_nodes before load_edges";
+    return -1;
+  }
 #ifdef PADDLE_WITH_HETERPS
   if (gpups_mode) pthread_rwlock_rdlock(rw_lock.get());
 #endif
   auto paths = paddle::string::split_string<std::string>(path, ";");
-  int64_t count = 0;
-  std::string sample_type = "random";
-  bool is_weighted = false;
-  int valid_count = 0;
+  std::vector<std::unique_ptr<GraphTextFile>> files;
+  auto blocks = split_graph_files(paths, task_pool_size_, &files);
+
+  // The edge blobs of a node are typed when its first edge is added, so
+  // whether the edges are weighted is decided over all the files before any
+  // of them is inserted. This pass only splits the lines.
+  std::atomic<bool> weighted_found(false);
+  std::vector<std::future<int>> tasks;
+  for (size_t b = 0; b < blocks.size(); b++) {
+    tasks.push_back(_shards_task_pool[b % task_pool_size_]->enqueue(
+        [&, b]() -> int {
+          auto &block = blocks[b];
+          const char *data = block.file->data();
+          TextSlice fields[4];
+          float weight;
+          for_each_line(
+              data + block.begin, data + block.end, [&](TextSlice line) {
+                if (weighted_found.load(std::memory_order_relaxed)) return;
+                if (split_fields(line, '\t', fields, 4) == 3 &&
+                    parse_float(fields[2], &weight)) {
+                  weighted_found.store(true, std::memory_order_relaxed);
+                }
+              });
+          return 0;
+        }));
+  }
+  for (auto &task : tasks) task.get();
+  tasks.clear();
+  bool is_weighted = weighted_found.load();
+  std::string sample_type = is_weighted ? "weighted" : "random";
+
+  // The edges are parsed and inserted chunk by chunk like in load_nodes.
+  struct EdgeRecord {
+    int64_t src_id;
+    int64_t dst_id;
+    float weight;
+  };
+  struct BlockResult {
+    std::vector<std::vector<EdgeRecord>> edges;
+    std::vector<EdgeRecord> extra_edges;
+    int64_t count = 0;
+  };
+  int64_t count = 0, valid_count = 0;
+  // extra nodes are assigned to threads round-robin in file order.
   int extra_alloc_index = 0;
-  for (auto path : paths) {
-    std::ifstream file(path);
-    std::string line;
-    while (std::getline(file, line)) {
-      auto values = paddle::string::split_string<std::string>(line, "\t");
-      count++;
-      if (values.size() < 2) continue;
-      auto src_id = std::stoull(values[0]);
-      auto dst_id = std::stoull(values[1]);
-      if (reverse_edge) {
-        std::swap(src_id, dst_id);
-      }
-      float weight = 1;
-      if (values.size() == 3) {
-        weight = std::stof(values[2]);
-        sample_type = "weighted";
-        is_weighted = true;
-      }
+  size_t chunk_size = kGraphLoadChunkBlocks * task_pool_size_;
+  for (size_t chunk_begin = 0; chunk_begin < blocks.size();
+       chunk_begin += chunk_size) {
+    size_t chunk_end = std::min(blocks.size(), chunk_begin + chunk_size);
+    std::vector<BlockResult> results(chunk_end - chunk_begin);
+    for (size_t b = chunk_begin; b < chunk_end; b++) {
+      tasks.push_back(_shards_task_pool[b % task_pool_size_]->enqueue(
+          [&, b, this]() -> int {
+            auto &block = blocks[b];
+            auto &result = results[b - chunk_begin];
+            result.edges.resize(task_pool_size_);
+            const char *data = block.file->data();
+            TextSlice fields[4];
+            for_each_line(
+                data + block.begin, data + block.end, [&](TextSlice line) {
+                  result.count++;
+                  int field_num = split_fields(line, '\t', fields, 4);
+                  if (field_num < 2) return;
+                  uint64_t src_id, dst_id;
+                  if (!parse_uint64(fields[0], &src_id) ||
+                      !parse_uint64(fields[1], &dst_id)) {
+                    return;
+                  }
+                  if (reverse_edge) {
+                    std::swap(src_id, dst_id);
+                  }
+                  float weight = 1;
+                  if (field_num == 3 && !parse_float(fields[2], &weight)) {
+                    return;
+                  }
 
-      size_t src_shard_id = src_id % shard_num;
+                  EdgeRecord record{int64_t(src_id), int64_t(dst_id), weight};
+                  size_t src_shard_id = src_id % shard_num;
+                  if (src_shard_id >= shard_end ||
+                      src_shard_id < shard_start) {
+                    if (use_duplicate_nodes == false ||
+                        extra_nodes.find(src_id) == extra_nodes.end()) {
+                      VLOG(4) << "will not load " << src_id
+                              << ", please check id distribution";
+                      return;
+                    }
+                    result.extra_edges.push_back(record);
+                    return;
+                  }
+                  result.edges[get_thread_pool_index(src_id)].push_back(
+                      record);
+                });
+            return 0;
+          }));
+    }
+    for (auto &task : tasks) task.get();
+    tasks.clear();
 
-      if (src_shard_id >= shard_end || src_shard_id < shard_start) {
-        if (use_duplicate_nodes == false ||
-            extra_nodes.find(src_id) == extra_nodes.end()) {
-          VLOG(4) << "will not load " << src_id << " from " << path
-                  << ", please check id distribution";
-          continue;
+    for (int i = 0; i < task_pool_size_; i++) {
+      tasks.push_back(_shards_task_pool[i]->enqueue([&, i, this]() -> int {
+        int valid_count = 0;
+        for (auto &result : results) {
+          for (auto &record : result.edges[i]) {
+            size_t index =
+                record.src_id % this->shard_num - this->shard_start;
+            this->shards[index]
+                ->add_graph_node(record.src_id)
+                ->build_edges(is_weighted);
+            this->shards[index]->add_neighbor(record.src_id, record.dst_id,
+                                              record.weight);
+            valid_count++;
+          }
+          std::vector<EdgeRecord>().swap(result.edges[i]);
         }
+        return valid_count;
+      }));
+    }
+    for (auto &task : tasks) valid_count += task.get();
+    tasks.clear();
+
+    for (auto &result : results) {
+      count += result.count;
+      for (auto &record : result.extra_edges) {
+        int64_t src_id = record.src_id;
         int index;
         if (extra_nodes_to_thread_index.find(src_id) !=
             extra_nodes_to_thread_index.end()) {
@@ -601,33 +794,30 @@ int32_t GraphTable::load_edges(const std::string &path, bool reverse_edge) {
           extra_nodes_to_thread_index[src_id] = index;
         }
         extra_shards[index]->add_graph_node(src_id)->build_edges(is_weighted);
-        extra_shards[index]->add_neighbor(src_id, dst_id, weight);
+        extra_shards[index]->add_neighbor(src_id, record.dst_id,
+                                          record.weight);
         valid_count++;
-        continue;
-      }
-      if (count % 1000000 == 0) {
-        VLOG(0) << count << " edges are loaded from filepath";
-        VLOG(0) << line;
       }
-
-      size_t index = src_shard_id - shard_start;
-      shards[index]->add_graph_node(src_id)->build_edges(is_weighted);
-      shards[index]->add_neighbor(src_id, dst_id, weight);
-      valid_count++;
     }
   }
   VLOG(0) << valid_count << "/" << count << " edges are loaded successfully in "
           << path;
 
+  // Build Sampler
   std::vector<int> used(task_pool_size_, 0);
-  // Build Sampler j
-
-  for (auto &shard : shards) {
-    auto bucket = shard->get_bucket();
-    for (size_t i = 0; i < bucket.size(); i++) {
-      bucket[i]->build_sampler(sample_type);
-      used[get_thread_pool_index(bucket[i]->get_id())]++;
-    }
+  for (size_t i = 0; i < shards.size(); i++) {
+    tasks.push_back(
+        _shards_task_pool[get_thread_pool_index_by_shard_index(
+                              shard_start + i)]
+            ->enqueue([&, i, this]() -> int {
+              auto &bucket = this->shards[i]->get_bucket();
+              for (auto node : bucket) node->build_sampler(sample_type);
+              return bucket.size();
+            }));
+  }
+  for (size_t i = 0; i < shards.size(); i++) {
+    used[get_thread_pool_index_by_shard_index(shard_start + i)] +=
+        tasks[i].get();
   }
   /*-----------------------
   relocate the duplicate nodes to make them distributed evenly among threads.
@@ -767,6 +957,108 @@ int32_t GraphTable::clear_nodes() {
     }));
   }
   for (size_t i = 0; i < tasks.size(); i++) tasks[i].get();
+  csr_shards.clear();
+  frozen = false;
+  return 0;
+}
+
+size_t GraphTable::get_shard_size(size_t shard_index) {
+  return frozen ? csr_shards[shard_index]->node_num()
+                : shards[shard_index]->get_size();
+}
+
+const GraphCSRShard *GraphTable::find_csr_shard(int64_t id) {
+  size_t shard_id = id % shard_num;
+  if (shard_id >= shard_end || shard_id < shard_start) return nullptr;
+  return csr_shards[shard_id - shard_start].get();
+}
+
+int32_t GraphTable::freeze_graph() {
+  if (frozen) return 0;
+#ifdef PADDLE_WITH_HETERPS
+  if (gpups_mode) {
+    VLOG(0) << "freeze_graph is not supported in gpups mode";
+    return -1;
+  }
+#endif
+  if (use_duplicate_nodes) {
+    VLOG(0) << "freeze_graph is not supported with duplicate nodes";
+    return -1;
+  }
+  csr_shards.resize(shards.size());
+  std::vector<std::future<int>> tasks;
+  for (size_t i = 0; i < shards.size(); i++) {
+    tasks.push_back(
+        _shards_task_pool[i % task_pool_size_]->enqueue([this, i]() -> int {
+          auto &bucket = this->shards[i]->get_bucket();
+          this->csr_shards[i].reset(new GraphCSRShard());
+          this->csr_shards[i]->build(bucket);
+          for (auto node : bucket) node->release_edges();
+          return 0;
+        }));
+  }
+  for (size_t i = 0; i < tasks.size(); i++) tasks[i].get();
+  size_t node_num = 0, edge_num = 0;
+  for (auto &csr : csr_shards) {
+    node_num += csr->node_num();
+    edge_num += csr->edge_num();
+  }
+  VLOG(0) << "graph table frozen with " << node_num << " nodes and "
+          << edge_num << " edges";
+  frozen = true;
+  return 0;
+}
+
+int32_t GraphTable::save_frozen_graph(const std::string &path) {
+  if (!frozen) {
+    VLOG(0) << "call freeze_graph before save_frozen_graph";
+    return -1;
+  }
+  for (size_t i = 0; i < csr_shards.size(); i++) {
+    std::string file =
+        paddle::string::Sprintf("%s/csr_shard_%05d", path, shard_start + i);
+    if (csr_shards[i]->save(file) != 0) {
+      VLOG(0) << "failed to save frozen graph shard to " << file;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int32_t GraphTable::load_frozen_graph(const std::string &path) {
+#ifdef PADDLE_WITH_HETERPS
+  if (gpups_mode) {
+    VLOG(0) << "load_frozen_graph is not supported in gpups mode";
+    return -1;
+  }
+#endif
+  if (frozen) {
+    VLOG(0) << "graph table is frozen, call clear_nodes before loading";
+    return -1;
+  }
+  std::vector<std::unique_ptr<GraphCSRShard>> loaded(shards.size());
+  for (size_t i = 0; i < shards.size(); i++) {
+    std::string file =
+        paddle::string::Sprintf("%s/csr_shard_%05d", path, shard_start + i);
+    loaded[i].reset(new GraphCSRShard());
+    if (loaded[i]->load(file) != 0) {
+      VLOG(0) << "failed to load frozen graph shard from " << file;
+      return -1;
+    }
+  }
+  csr_shards.swap(loaded);
+  std::vector<std::future<int>> tasks;
+  for (size_t i = 0; i < shards.size(); i++) {
+    tasks.push_back(
+        _shards_task_pool[i % task_pool_size_]->enqueue([this, i]() -> int {
+          for (auto node : this->shards[i]->get_bucket()) {
+            node->release_edges();
+          }
+          return 0;
+        }));
+  }
+  for (size_t i = 0; i < tasks.size(); i++) tasks[i].get();
+  frozen = true;
   return 0;
 }
 
@@ -775,7 +1067,7 @@ int32_t GraphTable::random_sample_nodes(int sample_size,
                                         int &actual_size) {
   int total_size = 0;
   for (int i = 0; i < (int)shards.size(); i++) {
-    total_size += shards[i]->get_size();
+    total_size += get_shard_size(i);
   }
   if (sample_size > total_size) sample_size = total_size;
   int range_num = random_sample_nodes_ranges;
@@ -840,6 +1132,8 @@ int32_t GraphTable::random_sample_neighbors(
     std::vector<std::shared_ptr<char>> &buffers, std::vector<int> &actual_sizes,
     bool need_weight) {
   size_t node_num = buffers.size();
+  // one sampling call reads either the CSR shards or the node edges
+  bool use_csr = frozen;
   std::function<void(char *)> char_del = [](char *c) { delete[] c; };
   std::vector<std::future<int>> tasks;
   std::vector<std::vector<uint32_t>> seq_id(task_pool_size_);
@@ -874,15 +1168,29 @@ int32_t GraphTable::random_sample_neighbors(
           index++;
         } else {
           node_id = id_list[i][k].node_key;
-          Node *node = find_node(node_id);
           idx = seq_id[i][k];
           int &actual_size = actual_sizes[idx];
-          if (node == nullptr) {
-            actual_size = 0;
-            continue;
+          Node *node = nullptr;
+          const GraphCSRShard *csr = nullptr;
+          int64_t csr_idx = -1;
+          if (use_csr) {
+            csr = find_csr_shard(node_id);
+            if (csr != nullptr) csr_idx = csr->find(node_id);
+            if (csr_idx < 0) {
+              actual_size = 0;
+              continue;
+            }
+          } else {
+            node = find_node(node_id);
+            if (node == nullptr) {
+              actual_size = 0;
+              continue;
+            }
           }
           std::shared_ptr<char> &buffer = buffers[idx];
-          std::vector<int> res = node->sample_k(sample_size, rng);
+          std::vector<int> res =
+              use_csr ? csr->sample_k(csr_idx, sample_size, *rng)
+                     : node->sample_k(sample_size, rng);
           actual_size =
               res.size() * (need_weight ? (Node::id_size + Node::weight_size)
                                         : Node::id_size);
@@ -898,11 +1206,13 @@ int32_t GraphTable::random_sample_neighbors(
             buffer.reset(buffer_addr, char_del);
           }
           for (int &x : res) {
-            id = node->get_neighbor_id(x);
+            id = use_csr ? csr->get_neighbor_id(csr_idx, x)
+                        : node->get_neighbor_id(x);
             memcpy(buffer_addr + offset, &id, Node::id_size);
             offset += Node::id_size;
             if (need_weight) {
-              weight = node->get_neighbor_weight(x);
+              weight = use_csr ? csr->get_neighbor_weight(csr_idx, x)
+                              : node->get_neighbor_weight(x);
               memcpy(buffer_addr + offset, &weight, Node::weight_size);
               offset += Node::weight_size;
             }
@@ -1024,7 +1334,7 @@ int32_t GraphTable::pull_graph_list(int start, int total_size,
   int size = 0, cur_size;
   std::vector<std::future<std::vector<Node *>>> tasks;
   for (size_t i = 0; i < shards.size() && total_size > 0; i++) {
-    cur_size = shards[i]->get_size();
+    cur_size = get_shard_size(i);
     if (size + cur_size <= start) {
       size += cur_size;
       continue;
@@ -1033,7 +1343,22 @@ int32_t GraphTable::pull_graph_list(int start, int total_size,
     int end = start + (count - 1) * step + 1;
     tasks.push_back(_shards_task_pool[i % task_pool_size_]->enqueue(
         [this, i, start, end, step, size]() -> std::vector<Node *> {
-          return this->shards[i]->get_batch(start - size, end - size, step);
+          if (!this->frozen) {
+            return this->shards[i]->get_batch(start - size, end - size, step);
+          }
+          // the nodes of a loaded frozen graph are created when pulled
+          auto &csr = this->csr_shards[i];
+          std::vector<Node *> res;
+          int batch_end = std::min(end - size, (int)csr->node_num());
+          for (int pos = std::max(start - size, 0); pos < batch_end;
+               pos += step) {
+            Node *node = this->shards[i]->find_node(csr->get_id(pos));
+            if (node == nullptr) {
+              node = this->shards[i]->add_graph_node(csr->get_id(pos));
+            }
+            res.push_back(node);
+          }
+          return res;
         }));
     start += count * step;
     total_size -= count;
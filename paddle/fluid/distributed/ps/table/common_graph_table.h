@@ -18,6 +18,7 @@
 #include <assert.h>
 #include <pthread.h>
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdio>
 #include <ctime>
@@ -39,6 +40,7 @@
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/common_table.h"
 #include "paddle/fluid/distributed/ps/table/graph/class_macro.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr_shard.h"
 #include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
 #include "paddle/fluid/string/string_helper.h"
 #include "paddle/phi/core/utils/rw_lock.h"
@@ -408,6 +410,7 @@ class GraphTable : public SparseTable {
  public:
   GraphTable() {
     use_cache = false;
+    frozen = false;
     shard_num = 0;
 #ifdef PADDLE_WITH_HETERPS
     gpups_mode = false;
@@ -446,6 +449,19 @@ class GraphTable : public SparseTable {
 
   int32_t remove_graph_node(std::vector<int64_t> &id_list);
 
+  // Packs the adjacency of every local shard into an immutable
+  // GraphCSRShard and drops the per-node edge blobs and samplers. After
+  // freezing, neighbor sampling reads the CSR arrays and the topology can no
+  // longer be changed until clear_nodes is called.
+  int32_t freeze_graph();
+  // one file per local shard under path; loading mmaps them read-only,
+  // leaving the table frozen. Neighbor sampling and the node id lookups read
+  // the CSR arrays, and the GraphNodes are only created by pull_graph_list
+  // and set_node_feat.
+  int32_t save_frozen_graph(const std::string &path);
+  int32_t load_frozen_graph(const std::string &path);
+  bool is_frozen() { return frozen; }
+
   int32_t get_server_index_by_id(int64_t id);
   Node *find_node(int64_t id);
 
@@ -467,8 +483,11 @@ class GraphTable : public SparseTable {
   virtual int32_t flush() { return 0; }
   virtual int32_t shrink(const std::string &param) { return 0; }
   //指定保存路径
+  // saves the topology as frozen CSR shards, freezing the table first; they
+  // are loaded back with the load param "f".
   virtual int32_t save(const std::string &path, const std::string &converter) {
-    return 0;
+    if (freeze_graph() != 0) return -1;
+    return save_frozen_graph(path);
   }
   virtual int32_t initialize_shard() { return 0; }
   virtual int32_t set_shard(size_t shard_idx, size_t server_num) {
@@ -484,6 +503,9 @@ class GraphTable : public SparseTable {
   }
   virtual uint32_t get_thread_pool_index_by_shard_index(int64_t shard_index);
   virtual uint32_t get_thread_pool_index(int64_t node_id);
+  const GraphCSRShard *find_csr_shard(int64_t id);
+  // the node number of a local shard, read from its CSR shard while frozen
+  size_t get_shard_size(size_t shard_index);
   virtual std::pair<int32_t, std::string> parse_feature(std::string feat_str);
 
   virtual int32_t get_node_feat(const std::vector<int64_t> &node_ids,
@@ -525,6 +547,9 @@ class GraphTable : public SparseTable {
 #endif
  protected:
   std::vector<GraphShard *> shards, extra_shards;
+  std::vector<std::unique_ptr<GraphCSRShard>> csr_shards;
+  // checked by the service threads without holding a lock
+  std::atomic<bool> frozen;
   size_t shard_start, shard_end, server_num, shard_num_per_server, shard_num;
   int task_pool_size_ = 24;
   const int random_sample_nodes_ranges = 3;
@@ -14,6 +14,14 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>   // NOLINT
+#include <new>
+#include <thread>  // NOLINT
 #include <vector>
 #include "gflags/gflags.h"
 
@@ -27,17 +35,287 @@ static const int CTR_SPARSE_SHARD_BUCKET_NUM_BITS = 6;
 static const size_t CTR_SPARSE_SHARD_BUCKET_NUM =
     static_cast<size_t>(1) << CTR_SPARSE_SHARD_BUCKET_NUM_BITS;
 
+// Size-class slab storage for the float arrays of FixedFeatureValue. A
+// sparse table holds billions of small values whose sizes take only a few
+// distinct values per accessor, so carving them out of large slabs avoids
+// the per-value malloc header and rounding.
+//
+// Every size class is split into shards with their own lock, and a thread
+// allocates from the shard its id hashes to, so concurrent pulls of new
+// features rarely contend. Slabs are aligned to their size, the owning slab
+// of a block is found by masking its address. A freed block goes back to its
+// slab, and a slab whose blocks are all free is returned to the system
+// unless it is the only empty slab kept by its shard. The pool is never
+// destroyed, so values of static tables can still be freed at exit.
+class FeatureValueSlab {
+ public:
+  // size classes are multiples of 2 floats, which keeps every block aligned
+  // for the free list pointer stored in it.
+  static const size_t kClassFloats = 2;
+  static const size_t kMaxSlabFloats = 512;
+  static const size_t kClassNum = kMaxSlabFloats / kClassFloats;
+  static const size_t kSlabBytes = 256 * 1024;
+  static const size_t kShardNum = 16;
+
+  static FeatureValueSlab& instance() {
+    static FeatureValueSlab* slab = new FeatureValueSlab();
+    return *slab;
+  }
+
+  // capacity in floats a request of `size` floats is rounded up to
+  static size_t capacity_of(size_t size) {
+    return (size + kClassFloats - 1) / kClassFloats * kClassFloats;
+  }
+
+  float* acquire(size_t capacity) {
+    if (capacity > kMaxSlabFloats) {
+      return static_cast<float*>(malloc(capacity * sizeof(float)));
+    }
+    size_t class_id = capacity / kClassFloats - 1;
+    Shard& shard = _shards[class_id][thread_shard()];
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    Slab* slab = shard.partial;
+    if (slab == NULL) {
+      slab = new_slab(capacity * sizeof(float), &shard);
+      link(&shard, slab);
+    } else if (slab->used == 0) {
+      --shard.empty_slabs;
+    }
+    Block* block = slab->free_blocks;
+    slab->free_blocks = block->next;
+    if (++slab->used == slab->block_num) {
+      unlink(&shard, slab);
+    }
+    return reinterpret_cast<float*>(block);
+  }
+
+  void release(float* data, size_t capacity) {
+    if (capacity > kMaxSlabFloats) {
+      free(data);
+      return;
+    }
+    Slab* slab = reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(data) &
+                                         ~(kSlabBytes - 1));
+    Shard& shard = *slab->shard;
+    Block* block = reinterpret_cast<Block*>(data);
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    block->next = slab->free_blocks;
+    slab->free_blocks = block;
+    if (slab->used-- == slab->block_num) {
+      link(&shard, slab);
+    }
+    if (slab->used == 0) {
+      if (shard.empty_slabs > 0) {
+        unlink(&shard, slab);
+        free(slab);
+        --shard.slab_num;
+      } else {
+        ++shard.empty_slabs;
+      }
+    }
+  }
+
+  // the number of slabs allocated from the system
+  size_t slab_num() {
+    size_t num = 0;
+    for (auto& shards : _shards) {
+      for (auto& shard : shards) {
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        num += shard.slab_num;
+      }
+    }
+    return num;
+  }
+
+ private:
+  struct Block {
+    Block* next;
+  };
+  struct Shard;
+  // The header at the beginning of every slab, followed by the blocks.
+  struct alignas(64) Slab {
+    Shard* shard;
+    // the doubly linked list of the slabs with free blocks in the shard
+    Slab* prev;
+    Slab* next;
+    Block* free_blocks;
+    size_t used;
+    size_t block_num;
+  };
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    Slab* partial = NULL;
+    size_t empty_slabs = 0;
+    size_t slab_num = 0;
+  };
+
+  FeatureValueSlab() {}
+
+  static size_t thread_shard() {
+    static thread_local size_t shard =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) % kShardNum;
+    return shard;
+  }
+
+  static Slab* new_slab(size_t block_bytes, Shard* shard) {
+    void* memory = NULL;
+    if (posix_memalign(&memory, kSlabBytes, kSlabBytes) != 0) {
+      throw std::bad_alloc();
+    }
+    Slab* slab = static_cast<Slab*>(memory);
+    slab->shard = shard;
+    slab->prev = slab->next = NULL;
+    slab->free_blocks = NULL;
+    slab->used = 0;
+    slab->block_num = (kSlabBytes - sizeof(Slab)) / block_bytes;
+    char* blocks = static_cast<char*>(memory) + sizeof(Slab);
+    for (size_t i = slab->block_num; i > 0; --i) {
+      Block* block = reinterpret_cast<Block*>(blocks + (i - 1) * block_bytes);
+      block->next = slab->free_blocks;
+      slab->free_blocks = block;
+    }
+    ++shard->slab_num;
+    return slab;
+  }
+
+  static void link(Shard* shard, Slab* slab) {
+    slab->prev = NULL;
+    slab->next = shard->partial;
+    if (shard->partial != NULL) {
+      shard->partial->prev = slab;
+    }
+    shard->partial = slab;
+  }
+
+  static void unlink(Shard* shard, Slab* slab) {
+    if (slab->prev != NULL) {
+      slab->prev->next = slab->next;
+    } else {
+      shard->partial = slab->next;
+    }
+    if (slab->next != NULL) {
+      slab->next->prev = slab->prev;
+    }
+    slab->prev = slab->next = NULL;
+  }
+
+  Shard _shards[kClassNum][kShardNum];
+};
+
+// The floats of one feature, stored in a FeatureValueSlab block. The handle
+// is 16 bytes instead of the 24 of a std::vector and the block has no malloc
+// header; resize keeps the old floats and zero-fills new ones like vector.
 class FixedFeatureValue {
  public:
-  FixedFeatureValue() {}
-  ~FixedFeatureValue() {}
-  float* data() { return _data.data(); }
-  size_t size() { return _data.size(); }
-  void resize(size_t size) { _data.resize(size); }
-  void shrink_to_fit() { _data.shrink_to_fit(); }
+  FixedFeatureValue() : _data(NULL), _size(0), _capacity(0) {}
+  FixedFeatureValue(const FixedFeatureValue& other)
+      : _data(NULL), _size(0), _capacity(0) {
+    *this = other;
+  }
+  FixedFeatureValue& operator=(const FixedFeatureValue& other) {
+    if (this != &other) {
+      _size = 0;
+      resize(other._size);
+      if (_size > 0) {
+        memcpy(_data, other._data, _size * sizeof(float));
+      }
+    }
+    return *this;
+  }
+  ~FixedFeatureValue() { release(); }
+  float* data() { return _data; }
+  size_t size() { return _size; }
+  void resize(size_t size) {
+    if (size > _capacity) {
+      reallocate(FeatureValueSlab::capacity_of(size));
+    }
+    if (size > _size) {
+      memset(_data + _size, 0, (size - _size) * sizeof(float));
+    }
+    _size = static_cast<uint32_t>(size);
+  }
+  void shrink_to_fit() {
+    if (_size == 0) {
+      release();
+    } else if (FeatureValueSlab::capacity_of(_size) < _capacity) {
+      reallocate(FeatureValueSlab::capacity_of(_size));
+    }
+  }
 
  private:
-  std::vector<float> _data;
+  void reallocate(size_t capacity) {
+    float* data = FeatureValueSlab::instance().acquire(capacity);
+    if (_size > 0) {
+      memcpy(data, _data, std::min<size_t>(_size, capacity) * sizeof(float));
+    }
+    release();
+    _data = data;
+    _capacity = static_cast<uint32_t>(capacity);
+  }
+  void release() {
+    if (_data != NULL) {
+      FeatureValueSlab::instance().release(_data, _capacity);
+      _data = NULL;
+      _capacity = 0;
+    }
+  }
+
+  float* _data;
+  uint32_t _size;
+  uint32_t _capacity;
+};
+
+// Reader-writer spin lock guarding one bucket of a SparseTableShard. The
+// critical sections are a hash lookup plus a copy or update of one value, so
+// spinning is cheaper than parking the thread. Writers are preferred: once a
+// writer is waiting, new readers back off until it has been served.
+class alignas(64) SparseBucketLock {
+ public:
+  SparseBucketLock() : _state(0) {}
+  SparseBucketLock(const SparseBucketLock&) = delete;
+  SparseBucketLock& operator=(const SparseBucketLock&) = delete;
+
+  void lock_shared() {
+    for (int spin = 0;; ++spin) {
+      uint32_t state = _state.load(std::memory_order_relaxed);
+      if ((state & (kWriter | kWriterWaiting)) == 0 &&
+          _state.compare_exchange_weak(state, state + 1,
+                                       std::memory_order_acquire)) {
+        return;
+      }
+      backoff(spin);
+    }
+  }
+  void unlock_shared() { _state.fetch_sub(1, std::memory_order_release); }
+
+  void lock() {
+    for (int spin = 0;; ++spin) {
+      uint32_t state = _state.load(std::memory_order_relaxed);
+      if ((state & ~kWriterWaiting) == 0) {
+        if (_state.compare_exchange_weak(state, kWriter,
+                                         std::memory_order_acquire)) {
+          return;
+        }
+      } else if ((state & kWriterWaiting) == 0) {
+        _state.compare_exchange_weak(state, state | kWriterWaiting,
+                                     std::memory_order_relaxed);
+      }
+      backoff(spin);
+    }
+  }
+  void unlock() { _state.fetch_sub(kWriter, std::memory_order_release); }
+
+ private:
+  static constexpr uint32_t kWriter = 1u << 31;
+  static constexpr uint32_t kWriterWaiting = 1u << 30;
+
+  static void backoff(int spin) {
+    if (spin > 64) {
+      std::this_thread::yield();
+    }
+  }
+
+  std::atomic<uint32_t> _state;
 };
 
 template <class KEY, class VALUE>
@@ -92,8 +370,14 @@ struct alignas(64) SparseTableShard {
   };
 
   ~SparseTableShard() { clear(); }
-  bool empty() { return _alloc.size() == 0; }
-  size_t size() { return _alloc.size(); }
+  bool empty() { return size() == 0; }
+  size_t size() {
+    size_t total = 0;
+    for (size_t bucket = 0; bucket < CTR_SPARSE_SHARD_BUCKET_NUM; bucket++) {
+      total += _allocs[bucket].size();
+    }
+    return total;
+  }
   void set_max_load_factor(float x) {
     for (size_t bucket = 0; bucket < CTR_SPARSE_SHARD_BUCKET_NUM; bucket++) {
       _buckets[bucket].max_load_factor(x);
@@ -105,7 +389,7 @@ struct alignas(64) SparseTableShard {
     for (size_t bucket = 0; bucket < CTR_SPARSE_SHARD_BUCKET_NUM; bucket++) {
       map_type& data = _buckets[bucket];
       for (auto it = data.begin(); it != data.end(); ++it) {
-        _alloc.release((VALUE*)(void*)it->second);  // NOLINT
+        _allocs[bucket].release((VALUE*)(void*)it->second);  // NOLINT
       }
       data.clear();
     }
@@ -148,13 +432,14 @@ struct alignas(64) SparseTableShard {
     auto res = _buckets[bucket].insert_with_hash({key, NULL}, hash);
 
     if (res.second) {
-      res.first->second = _alloc.acquire(std::forward<ARGS>(args)...);
+      res.first->second =
+          _allocs[bucket].acquire(std::forward<ARGS>(args)...);
     }
 
     return {{res.first, bucket, _buckets}, res.second};
   }
   iterator erase(iterator it) {
-    _alloc.release((VALUE*)(void*)it.it->second);  // NOLINT
+    _allocs[it.bucket].release((VALUE*)(void*)it.it->second);  // NOLINT
     size_t bucket = it.bucket;
     auto it2 = _buckets[bucket].erase(it.it);
     while (it2 == _buckets[bucket].end() &&
@@ -164,15 +449,15 @@ struct alignas(64) SparseTableShard {
     return {it2, bucket, _buckets};
   }
   void quick_erase(iterator it) {
-    _alloc.release((VALUE*)(void*)it.it->second);  // NOLINT
+    _allocs[it.bucket].release((VALUE*)(void*)it.it->second);  // NOLINT
     _buckets[it.bucket].quick_erase(it.it);
   }
   local_iterator erase(size_t bucket, local_iterator it) {
-    _alloc.release((VALUE*)(void*)it.it->second);  // NOLINT
+    _allocs[bucket].release((VALUE*)(void*)it.it->second);  // NOLINT
     return {_buckets[bucket].erase(it.it)};
   }
   void quick_erase(size_t bucket, local_iterator it) {
-    _alloc.release((VALUE*)(void*)it.it->second);  // NOLINT
+    _allocs[bucket].release((VALUE*)(void*)it.it->second);  // NOLINT
     _buckets[bucket].quick_erase(it.it);
   }
   size_t erase(const KEY& key) {
@@ -190,10 +475,19 @@ struct alignas(64) SparseTableShard {
       return hash >> (sizeof(size_t) * 8 - CTR_SPARSE_SHARD_BUCKET_NUM_BITS);
     }
   }
+  size_t bucket_of(const KEY& key) { return compute_bucket(_hasher(key)); }
+  // Lock of the bucket a key falls into. Only callers that access one shard
+  // from several threads need to take it; find/emplace do not lock.
+  SparseBucketLock& bucket_lock(size_t bucket) {
+    return _bucket_locks[bucket];
+  }
 
  private:
   map_type _buckets[CTR_SPARSE_SHARD_BUCKET_NUM];
-  ChunkAllocator<VALUE> _alloc;
+  SparseBucketLock _bucket_locks[CTR_SPARSE_SHARD_BUCKET_NUM];
+  // One allocator per bucket, so inserts into different buckets do not
+  // share any state and only need the lock of their own bucket.
+  ChunkAllocator<VALUE> _allocs[CTR_SPARSE_SHARD_BUCKET_NUM];
   std::hash<KEY> _hasher;
 };
 
@@ -0,0 +1,112 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace distributed {
+
+// Approximate access frequency of feasigns, the admission filter of TinyLFU.
+// A count-min sketch of saturating 8-bit counters: every key is counted in
+// one counter of each row and its estimate is the minimum of those. After
+// 10 * width increments all counters are halved, so keys that were hot long
+// ago fade out and recent popularity decides what stays in memory.
+class FrequencySketch {
+ public:
+  explicit FrequencySketch(size_t width) {
+    width_ = 64;
+    while (width_ < width) {
+      width_ <<= 1;
+    }
+    counters_.resize(kDepth * width_, 0);
+    sample_size_ = 10 * width_;
+    additions_ = 0;
+  }
+
+  void Increment(uint64_t key, uint32_t count = 1) {
+    for (int row = 0; row < kDepth; ++row) {
+      uint8_t& counter = counters_[row * width_ + Index(key, row)];
+      counter = static_cast<uint8_t>(
+          std::min<uint32_t>(uint32_t(kMaxCount), counter + count));
+    }
+    additions_ += count;
+    if (additions_ >= sample_size_) {
+      Age();
+    }
+  }
+
+  uint32_t Estimate(uint64_t key) const {
+    uint32_t estimate = uint32_t(kMaxCount);
+    for (int row = 0; row < kDepth; ++row) {
+      estimate = std::min<uint32_t>(estimate,
+                                    counters_[row * width_ + Index(key, row)]);
+    }
+    return estimate;
+  }
+
+  void Age() {
+    for (auto& counter : counters_) {
+      counter >>= 1;
+    }
+    additions_ /= 2;
+  }
+
+ private:
+  static const int kDepth = 4;
+  static const uint32_t kMaxCount = 255;
+
+  size_t Index(uint64_t key, int row) const {
+    static const uint64_t seeds[kDepth] = {
+        0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL,
+        0xD6E8FEB86659FD93ULL};
+    uint64_t hash = (key ^ seeds[row]) * 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash & (width_ - 1));
+  }
+
+  size_t width_;
+  std::vector<uint8_t> counters_;
+  size_t sample_size_;
+  size_t additions_;
+};
+
+// Return the count keys of the lowest estimated frequencies, the ones to
+// evict when the hot set is count keys over its capacity. Keys of the same
+// estimate are ranked by their values, so exactly min(count, keys.size())
+// keys are returned however many of them tie.
+inline std::vector<uint64_t> LeastFrequentKeys(
+    const FrequencySketch& sketch, const std::vector<uint64_t>& keys,
+    size_t count) {
+  count = std::min(count, keys.size());
+  std::vector<std::pair<uint32_t, uint64_t>> ranks;
+  ranks.reserve(keys.size());
+  for (auto key : keys) {
+    ranks.emplace_back(sketch.Estimate(key), key);
+  }
+  std::nth_element(ranks.begin(), ranks.begin() + count, ranks.end());
+  std::vector<uint64_t> least_frequent_keys;
+  least_frequent_keys.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    least_frequent_keys.push_back(ranks[i].second);
+  }
+  return least_frequent_keys;
+}
+
+}  // namespace distributed
+}  // namespace paddle
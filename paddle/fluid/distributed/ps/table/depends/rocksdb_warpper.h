@@ -22,6 +22,8 @@
 #include <rocksdb/write_batch.h>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace paddle {
 namespace distributed {
@@ -125,6 +127,31 @@ class RocksDBHandler {
     return 0;
   }
 
+  // Reads all `keys` with one MultiGet. status[i] follows get: 0 if the key
+  // was found and its value is in values[i], 1 if it is not in the db.
+  int get_batch(int id, const std::vector<std::pair<char*, int>>& keys,
+                std::vector<std::string>* values, std::vector<int>* status) {
+    std::vector<rocksdb::Slice> slices;
+    slices.reserve(keys.size());
+    for (auto& key : keys) {
+      slices.emplace_back(key.first, key.second);
+    }
+    std::vector<rocksdb::ColumnFamilyHandle*> handles(keys.size(),
+                                                      _handles[id]);
+    std::vector<rocksdb::Status> s =
+        _db->MultiGet(rocksdb::ReadOptions(), handles, slices, values);
+    status->resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      if (s[i].IsNotFound()) {
+        (*status)[i] = 1;
+      } else {
+        assert(s[i].ok());
+        (*status)[i] = 0;
+      }
+    }
+    return 0;
+  }
+
   int del_data(int id, const char* key, int key_len) {
     rocksdb::WriteOptions options;
     options.disableWAL = true;
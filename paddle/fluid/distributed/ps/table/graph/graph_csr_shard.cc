@@ -0,0 +1,291 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr_shard.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+namespace paddle {
+namespace distributed {
+
+static const char kCSRMagic[8] = {'P', 'D', 'C', 'S', 'R', '0', '0', '1'};
+
+GraphCSRShard::~GraphCSRShard() { reset(); }
+
+void GraphCSRShard::reset() {
+  if (data_ != nullptr) {
+    if (mapped_) {
+      munmap(data_, size_);
+    } else {
+      delete[] data_;
+    }
+  }
+  data_ = nullptr;
+  size_ = 0;
+  mapped_ = false;
+  header_ = nullptr;
+  ids_ = nullptr;
+  offsets_ = nullptr;
+  neighbors_ = nullptr;
+  node_flags_ = nullptr;
+  weights_ = nullptr;
+  alias_prob_ = nullptr;
+  alias_index_ = nullptr;
+}
+
+size_t GraphCSRShard::buffer_size(uint64_t node_num, uint64_t edge_num,
+                                  bool weighted) {
+  size_t size = align(sizeof(Header));
+  size += align(node_num * sizeof(uint64_t));
+  size += align((node_num + 1) * sizeof(int64_t));
+  size += align(edge_num * sizeof(uint64_t));
+  size += align(node_num * sizeof(uint8_t));
+  if (weighted) {
+    size += align(edge_num * sizeof(float));
+    size += align(edge_num * sizeof(float));
+    size += align(edge_num * sizeof(int32_t));
+  }
+  return size;
+}
+
+int GraphCSRShard::bind(char *data, size_t size) {
+  if (size < sizeof(Header)) return -1;
+  Header *header = reinterpret_cast<Header *>(data);
+  if (memcmp(header->magic, kCSRMagic, sizeof(kCSRMagic)) != 0) return -1;
+  uint64_t n = header->node_num, e = header->edge_num;
+  bool weighted = header->weighted != 0;
+  if (buffer_size(n, e, weighted) != size) return -1;
+
+  char *p = data + align(sizeof(Header));
+  ids_ = reinterpret_cast<uint64_t *>(p);
+  p += align(n * sizeof(uint64_t));
+  offsets_ = reinterpret_cast<int64_t *>(p);
+  p += align((n + 1) * sizeof(int64_t));
+  neighbors_ = reinterpret_cast<uint64_t *>(p);
+  p += align(e * sizeof(uint64_t));
+  node_flags_ = reinterpret_cast<uint8_t *>(p);
+  p += align(n * sizeof(uint8_t));
+  if (weighted) {
+    weights_ = reinterpret_cast<float *>(p);
+    p += align(e * sizeof(float));
+    alias_prob_ = reinterpret_cast<float *>(p);
+    p += align(e * sizeof(float));
+    alias_index_ = reinterpret_cast<int32_t *>(p);
+  }
+  header_ = header;
+  return 0;
+}
+
+void GraphCSRShard::build(const std::vector<Node *> &nodes) {
+  reset();
+  std::vector<Node *> sorted(nodes);
+  std::sort(sorted.begin(), sorted.end(),
+            [](Node *a, Node *b) { return a->get_id() < b->get_id(); });
+  uint64_t n = sorted.size(), e = 0;
+  bool weighted = false;
+  for (auto node : sorted) {
+    e += node->get_neighbor_size();
+    weighted = weighted || node->get_is_weighted();
+  }
+
+  size_ = buffer_size(n, e, weighted);
+  data_ = new char[size_];
+  memset(data_, 0, size_);
+  Header *header = reinterpret_cast<Header *>(data_);
+  memcpy(header->magic, kCSRMagic, sizeof(kCSRMagic));
+  header->node_num = n;
+  header->edge_num = e;
+  header->weighted = weighted ? 1 : 0;
+  bind(data_, size_);
+
+  int64_t offset = 0;
+  for (size_t i = 0; i < n; i++) {
+    Node *node = sorted[i];
+    int degree = node->get_neighbor_size();
+    ids_[i] = node->get_id();
+    offsets_[i] = offset;
+    node_flags_[i] = node->get_is_weighted() ? 1 : 0;
+    for (int j = 0; j < degree; j++) {
+      neighbors_[offset + j] = node->get_neighbor_id(j);
+      if (weighted) weights_[offset + j] = node->get_neighbor_weight(j);
+    }
+    offset += degree;
+  }
+  offsets_[n] = offset;
+  if (weighted) {
+    for (size_t i = 0; i < n; i++) {
+      if (node_flags_[i]) build_alias(i);
+    }
+  }
+}
+
+// Vose's alias method over the neighbors of one node.
+void GraphCSRShard::build_alias(size_t idx) {
+  int64_t start = offsets_[idx];
+  int degree = get_neighbor_size(idx);
+  if (degree == 0) return;
+  double sum = 0;
+  for (int j = 0; j < degree; j++) sum += std::max(weights_[start + j], 0.f);
+  std::vector<double> scaled(degree);
+  std::vector<int> small, large;
+  for (int j = 0; j < degree; j++) {
+    scaled[j] = sum > 0 ? std::max(weights_[start + j], 0.f) * degree / sum
+                        : 1.0;
+    if (scaled[j] < 1.0) {
+      small.push_back(j);
+    } else {
+      large.push_back(j);
+    }
+  }
+  while (!small.empty() && !large.empty()) {
+    int s = small.back(), l = large.back();
+    small.pop_back();
+    alias_prob_[start + s] = scaled[s];
+    alias_index_[start + s] = l;
+    scaled[l] = scaled[l] + scaled[s] - 1.0;
+    if (scaled[l] < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  for (int j : large) {
+    alias_prob_[start + j] = 1.0;
+    alias_index_[start + j] = j;
+  }
+  for (int j : small) {
+    alias_prob_[start + j] = 1.0;
+    alias_index_[start + j] = j;
+  }
+}
+
+int64_t GraphCSRShard::find(uint64_t id) const {
+  size_t n = node_num();
+  const uint64_t *pos = std::lower_bound(ids_, ids_ + n, id);
+  if (pos == ids_ + n || *pos != id) return -1;
+  return pos - ids_;
+}
+
+std::vector<int> GraphCSRShard::sample_k(size_t idx, int k,
+                                         std::mt19937_64 &rng) const {
+  int degree = get_neighbor_size(idx);
+  if (k >= degree) {
+    std::vector<int> sample_result(degree);
+    for (int i = 0; i < degree; i++) sample_result[i] = i;
+    return sample_result;
+  }
+  if (alias_prob_ != nullptr && node_flags_[idx]) {
+    return sample_weighted(idx, k, rng);
+  }
+  return sample_random(idx, k, rng);
+}
+
+std::vector<int> GraphCSRShard::sample_random(size_t idx, int k,
+                                              std::mt19937_64 &rng) const {
+  int n = get_neighbor_size(idx);
+  // partial Fisher-Yates over a sparse permutation, as RandomSampler does.
+  std::unordered_map<int, int> replace_map;
+  std::vector<int> sample_result;
+  sample_result.reserve(k);
+  for (int i = 0; i < k; i++) {
+    std::uniform_int_distribution<int> distrib(0, n - 1 - i);
+    int j = distrib(rng);
+    auto iter = replace_map.find(j);
+    sample_result.push_back(iter == replace_map.end() ? j : iter->second);
+    auto last = replace_map.find(n - 1 - i);
+    replace_map[j] = last == replace_map.end() ? n - 1 - i : last->second;
+  }
+  return sample_result;
+}
+
+// Drawing from the alias table and rejecting duplicates is equivalent to
+// successive sampling without replacement, which is what WeightedSampler
+// implements. Heavily skewed nodes may reject a lot, so after a bounded
+// number of draws the remaining picks fall back to an exact linear scan.
+std::vector<int> GraphCSRShard::sample_weighted(size_t idx, int k,
+                                                std::mt19937_64 &rng) const {
+  int64_t start = offsets_[idx];
+  int degree = get_neighbor_size(idx);
+  std::vector<int> sample_result;
+  sample_result.reserve(k);
+  std::unordered_set<int> picked;
+  std::uniform_int_distribution<int> pick_bucket(0, degree - 1);
+  std::uniform_real_distribution<float> pick_prob(0, 1.0);
+  int attempts = 4 * k + 32;
+  while ((int)sample_result.size() < k && attempts-- > 0) {
+    int j = pick_bucket(rng);
+    if (pick_prob(rng) >= alias_prob_[start + j]) j = alias_index_[start + j];
+    if (picked.insert(j).second) sample_result.push_back(j);
+  }
+  if ((int)sample_result.size() < k) {
+    double remain = 0;
+    for (int j = 0; j < degree; j++) {
+      if (!picked.count(j)) remain += std::max(weights_[start + j], 0.f);
+    }
+    std::uniform_real_distribution<double> pick_weight(0, 1.0);
+    while ((int)sample_result.size() < k) {
+      double query = pick_weight(rng) * remain;
+      int last = -1;
+      for (int j = 0; j < degree; j++) {
+        if (picked.count(j)) continue;
+        last = j;
+        query -= std::max(weights_[start + j], 0.f);
+        if (query < 0) break;
+      }
+      picked.insert(last);
+      sample_result.push_back(last);
+      remain -= std::max(weights_[start + last], 0.f);
+    }
+  }
+  return sample_result;
+}
+
+int GraphCSRShard::save(const std::string &path) const {
+  if (data_ == nullptr) return -1;
+  FILE *fp = fopen(path.c_str(), "wb");
+  if (fp == nullptr) return -1;
+  size_t written = fwrite(data_, 1, size_, fp);
+  int ret = fclose(fp);
+  return written == size_ && ret == 0 ? 0 : -1;
+}
+
+int GraphCSRShard::load(const std::string &path) {
+  reset();
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return -1;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+    close(fd);
+    return -1;
+  }
+  size_t size = st.st_size;
+  void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) return -1;
+  data_ = reinterpret_cast<char *>(addr);
+  size_ = size;
+  mapped_ = true;
+  if (bind(data_, size_) != 0) {
+    reset();
+    return -1;
+  }
+  return 0;
+}
+}  // namespace distributed
+}  // namespace paddle
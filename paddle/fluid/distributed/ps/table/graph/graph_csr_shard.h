@@ -0,0 +1,95 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
+namespace paddle {
+namespace distributed {
+
+// Immutable CSR copy of the adjacency of one GraphShard. All arrays live in
+// a single contiguous buffer whose layout is also the on-disk format, so a
+// saved shard can be mmap-ed back without any parsing:
+//
+//   Header | ids[n] | offsets[n+1] | neighbors[e] | node_flags[n]
+//          | weights[e] | alias_prob[e] | alias_index[e]
+//
+// ids are sorted so that lookups are a binary search. The weight and alias
+// sections are only present when at least one node uses weighted sampling.
+class GraphCSRShard {
+ public:
+  GraphCSRShard() {}
+  ~GraphCSRShard();
+  GraphCSRShard(const GraphCSRShard &) = delete;
+  GraphCSRShard &operator=(const GraphCSRShard &) = delete;
+
+  // nodes must still own their edges, i.e. be called before release_edges.
+  void build(const std::vector<Node *> &nodes);
+  int save(const std::string &path) const;
+  int load(const std::string &path);
+
+  size_t node_num() const { return header_ == nullptr ? 0 : header_->node_num; }
+  size_t edge_num() const { return header_ == nullptr ? 0 : header_->edge_num; }
+  uint64_t get_id(size_t idx) const { return ids_[idx]; }
+  // returns the local index of id, or -1 if the id is not in this shard.
+  int64_t find(uint64_t id) const;
+  size_t get_neighbor_size(size_t idx) const {
+    return offsets_[idx + 1] - offsets_[idx];
+  }
+  uint64_t get_neighbor_id(size_t idx, int x) const {
+    return neighbors_[offsets_[idx] + x];
+  }
+  float get_neighbor_weight(size_t idx, int x) const {
+    return weights_ == nullptr ? 1. : weights_[offsets_[idx] + x];
+  }
+  // Same contract as Sampler::sample_k: k distinct neighbor positions, or
+  // all of them if the node has no more than k neighbors.
+  std::vector<int> sample_k(size_t idx, int k, std::mt19937_64 &rng) const;
+
+ private:
+  struct Header {
+    char magic[8];
+    uint64_t node_num;
+    uint64_t edge_num;
+    uint64_t weighted;
+  };
+  static size_t align(size_t size) { return (size + 7) & ~size_t(7); }
+  static size_t buffer_size(uint64_t node_num, uint64_t edge_num,
+                            bool weighted);
+  void reset();
+  int bind(char *data, size_t size);
+  void build_alias(size_t idx);
+
+  std::vector<int> sample_random(size_t idx, int k, std::mt19937_64 &rng) const;
+  std::vector<int> sample_weighted(size_t idx, int k,
+                                   std::mt19937_64 &rng) const;
+
+  char *data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+
+  Header *header_ = nullptr;
+  uint64_t *ids_ = nullptr;
+  int64_t *offsets_ = nullptr;
+  uint64_t *neighbors_ = nullptr;
+  uint8_t *node_flags_ = nullptr;
+  float *weights_ = nullptr;
+  float *alias_prob_ = nullptr;
+  int32_t *alias_index_ = nullptr;
+};
+}  // namespace distributed
+}  // namespace paddle
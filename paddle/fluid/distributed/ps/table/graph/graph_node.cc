@@ -17,7 +17,9 @@
 namespace paddle {
 namespace distributed {
 
-GraphNode::~GraphNode() {
+GraphNode::~GraphNode() { release_edges(); }
+
+void GraphNode::release_edges() {
   if (sampler != nullptr) {
     delete sampler;
     sampler = nullptr;
@@ -73,6 +75,7 @@ void GraphNode::build_sampler(std::string sample_type) {
   } else if (sample_type == "weighted") {
     sampler = new WeightedSampler();
   }
+  is_weighted = sample_type == "weighted";
   sampler->build(edges);
 }
 void FeatureNode::to_buffer(char* buffer, bool need_feature) {
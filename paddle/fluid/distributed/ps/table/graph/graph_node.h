@@ -24,16 +24,18 @@ namespace distributed {
 
 class Node {
  public:
-  Node() {}
-  Node(uint64_t id) : id(id) {}
+  Node() : is_weighted(false) {}
+  Node(uint64_t id) : id(id), is_weighted(false) {}
   virtual ~Node() {}
   static int id_size, int_size, weight_size;
   uint64_t get_id() { return id; }
   void set_id(uint64_t id) { this->id = id; }
+  bool get_is_weighted() { return is_weighted; }
 
   virtual void build_edges(bool is_weighted) {}
   virtual void build_sampler(std::string sample_type) {}
   virtual void add_edge(uint64_t id, float weight) {}
+  virtual void release_edges() {}
   virtual std::vector<int> sample_k(
       int k, const std::shared_ptr<std::mt19937_64> rng) {
     return std::vector<int>();
@@ -65,13 +67,19 @@ class GraphNode : public Node {
   virtual void add_edge(uint64_t id, float weight) {
     edges->add_edge(id, weight);
   }
+  // drops the edges and sampler once they have been copied into a frozen
+  // GraphCSRShard.
+  virtual void release_edges();
   virtual std::vector<int> sample_k(
       int k, const std::shared_ptr<std::mt19937_64> rng) {
+    if (sampler == nullptr) return std::vector<int>();
     return sampler->sample_k(k, rng);
   }
   virtual uint64_t get_neighbor_id(int idx) { return edges->get_id(idx); }
   virtual float get_neighbor_weight(int idx) { return edges->get_weight(idx); }
-  virtual size_t get_neighbor_size() { return edges->size(); }
+  virtual size_t get_neighbor_size() {
+    return edges == nullptr ? 0 : edges->size();
+  }
 
  protected:
   Sampler *sampler;
@@ -0,0 +1,116 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_text_file.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+namespace paddle {
+namespace distributed {
+
+GraphTextFile::~GraphTextFile() {
+  if (data_ != nullptr) munmap(data_, size_);
+}
+
+int GraphTextFile::open(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return -1;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return -1;
+  }
+  size_ = st.st_size;
+  if (size_ == 0) {
+    close(fd);
+    return 0;
+  }
+  void *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    size_ = 0;
+    return -1;
+  }
+  madvise(addr, size_, MADV_SEQUENTIAL);
+  data_ = reinterpret_cast<char *>(addr);
+  return 0;
+}
+
+std::vector<std::pair<size_t, size_t>> GraphTextFile::split(
+    int max_num, size_t min_size) const {
+  std::vector<std::pair<size_t, size_t>> ranges;
+  if (size_ == 0) return ranges;
+  size_t num = std::max<size_t>(
+      1, std::min<size_t>(max_num, size_ / std::max<size_t>(min_size, 1)));
+  size_t start = 0;
+  for (size_t i = 1; i <= num && start < size_; i++) {
+    size_t end = i == num ? size_ : std::max(start, size_ * i / num);
+    const char *eol =
+        reinterpret_cast<const char *>(memchr(data_ + end, '\n', size_ - end));
+    end = i == num || eol == nullptr ? size_ : eol - data_ + 1;
+    ranges.emplace_back(start, end);
+    start = end;
+  }
+  return ranges;
+}
+
+int split_fields(TextSlice line, char sep, TextSlice *fields, int max_num) {
+  int num = 0;
+  const char *begin = line.begin;
+  while (num < max_num) {
+    const char *pos = begin;
+    if (num + 1 < max_num) {
+      while (pos < line.end && *pos != sep) ++pos;
+    } else {
+      pos = line.end;
+    }
+    fields[num++] = TextSlice{begin, pos};
+    if (pos == line.end) break;
+    begin = pos + 1;
+  }
+  return num;
+}
+
+bool parse_uint64(TextSlice str, uint64_t *value) {
+  if (str.begin == str.end) return false;
+  uint64_t result = 0;
+  for (const char *p = str.begin; p < str.end; ++p) {
+    unsigned digit = static_cast<unsigned char>(*p) - '0';
+    if (digit > 9) return false;
+    // reject ids which do not fit instead of wrapping around
+    if (result > (UINT64_MAX - digit) / 10) return false;
+    result = result * 10 + digit;
+  }
+  *value = result;
+  return true;
+}
+
+bool parse_float(TextSlice str, float *value) {
+  // strtof needs a terminated string, weights are short so copy them to the
+  // stack instead of allocating.
+  char buffer[64];
+  size_t len = str.size();
+  if (len == 0 || len >= sizeof(buffer)) return false;
+  memcpy(buffer, str.begin, len);
+  buffer[len] = '\0';
+  char *end = nullptr;
+  *value = strtof(buffer, &end);
+  return end == buffer + len;
+}
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,80 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+namespace paddle {
+namespace distributed {
+
+// A [begin, end) slice of a text buffer, used to address lines and fields
+// without copying them into std::string.
+struct TextSlice {
+  const char *begin;
+  const char *end;
+  size_t size() const { return end - begin; }
+  bool equals(const std::string &str) const {
+    return size() == str.size() && str.compare(0, size(), begin, size()) == 0;
+  }
+  std::string to_string() const { return std::string(begin, end); }
+};
+
+// Read-only, memory-mapped view of a local graph file. The loader splits it
+// into line-aligned byte ranges that are parsed concurrently.
+class GraphTextFile {
+ public:
+  GraphTextFile() {}
+  ~GraphTextFile();
+  GraphTextFile(const GraphTextFile &) = delete;
+  GraphTextFile &operator=(const GraphTextFile &) = delete;
+
+  int open(const std::string &path);
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+  // Splits the file into at most max_num ranges of at least min_size bytes,
+  // each starting at the beginning of a line.
+  std::vector<std::pair<size_t, size_t>> split(int max_num,
+                                               size_t min_size) const;
+
+ private:
+  char *data_ = nullptr;
+  size_t size_ = 0;
+};
+
+// Calls fn(TextSlice line) for every line in [begin, end), without the
+// trailing '\n' or '\r'.
+template <typename Fn>
+void for_each_line(const char *begin, const char *end, Fn fn) {
+  while (begin < end) {
+    const char *eol = begin;
+    while (eol < end && *eol != '\n') ++eol;
+    const char *line_end = eol;
+    if (line_end > begin && line_end[-1] == '\r') --line_end;
+    fn(TextSlice{begin, line_end});
+    begin = eol + 1;
+  }
+}
+
+// Splits line on sep into at most max_num fields, the last one keeping the
+// remainder. Returns the number of fields.
+int split_fields(TextSlice line, char sep, TextSlice *fields, int max_num);
+
+// In-place number parsing. Both return false unless the whole slice is a
+// valid number.
+bool parse_uint64(TextSlice str, uint64_t *value);
+bool parse_float(TextSlice str, float *value);
+}  // namespace distributed
+}  // namespace paddle
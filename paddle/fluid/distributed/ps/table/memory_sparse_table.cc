@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <omp.h>
+#include <algorithm>
+#include <shared_mutex>  // NOLINT
 #include <sstream>
 
 #include "paddle/fluid/distributed/common/cost_timer.h"
@@ -20,6 +22,7 @@
 #include "paddle/fluid/framework/io/fs.h"
 
 #include "boost/lexical_cast.hpp"
+#include "gflags/gflags.h"
 #include "glog/logging.h"
 #include "paddle/fluid/platform/enforce.h"
 
@@ -31,6 +34,11 @@ bool FLAGS_pserver_create_value_when_push = true;
 int FLAGS_pserver_table_save_max_retry = 3;
 bool FLAGS_pserver_enable_create_feasign_randomly = false;
 
+DEFINE_bool(pserver_concurrent_sparse_shard, false,
+            "serve sparse pull/push of MemorySparseTable from all task pool "
+            "threads, locking the bucket of each key instead of queueing the "
+            "keys of a shard on its single thread");
+
 int32_t MemorySparseTable::initialize() {
   _shards_task_pool.resize(_task_pool_size);
   for (int i = 0; i < _shards_task_pool.size(); ++i) {
@@ -390,6 +398,181 @@ std::pair<int64_t, int64_t> MemorySparseTable::print_table_stat() {
   return {feasign_size, mf_size};
 }
 
+template <typename Func>
+void MemorySparseTable::_run_concurrent(size_t num, Func&& func) {
+  // Small ranges are not worth the round trip through a task pool.
+  const size_t min_keys_per_task = 64;
+  if (num == 0) {
+    return;
+  }
+  size_t task_num = std::min(_shards_task_pool.size(),
+                             (num + min_keys_per_task - 1) / min_keys_per_task);
+  size_t step = (num + task_num - 1) / task_num;
+  // Rotate the first pool so that concurrent requests do not pile up on the
+  // same pools.
+  size_t pool_start =
+      _task_pool_cursor.fetch_add(task_num, std::memory_order_relaxed);
+  std::vector<std::future<int>> tasks;
+  tasks.reserve(task_num);
+  for (size_t begin = 0; begin < num; begin += step) {
+    size_t end = std::min(begin + step, num);
+    size_t pool_id = (pool_start + tasks.size()) % _shards_task_pool.size();
+    auto& pool = _shards_task_pool[pool_id];
+    tasks.push_back(pool->enqueue([&func, begin, end]() -> int {
+      func(begin, end);
+      return 0;
+    }));
+  }
+  for (auto& task : tasks) {
+    task.wait();
+  }
+}
+
+int32_t MemorySparseTable::_pull_sparse_concurrent(
+    float* pull_values, const PullSparseValue& pull_value) {
+  const size_t value_size = _value_accesor->GetTableInfo(SIZE) / sizeof(float);
+  size_t mf_value_size = _value_accesor->GetTableInfo(MF_SIZE) / sizeof(float);
+  size_t select_value_size =
+      _value_accesor->GetTableInfo(SELECT_SIZE) / sizeof(float);
+
+  _run_concurrent(pull_value.numel_, [&](size_t begin, size_t end) {
+    float data_buffer[value_size];  // NOLINT
+    float* data_buffer_ptr = data_buffer;
+    for (size_t i = begin; i < end; ++i) {
+      uint64_t key = pull_value.feasigns_[i];
+      auto& local_shard = _local_shards[_shard_id_of(key)];
+      auto& bucket_lock = local_shard.bucket_lock(local_shard.bucket_of(key));
+      size_t data_size = value_size - mf_value_size;
+      bool found = false;
+      {
+        std::shared_lock<SparseBucketLock> guard(bucket_lock);
+        auto itr = local_shard.find(key);
+        if (itr != local_shard.end()) {
+          data_size = itr.value().size();
+          memcpy(data_buffer_ptr, itr.value().data(),
+                 data_size * sizeof(float));
+          found = true;
+        }
+      }
+      if (!found) {
+        if (FLAGS_pserver_create_value_when_push) {
+          memset(data_buffer, 0, sizeof(float) * data_size);
+        } else {
+          std::lock_guard<SparseBucketLock> guard(bucket_lock);
+          auto& feature_value = local_shard[key];
+          if (feature_value.size() == 0) {
+            feature_value.resize(data_size);
+            _value_accesor->Create(&data_buffer_ptr, 1);
+            memcpy(feature_value.data(), data_buffer_ptr,
+                   data_size * sizeof(float));
+          } else {
+            // created by another thread after the shared lookup
+            data_size = feature_value.size();
+            memcpy(data_buffer_ptr, feature_value.data(),
+                   data_size * sizeof(float));
+          }
+        }
+      }
+      for (size_t mf_idx = data_size; mf_idx < value_size; ++mf_idx) {
+        data_buffer[mf_idx] = 0.0;
+      }
+      float* select_data = pull_values + select_value_size * i;
+      _value_accesor->Select(&select_data, (const float**)&data_buffer_ptr,
+                             1);
+    }
+  });
+  return 0;
+}
+
+int32_t MemorySparseTable::_pull_sparse_ptr_concurrent(char** pull_values,
+                                                       const uint64_t* keys,
+                                                       size_t num) {
+  size_t value_size = _value_accesor->GetTableInfo(SIZE) / sizeof(float);
+  size_t mf_value_size = _value_accesor->GetTableInfo(MF_SIZE) / sizeof(float);
+
+  _run_concurrent(num, [&](size_t begin, size_t end) {
+    float data_buffer[value_size];  // NOLINT
+    float* data_buffer_ptr = data_buffer;
+    for (size_t i = begin; i < end; ++i) {
+      uint64_t key = keys[i];
+      auto& local_shard = _local_shards[_shard_id_of(key)];
+      auto& bucket_lock = local_shard.bucket_lock(local_shard.bucket_of(key));
+      FixedFeatureValue* ret = NULL;
+      {
+        std::shared_lock<SparseBucketLock> guard(bucket_lock);
+        auto itr = local_shard.find(key);
+        if (itr != local_shard.end()) {
+          ret = itr.value_ptr();
+        }
+      }
+      if (ret == NULL) {
+        std::lock_guard<SparseBucketLock> guard(bucket_lock);
+        auto& feature_value = local_shard[key];
+        if (feature_value.size() == 0) {
+          size_t data_size = value_size - mf_value_size;
+          feature_value.resize(data_size);
+          _value_accesor->Create(&data_buffer_ptr, 1);
+          memcpy(feature_value.data(), data_buffer_ptr,
+                 data_size * sizeof(float));
+        }
+        ret = &feature_value;
+      }
+      pull_values[i] = (char*)ret;  // NOLINT
+    }
+  });
+  return 0;
+}
+
+template <typename GetUpdate>
+int32_t MemorySparseTable::_push_sparse_concurrent(const uint64_t* keys,
+                                                   GetUpdate get_update,
+                                                   size_t num) {
+  size_t value_col = _value_accesor->GetTableInfo(SIZE) / sizeof(float);
+  size_t mf_value_col = _value_accesor->GetTableInfo(MF_SIZE) / sizeof(float);
+
+  _run_concurrent(num, [&](size_t begin, size_t end) {
+    float data_buffer[value_col];  // NOLINT
+    float* data_buffer_ptr = data_buffer;
+    for (size_t i = begin; i < end; ++i) {
+      uint64_t key = keys[i];
+      const float* update_data = get_update(i);
+      auto& local_shard = _local_shards[_shard_id_of(key)];
+      std::lock_guard<SparseBucketLock> guard(
+          local_shard.bucket_lock(local_shard.bucket_of(key)));
+      auto itr = local_shard.find(key);
+      if (itr == local_shard.end()) {
+        if (FLAGS_pserver_enable_create_feasign_randomly &&
+            !_value_accesor->CreateValue(1, update_data)) {
+          continue;
+        }
+        auto value_size = value_col - mf_value_col;
+        auto& feature_value = local_shard[key];
+        feature_value.resize(value_size);
+        _value_accesor->Create(&data_buffer_ptr, 1);
+        memcpy(feature_value.data(), data_buffer_ptr,
+               value_size * sizeof(float));
+        itr = local_shard.find(key);
+      }
+      auto& feature_value = itr.value();
+      float* value_data = feature_value.data();
+      size_t value_size = feature_value.size();
+      if (value_size == value_col) {
+        _value_accesor->Update(&value_data, &update_data, 1);
+      } else {
+        memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
+        _value_accesor->Update(&data_buffer_ptr, &update_data, 1);
+        if (_value_accesor->NeedExtendMF(data_buffer)) {
+          feature_value.resize(value_col);
+          value_data = feature_value.data();
+          _value_accesor->Create(&value_data, 1);
+        }
+        memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
+      }
+    }
+  });
+  return 0;
+}
+
 int32_t MemorySparseTable::Pull(TableContext& context) {
   CHECK(context.value_type == Sparse);
   if (context.use_ptr) {
@@ -413,6 +596,9 @@ int32_t MemorySparseTable::Push(TableContext& context) {
 int32_t MemorySparseTable::pull_sparse(float* pull_values,
                                        const PullSparseValue& pull_value) {
   CostTimer timer("pserver_sparse_select_all");
+  if (FLAGS_pserver_concurrent_sparse_shard) {
+    return _pull_sparse_concurrent(pull_values, pull_value);
+  }
   std::vector<std::future<int>> tasks(_real_local_shard_num);
 
   const size_t value_size = _value_accesor->GetTableInfo(SIZE) / sizeof(float);
@@ -482,6 +668,9 @@ int32_t MemorySparseTable::pull_sparse(float* pull_values,
 int32_t MemorySparseTable::pull_sparse_ptr(char** pull_values,
                                            const uint64_t* keys, size_t num) {
   CostTimer timer("pscore_sparse_select_all");
+  if (FLAGS_pserver_concurrent_sparse_shard) {
+    return _pull_sparse_ptr_concurrent(pull_values, keys, num);
+  }
   size_t value_size = _value_accesor->GetTableInfo(SIZE) / sizeof(float);
   size_t mf_value_size = _value_accesor->GetTableInfo(MF_SIZE) / sizeof(float);
 
@@ -533,6 +722,16 @@ int32_t MemorySparseTable::pull_sparse_ptr(char** pull_values,
 int32_t MemorySparseTable::push_sparse(const uint64_t* keys,
                                        const float* values, size_t num) {
   CostTimer timer("pserver_sparse_update_all");
+  if (FLAGS_pserver_concurrent_sparse_shard) {
+    size_t update_value_col =
+        _value_accesor->GetTableInfo(UPDATE_SIZE) / sizeof(float);
+    return _push_sparse_concurrent(
+        keys,
+        [values, update_value_col](size_t i) {
+          return values + i * update_value_col;
+        },
+        num);
+  }
   std::vector<std::future<int>> tasks(_real_local_shard_num);
   std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
       _real_local_shard_num);
@@ -611,6 +810,10 @@ int32_t MemorySparseTable::push_sparse(const uint64_t* keys,
 
 int32_t MemorySparseTable::_push_sparse(const uint64_t* keys,
                                         const float** values, size_t num) {
+  if (FLAGS_pserver_concurrent_sparse_shard) {
+    return _push_sparse_concurrent(
+        keys, [values](size_t i) { return values[i]; }, num);
+  }
   std::vector<std::future<int>> tasks(_real_local_shard_num);
   std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
       _real_local_shard_num);
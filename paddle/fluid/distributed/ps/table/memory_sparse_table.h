@@ -17,6 +17,7 @@
 #include <ThreadPool.h>
 #include <assert.h>
 #include <pthread.h>
+#include <atomic>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
@@ -86,12 +87,29 @@ class MemorySparseTable : public SparseTable {
   virtual int32_t _push_sparse(const uint64_t* keys, const float** values,
                                size_t num);
 
+  // Concurrent shard mode: a batch is split into contiguous ranges that run
+  // on any task pool, and each key only locks the bucket it hashes to inside
+  // its shard, so a hot shard is served by all pool threads.
+  size_t _shard_id_of(uint64_t key) const {
+    return (key % _sparse_table_shard_num) % _avg_local_shard_num;
+  }
+  template <typename Func>
+  void _run_concurrent(size_t num, Func&& func);
+  int32_t _pull_sparse_concurrent(float* pull_values,
+                                  const PullSparseValue& pull_value);
+  int32_t _pull_sparse_ptr_concurrent(char** pull_values,
+                                      const uint64_t* keys, size_t num);
+  template <typename GetUpdate>
+  int32_t _push_sparse_concurrent(const uint64_t* keys, GetUpdate get_update,
+                                  size_t num);
+
  protected:
   const int _task_pool_size = 24;
   size_t _avg_local_shard_num;
   size_t _real_local_shard_num;
   size_t _sparse_table_shard_num;
   std::vector<std::shared_ptr<::ThreadPool>> _shards_task_pool;
+  std::atomic<size_t> _task_pool_cursor{0};
   std::unique_ptr<shard_type[]> _local_shards;
 };
 
@@ -14,8 +14,15 @@
 
 #ifdef PADDLE_WITH_HETERPS
 #include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
 
 DEFINE_string(rocksdb_path, "database", "path of sparse table rocksdb file");
+DEFINE_int64(ssd_table_mem_capacity, 0,
+             "max number of values one SSDSparseTable shard keeps in memory "
+             "after update_table, the most frequently pulled ones are kept. "
+             "0 keeps every value seen since the last update");
 
 namespace paddle {
 namespace distributed {
@@ -58,6 +65,12 @@ int32_t SSDSparseTable::initialize() {
   initialize_recorder();
   _db = paddle::distributed::RocksDBHandler::GetInstance();
   _db->initialize(FLAGS_rocksdb_path, task_pool_size_);
+  if (FLAGS_ssd_table_mem_capacity > 0) {
+    for (int i = 0; i < task_pool_size_; ++i) {
+      _sketches.emplace_back(new FrequencySketch(
+          static_cast<size_t>(FLAGS_ssd_table_mem_capacity)));
+    }
+  }
   return 0;
 }
 
@@ -76,6 +89,38 @@ int32_t SSDSparseTable::Pull(TableContext& context) {
 
 int32_t SSDSparseTable::Push(TableContext& context) { return 0; }
 
+void SSDSparseTable::get_from_db(int shard_id,
+                                 const std::vector<uint64_t>& feasigns,
+                                 std::vector<std::string>* db_values,
+                                 std::vector<int>* status) {
+  if (feasigns.empty()) {
+    return;
+  }
+  std::vector<std::pair<char*, int>> db_keys;
+  db_keys.reserve(feasigns.size());
+  for (auto& feasign : feasigns) {
+    db_keys.emplace_back((char*)&feasign, sizeof(uint64_t));  // NOLINT
+  }
+  _db->get_batch(shard_id, db_keys, db_values, status);
+}
+
+VALUE* SSDSparseTable::load_from_db(std::shared_ptr<ValueBlock>& block,
+                                    uint64_t feasign,
+                                    const std::string& db_value) {
+  int value_size = block->value_length_;
+  const float* db_data = reinterpret_cast<const float*>(db_value.data());
+  VALUE* value = block->InitGet(feasign);
+
+  // copy to mem
+  memcpy(value->data_.data(), db_data, value_size * sizeof(float));
+
+  // param, count, unseen_day
+  value->count_ = db_data[value_size];
+  value->unseen_days_ = db_data[value_size + 1];
+  value->is_entry_ = db_data[value_size + 2];
+  return value;
+}
+
 int32_t SSDSparseTable::pull_sparse(float* pull_values,
                                     const PullSparseValue& pull_value) {
   auto shard_num = task_pool_size_;
@@ -85,47 +130,60 @@ int32_t SSDSparseTable::pull_sparse(float* pull_values,
     tasks[shard_id] = _shards_task_pool[shard_id]->enqueue(
         [this, shard_id, shard_num, &pull_value, &pull_values]() -> int {
           auto& block = shard_values_[shard_id];
+          auto* sketch =
+              _sketches.empty() ? nullptr : _sketches[shard_id].get();
 
           std::vector<int> offsets;
           pull_value.Fission(shard_id, shard_num, &offsets);
 
+          // values in mem are served right away, the others are read from
+          // rocksdb with one batch afterwards
+          std::vector<int> miss_offsets;
+          std::vector<uint64_t> miss_feasigns;
           for (auto& offset : offsets) {
             auto feasign = pull_value.feasigns_[offset];
             auto frequencie = pull_value.frequencies_[offset];
-            float* embedding = nullptr;
+            if (sketch != nullptr) {
+              sketch->Increment(feasign, frequencie);
+            }
             auto iter = block->Find(feasign);
-            // in mem
             if (iter == block->end()) {
+              miss_offsets.push_back(offset);
+              miss_feasigns.push_back(feasign);
+              continue;
+            }
+            if (pull_value.is_training_) {
+              block->AttrUpdate(iter->second, frequencie);
+            }
+            std::copy_n(iter->second->data_.data() + param_offset_, param_dim_,
+                        pull_values + param_dim_ * offset);
+          }
+
+          std::vector<std::string> db_values;
+          std::vector<int> status;
+          get_from_db(shard_id, miss_feasigns, &db_values, &status);
+          for (size_t i = 0; i < miss_offsets.size(); ++i) {
+            auto offset = miss_offsets[i];
+            auto feasign = miss_feasigns[i];
+            auto frequencie = pull_value.frequencies_[offset];
+            float* embedding = nullptr;
+            auto iter = block->Find(feasign);
+            if (iter != block->end()) {
+              // repeated feasign, loaded earlier in this batch
               embedding = iter->second->data_.data();
               if (pull_value.is_training_) {
                 block->AttrUpdate(iter->second, frequencie);
               }
-            } else {
+            } else if (status[i] > 0) {
               // need create
-              std::string tmp_str("");
-              if (_db->get(shard_id, (char*)&feasign, sizeof(uint64_t),
-                           tmp_str) > 0) {
-                embedding = block->Init(feasign, true, frequencie);
-              } else {
-                // in db
-                int data_size = tmp_str.size() / sizeof(float);
-                int value_size = block->value_length_;
-                float* db_value = (float*)const_cast<char*>(tmp_str.c_str());
-                VALUE* value = block->InitGet(feasign);
-
-                // copy to mem
-                memcpy(value->data_.data(), db_value,
-                       value_size * sizeof(float));
-                embedding = db_value;
-
-                // param, count, unseen_day
-                value->count_ = db_value[value_size];
-                value->unseen_days_ = db_value[value_size + 1];
-                value->is_entry_ = db_value[value_size + 2];
-                if (pull_value.is_training_) {
-                  block->AttrUpdate(value, frequencie);
-                }
+              embedding = block->Init(feasign, true, frequencie);
+            } else {
+              // in db
+              VALUE* value = load_from_db(block, feasign, db_values[i]);
+              if (pull_value.is_training_) {
+                block->AttrUpdate(value, frequencie);
               }
+              embedding = value->data_.data();
             }
             std::copy_n(embedding + param_offset_, param_dim_,
                         pull_values + param_dim_ * offset);
@@ -158,38 +216,44 @@ int32_t SSDSparseTable::pull_sparse_ptr(char** pull_values,
         [this, shard_id, &keys, &pull_values, &offset_bucket]() -> int {
           auto& block = shard_values_[shard_id];
           auto& offsets = offset_bucket[shard_id];
+          auto* sketch =
+              _sketches.empty() ? nullptr : _sketches[shard_id].get();
 
+          std::vector<uint64_t> miss_offsets;
+          std::vector<uint64_t> miss_feasigns;
           for (auto& offset : offsets) {
             auto feasign = keys[offset];
+            if (sketch != nullptr) {
+              sketch->Increment(feasign);
+            }
             auto iter = block->Find(feasign);
-            VALUE* value = nullptr;
             // in mem
             if (iter != block->end()) {
-              value = iter->second;
+              pull_values[offset] = (char*)iter->second;  // NOLINT
             } else {
+              miss_offsets.push_back(offset);
+              miss_feasigns.push_back(feasign);
+            }
+          }
+
+          std::vector<std::string> db_values;
+          std::vector<int> status;
+          get_from_db(shard_id, miss_feasigns, &db_values, &status);
+          for (size_t i = 0; i < miss_offsets.size(); ++i) {
+            auto feasign = miss_feasigns[i];
+            VALUE* value = nullptr;
+            auto iter = block->Find(feasign);
+            if (iter != block->end()) {
+              // repeated feasign, loaded earlier in this batch
+              value = iter->second;
+            } else if (status[i] > 0) {
               // need create
-              std::string tmp_str("");
-              if (_db->get(shard_id, (char*)&feasign, sizeof(uint64_t),
-                           tmp_str) > 0) {
-                value = block->InitGet(feasign);
-              } else {
-                // in db
-                int data_size = tmp_str.size() / sizeof(float);
-                int value_size = block->value_length_;
-                float* db_value = (float*)const_cast<char*>(tmp_str.c_str());
-                value = block->InitGet(feasign);
-
-                // copy to mem
-                memcpy(value->data_.data(), db_value,
-                       value_size * sizeof(float));
-
-                // param, count, unseen_day
-                value->count_ = db_value[value_size];
-                value->unseen_days_ = db_value[value_size + 1];
-                value->is_entry_ = db_value[value_size + 2];
-              }
+              value = block->InitGet(feasign);
+            } else {
+              // in db
+              value = load_from_db(block, feasign, db_values[i]);
             }
-            pull_values[offset] = (char*)value;
+            pull_values[miss_offsets[i]] = (char*)value;  // NOLINT
           }
           return 0;
         });
@@ -203,35 +267,87 @@ int32_t SSDSparseTable::pull_sparse_ptr(char** pull_values,
 
 int32_t SSDSparseTable::shrink(const std::string& param) { return 0; }
 
-int32_t SSDSparseTable::update_table() {
-  int count = 0;
-  int value_size = shard_values_[0]->value_length_;
+int64_t SSDSparseTable::evict_shard(int shard_id) {
+  auto& block = shard_values_[shard_id];
+  int value_size = block->value_length_;
   int db_size = 3 + value_size;
-  float tmp_value[db_size];
-
-  for (size_t i = 0; i < task_pool_size_; ++i) {
-    auto& block = shard_values_[i];
 
+  // TinyLFU style admission: when the shard holds more values than the hot
+  // set may keep, the values of the lowest frequencies are evicted until
+  // exactly capacity values stay in memory.
+  std::unordered_set<uint64_t> cold_keys;
+  size_t capacity = static_cast<size_t>(FLAGS_ssd_table_mem_capacity);
+  if (!_sketches.empty()) {
+    std::vector<uint64_t> keys;
     for (auto& table : block->values_) {
-      for (auto iter = table.begin(); iter != table.end();) {
-        VALUE* value = iter->second;
-        if (value->unseen_days_ >= 1) {
-          tmp_value[value_size] = value->count_;
-          tmp_value[value_size + 1] = value->unseen_days_;
-          tmp_value[value_size + 2] = value->is_entry_;
-          memcpy(tmp_value, value->data_.data(), sizeof(float) * value_size);
-          _db->put(i, (char*)&(iter->first), sizeof(uint64_t), (char*)tmp_value,
-                   db_size * sizeof(float));
-          count++;
-
-          butil::return_object(iter->second);
-          iter = table.erase(iter);
-        } else {
-          ++iter;
+      for (auto& iter : table) {
+        if (iter.second->unseen_days_ < 1) {
+          keys.push_back(iter.first);
         }
       }
     }
-    _db->flush(i);
+    if (keys.size() > capacity) {
+      auto evict_keys = LeastFrequentKeys(*_sketches[shard_id], keys,
+                                          keys.size() - capacity);
+      cold_keys.insert(evict_keys.begin(), evict_keys.end());
+    }
+  }
+
+  // evicted values are written to rocksdb in batches
+  const int batch_size = 1024;
+  std::vector<uint64_t> batch_keys(batch_size);
+  std::vector<float> batch_values(batch_size * db_size);
+  std::vector<std::pair<char*, int>> ssd_keys(batch_size);
+  std::vector<std::pair<char*, int>> ssd_values(batch_size);
+  for (int i = 0; i < batch_size; ++i) {
+    ssd_keys[i] = {(char*)&batch_keys[i], sizeof(uint64_t)};  // NOLINT
+    ssd_values[i] = {(char*)&batch_values[i * db_size],       // NOLINT
+                     static_cast<int>(db_size * sizeof(float))};
+  }
+  int batch_num = 0;
+  int64_t count = 0;
+
+  for (auto& table : block->values_) {
+    for (auto iter = table.begin(); iter != table.end();) {
+      VALUE* value = iter->second;
+      bool evict =
+          value->unseen_days_ >= 1 || cold_keys.count(iter->first) > 0;
+      if (!evict) {
+        ++iter;
+        continue;
+      }
+      float* tmp_value = &batch_values[batch_num * db_size];
+      memcpy(tmp_value, value->data_.data(), sizeof(float) * value_size);
+      tmp_value[value_size] = value->count_;
+      tmp_value[value_size + 1] = value->unseen_days_;
+      tmp_value[value_size + 2] = value->is_entry_;
+      batch_keys[batch_num] = iter->first;
+      if (++batch_num == batch_size) {
+        _db->put_batch(shard_id, ssd_keys, ssd_values, batch_num);
+        batch_num = 0;
+      }
+      count++;
+
+      butil::return_object(iter->second);
+      iter = table.erase(iter);
+    }
+  }
+  if (batch_num > 0) {
+    _db->put_batch(shard_id, ssd_keys, ssd_values, batch_num);
+  }
+  _db->flush(shard_id);
+  return count;
+}
+
+int32_t SSDSparseTable::update_table() {
+  std::vector<std::future<int64_t>> tasks(task_pool_size_);
+  for (int shard_id = 0; shard_id < task_pool_size_; ++shard_id) {
+    tasks[shard_id] = _shards_task_pool[shard_id]->enqueue(
+        [this, shard_id]() -> int64_t { return evict_shard(shard_id); });
+  }
+  int64_t count = 0;
+  for (auto& task : tasks) {
+    count += task.get();
   }
   VLOG(1) << "Table>> update count: " << count;
   return 0;
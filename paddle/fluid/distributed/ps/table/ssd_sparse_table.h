@@ -14,6 +14,7 @@
 
 #pragma once
 #include "paddle/fluid/distributed/ps/table/common_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/depends/frequency_sketch.h"
 #include "paddle/fluid/distributed/ps/table/depends/rocksdb_warpper.h"
 #ifdef PADDLE_WITH_HETERPS
 namespace paddle {
@@ -55,8 +56,22 @@ class SSDSparseTable : public CommonSparseTable {
   virtual void clear() override {}
 
  private:
+  // Reads the feasigns of one shard that are not in memory from rocksdb
+  // with one batched call. status follows RocksDBHandler::get_batch.
+  void get_from_db(int shard_id, const std::vector<uint64_t>& feasigns,
+                   std::vector<std::string>* db_values,
+                   std::vector<int>* status);
+  // Creates the in-memory value of a feasign from its rocksdb record.
+  VALUE* load_from_db(std::shared_ptr<ValueBlock>& block, uint64_t feasign,
+                      const std::string& db_value);
+  // Moves the values of one shard that are unseen since the last update, or
+  // that fall out of the hot set kept in memory, to rocksdb.
+  int64_t evict_shard(int shard_id);
+
   RocksDBHandler* _db;
   int64_t _cache_tk_size;
+  // per shard access frequency, only kept when the hot set is bounded
+  std::vector<std::unique_ptr<FrequencySketch>> _sketches;
 };
 
 }  // namespace ps
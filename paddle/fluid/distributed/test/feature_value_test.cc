@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
+#include <mutex>         // NOLINT
+#include <shared_mutex>  // NOLINT
+#include <thread>        // NOLINT
 #include <vector>
 #include "gtest/gtest.h"
 
@@ -44,5 +47,120 @@ TEST(BENCHMARK, LargeScaleKV) {
   ASSERT_FLOAT_EQ(value_data[3], 0.3);
 }
 
+TEST(FixedFeatureValue, SlabResize) {
+  FixedFeatureValue value;
+  ASSERT_EQ(value.size(), 0UL);
+  value.resize(7);
+  for (int i = 0; i < 7; ++i) {
+    value.data()[i] = static_cast<float>(i);
+  }
+  // growing keeps the old floats and zero-fills the new ones
+  value.resize(7 + 600);
+  ASSERT_EQ(value.size(), 607UL);
+  for (int i = 0; i < 7; ++i) {
+    ASSERT_FLOAT_EQ(value.data()[i], static_cast<float>(i));
+  }
+  for (int i = 7; i < 607; ++i) {
+    ASSERT_FLOAT_EQ(value.data()[i], 0.0);
+  }
+  value.resize(9);
+  value.shrink_to_fit();
+  ASSERT_EQ(value.size(), 9UL);
+  ASSERT_FLOAT_EQ(value.data()[6], 6.0);
+
+  FixedFeatureValue copy(value);
+  ASSERT_EQ(copy.size(), 9UL);
+  ASSERT_NE(copy.data(), value.data());
+  ASSERT_FLOAT_EQ(copy.data()[6], 6.0);
+
+}
+
+TEST(FixedFeatureValue, SlabConcurrentAcquireRelease) {
+  auto& slab = FeatureValueSlab::instance();
+  size_t slab_num = slab.slab_num();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([t] {
+      // enough values of each of the 3 sizes to fill several slabs
+      std::vector<FixedFeatureValue> values(20000);
+      for (size_t i = 0; i < values.size(); ++i) {
+        values[i].resize(3 + i % 3 * 2);
+        for (size_t j = 0; j < values[i].size(); ++j) {
+          values[i].data()[j] = static_cast<float>(t * 100000 + i);
+        }
+      }
+      // no block is handed out twice
+      for (size_t i = 0; i < values.size(); ++i) {
+        for (size_t j = 0; j < values[i].size(); ++j) {
+          ASSERT_FLOAT_EQ(values[i].data()[j],
+                          static_cast<float>(t * 100000 + i));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // the slabs of freed values are returned, except for one empty slab kept
+  // by each shard of a size class
+  ASSERT_LE(slab.slab_num(), slab_num + 3 * FeatureValueSlab::kShardNum);
+}
+
+TEST(SparseBucketLock, ConcurrentReadWrite) {
+  SparseBucketLock lock;
+  int64_t counter = 0;
+  int64_t mirror = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 10000; ++i) {
+        std::lock_guard<SparseBucketLock> guard(lock);
+        ++counter;
+        ++mirror;
+      }
+    });
+    threads.emplace_back([&] {
+      for (int i = 0; i < 10000; ++i) {
+        std::shared_lock<SparseBucketLock> guard(lock);
+        ASSERT_EQ(counter, mirror);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(counter, 40000);
+}
+
+TEST(SparseTableShard, ConcurrentEmplace) {
+  typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
+  shard_type shard;
+  std::vector<std::thread> threads;
+  for (uint64_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&shard, t] {
+      for (uint64_t i = 0; i < 1000; ++i) {
+        // every key is inserted by two threads, spread over the buckets
+        uint64_t key = ((t % 2) * 1000 + i + 1) * 0x9E3779B97F4A7C15UL;
+        std::lock_guard<SparseBucketLock> guard(
+            shard.bucket_lock(shard.bucket_of(key)));
+        auto& feature_value = shard[key];
+        if (feature_value.size() == 0) {
+          feature_value.resize(1);
+          feature_value.data()[0] = static_cast<float>(i);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(shard.size(), 2000UL);
+  for (uint64_t i = 0; i < 1000; ++i) {
+    auto itr = shard.find((1000 + i + 1) * 0x9E3779B97F4A7C15UL);
+    ASSERT_TRUE(itr != shard.end());
+    ASSERT_FLOAT_EQ(itr.value().data()[0], static_cast<float>(i));
+  }
+}
+
 }  // namespace distributed
 }  // namespace paddle
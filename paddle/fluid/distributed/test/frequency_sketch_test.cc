@@ -0,0 +1,81 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/depends/frequency_sketch.h"
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace distributed {
+
+TEST(FrequencySketch, HotKeysOutrankColdKeys) {
+  FrequencySketch sketch(1024);
+  for (uint64_t key = 0; key < 512; ++key) {
+    sketch.Increment(key);
+  }
+  for (int i = 0; i < 20; ++i) {
+    sketch.Increment(7);
+    sketch.Increment(100000, 2);
+  }
+  ASSERT_GE(sketch.Estimate(7), 21U);
+  ASSERT_GE(sketch.Estimate(100000), 40U);
+  ASSERT_LT(sketch.Estimate(8), sketch.Estimate(7));
+  ASSERT_LE(sketch.Estimate(123456789), 1U);
+}
+
+TEST(FrequencySketch, AgingHalvesCounts) {
+  FrequencySketch sketch(64);
+  sketch.Increment(42, 40);
+  uint32_t before = sketch.Estimate(42);
+  sketch.Age();
+  ASSERT_EQ(sketch.Estimate(42), before / 2);
+}
+
+TEST(FrequencySketch, LeastFrequentKeys) {
+  FrequencySketch sketch(1024);
+  // keys 0-9 are never seen, keys 10-19 are seen 3 times each
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 0; key < 20; ++key) {
+    keys.push_back(19 - key);
+  }
+  for (uint64_t key = 10; key < 20; ++key) {
+    sketch.Increment(key, 3);
+  }
+  sketch.Increment(100, 5);
+  keys.push_back(100);
+
+  auto SortedLeastFrequentKeys = [&](size_t count) {
+    auto evict_keys = LeastFrequentKeys(sketch, keys, count);
+    std::sort(evict_keys.begin(), evict_keys.end());
+    return evict_keys;
+  };
+  // the ties at the cutoff are broken by the keys, so exactly count keys
+  // are evicted however many keys share the cutoff frequency
+  std::vector<uint64_t> expected;
+  for (uint64_t key = 0; key < 15; ++key) {
+    expected.push_back(key);
+  }
+  ASSERT_EQ(SortedLeastFrequentKeys(15), expected);
+  // keys of zero frequency are evicted too
+  ASSERT_EQ(SortedLeastFrequentKeys(3), std::vector<uint64_t>({0, 1, 2}));
+  ASSERT_TRUE(SortedLeastFrequentKeys(0).empty());
+  expected.assign(keys.begin(), keys.end());
+  std::sort(expected.begin(), expected.end());
+  ASSERT_EQ(SortedLeastFrequentKeys(keys.size() + 1), expected);
+}
+
+}  // namespace distributed
+}  // namespace paddle
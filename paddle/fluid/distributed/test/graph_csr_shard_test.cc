@@ -0,0 +1,139 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr_shard.h"
+#include <unistd.h>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace distributed {
+
+static std::vector<Node *> build_nodes(bool is_weighted) {
+  std::vector<Node *> nodes;
+  // deliberately unsorted ids, node 5 has no edges and hence no sampler
+  std::vector<uint64_t> ids = {42, 7, 5, 100};
+  for (auto id : ids) {
+    GraphNode *node = new GraphNode(id);
+    node->build_edges(is_weighted);
+    if (id != 5) {
+      for (uint64_t j = 0; j < id % 10 + 3; j++) {
+        node->add_edge(id * 1000 + j, float(j + 1));
+      }
+      node->build_sampler(is_weighted ? "weighted" : "random");
+    }
+    nodes.push_back(node);
+  }
+  return nodes;
+}
+
+static void check_same(const GraphCSRShard &csr,
+                       const std::vector<Node *> &nodes, bool is_weighted) {
+  ASSERT_EQ(csr.node_num(), nodes.size());
+  for (auto node : nodes) {
+    int64_t idx = csr.find(node->get_id());
+    ASSERT_GE(idx, 0);
+    ASSERT_EQ(csr.get_neighbor_size(idx), node->get_neighbor_size());
+    for (size_t j = 0; j < node->get_neighbor_size(); j++) {
+      ASSERT_EQ(csr.get_neighbor_id(idx, j), node->get_neighbor_id(j));
+      if (is_weighted) {
+        ASSERT_FLOAT_EQ(csr.get_neighbor_weight(idx, j),
+                        node->get_neighbor_weight(j));
+      }
+    }
+  }
+  ASSERT_EQ(csr.find(6), -1);
+  ASSERT_EQ(csr.find(1000), -1);
+}
+
+static void check_sample(const GraphCSRShard &csr) {
+  std::mt19937_64 rng(2022);
+  for (size_t i = 0; i < csr.node_num(); i++) {
+    int degree = csr.get_neighbor_size(i);
+    for (int k = 1; k <= degree + 1; k++) {
+      auto res = csr.sample_k(i, k, rng);
+      ASSERT_EQ((int)res.size(), std::min(k, degree));
+      std::set<int> uniq(res.begin(), res.end());
+      ASSERT_EQ(uniq.size(), res.size());
+      for (int x : res) {
+        ASSERT_GE(x, 0);
+        ASSERT_LT(x, degree);
+      }
+    }
+  }
+}
+
+TEST(GraphCSRShard, BuildAndSample) {
+  for (bool is_weighted : {false, true}) {
+    auto nodes = build_nodes(is_weighted);
+    GraphCSRShard csr;
+    csr.build(nodes);
+    check_same(csr, nodes, is_weighted);
+    check_sample(csr);
+    for (auto node : nodes) delete node;
+  }
+}
+
+TEST(GraphCSRShard, WeightedDistribution) {
+  GraphNode node(1);
+  node.build_edges(true);
+  node.add_edge(10, 1.0);
+  node.add_edge(11, 3.0);
+  node.add_edge(12, 0.0);
+  node.build_sampler("weighted");
+  GraphCSRShard csr;
+  csr.build({&node});
+  std::mt19937_64 rng(7);
+  int count[3] = {0, 0, 0};
+  const int rounds = 40000;
+  for (int i = 0; i < rounds; i++) {
+    auto res = csr.sample_k(0, 1, rng);
+    ASSERT_EQ(res.size(), 1UL);
+    count[res[0]]++;
+  }
+  ASSERT_EQ(count[2], 0);
+  ASSERT_NEAR(count[1] / double(rounds), 0.75, 0.02);
+  // two picks out of three with a zero weight edge must return the others
+  for (int i = 0; i < 100; i++) {
+    auto res = csr.sample_k(0, 2, rng);
+    std::set<int> uniq(res.begin(), res.end());
+    ASSERT_EQ(uniq, std::set<int>({0, 1}));
+  }
+}
+
+TEST(GraphCSRShard, SaveAndMmapLoad) {
+  auto nodes = build_nodes(true);
+  GraphCSRShard csr;
+  csr.build(nodes);
+  std::string path = "graph_csr_shard_test.bin";
+  ASSERT_EQ(csr.save(path), 0);
+
+  GraphCSRShard loaded;
+  ASSERT_EQ(loaded.load(path), 0);
+  ASSERT_EQ(loaded.edge_num(), csr.edge_num());
+  check_same(loaded, nodes, true);
+  check_sample(loaded);
+
+  GraphCSRShard missing;
+  ASSERT_NE(missing.load(path + ".missing"), 0);
+  ::unlink(path.c_str());
+  for (auto node : nodes) delete node;
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -12,10 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <stdlib.h>
 #include <unistd.h>
 #include <condition_variable>  // NOLINT
 #include <fstream>
 #include <iomanip>
+#include <map>
+#include <set>
 #include <string>
 #include <thread>  // NOLINT
 #include <unordered_set>
@@ -146,3 +149,90 @@ void testGraphSample() {
 }
 
 TEST(testGraphSample, Run) { testGraphSample(); }
+
+static std::map<int64_t, std::set<std::pair<int64_t, float>>> sample_all(
+    distributed::GraphTable *graph_table, std::vector<int64_t> ids) {
+  std::vector<std::shared_ptr<char>> buffers(ids.size());
+  std::vector<int> actual_sizes(ids.size(), 0);
+  EXPECT_EQ(graph_table->random_sample_neighbors(ids.data(), 10, buffers,
+                                                 actual_sizes, true),
+            0);
+  std::map<int64_t, std::set<std::pair<int64_t, float>>> res;
+  int entry_size = distributed::Node::id_size + distributed::Node::weight_size;
+  for (size_t i = 0; i < ids.size(); i++) {
+    auto &neighbors = res[ids[i]];
+    for (int offset = 0; offset < actual_sizes[i]; offset += entry_size) {
+      int64_t id;
+      float weight;
+      memcpy(&id, buffers[i].get() + offset, distributed::Node::id_size);
+      memcpy(&weight, buffers[i].get() + offset + distributed::Node::id_size,
+             distributed::Node::weight_size);
+      neighbors.emplace(id, weight);
+    }
+  }
+  return res;
+}
+
+static std::set<int64_t> sample_all_nodes(
+    distributed::GraphTable *graph_table) {
+  std::unique_ptr<char[]> buffer;
+  int actual_size = 0;
+  EXPECT_EQ(graph_table->random_sample_nodes(1000, buffer, actual_size), 0);
+  int64_t *ids = reinterpret_cast<int64_t *>(buffer.get());
+  return std::set<int64_t>(ids, ids + actual_size / sizeof(int64_t));
+}
+
+TEST(testGraphSample, FreezeSaveLoad) {
+  ::paddle::distributed::GraphParameter table_proto;
+  table_proto.set_shard_num(7);
+  table_proto.set_task_pool_size(4);
+  distributed::GraphTable graph_table;
+  graph_table.initialize(table_proto);
+  prepare_file(edge_file_name, edges);
+  ASSERT_EQ(graph_table.load(std::string(edge_file_name), std::string("e>")),
+            0);
+  // 45 has no out edges and 1000 is unknown
+  std::vector<int64_t> ids = {37, 96, 59, 97, 45, 1000};
+  auto expected = sample_all(&graph_table, ids);
+  ASSERT_EQ(expected[96].size(), 3UL);
+  ASSERT_EQ(expected[96].count(std::make_pair(int64_t(111), 1.21f)), 1UL);
+  ASSERT_EQ(expected[1000].size(), 0UL);
+  auto expected_nodes = sample_all_nodes(&graph_table);
+  std::unique_ptr<char[]> expected_list;
+  int expected_list_size = 0;
+  ASSERT_EQ(graph_table.pull_graph_list(0, 1000, expected_list,
+                                        expected_list_size, false, 1),
+            0);
+
+  char dir[] = "/tmp/graph_frozen_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  ASSERT_EQ(graph_table.save(std::string(dir), std::string("")), 0);
+  ASSERT_TRUE(graph_table.is_frozen());
+  ASSERT_EQ(sample_all(&graph_table, ids), expected);
+  // the topology is immutable while frozen
+  ASSERT_NE(graph_table.load(std::string(edge_file_name), std::string("e>")),
+            0);
+
+  ASSERT_EQ(graph_table.clear_nodes(), 0);
+  ASSERT_FALSE(graph_table.is_frozen());
+  ASSERT_EQ(sample_all(&graph_table, ids)[37].size(), 0UL);
+  ASSERT_EQ(graph_table.load(std::string(dir), std::string("f")), 0);
+  ASSERT_TRUE(graph_table.is_frozen());
+  ASSERT_EQ(sample_all(&graph_table, ids), expected);
+  // the node ids are read from the CSR shards without creating nodes
+  ASSERT_EQ(graph_table.find_node(96), nullptr);
+  ASSERT_EQ(sample_all_nodes(&graph_table), expected_nodes);
+  ASSERT_EQ(graph_table.find_node(96), nullptr);
+  // pulling the node list creates the nodes
+  std::unique_ptr<char[]> list;
+  int list_size = 0;
+  ASSERT_EQ(graph_table.pull_graph_list(0, 1000, list, list_size, false, 1),
+            0);
+  ASSERT_EQ(list_size, expected_list_size);
+  ASSERT_NE(graph_table.find_node(96), nullptr);
+
+  for (int i = 0; i < 7; i++) {
+    unlink(paddle::string::Sprintf("%s/csr_shard_%05d", dir, i).c_str());
+  }
+  rmdir(dir);
+}
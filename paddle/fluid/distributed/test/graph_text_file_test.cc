@@ -0,0 +1,99 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_text_file.h"
+#include <unistd.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace distributed {
+
+static TextSlice slice(const std::string &str) {
+  return TextSlice{str.data(), str.data() + str.size()};
+}
+
+TEST(GraphTextFile, SplitCoversEveryLineOnce) {
+  std::string path = "graph_text_file_test.txt";
+  std::vector<std::string> lines;
+  {
+    std::ofstream out(path);
+    for (int i = 0; i < 1000; i++) {
+      lines.push_back(std::to_string(i) + "\t" + std::to_string(i * 7));
+      out << lines.back() << (i % 3 == 0 ? "\r\n" : "\n");
+    }
+    // last line without trailing newline
+    lines.push_back("1000\t7000");
+    out << lines.back();
+  }
+  GraphTextFile file;
+  ASSERT_EQ(file.open(path), 0);
+  for (int num : {1, 3, 7, 64}) {
+    auto ranges = file.split(num, 1);
+    ASSERT_LE(ranges.size(), size_t(num));
+    ASSERT_EQ(ranges.front().first, 0UL);
+    ASSERT_EQ(ranges.back().second, file.size());
+    std::vector<std::string> parsed;
+    for (size_t i = 0; i < ranges.size(); i++) {
+      if (i > 0) {
+        ASSERT_EQ(ranges[i].first, ranges[i - 1].second);
+        ASSERT_EQ(file.data()[ranges[i].first - 1], '\n');
+      }
+      for_each_line(
+          file.data() + ranges[i].first, file.data() + ranges[i].second,
+          [&](TextSlice line) { parsed.push_back(line.to_string()); });
+    }
+    ASSERT_EQ(parsed, lines);
+  }
+  // min_size limits the number of ranges for small files
+  ASSERT_EQ(file.split(64, 1 << 20).size(), 1UL);
+
+  GraphTextFile missing;
+  ASSERT_NE(missing.open(path + ".missing"), 0);
+  ::unlink(path.c_str());
+}
+
+TEST(GraphTextFile, ParseFields) {
+  std::string line = "user\t37\ta 0.34\tb 13 14";
+  TextSlice fields[3];
+  ASSERT_EQ(split_fields(slice(line), '\t', fields, 3), 3);
+  ASSERT_TRUE(fields[0].equals("user"));
+  ASSERT_TRUE(fields[1].equals("37"));
+  ASSERT_TRUE(fields[2].equals("a 0.34\tb 13 14"));
+  std::string single = "37";
+  ASSERT_EQ(split_fields(slice(single), '\t', fields, 3), 1);
+
+  uint64_t id;
+  ASSERT_TRUE(parse_uint64(fields[0], &id));
+  ASSERT_EQ(id, 37UL);
+  ASSERT_TRUE(parse_uint64(slice("18446744073709551615"), &id));
+  ASSERT_EQ(id, 18446744073709551615UL);
+  ASSERT_FALSE(parse_uint64(slice("18446744073709551616"), &id));
+  ASSERT_FALSE(parse_uint64(slice("99999999999999999999"), &id));
+  ASSERT_FALSE(parse_uint64(slice(""), &id));
+  ASSERT_FALSE(parse_uint64(slice("12a"), &id));
+
+  float weight;
+  ASSERT_TRUE(parse_float(slice("0.25"), &weight));
+  ASSERT_FLOAT_EQ(weight, 0.25);
+  ASSERT_TRUE(parse_float(slice("1e-3"), &weight));
+  ASSERT_FLOAT_EQ(weight, 1e-3);
+  ASSERT_FALSE(parse_float(slice("0.3x"), &weight));
+  ASSERT_FALSE(parse_float(slice(""), &weight));
+}
+
+}  // namespace distributed
+}  // namespace paddle
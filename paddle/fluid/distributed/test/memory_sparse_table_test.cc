@@ -15,9 +15,12 @@ limitations under the License. */
 #include <ThreadPool.h>
 
 #include <unistd.h>
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
+#include "gflags/gflags.h"
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/distributed/ps.pb.h"
@@ -27,10 +30,11 @@ limitations under the License. */
 namespace paddle {
 namespace distributed {
 
-TEST(MemorySparseTable, SGD) {
-  int emb_dim = 8;
-  int trainers = 2;
+DECLARE_bool(pserver_concurrent_sparse_shard);
 
+// A MemorySparseTable of 10 shards with a CtrCommonAccessor, updating the
+// embeddings with SparseNaiveSGDRule.
+static Table *CreateCtrTable() {
   TableParameter table_config;
   table_config.set_table_class("MemorySparseTable");
   table_config.set_shard_num(10);
@@ -66,8 +70,15 @@ TEST(MemorySparseTable, SGD) {
   naive_param->add_weight_bounds(-10.0);
   naive_param->add_weight_bounds(10.0);
 
-  auto ret = table->initialize(table_config, fs_config);
-  ASSERT_EQ(ret, 0);
+  EXPECT_EQ(table->initialize(table_config, fs_config), 0);
+  return table;
+}
+
+TEST(MemorySparseTable, SGD) {
+  int emb_dim = 8;
+  int trainers = 2;
+
+  Table *table = CreateCtrTable();
 
   // pull parameters for create and check
   std::vector<uint64_t> init_keys = {0, 1, 2, 3, 4};
@@ -136,5 +147,84 @@ TEST(MemorySparseTable, SGD) {
   ctr_table->save_local_fs("./work/table.save", "0", "test");
 }
 
+// Pulls kKeyNum keys from kThreads threads at once, pushes the gradients of
+// kThreads trainers over the same keys at once, and returns how much the
+// pulled values of each key changed.
+static std::vector<float> PullPushDelta(bool concurrent_shard) {
+  const int kEmbDim = 8;
+  const int kThreads = 4;
+  const int kKeyNum = 1000;
+  const size_t kPullDim = kEmbDim + 3;
+  const size_t kPushDim = kEmbDim + 4;
+  FLAGS_pserver_concurrent_sparse_shard = concurrent_shard;
+  std::unique_ptr<Table> table(CreateCtrTable());
+
+  std::vector<uint64_t> keys(kKeyNum);
+  std::vector<uint32_t> fres(kKeyNum, 1);
+  for (int i = 0; i < kKeyNum; ++i) {
+    keys[i] = i * 7;
+  }
+  auto value = PullSparseValue(keys, fres, kEmbDim);
+  std::vector<float> init_values(kKeyNum * kPullDim);
+  table->pull_sparse(init_values.data(), value);
+
+  ::ThreadPool pool(kThreads);
+  std::vector<std::vector<float>> pulled(kThreads);
+  std::vector<std::future<void>> tasks;
+  for (int t = 0; t < kThreads; ++t) {
+    tasks.push_back(pool.enqueue([&, t] {
+      pulled[t].resize(kKeyNum * kPullDim);
+      table->pull_sparse(pulled[t].data(), value);
+    }));
+  }
+  for (auto &task : tasks) {
+    task.wait();
+  }
+  // a key is created only once however many threads pull it
+  for (int t = 0; t < kThreads; ++t) {
+    EXPECT_EQ(pulled[t], init_values) << "thread " << t;
+  }
+
+  // one show and no click per push keeps the embedx of the keys uncreated
+  std::vector<std::vector<float>> gradients(kThreads);
+  for (int t = 0; t < kThreads; ++t) {
+    for (int i = 0; i < kKeyNum; ++i) {
+      gradients[t].push_back(0);  // slot
+      gradients[t].push_back(1);  // show
+      gradients[t].push_back(0);  // click
+      for (size_t k = 3; k < kPushDim; ++k) {
+        gradients[t].push_back(0.01 * ((i + t + k) % 5));
+      }
+    }
+  }
+  tasks.clear();
+  for (int t = 0; t < kThreads; ++t) {
+    tasks.push_back(pool.enqueue([&, t] {
+      table->push_sparse(keys.data(), gradients[t].data(), keys.size());
+    }));
+  }
+  for (auto &task : tasks) {
+    task.wait();
+  }
+
+  std::vector<float> pull_values(kKeyNum * kPullDim);
+  table->pull_sparse(pull_values.data(), value);
+  for (size_t i = 0; i < pull_values.size(); ++i) {
+    pull_values[i] -= init_values[i];
+  }
+  FLAGS_pserver_concurrent_sparse_shard = false;
+  return pull_values;
+}
+
+TEST(MemorySparseTable, ConcurrentShard) {
+  // the random initial values differ between the tables, the updates do not
+  auto expected = PullPushDelta(false);
+  auto delta = PullPushDelta(true);
+  ASSERT_EQ(delta.size(), expected.size());
+  for (size_t i = 0; i < delta.size(); ++i) {
+    ASSERT_NEAR(delta[i], expected[i], 1e-5) << "value " << i;
+  }
+}
+
 }  // namespace distributed
 }  // namespace paddle
@@ -13,12 +13,19 @@
 // limitations under the License.
 
 #include "paddle/fluid/eager/backward.h"
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <map>
+#include <mutex>  // NOLINT
 #include <queue>
 
+#include "paddle/fluid/eager/accumulation/accumulation_node.h"
+#include "paddle/fluid/eager/api/utils/global_utils.h"
 #include "paddle/fluid/eager/autograd_meta.h"
 #include "paddle/fluid/eager/grad_node_info.h"
 #include "paddle/fluid/eager/grad_tensor_holder.h"
 #include "paddle/fluid/eager/utils.h"
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 
@@ -27,6 +34,9 @@
 
 #include "glog/logging.h"
 
+DECLARE_int32(eager_backward_num_threads);
+DECLARE_bool(eager_backward_deterministic);
+
 namespace egr {
 
 /*
@@ -425,6 +435,285 @@ void DuplicateCheck(const std::vector<paddle::experimental::Tensor>& inputs,
 
 GeneralGrad* GeneralGrad::general_grad_ = new GeneralGrad();
 
+// Sum the grad outputs of node into the GradTensorHolders of its next nodes,
+// and push the next nodes which get all their grads into queue.
+void AccumulateGradOutputs(
+    GradNodeBase* node,
+    std::vector<std::vector<paddle::experimental::Tensor>>*
+        grad_output_tensors,
+    bool is_general_grad,
+    std::unordered_map<GradNodeBase*, std::unique_ptr<GradTensorHolder>>*
+        node_input_buffers_dict,
+    std::unordered_map<GradNodeBase*, int>* node_in_degree_map,
+    std::queue<GradNodeBase*>* queue) {
+  const std::vector<std::vector<Edge>>& edges = node->GetEdges();
+  PADDLE_ENFORCE(edges.size() == grad_output_tensors->size() || edges.empty(),
+                 paddle::platform::errors::Fatal(
+                     "Number of edges should be either empty ( for leaf node "
+                     ") or the same as number of output grad tensors, but we "
+                     "got edges size is: %d, grad_output size is: %d",
+                     edges.size(), grad_output_tensors->size()));
+
+  for (size_t i = 0; i < edges.size(); i++) {
+    for (size_t j = 0; j < edges[i].size(); j++) {
+      const Edge& edge = edges[i][j];
+      if (!edge.IsInitialized()) {
+        continue;
+      }
+      auto edge_rank = edge.GetEdgeRankInfo();
+      // Since we make edge has as same rank as bwd outputs, we indexing them
+      // with
+      // the same rank(i, j)
+      auto next_node_shared = edge.GetMutableGradNode();
+
+      // Next node could be nullptr if it is leaf tensor with no
+      // AccumulationNode attached
+      // Or it could also originated from dispensable inputs
+      if (!next_node_shared || !next_node_shared.get() ||
+          (*grad_output_tensors)[i].empty()) {
+        continue;
+      }
+
+      PADDLE_ENFORCE_LT(
+          j, (*grad_output_tensors)[i].size(),
+          paddle::platform::errors::Fatal(
+              "Rank of grad_output_tensors should be less than "
+              "grad_output_tensors[i].size(), which is: %d. This error may "
+              "indicate autoprune or autograd api error. ",
+              grad_output_tensors->size()));
+      paddle::experimental::Tensor& grad_output_tensor =
+          (*grad_output_tensors)[i][j];
+
+      if ((!grad_output_tensor.defined() ||
+           !grad_output_tensor.initialized())) {
+        VLOG(6) << "We get grad_output_tensor with slot: " << i
+                << ", rank: " << j << " as uninitialized or undefined tensor";
+      }
+      VLOG(6) << "Get Edge and grad_output_tensor with slot: " << i
+              << ", rank: " << j
+              << " 's name is: " << grad_output_tensor.name();
+
+      auto* next_node = next_node_shared.get();
+      if (!node_input_buffers_dict->count(next_node)) {
+        const auto& input_meta = next_node->InputMeta();
+        auto grad_tensor_holder =
+            std::make_unique<GradTensorHolder>(input_meta);
+        VLOG(6) << "Construct GradTensorHolder for grad node: "
+                << next_node->name();
+        (*node_input_buffers_dict)[next_node] = std::move(grad_tensor_holder);
+      }
+      VLOG(6) << "Sum grad inputs for edge slot: " << edge_rank.first
+              << ", rank: " << edge_rank.second;
+      (*node_input_buffers_dict)[next_node]->add(
+          edge_rank.first, edge_rank.second, grad_output_tensor);
+
+      // Update queue
+      (*node_in_degree_map)[next_node]--;
+
+      PADDLE_ENFORCE(
+          (*node_in_degree_map)[next_node] >= 0,
+          paddle::platform::errors::Fatal(
+              "Detected in-degree value smaller than zero. For Node: %s"
+              "Node's in-degree cannot be negative.",
+              next_node->name()));
+
+      if (is_general_grad) {
+        bool is_potential_stop_node =
+            GeneralGrad::Instance().GetPotentialStopNodes()->count(next_node);
+        if ((*node_in_degree_map)[next_node] == 0 && !is_potential_stop_node) {
+          queue->emplace(std::move(next_node));
+        }
+      } else {
+        if ((*node_in_degree_map)[next_node] == 0) {
+          queue->emplace(std::move(next_node));
+        }
+      }
+    }
+  }
+}
+
+// A grad node dispatched to the thread pool of the parallel backward.
+struct GradNodeRun {
+  GradNodeBase* node;
+  std::unique_ptr<GradTensorHolder> input_buffer;
+  std::vector<std::vector<paddle::experimental::Tensor>> grad_output_tensors;
+  std::exception_ptr error;
+  bool finished{false};
+};
+
+std::vector<std::vector<paddle::experimental::Tensor>> RunGradNode(
+    GradNodeBase* node, GradTensorHolder* input_buffer, bool retain_graph,
+    bool create_graph) {
+  paddle::platform::RecordEvent node_record_event(
+      std::string(typeid(*node).name()) + " grad_node",
+      paddle::platform::TracerEventType::Operator, 1);
+  VLOG(6) << "Running GradNode:" << node->name();
+  EnforceGradNodeHasInput(node);
+  std::vector<std::vector<paddle::experimental::Tensor>> grad_output_tensors =
+      (*node)(input_buffer->Buffers(), create_graph);
+  if (!retain_graph) {
+    node->ClearTensorWrappers();
+  }
+  return grad_output_tensors;
+}
+
+// Whether all the grads node gets are on CPU.
+bool IsCPUGradNode(GradTensorHolder* input_buffer) {
+  for (auto& slot : input_buffer->Buffers()) {
+    for (auto& tensor : slot) {
+      if (tensor.initialized() &&
+          !paddle::platform::is_cpu_place(tensor.inner_place())) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+paddle::framework::ThreadPool* GetBackwardThreadPool(int num_threads) {
+  static std::mutex mutex;
+  static std::map<int, std::unique_ptr<paddle::framework::ThreadPool>> pools;
+  std::lock_guard<std::mutex> guard(mutex);
+  auto& pool = pools[num_threads];
+  if (pool == nullptr) {
+    pool.reset(new paddle::framework::ThreadPool(num_threads));
+  }
+  return pool.get();
+}
+
+// The topological visit of RunBackward with FLAGS_eager_backward_num_threads
+// threads. There are two ready queues: the grad nodes whose grads are all on
+// CPU run in the thread pool, and the other ones run one by one in the
+// calling thread, to launch the kernels of a device in order. So do the
+// GradNodeAccumulations, whose reduce hooks (e.g. the ones of EagerReducer)
+// are not thread safe and must see the leaf grads in one order. Only the
+// calling thread touches the GradTensorHolders and the in-degrees, so the
+// grads are summed without locks, in the order the grad nodes finish, or, if
+// FLAGS_eager_backward_deterministic is set, in the order they are dispatched,
+// which gives the same results whatever the number of threads is.
+void RunBackwardInParallel(
+    std::queue<GradNodeBase*>* queue,
+    std::unordered_map<GradNodeBase*, std::unique_ptr<GradTensorHolder>>*
+        node_input_buffers_dict,
+    std::unordered_map<GradNodeBase*, int>* node_in_degree_map,
+    bool retain_graph, bool create_graph) {
+  auto* pool = GetBackwardThreadPool(FLAGS_eager_backward_num_threads);
+  bool deterministic = FLAGS_eager_backward_deterministic;
+  // the thread local states of the tracer, for the threads of the pool
+  bool has_grad = Controller::Instance().HasGrad();
+  auto amp_level = Controller::Instance().GetAMPLevel();
+  std::string amp_dtype =
+      Controller::Instance().GetCurrentTracer()->GetAmpDtype();
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  // the grad nodes dispatched to the pool in order, and the finished ones
+  // in order, guarded by mutex
+  std::vector<std::unique_ptr<GradNodeRun>> runs;
+  std::deque<GradNodeRun*> finished_runs;
+  size_t finished_num = 0;
+  size_t processed_num = 0;
+  // the grad nodes to run in the calling thread
+  std::queue<std::unique_ptr<GradNodeRun>> device_runs;
+
+  auto dispatch = [&]() {
+    while (!queue->empty()) {
+      GradNodeBase* node = queue->front();
+      queue->pop();
+      // a startup node which is also the next node of another one
+      if ((*node_in_degree_map)[node] != 0) {
+        continue;
+      }
+      PADDLE_ENFORCE(
+          node_input_buffers_dict->count(node),
+          paddle::platform::errors::Fatal(
+              "Unable to find next node in the GradTensorHolder \n"
+              "Trying to run Node without configuring its GradTensorHolder."));
+      std::unique_ptr<GradNodeRun> run(new GradNodeRun());
+      run->node = node;
+      run->input_buffer = std::move((*node_input_buffers_dict)[node]);
+      node_input_buffers_dict->erase(node);
+      if (dynamic_cast<GradNodeAccumulation*>(node) != nullptr ||
+          !IsCPUGradNode(run->input_buffer.get())) {
+        device_runs.push(std::move(run));
+        continue;
+      }
+      GradNodeRun* cpu_run = run.get();
+      runs.push_back(std::move(run));
+      pool->Run([&, cpu_run] {
+        Controller::Instance().SetHasGrad(has_grad);
+        Controller::Instance().SetAMPLevel(amp_level);
+        Controller::Instance().GetCurrentTracer()->SetAmpDtype(amp_dtype);
+        try {
+          cpu_run->grad_output_tensors =
+              RunGradNode(cpu_run->node, cpu_run->input_buffer.get(),
+                          retain_graph, create_graph);
+        } catch (...) {
+          cpu_run->error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> guard(mutex);
+        cpu_run->finished = true;
+        if (!deterministic) {
+          finished_runs.push_back(cpu_run);
+        }
+        ++finished_num;
+        cv.notify_one();
+      });
+    }
+  };
+
+  std::exception_ptr error;
+  try {
+    dispatch();
+    while (true) {
+      if (!device_runs.empty()) {
+        auto run = std::move(device_runs.front());
+        device_runs.pop();
+        run->grad_output_tensors = RunGradNode(
+            run->node, run->input_buffer.get(), retain_graph, create_graph);
+        AccumulateGradOutputs(run->node, &run->grad_output_tensors, false,
+                              node_input_buffers_dict, node_in_degree_map,
+                              queue);
+        dispatch();
+        continue;
+      }
+      GradNodeRun* run = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (processed_num == runs.size()) {
+          break;
+        }
+        if (deterministic) {
+          run = runs[processed_num].get();
+          cv.wait(lock, [run] { return run->finished; });
+        } else {
+          cv.wait(lock, [&] { return !finished_runs.empty(); });
+          run = finished_runs.front();
+          finished_runs.pop_front();
+        }
+        ++processed_num;
+      }
+      if (run->error != nullptr) {
+        std::rethrow_exception(run->error);
+      }
+      AccumulateGradOutputs(run->node, &run->grad_output_tensors, false,
+                            node_input_buffers_dict, node_in_degree_map,
+                            queue);
+      run->grad_output_tensors.clear();
+      run->input_buffer.reset();
+      dispatch();
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  if (error != nullptr) {
+    // the grad nodes still running refer to the states above
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return finished_num == runs.size(); });
+    std::rethrow_exception(error);
+  }
+}
+
 std::vector<paddle::experimental::Tensor> RunBackward(
     const std::vector<paddle::experimental::Tensor>& tensors,  // output
     const std::vector<paddle::experimental::Tensor>& grad_tensors,
@@ -528,6 +817,13 @@ std::vector<paddle::experimental::Tensor> RunBackward(
 
   VLOG(6) << " startup_ops' size is :" << queue.size();
 
+  if (FLAGS_eager_backward_num_threads > 0 && !is_general_grad) {
+    VLOG(6) << "Run Backward in parallel";
+    RunBackwardInParallel(&queue, &node_input_buffers_dict,
+                          &node_in_degree_map, retain_graph, create_graph);
+    return {};
+  }
+
   /* --- Topological Visit --- */
   // 1. Pop queue
   // 2. Run node
@@ -600,91 +896,9 @@ std::vector<paddle::experimental::Tensor> RunBackward(
 
     node_input_buffers_dict.erase(node);
 
-    // Prepare GradTensorHolder for next node
-    const std::vector<std::vector<Edge>>& edges = node->GetEdges();
-    PADDLE_ENFORCE(edges.size() == grad_output_tensors.size() || edges.empty(),
-                   paddle::platform::errors::Fatal(
-                       "Number of edges should be either empty ( for leaf node "
-                       ") or the same as number of output grad tensors, but we "
-                       "got edges size is: %d, grad_output size is: %d",
-                       edges.size(), grad_output_tensors.size()));
-
-    for (size_t i = 0; i < edges.size(); i++) {
-      for (size_t j = 0; j < edges[i].size(); j++) {
-        const Edge& edge = edges[i][j];
-        if (!edge.IsInitialized()) {
-          continue;
-        }
-        auto edge_rank = edge.GetEdgeRankInfo();
-        // Since we make edge has as same rank as bwd outputs, we indexing them
-        // with
-        // the same rank(i, j)
-        auto next_node_shared = edge.GetMutableGradNode();
-
-        // Next node could be nullptr if it is leaf tensor with no
-        // AccumulationNode attached
-        // Or it could also originated from dispensable inputs
-        if (!next_node_shared || !next_node_shared.get() ||
-            grad_output_tensors[i].empty()) {
-          continue;
-        }
-
-        PADDLE_ENFORCE_LT(
-            j, grad_output_tensors[i].size(),
-            paddle::platform::errors::Fatal(
-                "Rank of grad_output_tensors should be less than "
-                "grad_output_tensors[i].size(), which is: %d. This error may "
-                "indicate autoprune or autograd api error. ",
-                grad_output_tensors.size()));
-        paddle::experimental::Tensor& grad_output_tensor =
-            grad_output_tensors[i][j];
-
-        if ((!grad_output_tensor.defined() ||
-             !grad_output_tensor.initialized())) {
-          VLOG(6) << "We get grad_output_tensor with slot: " << i
-                  << ", rank: " << j << " as uninitialized or undefined tensor";
-        }
-        VLOG(6) << "Get Edge and grad_output_tensor with slot: " << i
-                << ", rank: " << j
-                << " 's name is: " << grad_output_tensor.name();
-
-        auto* next_node = next_node_shared.get();
-        if (!node_input_buffers_dict.count(next_node)) {
-          const auto& input_meta = next_node->InputMeta();
-          auto grad_tensor_holder =
-              std::make_unique<GradTensorHolder>(input_meta);
-          VLOG(6) << "Construct GradTensorHolder for grad node: "
-                  << next_node->name();
-          node_input_buffers_dict[next_node] = std::move(grad_tensor_holder);
-        }
-        VLOG(6) << "Sum grad inputs for edge slot: " << edge_rank.first
-                << ", rank: " << edge_rank.second;
-        node_input_buffers_dict[next_node]->add(
-            edge_rank.first, edge_rank.second, grad_output_tensor);
-
-        // Update queue
-        node_in_degree_map[next_node]--;
-
-        PADDLE_ENFORCE(
-            node_in_degree_map[next_node] >= 0,
-            paddle::platform::errors::Fatal(
-                "Detected in-degree value smaller than zero. For Node: %s"
-                "Node's in-degree cannot be negative.",
-                next_node->name()));
-
-        if (is_general_grad) {
-          bool is_potential_stop_node =
-              GeneralGrad::Instance().GetPotentialStopNodes()->count(next_node);
-          if (node_in_degree_map[next_node] == 0 && !is_potential_stop_node) {
-            queue.emplace(std::move(next_node));
-          }
-        } else {
-          if (node_in_degree_map[next_node] == 0) {
-            queue.emplace(std::move(next_node));
-          }
-        }
-      }
-    }
+    AccumulateGradOutputs(node, &grad_output_tensors, is_general_grad,
+                          &node_input_buffers_dict, &node_in_degree_map,
+                          &queue);
   }
   if (!is_general_grad) return {};
   return GeneralGrad::Instance().GetResults(inputs, allow_unused, create_graph);
@@ -26,6 +26,7 @@
 
 #include "glog/logging.h"
 #pragma GCC diagnostic ignored "-Wattributes"
+#include "pybind11/pybind11.h"
 #include "pybind11/pytypes.h"
 
 namespace egr {
@@ -33,6 +34,8 @@ std::vector<std::vector<paddle::experimental::Tensor>> GradNodePyLayer::
 operator()(
     std::vector<std::vector<paddle::experimental::Tensor>>& grads,  // NOLINT
     bool create_graph) {
+  // It may run in a thread of the parallel backward.
+  pybind11::gil_scoped_acquire gil;
   VLOG(3) << "Running Eager Backward Node: " << name();
 
   std::vector<std::vector<paddle::experimental::Tensor>> hooked_grads =
@@ -13,6 +13,9 @@
 // limitations under the License.
 
 #include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "glog/logging.h"
 #include "gtest/gtest.h"
@@ -35,6 +38,9 @@
 PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(copy, CPU, ALL_LAYOUT);
 
+DECLARE_int32(eager_backward_num_threads);
+DECLARE_bool(eager_backward_deterministic);
+
 namespace egr {
 
 TEST(Backward, SingleNodeEmptyGrad) {
@@ -321,4 +327,242 @@ TEST(Backward, WithAccumulation) {
   eager_test::CompareGradTensorWithValue<float>(leaf_tensor, 2500.0);
 }
 
+/*
+          Node8
+     |   |  ...  |
+Node0  Node1 ... Node7
+  |      |        |
+ inp0   inp1     inp7
+*/
+// Node0 ~ Node7 scale by scales, Node8 by 2, and the grad of the leaf tensor
+// of Node8 is returned.
+static paddle::experimental::Tensor BackwardWideNodes(
+    const std::vector<float>& scales) {
+  paddle::framework::DDim ddim = phi::make_ddim({4, 16, 16, 32});
+  const int kWidth = static_cast<int>(scales.size());
+
+  // Create Target Tensors
+  std::vector<paddle::experimental::Tensor> target_tensors;
+  for (int i = 0; i < kWidth; ++i) {
+    target_tensors.emplace_back(egr_utils_api::CreateTensorWithValue(
+        ddim, paddle::platform::CPUPlace(), phi::DataType::FLOAT32,
+        phi::DataLayout::NCHW, 1.0 /*value*/, false /*is_leaf*/));
+  }
+
+  paddle::experimental::Tensor leaf_tensor;
+  {
+    // Create Node8
+    auto sum_node_ptr = std::make_shared<GradNodeScale>(1, 1);
+    sum_node_ptr->SetAttributes_scale(2.0 /*scale*/);
+    sum_node_ptr->SetDefaultGradInOutMeta();
+
+    // Connect Node0 ~ Node7 -> Node8 via Edge
+    std::vector<egr::AutogradMeta> metas(kWidth);
+    for (int i = 0; i < kWidth; ++i) {
+      auto node_ptr = std::make_shared<GradNodeScale>(1, 1);
+      node_ptr->SetAttributes_scale(scales[i]);
+      node_ptr->SetDefaultGradInOutMeta();
+      AutogradMeta* auto_grad_meta =
+          EagerUtils::autograd_meta(&(target_tensors[i]));
+      auto_grad_meta->SetGradNode(
+          std::dynamic_pointer_cast<GradNodeBase>(node_ptr));
+      auto_grad_meta->SetSingleOutRankWithSlot(0, 0);
+      auto_grad_meta->SetStopGradient(false);
+
+      metas[i].SetStopGradient(false);
+      metas[i].SetSingleOutRankWithSlot(0, 0);
+      metas[i].SetGradNode(sum_node_ptr);
+      std::vector<egr::AutogradMeta*> res = {&metas[i]};
+      node_ptr->AddEdges(&res, 0);
+    }
+
+    AutogradMeta* auto_grad_meta = EagerUtils::autograd_meta(&leaf_tensor);
+    // Connect Tensor and AccumulationNode via AutoGradMeta
+    auto acc_node_ptr =
+        std::make_shared<egr::GradNodeAccumulation>(auto_grad_meta);
+    auto_grad_meta->SetGradNode(
+        std::dynamic_pointer_cast<GradNodeBase>(acc_node_ptr));
+    auto_grad_meta->SetSingleOutRankWithSlot(0, 0);
+    auto_grad_meta->SetStopGradient(false);
+    std::vector<egr::AutogradMeta*> res = {auto_grad_meta};
+    sum_node_ptr->AddEdges(&res, 0);
+  }
+
+  Backward(target_tensors, {});
+  return leaf_tensor;
+}
+
+TEST(Backward, ParallelWideNodes) {
+  // Prepare Device Contexts
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+
+  for (bool deterministic : {false, true}) {
+    FLAGS_eager_backward_num_threads = 4;
+    FLAGS_eager_backward_deterministic = deterministic;
+    auto leaf_tensor = BackwardWideNodes({1, 2, 3, 4, 5, 6, 7, 8});
+    // (1 + 2 + ... + 8) * 2
+    eager_test::CompareGradTensorWithValue<float>(leaf_tensor, 72.0);
+  }
+  FLAGS_eager_backward_num_threads = 0;
+  FLAGS_eager_backward_deterministic = false;
+}
+
+TEST(Backward, ParallelDeterministicSumOrder) {
+  // Prepare Device Contexts
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+
+  // The 1s added to 1e8 are lost in float, so the sum of the grads of Node8
+  // depends on the order they are added in.
+  std::vector<float> scales = {1e8, 1, 1, 1, -1e8, 1, 1, 1};
+  auto leaf_tensor = BackwardWideNodes(scales);
+  auto* meta = EagerUtils::unsafe_autograd_meta(leaf_tensor);
+  float expected =
+      std::dynamic_pointer_cast<phi::DenseTensor>(meta->Grad().impl())
+          ->data<float>()[0];
+  ASSERT_NE(expected, 12.0f);
+
+  // the same sum as the sequential backward, whatever order the nodes
+  // finish in
+  FLAGS_eager_backward_num_threads = 4;
+  FLAGS_eager_backward_deterministic = true;
+  for (int i = 0; i < 20; ++i) {
+    leaf_tensor = BackwardWideNodes(scales);
+    eager_test::CompareGradTensorWithValue<float>(leaf_tensor, expected);
+  }
+  FLAGS_eager_backward_num_threads = 0;
+  FLAGS_eager_backward_deterministic = false;
+}
+
+// A GradNodeScale which records the AMP states of the tracer in the thread
+// running it.
+class AmpStateGradNode : public GradNodeScale {
+ public:
+  AmpStateGradNode() : GradNodeScale(1, 1) {}
+
+  std::vector<std::vector<paddle::experimental::Tensor>> operator()(
+      std::vector<std::vector<paddle::experimental::Tensor>>& grads,  // NOLINT
+      bool create_graph = false) override {
+    amp_level = Controller::Instance().GetAMPLevel();
+    amp_dtype = Controller::Instance().GetCurrentTracer()->GetAmpDtype();
+    return GradNodeScale::operator()(grads, create_graph);
+  }
+
+  paddle::imperative::AmpLevel amp_level{paddle::imperative::AmpLevel::O0};
+  std::string amp_dtype;
+};
+
+TEST(Backward, ParallelAmpStates) {
+  // Prepare Device Contexts
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+
+  paddle::framework::DDim ddim = phi::make_ddim({4, 16});
+  const int kWidth = 8;
+  FLAGS_eager_backward_num_threads = 4;
+  Controller::Instance().SetAMPLevel(paddle::imperative::AmpLevel::O1);
+  Controller::Instance().GetCurrentTracer()->SetAmpDtype("bfloat16");
+
+  std::vector<paddle::experimental::Tensor> target_tensors;
+  std::vector<paddle::experimental::Tensor> leaf_tensors(kWidth);
+  std::vector<std::shared_ptr<AmpStateGradNode>> nodes;
+  for (int i = 0; i < kWidth; ++i) {
+    target_tensors.emplace_back(egr_utils_api::CreateTensorWithValue(
+        ddim, paddle::platform::CPUPlace(), phi::DataType::FLOAT32,
+        phi::DataLayout::NCHW, 1.0 /*value*/, false /*is_leaf*/));
+
+    auto node_ptr = std::make_shared<AmpStateGradNode>();
+    node_ptr->SetAttributes_scale(1.0 /*scale*/);
+    node_ptr->SetDefaultGradInOutMeta();
+    AutogradMeta* auto_grad_meta =
+        EagerUtils::autograd_meta(&(target_tensors[i]));
+    auto_grad_meta->SetGradNode(
+        std::dynamic_pointer_cast<GradNodeBase>(node_ptr));
+    auto_grad_meta->SetSingleOutRankWithSlot(0, 0);
+    auto_grad_meta->SetStopGradient(false);
+    nodes.push_back(node_ptr);
+
+    AutogradMeta* leaf_meta = EagerUtils::autograd_meta(&leaf_tensors[i]);
+    auto acc_node_ptr = std::make_shared<egr::GradNodeAccumulation>(leaf_meta);
+    leaf_meta->SetGradNode(
+        std::dynamic_pointer_cast<GradNodeBase>(acc_node_ptr));
+    leaf_meta->SetSingleOutRankWithSlot(0, 0);
+    leaf_meta->SetStopGradient(false);
+    std::vector<egr::AutogradMeta*> res = {leaf_meta};
+    node_ptr->AddEdges(&res, 0);
+  }
+
+  Backward(target_tensors, {});
+
+  for (auto& node : nodes) {
+    ASSERT_EQ(node->amp_level, paddle::imperative::AmpLevel::O1);
+    ASSERT_EQ(node->amp_dtype, "bfloat16");
+  }
+  Controller::Instance().SetAMPLevel(paddle::imperative::AmpLevel::O0);
+  Controller::Instance().GetCurrentTracer()->SetAmpDtype("float32");
+  FLAGS_eager_backward_num_threads = 0;
+}
+
+/*
+Leaf0  Leaf1 ... Leaf7  (with reduce hooks)
+  |      |        |
+Node0  Node1 ... Node7
+  |      |        |
+ inp0   inp1     inp7
+*/
+TEST(Backward, ParallelWithReduceHooks) {
+  // Prepare Device Contexts
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+
+  paddle::framework::DDim ddim = phi::make_ddim({4, 16, 16, 32});
+  const int kWidth = 8;
+  FLAGS_eager_backward_num_threads = 4;
+
+  std::vector<paddle::experimental::Tensor> target_tensors;
+  std::vector<paddle::experimental::Tensor> leaf_tensors(kWidth);
+  // Like the ones of EagerReducer, the hooks update states without locks,
+  // so they must all run in the calling thread.
+  std::vector<std::thread::id> hook_threads;
+  int pending_leaves = kWidth;
+  for (int i = 0; i < kWidth; ++i) {
+    target_tensors.emplace_back(egr_utils_api::CreateTensorWithValue(
+        ddim, paddle::platform::CPUPlace(), phi::DataType::FLOAT32,
+        phi::DataLayout::NCHW, 1.0 /*value*/, false /*is_leaf*/));
+
+    auto node_ptr = std::make_shared<GradNodeScale>(1, 1);
+    node_ptr->SetAttributes_scale(i + 1.0 /*scale*/);
+    node_ptr->SetDefaultGradInOutMeta();
+    AutogradMeta* auto_grad_meta =
+        EagerUtils::autograd_meta(&(target_tensors[i]));
+    auto_grad_meta->SetGradNode(
+        std::dynamic_pointer_cast<GradNodeBase>(node_ptr));
+    auto_grad_meta->SetSingleOutRankWithSlot(0, 0);
+    auto_grad_meta->SetStopGradient(false);
+
+    AutogradMeta* leaf_meta = EagerUtils::autograd_meta(&leaf_tensors[i]);
+    auto acc_node_ptr = std::make_shared<egr::GradNodeAccumulation>(leaf_meta);
+    acc_node_ptr->RegisterReduceHook(
+        std::make_shared<egr::CppTensorVoidHook>([&]() {
+          hook_threads.push_back(std::this_thread::get_id());
+          --pending_leaves;
+        }));
+    leaf_meta->SetGradNode(
+        std::dynamic_pointer_cast<GradNodeBase>(acc_node_ptr));
+    leaf_meta->SetSingleOutRankWithSlot(0, 0);
+    leaf_meta->SetStopGradient(false);
+    std::vector<egr::AutogradMeta*> res = {leaf_meta};
+    node_ptr->AddEdges(&res, 0);
+  }
+
+  Backward(target_tensors, {});
+
+  ASSERT_EQ(pending_leaves, 0);
+  ASSERT_EQ(hook_threads.size(), static_cast<size_t>(kWidth));
+  for (auto& id : hook_threads) {
+    ASSERT_EQ(id, std::this_thread::get_id());
+  }
+  for (int i = 0; i < kWidth; ++i) {
+    eager_test::CompareGradTensorWithValue<float>(leaf_tensors[i], i + 1.0);
+  }
+  FLAGS_eager_backward_num_threads = 0;
+}
+
 }  // namespace egr
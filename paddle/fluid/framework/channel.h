@@ -21,8 +21,10 @@
 
 #include <glog/logging.h>
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>  // NOLINT
 #include <deque>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -33,21 +35,65 @@
 namespace paddle {
 namespace framework {
 
+// A channel of bounded capacity, split into shards which each have their
+// own mutex and deque. A thread writes to its home shard, and reads from it
+// first and then from the other shards. With one shard, the default, the
+// channel is FIFO. With more shards only the records of one writer keep
+// their order, which suits the Dataset channels whose records are shuffled
+// anyway, and the readers and writers of different shards do not contend.
+// The size and the room of the channel are atomics, and the wait mutex is
+// only taken to sleep: the waiters are counted, so that the notifiers skip
+// it while nobody waits. The batch operations (Read, ReadAll, Write,
+// WriteMove) amortize the locking of the shards.
 template <class T>
 class ChannelObject {
  public:
-  ChannelObject() {}
+  ChannelObject() { SetShardNum(1); }
 
   // capacity can be zero
   explicit ChannelObject(size_t capacity) {
     capacity_ = (std::min)(MaxCapacity(), capacity);
+    SetShardNum(1);
+  }
+
+  // Must be called while the channel is empty and not in use.
+  void SetShardNum(size_t shard_num) {
+    CHECK(shard_num >= 1) << "shard num must be >= 1";
+    CHECK(size_ == 0) << "can not reshard a channel which is not empty";
+    shards_.clear();
+    for (size_t i = 0; i < shard_num; ++i) {
+      shards_.emplace_back(new Shard());
+    }
+  }
+
+  size_t ShardNum() { return shards_.size(); }
+
+  // Gathers the records of all the shards into the first one and returns
+  // it, the channel must not be read or written meanwhile.
+  const std::deque<T>& GetData() {
+    auto& data = shards_[0]->data;
+    for (size_t i = 1; i < shards_.size(); ++i) {
+      auto& other = shards_[i]->data;
+      data.insert(data.end(), std::make_move_iterator(other.begin()),
+                  std::make_move_iterator(other.end()));
+      shards_[0]->size += other.size();
+      shards_[i]->size = 0;
+      other.clear();
+    }
+    return data;
   }
 
-  const std::deque<T>& GetData() const { return data_; }
   void Clear() {
-    std::unique_lock<std::mutex> lock(mutex_);
-    data_.clear();
-    data_.shrink_to_fit();
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      size_t n = shard->data.size();
+      shard->data.clear();
+      shard->data.shrink_to_fit();
+      shard->size = 0;
+      size_ -= n;
+      reserved_ -= n;
+    }
+    Wake(&full_cond_, &full_waiters_, true);
   }
 
   size_t Capacity() {
@@ -55,9 +101,8 @@ class ChannelObject {
   }
 
   void SetCapacity(size_t x) {  // capacity can be zero
-    std::lock_guard<std::mutex> lock(mutex_);
     capacity_ = std::min(MaxCapacity(), x);
-    Notify();
+    Wake(&full_cond_, &full_waiters_, true);
   }
 
   size_t BlockSize() {
@@ -66,15 +111,14 @@ class ChannelObject {
 
   void SetBlockSize(size_t x) {
     CHECK(x >= 1) << "block size must be >= 1";
-    std::lock_guard<std::mutex> lock(mutex_);
     block_size_ = x;
   }
 
   template <class U>
   void InheritFrom(const std::shared_ptr<ChannelObject<U>>& other) {
-    std::lock_guard<std::mutex> lock(mutex_);
     capacity_ = other->Capacity();
     block_size_ = other->BlockSize();
+    SetShardNum(other->ShardNum());
   }
 
   bool Closed() {
@@ -82,28 +126,21 @@ class ChannelObject {
   }
 
   // open channel, then data can be write() to channel
-  void Open() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    closed_ = false;
-    Notify();
-  }
+  void Open() { closed_ = false; }
 
   // close channel, then no more data can be write() to channel
   void Close() {
-    std::lock_guard<std::mutex> lock(mutex_);
     closed_ = true;
-    Notify();
+    // wake up all the waiters, since none of them can wait any more
+    Wake(&empty_cond_, &empty_waiters_, true);
+    Wake(&full_cond_, &full_waiters_, true);
   }
 
   size_t Size() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return data_.size();
+    return size_;  // atomic
   }
 
-  bool Empty() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return EmptyUnlocked();
-  }
+  bool Empty() { return size_ == 0; }
 
   // blocking operation
   bool Get(T& val) { return Read(1, &val) != 0; }  // NOLINT
@@ -114,11 +151,7 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
-
-    std::unique_lock<std::mutex> lock(mutex_);
-    size_t finished = Read(n, p, lock);
-    Notify();
-    return finished;
+    return Read(n, p, false);
   }
 
   // blocking operation
@@ -133,10 +166,7 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
-    std::unique_lock<std::mutex> lock(mutex_);
-    size_t finished = Write(n, p, lock);
-    Notify();
-    return finished;
+    return WriteRange(n, p);
   }
 
   // WriteMove() will clear original contents of input array
@@ -144,10 +174,7 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
-    std::unique_lock<std::mutex> lock(mutex_);
-    size_t finished = WriteMove(n, p, lock);
-    Notify();
-    return finished;
+    return WriteRange(n, std::make_move_iterator(p));
   }
 
   // read data of block size from channel to vector
@@ -162,12 +189,9 @@ class ChannelObject {
     if (size == 0) {
       return 0;
     }
-    std::unique_lock<std::mutex> lock(mutex_);
     p.resize(size);
-    size_t finished = Read(size, &p[0], lock, true);
+    size_t finished = Read(size, &p[0], true);
     p.resize(finished);
-    Notify();
-
     return finished;
   }
   size_t ReadAll(std::vector<T>& p) {  // NOLINT
@@ -192,15 +216,32 @@ class ChannelObject {
   size_t Write(std::vector<T>&& p) { return WriteMove(p.size(), &p[0]); }
 
  private:
-  size_t capacity_ = MaxCapacity();
-  size_t block_size_ = 1024;
-  bool closed_ = false;
-  std::mutex mutex_;
-  // use deque to store data
-  std::deque<T> data_;
-  size_t reading_count_ = 0;
-  int empty_waiters_ = 0;
-  int full_waiters_ = 0;
+  // A reader taking at least this many records, and all of a shard, swaps
+  // the deque out and moves the records after releasing the mutex. Fewer
+  // records are moved in place, which is cheaper than allocating the new
+  // deque.
+  static constexpr size_t kSwapReadSize = 1024;
+
+  struct Shard {
+    std::mutex mutex;
+    std::deque<T> data;
+    // the same as data.size(), which can be read without the mutex
+    std::atomic<size_t> size{0};
+  };
+
+  std::atomic<size_t> capacity_{MaxCapacity()};
+  std::atomic<size_t> block_size_{1024};
+  std::atomic<bool> closed_{false};
+  // the number of records in the shards
+  std::atomic<size_t> size_{0};
+  // size_ plus the records the writers are about to add
+  std::atomic<size_t> reserved_{0};
+  // the records the readers wait for, which may exceed the capacity
+  std::atomic<size_t> reading_{0};
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::mutex wait_mutex_;
+  std::atomic<int> empty_waiters_{0};
+  std::atomic<int> full_waiters_{0};
   std::condition_variable empty_cond_;
   std::condition_variable full_cond_;
 
@@ -208,96 +249,151 @@ class ChannelObject {
     return (std::numeric_limits<size_t>::max)() / 2;
   }
 
-  void Notify() {
-    if (empty_waiters_ != 0 && (!EmptyUnlocked() || closed_)) {
-      empty_cond_.notify_one();
+  size_t HomeShard() {
+    if (shards_.size() == 1) {
+      return 0;
     }
-    if (full_waiters_ != 0 && (!FullUnlocked() || closed_)) {
-      full_cond_.notify_one();
+    static std::atomic<size_t> thread_num{0};
+    static thread_local size_t thread_idx = thread_num++;
+    return thread_idx % shards_.size();
+  }
+
+  // Sleeps until pred() holds. A notifier changes the state before it
+  // reads the waiter count, and a waiter counts itself before it checks
+  // the state, so one of them always sees the other.
+  template <class Pred>
+  void Wait(std::condition_variable* cond, std::atomic<int>* waiters,
+            Pred pred) {
+    if (pred()) {
+      return;
     }
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    ++*waiters;
+    cond->wait(lock, pred);
+    --*waiters;
   }
 
-  bool EmptyUnlocked() { return data_.empty(); }
-
-  bool FullUnlocked() { return data_.size() >= capacity_ + reading_count_; }
-
-  bool WaitForRead(std::unique_lock<std::mutex>& lock) {  // NOLINT
-#ifdef _LINUX
-    while (unlikely(EmptyUnlocked() && !closed_)) {
-#else
-    while (EmptyUnlocked() && !closed_) {
-#endif
-      if (full_waiters_ != 0) {
-        full_cond_.notify_one();
-      }
-      empty_waiters_++;
-      empty_cond_.wait(lock);
-      empty_waiters_--;
+  void Wake(std::condition_variable* cond, std::atomic<int>* waiters,
+            bool all) {
+    if (*waiters == 0) {
+      return;
     }
-    return !EmptyUnlocked();
-  }
-
-  bool WaitForWrite(std::unique_lock<std::mutex>& lock) {  // NOLINT
-#ifdef _LINUX
-    while (unlikely(FullUnlocked() && !closed_)) {
-#else
-    while (FullUnlocked() && !closed_) {
-#endif
-      if (empty_waiters_ != 0) {
-        empty_cond_.notify_one();
-      }
-      full_waiters_++;
-      full_cond_.wait(lock);
-      full_waiters_--;
+    // a waiter between checking pred() and sleeping holds the mutex
+    { std::lock_guard<std::mutex> lock(wait_mutex_); }
+    if (all) {
+      cond->notify_all();
+    } else {
+      cond->notify_one();
     }
-    return !closed_;
   }
 
-  size_t Read(size_t n, T* p, std::unique_lock<std::mutex>& lock,  // NOLINT
-              bool once = false) {                                 // NOLINT
-    size_t finished = 0;
-    CHECK(n <= MaxCapacity() - reading_count_);
-    reading_count_ += n;
-    while (finished < n && WaitForRead(lock)) {
-      size_t m = (std::min)(n - finished, data_.size());
-      for (size_t i = 0; i < m; i++) {
-        p[finished++] = std::move(data_.front());
-        data_.pop_front();
+  bool HasRoom() { return reserved_ < capacity_ + reading_; }
+
+  // Reserves room for at most n records, waiting while the channel is
+  // full. Returns 0 if the channel is closed.
+  size_t Reserve(size_t n) {
+    size_t reserved = reserved_;
+    while (!closed_) {
+      size_t limit = capacity_ + reading_;
+      if (reserved >= limit) {
+        Wait(&full_cond_, &full_waiters_,
+             [this] { return closed_ || HasRoom(); });
+        reserved = reserved_;
+        continue;
       }
-      reading_count_ -= m;
-      if (once && m > 0) {
-        break;
+      size_t m = (std::min)(n, limit - reserved);
+      if (reserved_.compare_exchange_weak(reserved, reserved + m)) {
+        if (reserved + m < limit) {
+          // room is left for another writer
+          Wake(&full_cond_, &full_waiters_, false);
+        }
+        return m;
       }
     }
-    reading_count_ -= n - finished;
-    return finished;
+    return 0;
   }
 
-  size_t Write(size_t n,
-               const T* p,                            // NOLINT
-               std::unique_lock<std::mutex>& lock) {  // NOLINT
+  template <class Iter>
+  size_t WriteRange(size_t n, Iter p) {
+    Shard& shard = *shards_[HomeShard()];
     size_t finished = 0;
-    while (finished < n && WaitForWrite(lock)) {
-      size_t m =
-          std::min(n - finished, capacity_ + reading_count_ - data_.size());
-      for (size_t i = 0; i < m; i++) {
-        data_.push_back(p[finished++]);
+    while (finished < n) {
+      size_t m = Reserve(n - finished);
+      if (m == 0) {
+        break;
+      }
+      {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.data.insert(shard.data.end(), p + finished, p + finished + m);
+        shard.size += m;
+        size_ += m;
       }
+      finished += m;
+      Wake(&empty_cond_, &empty_waiters_, false);
     }
     return finished;
   }
 
-  size_t WriteMove(size_t n,
-                   T* p,                                  // NOLINT
-                   std::unique_lock<std::mutex>& lock) {  // NOLINT
+  // Moves at most n records of the shard to p.
+  size_t Take(Shard* shard, size_t n, T* p) {
+    if (shard->size == 0) {
+      return 0;
+    }
+    std::unique_lock<std::mutex> lock(shard->mutex);
+    auto& data = shard->data;
+    size_t m = (std::min)(n, data.size());
+    if (m == data.size() && m >= kSwapReadSize) {
+      // Take all the data at once and move them out of the mutex, which
+      // is the common case when the readers are faster than the writers.
+      std::deque<T> batch;
+      batch.swap(data);
+      shard->size = 0;
+      size_ -= m;
+      lock.unlock();
+      std::move(batch.begin(), batch.end(), p);
+      return m;
+    }
+    std::move(data.begin(), data.begin() + m, p);
+    data.erase(data.begin(), data.begin() + m);
+    shard->size -= m;
+    size_ -= m;
+    return m;
+  }
+
+  size_t Read(size_t n, T* p, bool once) {
+    CHECK(n <= MaxCapacity() - reading_);
+    reading_ += n;
+    // the writers may exceed the capacity by the records being read
+    Wake(&full_cond_, &full_waiters_, false);
+    size_t home = HomeShard();
     size_t finished = 0;
-    while (finished < n && WaitForWrite(lock)) {
-      size_t m =
-          (std::min)(n - finished, capacity_ + reading_count_ - data_.size());
-      for (size_t i = 0; i < m; i++) {
-        data_.push_back(std::move(p[finished++]));
+    while (finished < n) {
+      Wait(&empty_cond_, &empty_waiters_,
+           [this] { return closed_ || size_ != 0; });
+      size_t m = 0;
+      for (size_t i = 0; i < shards_.size() && finished + m < n; ++i) {
+        Shard* shard = shards_[(home + i) % shards_.size()].get();
+        m += Take(shard, n - finished - m, p + finished + m);
+      }
+      if (m == 0) {
+        if (closed_ && size_ == 0) {
+          break;
+        }
+        // the other readers took the records first
+        continue;
+      }
+      finished += m;
+      reading_ -= m;
+      reserved_ -= m;
+      Wake(&full_cond_, &full_waiters_, false);
+      if (size_ != 0) {
+        Wake(&empty_cond_, &empty_waiters_, false);
+      }
+      if (once) {
+        break;
       }
     }
+    reading_ -= n - finished;
     return finished;
   }
 };  // NOLINT
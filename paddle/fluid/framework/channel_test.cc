@@ -0,0 +1,198 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/channel.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <numeric>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(Channel, read_write) {
+  auto chan = MakeChannel<int>();
+  std::vector<int> in(10);
+  std::iota(in.begin(), in.end(), 0);
+  ASSERT_EQ(chan->Write(in), 10UL);
+  ASSERT_EQ(chan->Size(), 10UL);
+
+  std::vector<int> out;
+  chan->SetBlockSize(4);
+  ASSERT_EQ(chan->Read(out), 4UL);
+  ASSERT_EQ(out, std::vector<int>({0, 1, 2, 3}));
+  ASSERT_EQ(chan->Size(), 6UL);
+
+  chan->Close();
+  ASSERT_EQ(chan->ReadAll(out), 6UL);
+  ASSERT_EQ(out, std::vector<int>({4, 5, 6, 7, 8, 9}));
+  ASSERT_TRUE(chan->Empty());
+  int val = 0;
+  ASSERT_FALSE(chan->Get(val));
+  ASSERT_FALSE(chan->Put(1));
+
+  // a large read takes the whole deque out of the channel
+  chan->Open();
+  in.resize(5000);
+  std::iota(in.begin(), in.end(), 0);
+  ASSERT_EQ(chan->Write(in), 5000UL);
+  chan->Close();
+  ASSERT_EQ(chan->ReadAll(out), 5000UL);
+  ASSERT_EQ(out, in);
+  ASSERT_TRUE(chan->Empty());
+}
+
+TEST(Channel, move_only) {
+  auto chan = MakeChannel<std::unique_ptr<int>>();
+  std::vector<std::unique_ptr<int>> in;
+  for (int i = 0; i < 3; ++i) {
+    in.emplace_back(new int(i));
+  }
+  ASSERT_EQ(chan->Write(std::move(in)), 3UL);
+  chan->Close();
+  std::vector<std::unique_ptr<int>> out;
+  ASSERT_EQ(chan->ReadAll(out), 3UL);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(*out[i], i);
+  }
+}
+
+// kThreadNum writers and kThreadNum readers share a channel of a small
+// capacity, so that both sides keep blocking on each other.
+static void ProduceAndConsume(size_t shard_num) {
+  const int kThreadNum = 32;
+  const int kNumPerThread = 10000;
+  auto chan = MakeChannel<int>(64);
+  chan->SetShardNum(shard_num);
+  chan->SetBlockSize(16);
+
+  std::vector<std::thread> writers;
+  for (int i = 0; i < kThreadNum; ++i) {
+    writers.emplace_back([&chan, i] {
+      std::vector<int> block;
+      for (int j = 0; j < kNumPerThread; ++j) {
+        block.push_back(i * kNumPerThread + j);
+        if (block.size() == 10) {
+          ASSERT_EQ(chan->Write(std::move(block)), 10UL);
+          block.clear();
+        }
+      }
+    });
+  }
+  std::vector<std::vector<int>> results(kThreadNum);
+  std::vector<std::thread> readers;
+  for (int i = 0; i < kThreadNum; ++i) {
+    readers.emplace_back([&chan, &results, i] {
+      std::vector<int> block;
+      while (chan->Read(block) > 0) {
+        ASSERT_LE(chan->Size(), 64UL + 16UL * kThreadNum);
+        results[i].insert(results[i].end(), block.begin(), block.end());
+      }
+    });
+  }
+  for (auto& t : writers) {
+    t.join();
+  }
+  chan->Close();
+  for (auto& t : readers) {
+    t.join();
+  }
+
+  std::vector<int> seen(kThreadNum * kNumPerThread, 0);
+  for (auto& result : results) {
+    // The values of one writer arrive at one reader in order.
+    std::vector<int> last(kThreadNum, -1);
+    for (int x : result) {
+      ++seen[x];
+      ASSERT_GT(x, last[x / kNumPerThread]);
+      last[x / kNumPerThread] = x;
+    }
+  }
+  for (int count : seen) {
+    ASSERT_EQ(count, 1);
+  }
+}
+
+TEST(Channel, multi_producer_multi_consumer) { ProduceAndConsume(1); }
+
+TEST(Channel, sharded_multi_producer_multi_consumer) {
+  ProduceAndConsume(8);
+}
+
+TEST(Channel, sharded) {
+  auto chan = MakeChannel<int>();
+  chan->SetShardNum(4);
+  ASSERT_EQ(chan->ShardNum(), 4UL);
+  // the writers spread over the shards
+  std::vector<std::thread> writers;
+  for (int i = 0; i < 8; ++i) {
+    writers.emplace_back([&chan, i] {
+      std::vector<int> in(100);
+      std::iota(in.begin(), in.end(), i * 100);
+      ASSERT_EQ(chan->Write(in), 100UL);
+    });
+  }
+  for (auto& t : writers) {
+    t.join();
+  }
+  ASSERT_EQ(chan->Size(), 800UL);
+
+  // GetData gathers all the shards, which can still be read afterwards
+  const std::deque<int>& data = chan->GetData();
+  std::vector<int> all(data.begin(), data.end());
+  std::sort(all.begin(), all.end());
+  std::vector<int> expected(800);
+  std::iota(expected.begin(), expected.end(), 0);
+  ASSERT_EQ(all, expected);
+
+  chan->Close();
+  std::vector<int> out;
+  ASSERT_EQ(chan->ReadAll(out), 800UL);
+  std::sort(out.begin(), out.end());
+  ASSERT_EQ(out, expected);
+  ASSERT_TRUE(chan->Empty());
+
+  // a channel made from another one has its shards
+  auto other = MakeChannel<int64_t>(chan);
+  ASSERT_EQ(other->ShardNum(), 4UL);
+}
+
+TEST(Channel, close_wakes_up_waiters) {
+  auto chan = MakeChannel<int>(1);
+  ASSERT_TRUE(chan->Put(0));
+  std::thread writer([&chan] { ASSERT_FALSE(chan->Put(1)); });
+  std::thread reader([] {
+    auto empty_chan = MakeChannel<int>();
+    std::thread waiter([&empty_chan] {
+      int val = 0;
+      ASSERT_FALSE(empty_chan->Get(val));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    empty_chan->Close();
+    waiter.join();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  chan->Close();
+  writer.join();
+  reader.join();
+  ASSERT_EQ(chan->Size(), 1UL);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -30,9 +30,28 @@ limitations under the License. */
 
 USE_INT_STAT(STAT_total_feasign_num_in_mem);
 DECLARE_bool(enable_ins_parser_file);
+DECLARE_bool(enable_fast_slot_parser);
 namespace paddle {
 namespace framework {
 
+// The feasigns of the text lines are parsed by strtoull and strtof, or by
+// their fast versions if FLAGS_enable_fast_slot_parser, with the same results.
+static inline uint64_t ParseUint64Feasign(char* str, const char* end,
+                                          char** endptr) {
+  if (FLAGS_enable_fast_slot_parser) {
+    return string::fast_strtoull(str, end, endptr);
+  }
+  return static_cast<uint64_t>(strtoull(str, endptr, 10));
+}
+
+static inline float ParseFloatFeasign(char* str, const char* end,
+                                      char** endptr) {
+  if (FLAGS_enable_fast_slot_parser) {
+    return string::fast_strtof(str, end, endptr);
+  }
+  return strtof(str, endptr);
+}
+
 DLManager& global_dlmanager_pool() {
   static DLManager manager;
   return manager;
@@ -211,7 +230,7 @@ void DataFeed::SetBatchSize(int batch_size) {
   default_batch_size_ = batch_size;
 }
 
-bool DataFeed::PickOneFile(std::string* filename) {
+bool DataFeed::PickOneFile(std::string* filename, bool prefetch) {
   PADDLE_ENFORCE_NOT_NULL(
       mutex_for_pick_file_,
       platform::errors::PreconditionNotMet(
@@ -225,10 +244,25 @@ bool DataFeed::PickOneFile(std::string* filename) {
     return false;
   }
   VLOG(3) << "file_idx_=" << *file_idx_;
+  if (prefetch && file_prefetcher_ != nullptr) {
+    size_t end = std::min(filelist_.size(),
+                          *file_idx_ + 1 + file_prefetcher_->file_num());
+    for (size_t i = *file_idx_; i < end; ++i) {
+      file_prefetcher_->Prefetch(filelist_[i], pipe_command_);
+    }
+  }
   *filename = filelist_[(*file_idx_)++];
   return true;
 }
 
+std::shared_ptr<FILE> DataFeed::OpenPickedFile(const std::string& filename,
+                                               int* err_no) {
+  if (file_prefetcher_ != nullptr) {
+    return file_prefetcher_->Open(filename, err_no, pipe_command_);
+  }
+  return fs_open_read(filename, err_no, pipe_command_);
+}
+
 void DataFeed::CheckInit() {
   PADDLE_ENFORCE_EQ(finish_init_, true, platform::errors::PreconditionNotMet(
                                             "DataFeed initialization failed."));
@@ -294,9 +328,9 @@ template <typename T>
 void PrivateQueueDataFeed<T>::ReadThread() {
 #ifdef _LINUX
   std::string filename;
-  while (PickOneFile(&filename)) {
+  while (PickOneFile(&filename, true /*prefetch*/)) {
     int err_no = 0;
-    fp_ = fs_open_read(filename, &err_no, pipe_command_);
+    fp_ = OpenPickedFile(filename, &err_no);
     __fsetlocking(&*fp_, FSETLOCKING_BYCALLER);
     T instance;
     while (ParseOneInstanceFromPipe(&instance)) {
@@ -513,8 +547,13 @@ void InMemoryDataFeed<T>::LoadIntoMemory() {
     return;
   }
   VLOG(3) << "LoadIntoMemory() begin, thread_id=" << thread_id_;
+  // the files read by the AFS api are not opened with OpenPickedFile
+  bool prefetch = true;
+#ifdef PADDLE_WITH_BOX_PS
+  prefetch = !BoxWrapper::GetInstance()->UseAfsApi();
+#endif
   std::string filename;
-  while (this->PickOneFile(&filename)) {
+  while (this->PickOneFile(&filename, prefetch)) {
     VLOG(3) << "PickOneFile, filename=" << filename
             << ", thread_id=" << thread_id_;
 #ifdef PADDLE_WITH_BOX_PS
@@ -524,7 +563,7 @@ void InMemoryDataFeed<T>::LoadIntoMemory() {
     } else {
 #endif
       int err_no = 0;
-      this->fp_ = fs_open_read(filename, &err_no, this->pipe_command_);
+      this->fp_ = this->OpenPickedFile(filename, &err_no);
 #ifdef PADDLE_WITH_BOX_PS
     }
 #endif
@@ -663,9 +702,9 @@ void MultiSlotDataFeed::Init(
 void MultiSlotDataFeed::ReadThread() {
 #ifdef _LINUX
   std::string filename;
-  while (PickOneFile(&filename)) {
+  while (PickOneFile(&filename, true /*prefetch*/)) {
     int err_no = 0;
-    fp_ = fs_open_read(filename, &err_no, pipe_command_);
+    fp_ = OpenPickedFile(filename, &err_no);
     CHECK(fp_ != nullptr);
     __fsetlocking(&*fp_, FSETLOCKING_BYCALLER);
     std::vector<MultiSlotType> instance;
@@ -831,6 +870,7 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
     instance->resize(use_slots_num);
 
     const char* str = reader.get();
+    const char* end = str + reader.length();
     std::string line = std::string(str);
 
     char* endptr = const_cast<char*>(str);
@@ -864,16 +904,18 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
         (*instance)[idx].Init(all_slots_type_[i]);
         if ((*instance)[idx].GetType()[0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = ParseFloatFeasign(endptr, end, &endptr);
             (*instance)[idx].AddValue(feasign);
           }
         } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = ParseUint64Feasign(endptr, end, &endptr);
             (*instance)[idx].AddValue(feasign);
           }
         }
         pos = endptr - str;
+      } else if (FLAGS_enable_fast_slot_parser) {
+        pos = string::skip_tokens(str + pos, end, num + 1) - str;
       } else {
         for (int j = 0; j <= num; ++j) {
           // pos = line.find_first_of(' ', pos + 1);
@@ -898,6 +940,7 @@ bool MultiSlotDataFeed::ParseOneInstance(std::vector<MultiSlotType>* instance) {
     instance->resize(use_slots_num);
     // parse line
     const char* str = line.c_str();
+    const char* end = str + line.size();
     char* endptr = const_cast<char*>(str);
     int pos = 0;
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
@@ -921,16 +964,18 @@ bool MultiSlotDataFeed::ParseOneInstance(std::vector<MultiSlotType>* instance) {
         (*instance)[idx].Init(all_slots_type_[i]);
         if ((*instance)[idx].GetType()[0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = ParseFloatFeasign(endptr, end, &endptr);
             (*instance)[idx].AddValue(feasign);
           }
         } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = ParseUint64Feasign(endptr, end, &endptr);
             (*instance)[idx].AddValue(feasign);
           }
         }
         pos = endptr - str;
+      } else if (FLAGS_enable_fast_slot_parser) {
+        pos = string::skip_tokens(str + pos, end, num + 1) - str;
       } else {
         for (int j = 0; j <= num; ++j) {
           pos = line.find_first_of(' ', pos + 1);
@@ -1107,6 +1152,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
     return false;
   } else {
     const char* str = reader.get();
+    const char* end = str + reader.length();
     std::string line = std::string(str);
     // VLOG(3) << line;
     char* endptr = const_cast<char*>(str);
@@ -1188,7 +1234,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
       if (idx != -1) {
         if (all_slots_type_[i][0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = ParseFloatFeasign(endptr, end, &endptr);
             // if float feasign is equal to zero, ignore it
             // except when slot is dense
             if (fabs(feasign) < 1e-6 && !use_slots_is_dense_[i]) {
@@ -1200,7 +1246,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
           }
         } else if (all_slots_type_[i][0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = ParseUint64Feasign(endptr, end, &endptr);
             // if uint64 feasign is equal to zero, ignore it
             // except when slot is dense
             if (feasign == 0 && !use_slots_is_dense_[i]) {
@@ -1212,6 +1258,8 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
           }
         }
         pos = endptr - str;
+      } else if (FLAGS_enable_fast_slot_parser) {
+        pos = string::skip_tokens(str + pos, end, num + 1) - str;
       } else {
         for (int j = 0; j <= num; ++j) {
           // pos = line.find_first_of(' ', pos + 1);
@@ -1238,6 +1286,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
     VLOG(3) << line;
     // parse line
     const char* str = line.c_str();
+    const char* end = str + line.size();
     char* endptr = const_cast<char*>(str);
     int pos = 0;
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
@@ -1260,7 +1309,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
       if (idx != -1) {
         if (all_slots_type_[i][0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = ParseFloatFeasign(endptr, end, &endptr);
             if (fabs(feasign) < 1e-6) {
               continue;
             }
@@ -1270,7 +1319,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
           }
         } else if (all_slots_type_[i][0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = ParseUint64Feasign(endptr, end, &endptr);
             if (feasign == 0) {
               continue;
             }
@@ -1280,6 +1329,8 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
           }
         }
         pos = endptr - str;
+      } else if (FLAGS_enable_fast_slot_parser) {
+        pos = string::skip_tokens(str + pos, end, num + 1) - str;
       } else {
         for (int j = 0; j <= num; ++j) {
           pos = line.find_first_of(' ', pos + 1);
@@ -2033,18 +2084,7 @@ void SlotRecordInMemoryDataFeed::Init(const DataFeedDesc& data_feed_desc) {
   used_slots_info_.resize(use_slot_size_);
 
   feed_vec_.resize(used_slots_info_.size());
-  const int kEstimatedFeasignNumPerSlot = 5;  // Magic Number
-  for (size_t i = 0; i < all_slot_num; i++) {
-    batch_float_feasigns_.push_back(std::vector<float>());
-    batch_uint64_feasigns_.push_back(std::vector<uint64_t>());
-    batch_float_feasigns_[i].reserve(default_batch_size_ *
-                                     kEstimatedFeasignNumPerSlot);
-    batch_uint64_feasigns_[i].reserve(default_batch_size_ *
-                                      kEstimatedFeasignNumPerSlot);
-    offset_.push_back(std::vector<size_t>());
-    offset_[i].reserve(default_batch_size_ +
-                       1);  // Each lod info will prepend a zero
-  }
+  // the batches are assembled in batch_, by column
   visit_.resize(all_slot_num, false);
   pipe_command_ = data_feed_desc.pipe_command();
   finish_init_ = true;
@@ -2128,7 +2168,7 @@ void SlotRecordInMemoryDataFeed::LoadIntoMemoryByFile(void) {
             pull_record_func, lines);
       } else {
         int err_no = 0;
-        this->fp_ = fs_open_read(filename, &err_no, this->pipe_command_);
+        this->fp_ = this->OpenPickedFile(filename, &err_no);
 
         CHECK(this->fp_ != nullptr);
         __fsetlocking(&*(this->fp_), FSETLOCKING_BYCALLER);
@@ -2212,7 +2252,7 @@ void SlotRecordInMemoryDataFeed::LoadIntoMemoryByLine(void) {
 
     do {
       int err_no = 0;
-      this->fp_ = fs_open_read(filename, &err_no, this->pipe_command_);
+      this->fp_ = this->OpenPickedFile(filename, &err_no);
       CHECK(this->fp_ != nullptr);
       __fsetlocking(&*(this->fp_), FSETLOCKING_BYCALLER);
       lines = line_reader.read_file(this->fp_.get(), line_func, lines);
@@ -2249,7 +2289,7 @@ void SlotRecordInMemoryDataFeed::LoadIntoMemoryByCommand(void) {
   BufferedLineFileReader line_reader;
   line_reader.set_sample_rate(sample_rate_);
 
-  while (this->PickOneFile(&filename)) {
+  while (this->PickOneFile(&filename, true /*prefetch*/)) {
     VLOG(3) << "PickOneFile, filename=" << filename
             << ", thread_id=" << thread_id_;
     int lines = 0;
@@ -2261,7 +2301,7 @@ void SlotRecordInMemoryDataFeed::LoadIntoMemoryByCommand(void) {
 
     do {
       int err_no = 0;
-      this->fp_ = fs_open_read(filename, &err_no, this->pipe_command_);
+      this->fp_ = this->OpenPickedFile(filename, &err_no);
       CHECK(this->fp_ != nullptr);
       __fsetlocking(&*(this->fp_), FSETLOCKING_BYCALLER);
 
@@ -2323,6 +2363,7 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
   SlotRecord& rec = (*ins);
   // parse line
   const char* str = line.c_str();
+  const char* end = str + line.size();
   char* endptr = const_cast<char*>(str);
   int pos = 0;
 
@@ -2381,7 +2422,7 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
         auto& slot_fea = slot_float_feasigns[info.slot_value_idx];
         slot_fea.clear();
         for (int j = 0; j < num; ++j) {
-          float feasign = strtof(endptr, &endptr);
+          float feasign = ParseFloatFeasign(endptr, end, &endptr);
           if (fabs(feasign) < 1e-6 && !used_slots_info_[info.used_idx].dense) {
             continue;
           }
@@ -2392,8 +2433,7 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
         auto& slot_fea = slot_uint64_feasigns[info.slot_value_idx];
         slot_fea.clear();
         for (int j = 0; j < num; ++j) {
-          uint64_t feasign =
-              static_cast<uint64_t>(strtoull(endptr, &endptr, 10));
+          uint64_t feasign = ParseUint64Feasign(endptr, end, &endptr);
           if (feasign == 0 && !used_slots_info_[info.used_idx].dense) {
             continue;
           }
@@ -2402,6 +2442,8 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
         }
       }
       pos = endptr - str;
+    } else if (FLAGS_enable_fast_slot_parser) {
+      pos = string::skip_tokens(str + pos, end, num + 1) - str;
     } else {
       for (int j = 0; j <= num; ++j) {
         // pos = line.find_first_of(' ', pos + 1);
@@ -2419,71 +2461,118 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
   return (uint64_total_slot_num > 0);
 }
 
+// The values of one slot are contiguous in every SlotRecord, so a column is
+// built in two passes: the offsets of the instances first, then one memcpy
+// per instance into the arena.
+template <typename T>
+static size_t SlotColumnOffsets(const SlotRecord* ins_vec, int num,
+                                SlotValues<T> SlotRecordObject::*slot_values,
+                                int slot_value_idx, bool fill_empty,
+                                std::vector<size_t>* offsets) {
+  offsets->resize(num + 1);
+  size_t total = 0;
+  (*offsets)[0] = 0;
+  for (int i = 0; i < num; ++i) {
+    auto& slot_offsets = (ins_vec[i]->*slot_values).slot_offsets;
+    size_t fea_num =
+        slot_offsets[slot_value_idx + 1] - slot_offsets[slot_value_idx];
+    // fill empty slot with default value 0
+    total += (fea_num == 0 && fill_empty) ? 1 : fea_num;
+    (*offsets)[i + 1] = total;
+  }
+  return total * sizeof(T);
+}
+
+template <typename T>
+static void FillSlotColumn(const SlotRecord* ins_vec, int num,
+                           SlotValues<T> SlotRecordObject::*slot_values,
+                           int slot_value_idx,
+                           const std::vector<size_t>& offsets, T* dst) {
+  for (int i = 0; i < num; ++i) {
+    size_t fea_num = 0;
+    T* values =
+        (ins_vec[i]->*slot_values).get_values(slot_value_idx, &fea_num);
+    T* out = dst + offsets[i];
+    if (fea_num > 0) {
+      memcpy(out, values, sizeof(T) * fea_num);
+    } else if (offsets[i + 1] > offsets[i]) {
+      *out = 0;
+    }
+  }
+}
+
+void SlotRecordBatch::Build(const SlotRecord* ins_vec, int num,
+                            const std::vector<UsedSlotInfo>& used_slots) {
+  // keeps every column 8-byte aligned in the arena
+  const size_t kAlign = sizeof(uint64_t);
+  num_ = num;
+  columns_.resize(used_slots.size());
+  std::vector<size_t> column_bytes(used_slots.size(), 0);
+  size_t total_bytes = 0;
+  for (size_t j = 0; j < used_slots.size(); ++j) {
+    auto& info = used_slots[j];
+    auto& offsets = columns_[j].offsets;
+    if (info.type[0] == 'f') {  // float
+      column_bytes[j] = SlotColumnOffsets<float>(
+          ins_vec, num, &SlotRecordObject::slot_float_feasigns_,
+          info.slot_value_idx, false, &offsets);
+    } else if (info.type[0] == 'u') {  // uint64
+      column_bytes[j] = SlotColumnOffsets<uint64_t>(
+          ins_vec, num, &SlotRecordObject::slot_uint64_feasigns_,
+          info.slot_value_idx, true, &offsets);
+    } else {
+      offsets.assign(num + 1, 0);
+    }
+    total_bytes += (column_bytes[j] + kAlign - 1) / kAlign * kAlign;
+  }
+  if (total_bytes > arena_size_) {
+    arena_.reset(new char[total_bytes]);
+    arena_size_ = total_bytes;
+  }
+
+  char* pos = arena_.get();
+  for (size_t j = 0; j < used_slots.size(); ++j) {
+    auto& info = used_slots[j];
+    auto& column = columns_[j];
+    column.values = pos;
+    if (info.type[0] == 'f') {
+      FillSlotColumn<float>(
+          ins_vec, num, &SlotRecordObject::slot_float_feasigns_,
+          info.slot_value_idx, column.offsets, reinterpret_cast<float*>(pos));
+    } else if (info.type[0] == 'u') {
+      FillSlotColumn<uint64_t>(
+          ins_vec, num, &SlotRecordObject::slot_uint64_feasigns_,
+          info.slot_value_idx, column.offsets,
+          reinterpret_cast<uint64_t*>(pos));
+    }
+    pos += (column_bytes[j] + kAlign - 1) / kAlign * kAlign;
+  }
+}
+
 void SlotRecordInMemoryDataFeed::PutToFeedVec(const SlotRecord* ins_vec,
                                               int num) {
+  batch_.Build(ins_vec, num, used_slots_info_);
   for (int j = 0; j < use_slot_size_; ++j) {
     auto& feed = feed_vec_[j];
     if (feed == nullptr) {
       continue;
     }
 
-    auto& slot_offset = offset_[j];
-    slot_offset.clear();
-    slot_offset.reserve(num + 1);
-    slot_offset.push_back(0);
-
-    int total_instance = 0;
+    auto& column = batch_.column(j);
+    int total_instance = static_cast<int>(column.offsets.back());
     auto& info = used_slots_info_[j];
-    // fill slot value with default value 0
+    // one copy of the whole column into the feed tensor
     if (info.type[0] == 'f') {  // float
-      auto& batch_fea = batch_float_feasigns_[j];
-      batch_fea.clear();
-
-      for (int i = 0; i < num; ++i) {
-        auto r = ins_vec[i];
-        size_t fea_num = 0;
-        float* slot_values =
-            r->slot_float_feasigns_.get_values(info.slot_value_idx, &fea_num);
-        batch_fea.resize(total_instance + fea_num);
-        memcpy(&batch_fea[total_instance], slot_values,
-               sizeof(float) * fea_num);
-        total_instance += fea_num;
-        slot_offset.push_back(total_instance);
-      }
-
-      float* feasign = batch_fea.data();
       float* tensor_ptr =
           feed->mutable_data<float>({total_instance, 1}, this->place_);
-      CopyToFeedTensor(tensor_ptr, feasign, total_instance * sizeof(float));
-
+      CopyToFeedTensor(tensor_ptr, column.values,
+                       total_instance * sizeof(float));
     } else if (info.type[0] == 'u') {  // uint64
-      auto& batch_fea = batch_uint64_feasigns_[j];
-      batch_fea.clear();
-
-      for (int i = 0; i < num; ++i) {
-        auto r = ins_vec[i];
-        size_t fea_num = 0;
-        uint64_t* slot_values =
-            r->slot_uint64_feasigns_.get_values(info.slot_value_idx, &fea_num);
-        if (fea_num > 0) {
-          batch_fea.resize(total_instance + fea_num);
-          memcpy(&batch_fea[total_instance], slot_values,
-                 sizeof(uint64_t) * fea_num);
-          total_instance += fea_num;
-        }
-        if (fea_num == 0) {
-          batch_fea.resize(total_instance + fea_num);
-          batch_fea[total_instance] = 0;
-          total_instance += 1;
-        }
-        slot_offset.push_back(total_instance);
-      }
-
       // no uint64_t type in paddlepaddle
-      uint64_t* feasign = batch_fea.data();
       int64_t* tensor_ptr =
           feed->mutable_data<int64_t>({total_instance, 1}, this->place_);
-      CopyToFeedTensor(tensor_ptr, feasign, total_instance * sizeof(int64_t));
+      CopyToFeedTensor(tensor_ptr, column.values,
+                       total_instance * sizeof(int64_t));
     }
 
     if (info.dense) {
@@ -2493,7 +2582,7 @@ void SlotRecordInMemoryDataFeed::PutToFeedVec(const SlotRecord* ins_vec,
       }
       feed->Resize(phi::make_ddim(info.local_shape));
     } else {
-      LoD data_lod{slot_offset};
+      LoD data_lod{column.offsets};
       feed_vec_[j]->set_lod(data_lod);
     }
   }
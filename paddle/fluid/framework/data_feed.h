@@ -50,6 +50,7 @@ DECLARE_bool(enable_slotrecord_reset_shrink);
 namespace paddle {
 namespace framework {
 class DataFeedDesc;
+class FilePrefetcher;
 class Scope;
 class Variable;
 }  // namespace framework
@@ -367,6 +368,37 @@ inline SlotObjPool& SlotRecordPool() {
   static SlotObjPool pool;
   return pool;
 }
+
+// SlotRecordBatch stores a batch of SlotRecords by column: the values of one
+// used slot of all the instances lie in one contiguous array, delimited by
+// num + 1 offsets which are the LoD of the slot. The arrays of all the slots
+// are carved out of a single arena, which is kept across batches, so a batch
+// allocates nothing once the arena has grown to the largest batch.
+class SlotRecordBatch {
+ public:
+  struct Column {
+    // float or uint64_t values, by the type of the slot
+    const void* values = nullptr;
+    std::vector<size_t> offsets;
+  };
+
+  SlotRecordBatch() {}
+  // Transposes the records into one column per slot of used_slots. An empty
+  // uint64 slot holds a single 0, as the feed tensors expect.
+  void Build(const SlotRecord* ins_vec, int num,
+             const std::vector<UsedSlotInfo>& used_slots);
+  int size() const { return num_; }
+  const Column& column(int used_idx) const { return columns_[used_idx]; }
+  size_t arena_size() const { return arena_size_; }
+
+ private:
+  int num_ = 0;
+  std::vector<Column> columns_;
+  std::unique_ptr<char[]> arena_;
+  size_t arena_size_ = 0;
+
+  DISABLE_COPY_AND_ASSIGN(SlotRecordBatch);
+};
 struct PvInstanceObject {
   std::vector<Record*> ads;
   void merge_instance(Record* ins) { ads.push_back(ins); }
@@ -577,6 +609,12 @@ class DataFeed {
   }
   virtual void SetFeaNumMutex(std::mutex* mutex) { mutex_for_fea_num_ = mutex; }
   virtual void SetFileListIndex(size_t* file_index) { file_idx_ = file_index; }
+  // The files picked by PickOneFile with prefetch are read ahead by the
+  // prefetcher, which is shared by the readers of a dataset.
+  virtual void SetFilePrefetcher(
+      const std::shared_ptr<FilePrefetcher>& file_prefetcher) {
+    file_prefetcher_ = file_prefetcher;
+  }
   virtual void SetFeaNum(uint64_t* fea_num) { total_fea_num_ = fea_num; }
   virtual const std::vector<std::string>& GetInsIdVec() const {
     return ins_id_vec_;
@@ -604,13 +642,19 @@ class DataFeed {
   virtual void SetBatchSize(
       int batch);  // batch size will be set in Init() function
   // This function is used to pick one file from the global filelist(thread
-  // safe).
-  virtual bool PickOneFile(std::string* filename);
+  // safe). If prefetch is true, the file and the next ones are read ahead by
+  // the prefetcher, so it should only be set by the loaders which open every
+  // picked file with OpenPickedFile, without a custom parser or AFS.
+  virtual bool PickOneFile(std::string* filename, bool prefetch = false);
+  // Opens the file returned by PickOneFile with pipe_command_.
+  virtual std::shared_ptr<FILE> OpenPickedFile(const std::string& filename,
+                                               int* err_no);
   virtual void CopyToFeedTensor(void* dst, const void* src, size_t size);
 
   std::vector<std::string> filelist_;
   size_t* file_idx_;
   std::mutex* mutex_for_pick_file_;
+  std::shared_ptr<FilePrefetcher> file_prefetcher_;
   std::mutex* mutex_for_fea_num_ = nullptr;
   uint64_t* total_fea_num_ = nullptr;
   uint64_t fea_num_ = 0;
@@ -1157,6 +1201,7 @@ class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
   std::vector<UsedSlotInfo> used_slots_info_;
   size_t float_total_dims_size_ = 0;
   std::vector<int> float_total_dims_without_inductives_;
+  SlotRecordBatch batch_;
 };
 
 class PaddleBoxDataFeed : public MultiSlotInMemoryDataFeed {
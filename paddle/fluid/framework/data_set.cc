@@ -13,6 +13,10 @@
  *     limitations under the License. */
 
 #include "paddle/fluid/framework/data_set.h"
+
+#include <deque>
+#include <future>  // NOLINT
+
 #include "google/protobuf/text_format.h"
 #if (defined PADDLE_WITH_DISTRIBUTE) && (defined PADDLE_WITH_PSCORE)
 #include "paddle/fluid/distributed/index_dataset/index_sampler.h"
@@ -32,16 +36,40 @@
 #define _LINUX
 #endif
 
+#ifdef _LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 USE_INT_STAT(STAT_total_feasign_num_in_mem);
+DECLARE_int32(global_shuffle_max_inflight_batches);
+DECLARE_int32(dataset_input_channel_shard_num);
+DECLARE_int32(dataset_prefetch_file_num);
+DECLARE_int32(dataset_prefetch_block_size);
 namespace paddle {
 namespace framework {
 
+// the number of blocks each prefetched file keeps in memory
+static constexpr size_t kPrefetchBlockNum = 4;
+
+static std::shared_ptr<FilePrefetcher> CreateFilePrefetcher() {
+  if (FLAGS_dataset_prefetch_file_num <= 0) {
+    return nullptr;
+  }
+  return std::make_shared<FilePrefetcher>(FLAGS_dataset_prefetch_file_num,
+                                          FLAGS_dataset_prefetch_block_size,
+                                          kPrefetchBlockNum);
+}
+
 // constructor
 template <typename T>
 DatasetImpl<T>::DatasetImpl() {
   VLOG(3) << "DatasetImpl<T>::DatasetImpl() constructor";
   thread_num_ = 1;
   trainer_num_ = 1;
+  trainer_id_ = -1;
   channel_num_ = 1;
   file_idx_ = 0;
   total_fea_num_ = 0;
@@ -84,6 +112,12 @@ void DatasetImpl<T>::SetTrainerNum(int trainer_num) {
   trainer_num_ = trainer_num;
 }
 
+// the records of this worker itself skip the network in global shuffle
+template <typename T>
+void DatasetImpl<T>::SetTrainerId(int trainer_id) {
+  trainer_id_ = trainer_id;
+}
+
 // if you run distributed, and want to do global shuffle,
 // set this before global shuffle.
 // be sure you call CreateReaders before SetFleetSendBatchSize
@@ -191,6 +225,7 @@ template <typename T>
 void DatasetImpl<T>::CreateChannel() {
   if (input_channel_ == nullptr) {
     input_channel_ = paddle::framework::MakeChannel<T>();
+    input_channel_->SetShardNum(FLAGS_dataset_input_channel_shard_num);
   }
   if (multi_output_channel_.size() == 0) {
     multi_output_channel_.reserve(channel_num_);
@@ -460,7 +495,10 @@ template <typename T>
 void DatasetImpl<T>::WaitPreLoadDone() {
   VLOG(3) << "DatasetImpl<T>::WaitPreLoadDone() begin";
   for (std::thread& t : preload_threads_) {
-    t.join();
+    // joined already by a streaming GlobalShuffle
+    if (t.joinable()) {
+      t.join();
+    }
   }
   input_channel_->Close();
   int64_t in_chan_size = input_channel_->Size();
@@ -468,6 +506,310 @@ void DatasetImpl<T>::WaitPreLoadDone() {
   VLOG(3) << "DatasetImpl<T>::WaitPreLoadDone() end";
 }
 
+// The binary files of SaveIntoBinaryFiles start with a header, followed by
+// the instances. The feasigns and slot values are written as raw arrays, so
+// that loading an instance is a few memcpy from the mmap-ed file.
+static constexpr uint64_t kBinaryDatasetMagic = 0x31534444454c4150UL;
+static constexpr uint32_t kBinaryDatasetVersion = 2;
+
+struct BinaryDatasetHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t record_type;  // 0 for Record, 1 for SlotRecord
+  uint64_t record_num;
+  uint64_t slot_hash;  // see BinaryDatasetSlotHash
+};
+
+// The records refer to their slots by the index among the used slots of
+// each type, so they can only be loaded by a dataset of the same used slots
+// in the same order. The names and the types of those slots are hashed.
+static uint64_t BinaryDatasetSlotHash(const DataFeedDesc& desc) {
+  std::string slots;
+  for (auto& slot : desc.multi_slot_desc().slots()) {
+    if (slot.is_used()) {
+      slots += slot.name() + ":" + slot.type() + ";";
+    }
+  }
+  return XXH64(slots.data(), slots.length(), 0);
+}
+
+template <typename T>
+static void PutRawVector(BinaryArchive* ar, const std::vector<T>& v) {
+  *ar << static_cast<uint64_t>(v.size());
+  ar->Write(v.data(), v.size() * sizeof(T));
+}
+
+template <typename T>
+static void GetRawVector(BinaryArchive* ar, std::vector<T>* v) {
+  v->resize(ar->Get<uint64_t>());
+  ar->Read(v->data(), v->size() * sizeof(T));
+}
+
+static uint32_t BinaryRecordType(const Record*) { return 0; }
+
+static void SerializeBinaryRecord(BinaryArchive* ar, const Record& r) {
+  PutRawVector(ar, r.uint64_feasigns_);
+  PutRawVector(ar, r.float_feasigns_);
+  *ar << r.ins_id_ << r.content_ << r.uid_;
+  *ar << r.search_id << r.rank << r.cmatch;
+}
+
+static size_t DeserializeBinaryRecord(BinaryArchive* ar, Record* r) {
+  GetRawVector(ar, &r->uint64_feasigns_);
+  GetRawVector(ar, &r->float_feasigns_);
+  *ar >> r->ins_id_ >> r->content_ >> r->uid_;
+  *ar >> r->search_id >> r->rank >> r->cmatch;
+  return r->uint64_feasigns_.size();
+}
+
+static uint32_t BinaryRecordType(const SlotRecord*) { return 1; }
+
+static void SerializeBinaryRecord(BinaryArchive* ar, const SlotRecord& r) {
+  PutRawVector(ar, r->slot_uint64_feasigns_.slot_values);
+  PutRawVector(ar, r->slot_uint64_feasigns_.slot_offsets);
+  PutRawVector(ar, r->slot_float_feasigns_.slot_values);
+  PutRawVector(ar, r->slot_float_feasigns_.slot_offsets);
+  *ar << r->ins_id_;
+  *ar << r->search_id << r->rank << r->cmatch;
+}
+
+static size_t DeserializeBinaryRecord(BinaryArchive* ar, SlotRecord* r) {
+  SlotRecord& rec = *r;
+  GetRawVector(ar, &rec->slot_uint64_feasigns_.slot_values);
+  GetRawVector(ar, &rec->slot_uint64_feasigns_.slot_offsets);
+  GetRawVector(ar, &rec->slot_float_feasigns_.slot_values);
+  GetRawVector(ar, &rec->slot_float_feasigns_.slot_offsets);
+  *ar >> rec->ins_id_;
+  *ar >> rec->search_id >> rec->rank >> rec->cmatch;
+  return rec->slot_uint64_feasigns_.slot_values.size();
+}
+
+static void GetBinaryRecords(std::vector<Record>* records, size_t num) {
+  records->resize(num);
+}
+
+static void GetBinaryRecords(std::vector<SlotRecord>* records, size_t num) {
+  SlotRecordPool().get(records, num);
+}
+
+template <typename T>
+static void CheckBinaryDatasetHeader(const std::string& filename,
+                                     const BinaryDatasetHeader& header,
+                                     uint64_t slot_hash) {
+  PADDLE_ENFORCE_EQ(
+      header.magic == kBinaryDatasetMagic &&
+          header.version == kBinaryDatasetVersion,
+      true,
+      platform::errors::InvalidArgument(
+          "File %s is not a binary dataset file of version %d.", filename,
+          kBinaryDatasetVersion));
+  PADDLE_ENFORCE_EQ(
+      header.record_type, BinaryRecordType(static_cast<T*>(nullptr)),
+      platform::errors::InvalidArgument(
+          "The instance type of file %s does not match the dataset.",
+          filename));
+  PADDLE_ENFORCE_EQ(header.slot_hash, slot_hash,
+                    platform::errors::InvalidArgument(
+                        "The slots of file %s do not match the used slots of "
+                        "the dataset, the names, types and order of the used "
+                        "slots must be the same as when it was saved.",
+                        filename));
+}
+
+// The records are serialized into an archive of about this size, which is
+// written to the file and reused, instead of serializing a whole file in
+// memory.
+static constexpr size_t kBinaryDatasetChunkSize = 16UL << 20;
+
+// save the instances in memory, each thread writes one file
+template <typename T>
+void DatasetImpl<T>::SaveIntoBinaryFiles(const std::string& path_prefix) {
+#ifdef _LINUX
+  VLOG(3) << "DatasetImpl<T>::SaveIntoBinaryFiles() begin";
+  // the instances are in input_channel_ after loading, and in the output and
+  // consume channels after shuffling.
+  std::vector<const std::deque<T>*> sources;
+  if (input_channel_) {
+    sources.push_back(&input_channel_->GetData());
+  }
+  for (size_t i = 0; i < multi_output_channel_.size(); ++i) {
+    sources.push_back(&multi_output_channel_[i]->GetData());
+    sources.push_back(&multi_consume_channel_[i]->GetData());
+  }
+  PADDLE_ENFORCE_EQ(
+      sources.empty(), false,
+      platform::errors::PreconditionNotMet(
+          "The channels are not created, please load data first."));
+  platform::Timer timeline;
+  timeline.Start();
+  // the channels are not read or written during saving
+  size_t total_len = 0;
+  for (auto* source : sources) {
+    total_len += source->size();
+  }
+  size_t part_num = std::max(static_cast<size_t>(thread_num_), size_t(1));
+  uint64_t slot_hash = BinaryDatasetSlotHash(data_feed_desc_);
+  auto save_func = [&sources, &path_prefix, total_len, part_num,
+                    slot_hash](size_t part) {
+    size_t begin = total_len * part / part_num;
+    size_t end = total_len * (part + 1) / part_num;
+    std::string filename =
+        string::Sprintf("%s-%05d", path_prefix, static_cast<int>(part));
+    std::unique_ptr<FILE, int (*)(FILE*)> fp(fopen(filename.c_str(), "wb"),
+                                             &fclose);
+    PADDLE_ENFORCE_NOT_NULL(
+        fp, platform::errors::Unavailable("Failed to open file %s to write.",
+                                          filename));
+    BinaryArchive ar;
+    auto flush = [&ar, &fp, &filename]() {
+      PADDLE_ENFORCE_EQ(
+          fwrite(ar.Buffer(), 1, ar.Length(), fp.get()), ar.Length(),
+          platform::errors::Unavailable("Failed to write file %s.", filename));
+      ar.Clear();
+    };
+    BinaryDatasetHeader header;
+    header.magic = kBinaryDatasetMagic;
+    header.version = kBinaryDatasetVersion;
+    header.record_type = BinaryRecordType(static_cast<T*>(nullptr));
+    header.record_num = end - begin;
+    header.slot_hash = slot_hash;
+    ar.Write(&header, sizeof(header));
+    // the instances [begin, end) of the concatenated sources
+    size_t skip = begin;
+    size_t left = end - begin;
+    for (auto* source : sources) {
+      if (left == 0) break;
+      if (skip >= source->size()) {
+        skip -= source->size();
+        continue;
+      }
+      size_t num = std::min(left, source->size() - skip);
+      for (size_t i = skip; i < skip + num; ++i) {
+        SerializeBinaryRecord(&ar, (*source)[i]);
+        if (ar.Length() >= kBinaryDatasetChunkSize) {
+          flush();
+        }
+      }
+      left -= num;
+      skip = 0;
+    }
+    flush();
+  };
+  std::vector<std::thread> save_threads;
+  for (size_t i = 0; i < part_num; ++i) {
+    save_threads.push_back(std::thread(save_func, i));
+  }
+  for (std::thread& t : save_threads) {
+    t.join();
+  }
+  timeline.Pause();
+  VLOG(3) << "DatasetImpl<T>::SaveIntoBinaryFiles() end, saved " << total_len
+          << " instances into " << part_num << " files, cost time="
+          << timeline.ElapsedSec() << " seconds";
+#else
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "SaveIntoBinaryFiles is only supported on Linux."));
+#endif
+}
+
+// load the files saved by SaveIntoBinaryFiles into input_channel_, like
+// LoadIntoMemory does, each thread maps one file at a time
+template <typename T>
+void DatasetImpl<T>::LoadFromBinaryFiles(
+    const std::vector<std::string>& files) {
+#ifdef _LINUX
+  VLOG(3) << "DatasetImpl<T>::LoadFromBinaryFiles() begin";
+  PADDLE_ENFORCE_NOT_NULL(
+      input_channel_,
+      platform::errors::PreconditionNotMet(
+          "The input channel is not created, please call CreateChannel "
+          "first."));
+  platform::Timer timeline;
+  timeline.Start();
+  // check the headers here, where the errors can be thrown to the caller
+  uint64_t slot_hash = BinaryDatasetSlotHash(data_feed_desc_);
+  for (auto& filename : files) {
+    std::unique_ptr<FILE, int (*)(FILE*)> fp(fopen(filename.c_str(), "rb"),
+                                             &fclose);
+    PADDLE_ENFORCE_NOT_NULL(fp, platform::errors::Unavailable(
+                                    "Failed to open file %s.", filename));
+    BinaryDatasetHeader header;
+    PADDLE_ENFORCE_EQ(fread(&header, sizeof(header), 1, fp.get()), 1UL,
+                      platform::errors::InvalidArgument(
+                          "File %s is not a binary dataset file.", filename));
+    CheckBinaryDatasetHeader<T>(filename, header, slot_hash);
+  }
+  std::atomic<size_t> file_idx{0};
+  auto load_func = [this, &files, &file_idx]() {
+    size_t fea_num = 0;
+    for (size_t idx = file_idx++; idx < files.size(); idx = file_idx++) {
+      const std::string& filename = files[idx];
+      int fd = open(filename.c_str(), O_RDONLY);
+      PADDLE_ENFORCE_GE(fd, 0, platform::errors::Unavailable(
+                                   "Failed to open file %s.", filename));
+      struct stat st;
+      PADDLE_ENFORCE_EQ(
+          fstat(fd, &st), 0,
+          platform::errors::Unavailable("Failed to stat file %s.", filename));
+      size_t length = static_cast<size_t>(st.st_size);
+      PADDLE_ENFORCE_GE(length, sizeof(BinaryDatasetHeader),
+                        platform::errors::InvalidArgument(
+                            "File %s is not a binary dataset file.", filename));
+      void* addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      PADDLE_ENFORCE_NE(
+          addr, MAP_FAILED,
+          platform::errors::Unavailable("Failed to mmap file %s.", filename));
+      madvise(addr, length, MADV_SEQUENTIAL);
+      BinaryArchive ar;
+      ar.SetReadBuffer(static_cast<char*>(addr), length,
+                       [length](char* p) { munmap(p, length); });
+
+      // the header was checked before loading
+      BinaryDatasetHeader header;
+      ar.Read(&header, sizeof(header));
+
+      std::vector<T> records;
+      size_t left = header.record_num;
+      while (left > 0) {
+        size_t n = std::min(left, static_cast<size_t>(OBJPOOL_BLOCK_SIZE));
+        GetBinaryRecords(&records, n);
+        for (auto& r : records) {
+          fea_num += DeserializeBinaryRecord(&ar, &r);
+        }
+        input_channel_->Write(std::move(records));
+        records.clear();
+        left -= n;
+      }
+      PADDLE_ENFORCE_EQ(ar.Cursor() == ar.Finish(), true,
+                        platform::errors::InvalidArgument(
+                            "File %s has trailing bytes.", filename));
+    }
+    STAT_ADD(STAT_total_feasign_num_in_mem, fea_num);
+    std::lock_guard<std::mutex> flock(mutex_for_fea_num_);
+    total_fea_num_ += fea_num;
+  };
+  std::vector<std::thread> load_threads;
+  for (int64_t i = 0; i < thread_num_; ++i) {
+    load_threads.push_back(std::thread(load_func));
+  }
+  for (std::thread& t : load_threads) {
+    t.join();
+  }
+  input_channel_->Close();
+  int64_t in_chan_size = input_channel_->Size();
+  input_channel_->SetBlockSize(in_chan_size / thread_num_ + 1);
+
+  timeline.Pause();
+  VLOG(3) << "DatasetImpl<T>::LoadFromBinaryFiles() end"
+          << ", memory data size=" << input_channel_->Size()
+          << ", cost time=" << timeline.ElapsedSec() << " seconds";
+#else
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "LoadFromBinaryFiles is only supported on Linux."));
+#endif
+}
+
 // release memory data
 template <typename T>
 void DatasetImpl<T>::ReleaseMemory() {
@@ -651,22 +993,39 @@ void MultiSlotDataset::GlobalShuffle(int thread_num) {
   auto fleet_ptr = framework::FleetWrapper::GetInstance();
 #endif
 
-  if (!input_channel_ || input_channel_->Size() == 0) {
-    VLOG(3) << "MultiSlotDataset::GlobalShuffle() end, no data to shuffle";
-    return;
-  }
+  // If PreLoadIntoMemory is still running, the records are shuffled while
+  // they are loaded, and the input channel is closed when loading is done.
+  bool streaming = false;
+  for (auto& t : preload_threads_) {
+    streaming |= t.joinable();
+  }
+  std::thread preload_waiter;
+  if (streaming) {
+    VLOG(3) << "MultiSlotDataset::GlobalShuffle() streams the preloading data";
+    preload_waiter = std::thread([this] {
+      for (std::thread& t : this->preload_threads_) {
+        t.join();
+      }
+      this->input_channel_->Close();
+    });
+  } else {
+    if (!input_channel_ || input_channel_->Size() == 0) {
+      VLOG(3) << "MultiSlotDataset::GlobalShuffle() end, no data to shuffle";
+      return;
+    }
 
-  // local shuffle
-  input_channel_->Close();
-  std::vector<Record> data;
-  input_channel_->ReadAll(data);
-  std::shuffle(data.begin(), data.end(), fleet_ptr->LocalRandomEngine());
-  input_channel_->Open();
-  input_channel_->Write(std::move(data));
-  data.clear();
-  data.shrink_to_fit();
+    // local shuffle
+    input_channel_->Close();
+    std::vector<Record> data;
+    input_channel_->ReadAll(data);
+    std::shuffle(data.begin(), data.end(), fleet_ptr->LocalRandomEngine());
+    input_channel_->Open();
+    input_channel_->Write(std::move(data));
+    data.clear();
+    data.shrink_to_fit();
 
-  input_channel_->Close();
+    input_channel_->Close();
+  }
   input_channel_->SetBlockSize(fleet_send_batch_size_);
   VLOG(3) << "MultiSlotDataset::GlobalShuffle() input_channel_ size "
           << input_channel_->Size();
@@ -683,7 +1042,7 @@ void MultiSlotDataset::GlobalShuffle(int thread_num) {
     }
   };
 
-  auto global_shuffle_func = [this, get_client_id]() {
+  auto global_shuffle_func = [this, get_client_id, streaming]() {
 #ifdef PADDLE_WITH_PSCORE
     auto fleet_ptr = distributed::FleetWrapper::GetInstance();
 #else
@@ -691,11 +1050,22 @@ void MultiSlotDataset::GlobalShuffle(int thread_num) {
 #endif
     // auto fleet_ptr = framework::FleetWrapper::GetInstance();
     std::vector<Record> data;
+    std::vector<Record> local_data;
+    // The sends of the following batches are issued before the previous
+    // ones finish, at most FLAGS_global_shuffle_max_inflight_batches batches.
+    std::deque<std::vector<std::future<int32_t>>> inflight_status;
     while (this->input_channel_->Read(data)) {
+      if (streaming) {
+        std::shuffle(data.begin(), data.end(), fleet_ptr->LocalRandomEngine());
+      }
       std::vector<paddle::framework::BinaryArchive> ars(this->trainer_num_);
       for (auto& t : data) {
         auto client_id = get_client_id(t);
-        ars[client_id] << t;
+        if (static_cast<int>(client_id) == this->trainer_id_) {
+          local_data.push_back(std::move(t));
+        } else {
+          ars[client_id] << t;
+        }
       }
       std::vector<std::future<int32_t>> total_status;
       std::vector<int> send_index(this->trainer_num_);
@@ -710,11 +1080,21 @@ void MultiSlotDataset::GlobalShuffle(int thread_num) {
           continue;
         }
         std::string msg(ars[i].Buffer(), ars[i].Length());
-        auto ret = fleet_ptr->SendClientToClientMsg(0, i, msg);
+        auto ret = this->SendToClient(i, msg);
         total_status.push_back(std::move(ret));
       }
-      for (auto& t : total_status) {
-        t.wait();
+      // the records of this worker go to the output channels directly
+      if (!local_data.empty()) {
+        this->PutToOutputChannel(&local_data);
+      }
+      inflight_status.push_back(std::move(total_status));
+      while (inflight_status.size() >
+             static_cast<size_t>(
+                 std::max(FLAGS_global_shuffle_max_inflight_batches, 1))) {
+        for (auto& t : inflight_status.front()) {
+          if (t.valid()) t.wait();
+        }
+        inflight_status.pop_front();
       }
       ars.clear();
       ars.shrink_to_fit();
@@ -727,6 +1107,11 @@ void MultiSlotDataset::GlobalShuffle(int thread_num) {
         sleep(this->fleet_send_sleep_seconds_);
       }
     }
+    for (auto& status : inflight_status) {
+      for (auto& t : status) {
+        if (t.valid()) t.wait();
+      }
+    }
   };
 
   std::vector<std::thread> global_shuffle_threads;
@@ -740,6 +1125,9 @@ void MultiSlotDataset::GlobalShuffle(int thread_num) {
   for (std::thread& t : global_shuffle_threads) {
     t.join();
   }
+  if (preload_waiter.joinable()) {
+    preload_waiter.join();
+  }
   global_shuffle_threads.clear();
   global_shuffle_threads.shrink_to_fit();
   input_channel_->Clear();
@@ -902,6 +1290,7 @@ void DatasetImpl<T>::CreateReaders() {
   }
   VLOG(3) << "data feed class name: " << data_feed_desc_.name();
   int channel_idx = 0;
+  auto file_prefetcher = CreateFilePrefetcher();
   for (int i = 0; i < thread_num_; ++i) {
     readers_.push_back(DataFeedFactory::CreateDataFeed(data_feed_desc_.name()));
     readers_[i]->Init(data_feed_desc_);
@@ -909,6 +1298,7 @@ void DatasetImpl<T>::CreateReaders() {
     readers_[i]->SetThreadNum(thread_num_);
     readers_[i]->SetFileListMutex(&mutex_for_pick_file_);
     readers_[i]->SetFileListIndex(&file_idx_);
+    readers_[i]->SetFilePrefetcher(file_prefetcher);
     readers_[i]->SetFeaNumMutex(&mutex_for_fea_num_);
     readers_[i]->SetFeaNum(&total_fea_num_);
     readers_[i]->SetFileList(filelist_);
@@ -972,6 +1362,7 @@ void DatasetImpl<T>::CreatePreLoadReaders() {
   CHECK(preload_thread_num_ > 0) << "thread num should > 0";
   CHECK(input_channel_ != nullptr);
   preload_readers_.clear();
+  auto file_prefetcher = CreateFilePrefetcher();
   for (int i = 0; i < preload_thread_num_; ++i) {
     preload_readers_.push_back(
         DataFeedFactory::CreateDataFeed(data_feed_desc_.name()));
@@ -980,6 +1371,7 @@ void DatasetImpl<T>::CreatePreLoadReaders() {
     preload_readers_[i]->SetThreadNum(preload_thread_num_);
     preload_readers_[i]->SetFileListMutex(&mutex_for_pick_file_);
     preload_readers_[i]->SetFileListIndex(&file_idx_);
+    preload_readers_[i]->SetFilePrefetcher(file_prefetcher);
     preload_readers_[i]->SetFileList(filelist_);
     preload_readers_[i]->SetFeaNumMutex(&mutex_for_fea_num_);
     preload_readers_[i]->SetFeaNum(&total_fea_num_);
@@ -1049,8 +1441,22 @@ int MultiSlotDataset::ReceiveFromClient(int msg_type, int client_id,
     data.push_back(ar.Get<Record>());
   }
   CHECK(ar.Cursor() == ar.Finish());
+  PutToOutputChannel(&data);
+#endif
+  return 0;
+}
 
+std::future<int32_t> MultiSlotDataset::SendToClient(int client_id,
+                                                   const std::string& msg) {
+#ifdef PADDLE_WITH_PSCORE
+  auto fleet_ptr = distributed::FleetWrapper::GetInstance();
+#else
   auto fleet_ptr = framework::FleetWrapper::GetInstance();
+#endif
+  return fleet_ptr->SendClientToClientMsg(0, client_id, msg);
+}
+
+void MultiSlotDataset::PutToOutputChannel(std::vector<Record>* data) {
   // not use random because it doesn't perform well here.
   // to make sure each channel get data equally, we just put data to
   // channel one by one.
@@ -1062,12 +1468,10 @@ int MultiSlotDataset::ReceiveFromClient(int msg_type, int client_id,
   }
   index = index % channel_num_;
   VLOG(3) << "ramdom index=" << index;
-  multi_output_channel_[index]->Write(std::move(data));
+  multi_output_channel_[index]->Write(std::move(*data));
 
-  data.clear();
-  data.shrink_to_fit();
-#endif
-  return 0;
+  data->clear();
+  data->shrink_to_fit();
 }
 
 // explicit instantiation
@@ -1628,6 +2032,7 @@ template class DatasetImpl<SlotRecord>;
 void SlotRecordDataset::CreateChannel() {
   if (input_channel_ == nullptr) {
     input_channel_ = paddle::framework::MakeChannel<SlotRecord>();
+    input_channel_->SetShardNum(FLAGS_dataset_input_channel_shard_num);
   }
 }
 void SlotRecordDataset::CreateReaders() {
@@ -1645,6 +2050,7 @@ void SlotRecordDataset::CreateReaders() {
     return;
   }
   VLOG(3) << "data feed class name: " << data_feed_desc_.name();
+  auto file_prefetcher = CreateFilePrefetcher();
   for (int i = 0; i < thread_num_; ++i) {
     readers_.push_back(DataFeedFactory::CreateDataFeed(data_feed_desc_.name()));
     readers_[i]->Init(data_feed_desc_);
@@ -1652,6 +2058,7 @@ void SlotRecordDataset::CreateReaders() {
     readers_[i]->SetThreadNum(thread_num_);
     readers_[i]->SetFileListMutex(&mutex_for_pick_file_);
     readers_[i]->SetFileListIndex(&file_idx_);
+    readers_[i]->SetFilePrefetcher(file_prefetcher);
     readers_[i]->SetFeaNumMutex(&mutex_for_fea_num_);
     readers_[i]->SetFeaNum(&total_fea_num_);
     readers_[i]->SetFileList(filelist_);
@@ -16,6 +16,7 @@
 
 #include <ThreadPool.h>
 #include <fstream>
+#include <future>  // NOLINT
 #include <memory>
 #include <mutex>  // NOLINT
 #include <set>
@@ -61,6 +62,8 @@ class Dataset {
   virtual void SetThreadNum(int thread_num) = 0;
   // set workers' num
   virtual void SetTrainerNum(int trainer_num) = 0;
+  // set the index of this worker, -1 (default) if unknown
+  virtual void SetTrainerId(int trainer_id) = 0;
   // set fleet send batch size
   virtual void SetFleetSendBatchSize(int64_t size) = 0;
   virtual void ReleaseMemoryFun() = 0;
@@ -116,6 +119,12 @@ class Dataset {
   virtual void PreLoadIntoMemory() = 0;
   // wait async load done
   virtual void WaitPreLoadDone() = 0;
+  // save the instances in memory, loaded or shuffled, into binary files of
+  // path_prefix, which can be loaded into memory by LoadFromBinaryFiles
+  // without parsing
+  virtual void SaveIntoBinaryFiles(const std::string& path_prefix) = 0;
+  // load the binary files saved by SaveIntoBinaryFiles into memory
+  virtual void LoadFromBinaryFiles(const std::vector<std::string>& files) = 0;
   // release all memory data
   virtual void ReleaseMemory() = 0;
   // local shuffle data
@@ -179,6 +188,7 @@ class DatasetImpl : public Dataset {
   virtual void ReleaseMemoryFun();
   virtual void SetThreadNum(int thread_num);
   virtual void SetTrainerNum(int trainer_num);
+  virtual void SetTrainerId(int trainer_id);
   virtual void SetFleetSendBatchSize(int64_t size);
   virtual void SetHdfsConfig(const std::string& fs_name,
                              const std::string& fs_ugi);
@@ -218,6 +228,8 @@ class DatasetImpl : public Dataset {
   virtual void LoadIntoMemory();
   virtual void PreLoadIntoMemory();
   virtual void WaitPreLoadDone();
+  virtual void SaveIntoBinaryFiles(const std::string& path_prefix);
+  virtual void LoadFromBinaryFiles(const std::vector<std::string>& files);
   virtual void ReleaseMemory();
   virtual void LocalShuffle();
   virtual void GlobalShuffle(int thread_num = -1) {}
@@ -293,6 +305,7 @@ class DatasetImpl : public Dataset {
   int pull_sparse_to_local_thread_num_;
   paddle::framework::DataFeedDesc data_feed_desc_;
   int trainer_num_;
+  int trainer_id_;
   std::vector<std::string> filelist_;
   size_t file_idx_;
   uint64_t total_fea_num_;
@@ -363,6 +376,11 @@ class MultiSlotDataset : public DatasetImpl<Record> {
  protected:
   virtual int ReceiveFromClient(int msg_type, int client_id,
                                 const std::string& msg);
+  // send the serialized records of another trainer in GlobalShuffle
+  virtual std::future<int32_t> SendToClient(int client_id,
+                                            const std::string& msg);
+  // put the shuffled records into one of the output channels in turn
+  void PutToOutputChannel(std::vector<Record>* data);
 };
 class SlotRecordDataset : public DatasetImpl<SlotRecord> {
  public:
@@ -0,0 +1,206 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/data_set.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+
+DECLARE_int32(global_shuffle_max_inflight_batches);
+
+namespace paddle {
+namespace framework {
+
+// A trainer of GlobalShuffle whose messages go to the dataset of another
+// trainer in the same process instead of the fleet.
+class LocalShuffleDataset : public MultiSlotDataset {
+ public:
+  void SetPeer(LocalShuffleDataset* peer) { peer_ = peer; }
+
+  int max_inflight() const { return max_inflight_; }
+
+  bool sent_while_loading() const { return sent_while_loading_; }
+
+  // Writes the records into the input channel from thread_num threads, a
+  // small block at a time, like the readers started by PreLoadIntoMemory,
+  // so that GlobalShuffle streams them while they are loaded.
+  void PreLoad(std::vector<Record> records, int thread_num) {
+    auto all = std::make_shared<std::vector<Record>>(std::move(records));
+    const size_t kBlockSize = 16;
+    loading_threads_ = thread_num;
+    for (int i = 0; i < thread_num; ++i) {
+      preload_threads_.emplace_back([this, all, i, thread_num, kBlockSize] {
+        for (size_t begin = i * kBlockSize; begin < all->size();
+             begin += thread_num * kBlockSize) {
+          size_t end = std::min(begin + kBlockSize, all->size());
+          std::vector<Record> block(all->begin() + begin,
+                                    all->begin() + end);
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          input_channel_->Write(std::move(block));
+        }
+        --loading_threads_;
+      });
+    }
+  }
+
+ protected:
+  std::future<int32_t> SendToClient(int client_id,
+                                    const std::string& msg) override {
+    EXPECT_NE(client_id, trainer_id_);
+    if (loading_threads_ > 0) {
+      sent_while_loading_ = true;
+    }
+    int inflight = ++inflight_;
+    int max_inflight = max_inflight_;
+    while (inflight > max_inflight &&
+           !max_inflight_.compare_exchange_weak(max_inflight, inflight)) {
+    }
+    return std::async(std::launch::async, [this, msg]() -> int32_t {
+      // a slow network keeps the sends in flight
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      int32_t ret = peer_->ReceiveFromClient(0, trainer_id_, msg);
+      --inflight_;
+      return ret;
+    });
+  }
+
+ private:
+  LocalShuffleDataset* peer_ = nullptr;
+  std::atomic<int> inflight_{0};
+  std::atomic<int> max_inflight_{0};
+  std::atomic<int> loading_threads_{0};
+  std::atomic<bool> sent_while_loading_{false};
+};
+
+// Counts the records in the output channels of the datasets by ins_id.
+static std::map<std::string, int> ReceivedRecords(
+    LocalShuffleDataset* datasets, int trainer_num) {
+  std::map<std::string, int> received;
+  for (int t = 0; t < trainer_num; ++t) {
+    for (auto& chan : datasets[t].GetMultiOutputChannel()) {
+      std::vector<Record> records;
+      chan->Close();
+      chan->ReadAll(records);
+      for (auto& record : records) {
+        received[record.ins_id_]++;
+      }
+    }
+  }
+  return received;
+}
+
+TEST(MultiSlotDataset, GlobalShuffleTwoTrainers) {
+  const int kTrainerNum = 2;
+  const int kInsNum = 2000;
+  const int kMaxInflight = 2;
+  FLAGS_global_shuffle_max_inflight_batches = kMaxInflight;
+
+  LocalShuffleDataset datasets[kTrainerNum];
+  for (int t = 0; t < kTrainerNum; ++t) {
+    auto& dataset = datasets[t];
+    dataset.SetPeer(&datasets[1 - t]);
+    dataset.SetTrainerNum(kTrainerNum);
+    dataset.SetTrainerId(t);
+    dataset.SetThreadNum(1);
+    dataset.SetChannelNum(2);
+    dataset.SetFleetSendBatchSize(16);
+    dataset.CreateChannel();
+    std::vector<Record> records(kInsNum);
+    for (int i = 0; i < kInsNum; ++i) {
+      records[i].ins_id_ = std::to_string(t) + "_" + std::to_string(i);
+    }
+    dataset.GetInputChannelRef()->Write(std::move(records));
+  }
+
+  std::vector<std::thread> trainers;
+  for (int t = 0; t < kTrainerNum; ++t) {
+    trainers.emplace_back([&datasets, t] { datasets[t].GlobalShuffle(); });
+  }
+  for (auto& trainer : trainers) {
+    trainer.join();
+  }
+
+  for (int t = 0; t < kTrainerNum; ++t) {
+    // one shuffle thread keeps at most kMaxInflight sends in flight before
+    // issuing the next one
+    EXPECT_LE(datasets[t].max_inflight(), kMaxInflight + 1);
+    EXPECT_GE(datasets[t].max_inflight(), 2);
+  }
+  auto received = ReceivedRecords(datasets, kTrainerNum);
+  // every record arrives exactly once
+  ASSERT_EQ(received.size(), static_cast<size_t>(kTrainerNum * kInsNum));
+  for (auto& item : received) {
+    ASSERT_EQ(item.second, 1) << item.first;
+  }
+}
+
+TEST(MultiSlotDataset, GlobalShuffleWhilePreLoading) {
+  const int kTrainerNum = 2;
+  const int kInsNum = 4000;
+  const int kLoadThreadNum = 3;
+  const int kShuffleThreadNum = 2;
+  FLAGS_global_shuffle_max_inflight_batches = 2;
+
+  LocalShuffleDataset datasets[kTrainerNum];
+  for (int t = 0; t < kTrainerNum; ++t) {
+    auto& dataset = datasets[t];
+    dataset.SetPeer(&datasets[1 - t]);
+    dataset.SetTrainerNum(kTrainerNum);
+    dataset.SetTrainerId(t);
+    dataset.SetThreadNum(kShuffleThreadNum);
+    dataset.SetChannelNum(2);
+    dataset.SetFleetSendBatchSize(32);
+    dataset.CreateChannel();
+  }
+  for (int t = 0; t < kTrainerNum; ++t) {
+    std::vector<Record> records(kInsNum);
+    for (int i = 0; i < kInsNum; ++i) {
+      records[i].ins_id_ = std::to_string(t) + "_" + std::to_string(i);
+    }
+    datasets[t].PreLoad(std::move(records), kLoadThreadNum);
+  }
+
+  // the preload threads are still running, so the shuffle streams
+  std::vector<std::thread> trainers;
+  for (int t = 0; t < kTrainerNum; ++t) {
+    trainers.emplace_back([&datasets, t] { datasets[t].GlobalShuffle(); });
+  }
+  for (auto& trainer : trainers) {
+    trainer.join();
+  }
+  for (int t = 0; t < kTrainerNum; ++t) {
+    EXPECT_TRUE(datasets[t].sent_while_loading()) << "trainer " << t;
+    // the preload threads are joined by GlobalShuffle already
+    datasets[t].WaitPreLoadDone();
+  }
+
+  auto received = ReceivedRecords(datasets, kTrainerNum);
+  // no record is lost or duplicated
+  ASSERT_EQ(received.size(), static_cast<size_t>(kTrainerNum * kInsNum));
+  for (auto& item : received) {
+    ASSERT_EQ(item.second, 1) << item.first;
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -31,6 +31,139 @@ void DeviceWorker::SetDataFeed(DataFeed* data_feed) {
   device_reader_ = data_feed;
 }
 
+void DeviceWorker::StartFeedPipeline(int depth) {
+  StopFeedPipeline();
+  feed_pipeline_stat_ = FeedPipelineStat();
+  if (depth <= 0 || need_dump_field_) {
+    return;
+  }
+  // one more buffer for the batch being trained
+  feed_buffers_.resize(depth + 1);
+  feed_buffer_infos_.resize(depth + 1);
+  free_feed_buffers_ = MakeChannel<int>();
+  for (int i = 0; i <= depth; ++i) {
+    if (feed_buffers_[i] == nullptr) {
+      feed_buffers_[i].reset(new Scope());
+      for (auto& name : device_reader_->GetUseSlotAlias()) {
+        feed_buffers_[i]->Var(name)->GetMutable<LoDTensor>();
+      }
+    }
+    free_feed_buffers_->Put(i);
+  }
+  staged_feed_buffers_ = MakeChannel<std::pair<int, int>>(depth);
+  feed_exception_ = nullptr;
+  feed_thread_ = std::thread(&DeviceWorker::StageFeedBatches, this);
+}
+
+void DeviceWorker::StageFeedBatches() {
+  platform::Timer timeline;
+  int buffer_id = 0;
+  try {
+    while (free_feed_buffers_->Get(buffer_id)) {
+      Scope* scope = feed_buffers_[buffer_id].get();
+      device_reader_->AssignFeedVar(*scope);
+      timeline.Start();
+      int batch_size = device_reader_->Next();
+      timeline.Pause();
+      feed_pipeline_stat_.read_sec += timeline.ElapsedSec();
+      if (batch_size <= 0) {
+        break;
+      }
+      auto& info = feed_buffer_infos_[buffer_id];
+      info.batch_size = device_reader_->GetCurBatchSize();
+      info.ins_ids = device_reader_->GetInsIdVec();
+      timeline.Start();
+      StageBatch(scope, buffer_id);
+      timeline.Pause();
+      feed_pipeline_stat_.stage_sec += timeline.ElapsedSec();
+      if (!staged_feed_buffers_->Put(std::make_pair(buffer_id, batch_size))) {
+        break;
+      }
+    }
+  } catch (...) {
+    feed_exception_ = std::current_exception();
+  }
+  staged_feed_buffers_->Close();
+}
+
+int DeviceWorker::NextBatch() {
+  if (!feed_thread_.joinable()) {
+    return device_reader_->Next();
+  }
+  if (cur_feed_buffer_ >= 0) {
+    free_feed_buffers_->Put(cur_feed_buffer_);
+    cur_feed_buffer_ = -1;
+  }
+  platform::Timer timeline;
+  timeline.Start();
+  std::pair<int, int> staged;
+  bool ok = staged_feed_buffers_->Get(staged);
+  timeline.Pause();
+  feed_pipeline_stat_.wait_sec += timeline.ElapsedSec();
+  if (!ok) {
+    StopFeedPipeline();
+    return 0;
+  }
+  cur_feed_buffer_ = staged.first;
+  Scope* scope = feed_buffers_[cur_feed_buffer_].get();
+  for (auto& name : device_reader_->GetUseSlotAlias()) {
+    Variable* var = thread_scope_->FindVar(name);
+    if (var == nullptr) {
+      continue;
+    }
+    auto& src = scope->FindVar(name)->Get<LoDTensor>();
+    auto* dst = var->GetMutable<LoDTensor>();
+    dst->ShareDataWith(src);
+    dst->set_lod(src.lod());
+  }
+  ++feed_pipeline_stat_.batch_num;
+  return staged.second;
+}
+
+const std::vector<std::string>& DeviceWorker::CurBatchInsIds() const {
+  if (cur_feed_buffer_ < 0) {
+    return device_reader_->GetInsIdVec();
+  }
+  return feed_buffer_infos_[cur_feed_buffer_].ins_ids;
+}
+
+int DeviceWorker::CurBatchSize() const {
+  if (cur_feed_buffer_ < 0) {
+    return device_reader_->GetCurBatchSize();
+  }
+  return feed_buffer_infos_[cur_feed_buffer_].batch_size;
+}
+
+void DeviceWorker::JoinFeedThread() {
+  if (!feed_thread_.joinable()) {
+    return;
+  }
+  free_feed_buffers_->Close();
+  staged_feed_buffers_->Close();
+  feed_thread_.join();
+  cur_feed_buffer_ = -1;
+  // bind the DataFeed to thread_scope_ again
+  for (auto& name : device_reader_->GetUseSlotAlias()) {
+    device_reader_->AddFeedVar(thread_scope_->FindVar(name), name);
+  }
+}
+
+void DeviceWorker::StopFeedPipeline() {
+  if (!feed_thread_.joinable()) {
+    return;
+  }
+  JoinFeedThread();
+  VLOG(3) << "feed pipeline: " << feed_pipeline_stat_.batch_num
+          << " batches, read " << feed_pipeline_stat_.read_sec
+          << " seconds, stage " << feed_pipeline_stat_.stage_sec
+          << " seconds, wait " << feed_pipeline_stat_.wait_sec << " seconds";
+  if (feed_exception_ != nullptr) {
+    auto e = feed_exception_;
+    feed_exception_ = nullptr;
+    std::rethrow_exception(e);
+  }
+}
+
 template <typename T>
 std::string PrintLodTensorType(Tensor* tensor, int64_t start, int64_t end) {
   auto count = tensor->numel();
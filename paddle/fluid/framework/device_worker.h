@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 
 #include <atomic>
+#include <exception>
 #include <fstream>
 #include <map>
 #include <memory>
@@ -150,6 +151,17 @@ class PullDenseWorker {
   std::vector<Scope*> thread_scopes_;
 };
 
+// The time spent in each stage of the pipelined feed of a DeviceWorker.
+struct FeedPipelineStat {
+  int64_t batch_num = 0;
+  // DataFeed::Next, in the staging thread
+  double read_sec = 0;
+  // DeviceWorker::StageBatch, in the staging thread
+  double stage_sec = 0;
+  // waiting for the staged batches, in the training thread
+  double wait_sec = 0;
+};
+
 // should incorporate different type of device
 class DeviceWorker {
  public:
@@ -203,12 +215,45 @@ class DeviceWorker {
     dev_ctx_ = dev_ctx;
   }
   virtual Scope* GetThreadScope() { return thread_scope_; }
+  const FeedPipelineStat& feed_pipeline_stat() const {
+    return feed_pipeline_stat_;
+  }
   DataFeed* device_reader_ = nullptr;
 
  protected:
   virtual void DumpParam(const Scope& scope, const int batch_id);
   virtual void DumpField(const Scope& scope, int dump_mode,
                          int dump_interval = 10000);
+  // The pipelined feed. If depth > 0, a thread reads up to depth batches
+  // ahead into staging scopes, and calls StageBatch on each of them, while
+  // the ops of the current batch run. NextBatch shares the tensors of the
+  // next staged batch with the feed variables of thread_scope_, and returns
+  // its size like DataFeed::Next, which it just calls if depth is 0.
+  // The fields of the DataFeed other than the feed variables, like the ins
+  // ids, belong to the batches being read, so the dump of fields is not
+  // pipelined.
+  void StartFeedPipeline(int depth);
+  int NextBatch();
+  void StopFeedPipeline();
+  // The ins ids and the size of the batch returned by NextBatch, which the
+  // DataFeed no longer holds when the feed is pipelined.
+  const std::vector<std::string>& CurBatchInsIds() const;
+  int CurBatchSize() const;
+  // Called in the staging thread after a batch is read into scope, which is
+  // the staging scope of index buffer_id.
+  virtual void StageBatch(Scope* scope, int buffer_id) {}
+  // Stops the staging thread when TrainFiles leaves by an exception, while
+  // the members StageBatch reads are still alive. StopFeedPipeline should
+  // still be called on the normal path, to get the errors of the thread.
+  class FeedPipelineGuard {
+   public:
+    explicit FeedPipelineGuard(DeviceWorker* worker) : worker_(worker) {}
+    ~FeedPipelineGuard() { worker_->JoinFeedThread(); }
+
+   private:
+    DISABLE_COPY_AND_ASSIGN(FeedPipelineGuard);
+    DeviceWorker* worker_;
+  };
   Scope* root_scope_ = nullptr;
   Scope* thread_scope_;
   paddle::platform::Place place_;
@@ -230,6 +275,29 @@ class DeviceWorker {
   int dump_interval_ = 10000;
   ChannelWriter<std::string> writer_;
   platform::DeviceContext* dev_ctx_ = nullptr;
+
+  // the staging scope of the batch returned by NextBatch, -1 if the feed is
+  // not pipelined
+  int cur_feed_buffer_ = -1;
+  FeedPipelineStat feed_pipeline_stat_;
+
+ private:
+  void StageFeedBatches();
+  void JoinFeedThread();
+
+  // the fields of the DataFeed read with each staged batch
+  struct StagedBatchInfo {
+    int batch_size = 0;
+    std::vector<std::string> ins_ids;
+  };
+
+  std::vector<std::unique_ptr<Scope>> feed_buffers_;
+  std::vector<StagedBatchInfo> feed_buffer_infos_;
+  // (buffer id, batch size) of the staged batches
+  std::shared_ptr<ChannelObject<std::pair<int, int>>> staged_feed_buffers_;
+  std::shared_ptr<ChannelObject<int>> free_feed_buffers_;
+  std::thread feed_thread_;
+  std::exception_ptr feed_exception_;
 };
 
 class CPUWorkerBase : public DeviceWorker {
@@ -288,6 +356,8 @@ class DownpourWorker : public HogwildWorker {
  protected:
   std::shared_ptr<paddle::framework::FleetWrapper> fleet_ptr_;
   std::shared_ptr<paddle::framework::PullDenseWorker> pull_dense_worker_;
+  // pulls the sparse values of the staged batch ahead of its training
+  void StageBatch(Scope* scope, int buffer_id) override;
   void FillSparseValue(size_t table_id);
   void PushGradients();
   void CollectLabelInfo(size_t table_id);
@@ -309,6 +379,12 @@ class DownpourWorker : public HogwildWorker {
   // feasign embedding
   std::map<uint64_t, std::vector<std::vector<float>>> feature_values_;
   std::map<uint64_t, std::vector<std::string>> sparse_value_names_;
+  // features_ and feature_values_ of each staging scope, when the sparse
+  // pull is staged with the feed
+  bool stage_sparse_pull_ = false;
+  std::vector<std::map<uint64_t, std::vector<uint64_t>>> staged_features_;
+  std::vector<std::map<uint64_t, std::vector<std::vector<float>>>>
+      staged_feature_values_;
   // adjust ins weight
   AdjustInsWeightConfig adjust_ins_weight_config_;
   // check nan and inf during training
@@ -0,0 +1,173 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/device_worker.h"
+
+namespace paddle {
+namespace framework {
+
+// Feeds batch i of i + 1 instances of value i into slot "x", with the ins
+// ids "ins_i".
+class CountingDataFeed : public DataFeed {
+ public:
+  explicit CountingDataFeed(int batch_num) : batch_num_(batch_num) {
+    use_slots_ = {"x"};
+    feed_vec_.resize(1);
+    finish_init_ = true;
+  }
+  void Init(const DataFeedDesc& data_feed_desc) override {}
+  bool Start() override {
+    next_batch_ = 0;
+    return true;
+  }
+  int Next() override {
+    if (next_batch_ >= batch_num_) {
+      return 0;
+    }
+    int batch = next_batch_++;
+    batch_size_ = batch + 1;
+    feed_vec_[0]->Resize(phi::make_ddim({batch_size_, 1}));
+    auto* data = feed_vec_[0]->mutable_data<int64_t>(platform::CPUPlace());
+    for (int i = 0; i < batch_size_; ++i) {
+      data[i] = batch;
+    }
+    ins_id_vec_.assign(1, "ins_" + std::to_string(batch));
+    return batch_size_;
+  }
+
+ private:
+  int batch_num_;
+  int next_batch_ = 0;
+};
+
+class FeedPipelineWorker : public DeviceWorker {
+ public:
+  void Initialize(const TrainerDesc& desc) override {}
+  void SetDeviceIndex(int tid) override {}
+  void PrintFetchVars() override {}
+  void TrainFilesWithProfiler() override {}
+  void CreateDeviceResource(const ProgramDesc& main_prog) override {}
+  void BindingDataFeedMemory() override {
+    device_reader_->AddFeedVar(thread_scope_->Var("x"), "x");
+  }
+  void TrainFiles() override {
+    device_reader_->Start();
+    StartFeedPipeline(depth_);
+    FeedPipelineGuard feed_pipeline_guard(this);
+    int cur_batch;
+    while ((cur_batch = NextBatch()) > 0) {
+      auto& x = thread_scope_->FindVar("x")->Get<LoDTensor>();
+      EXPECT_EQ(x.numel(), cur_batch);
+      EXPECT_EQ(CurBatchSize(), cur_batch);
+      EXPECT_EQ(CurBatchInsIds().size(), 1UL);
+      values_.push_back(x.data<int64_t>()[0]);
+      ins_ids_.push_back(CurBatchInsIds()[0]);
+      if (static_cast<int>(values_.size()) == fail_at_batch_) {
+        PADDLE_THROW(platform::errors::Fatal("Fails in the training."));
+      }
+    }
+    StopFeedPipeline();
+  }
+
+  void SetThreadScope(Scope* scope) { thread_scope_ = scope; }
+
+  int depth_ = 0;
+  int fail_at_batch_ = -1;
+  int stage_fail_at_batch_ = -1;
+  std::vector<int64_t> values_;
+  std::vector<std::string> ins_ids_;
+
+ protected:
+  void StageBatch(Scope* scope, int buffer_id) override {
+    // the members of the derived worker must be alive while staging
+    ++staged_num_;
+    if (staged_num_ == stage_fail_at_batch_) {
+      PADDLE_THROW(platform::errors::Fatal("Fails in the staging."));
+    }
+  }
+
+ private:
+  int staged_num_ = 0;
+};
+
+static void CheckBatches(const FeedPipelineWorker& worker, int batch_num) {
+  ASSERT_EQ(worker.values_.size(), static_cast<size_t>(batch_num));
+  for (int i = 0; i < batch_num; ++i) {
+    EXPECT_EQ(worker.values_[i], i);
+    EXPECT_EQ(worker.ins_ids_[i], "ins_" + std::to_string(i));
+  }
+}
+
+TEST(DeviceWorker, FeedPipeline) {
+  const int kBatchNum = 20;
+  for (int depth : {0, 1, 3}) {
+    Scope scope;
+    CountingDataFeed feed(kBatchNum);
+    FeedPipelineWorker worker;
+    worker.depth_ = depth;
+    worker.SetThreadScope(&scope);
+    worker.SetDataFeed(&feed);
+    worker.BindingDataFeedMemory();
+    worker.TrainFiles();
+    CheckBatches(worker, kBatchNum);
+    EXPECT_EQ(worker.feed_pipeline_stat().batch_num,
+              depth > 0 ? kBatchNum : 0);
+
+    // the DataFeed is bound to the thread scope again
+    feed.Start();
+    ASSERT_EQ(feed.Next(), 1);
+    EXPECT_EQ(scope.FindVar("x")->Get<LoDTensor>().numel(), 1);
+  }
+}
+
+TEST(DeviceWorker, FeedPipelineStagingError) {
+  Scope scope;
+  CountingDataFeed feed(20);
+  FeedPipelineWorker worker;
+  worker.depth_ = 2;
+  worker.stage_fail_at_batch_ = 5;
+  worker.SetThreadScope(&scope);
+  worker.SetDataFeed(&feed);
+  worker.BindingDataFeedMemory();
+  // the error is rethrown in the training thread, after the batches staged
+  // before it are trained
+  EXPECT_THROW(worker.TrainFiles(), platform::EnforceNotMet);
+  CheckBatches(worker, 4);
+}
+
+TEST(DeviceWorker, FeedPipelineTrainingError) {
+  Scope scope;
+  CountingDataFeed feed(20);
+  {
+    FeedPipelineWorker worker;
+    worker.depth_ = 2;
+    worker.fail_at_batch_ = 3;
+    worker.SetThreadScope(&scope);
+    worker.SetDataFeed(&feed);
+    worker.BindingDataFeedMemory();
+    // the staging thread is joined before the worker is destroyed
+    EXPECT_THROW(worker.TrainFiles(), platform::EnforceNotMet);
+    CheckBatches(worker, 3);
+  }
+  feed.Start();
+  ASSERT_EQ(feed.Next(), 1);
+  EXPECT_EQ(scope.FindVar("x")->Get<LoDTensor>().numel(), 1);
+}
+
+}  // namespace framework
+}  // namespace paddle
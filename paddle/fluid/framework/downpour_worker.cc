@@ -31,6 +31,8 @@ class Variable;
 #define _LINUX
 #endif
 
+DECLARE_int32(device_worker_feed_pipeline_depth);
+
 namespace paddle {
 namespace framework {
 void DownpourWorker::Initialize(const TrainerDesc& desc) {
@@ -757,13 +759,62 @@ inline void AddAucMonitor(const Scope* scope, const platform::Place& place) {
 }
 #endif
 
+void DownpourWorker::StageBatch(Scope* scope, int buffer_id) {
+  if (!stage_sparse_pull_) {
+    return;
+  }
+  for (int i = 0; i < param_.program_config(0).pull_sparse_table_id_size();
+       ++i) {
+    uint64_t tid = static_cast<uint64_t>(
+        param_.program_config(0).pull_sparse_table_id(i));
+    TableParameter table;
+    for (auto j : param_.sparse_table()) {
+      if (j.table_id() == tid) {
+        table = j;
+        break;
+      }
+    }
+    // the slots without embedding are skipped by the pull, as they are in
+    // thread_scope_
+    for (auto& name : sparse_value_names_[tid]) {
+      if (scope->FindVar(name) == nullptr &&
+          thread_scope_->FindVar(name) != nullptr) {
+        scope->Var(name);
+      }
+    }
+    fleet_ptr_->PullSparseVarsSync(
+        *scope, tid, sparse_key_names_[tid], &staged_features_[buffer_id][tid],
+        &staged_feature_values_[buffer_id][tid], table.fea_dim(),
+        sparse_value_names_[tid]);
+  }
+}
+
 void DownpourWorker::TrainFiles() {
   VLOG(3) << "Begin to train files";
   platform::SetNumThreads(1);
   device_reader_->Start();
+  int depth = FLAGS_device_worker_feed_pipeline_depth;
+  // The sparse pull is staged only if all the keys are fed, and the tables
+  // are not copied between the batches.
+  stage_sparse_pull_ = depth > 0 && !copy_table_config_.need_copy();
+  const auto& use_slots = device_reader_->GetUseSlotAlias();
+  for (auto& item : sparse_key_names_) {
+    for (auto& name : item.second) {
+      if (std::find(use_slots.begin(), use_slots.end(), name) ==
+          use_slots.end()) {
+        stage_sparse_pull_ = false;
+      }
+    }
+  }
+  if (stage_sparse_pull_) {
+    staged_features_.assign(depth + 1, {});
+    staged_feature_values_.assign(depth + 1, {});
+  }
+  StartFeedPipeline(depth);
+  FeedPipelineGuard feed_pipeline_guard(this);
   int batch_cnt = 0;
   int cur_batch;
-  while ((cur_batch = device_reader_->Next()) > 0) {
+  while ((cur_batch = NextBatch()) > 0) {
     if (copy_table_config_.need_copy()) {
       if (batch_cnt % copy_table_config_.batch_num() == 0) {
         CopySparseTable();
@@ -783,9 +834,15 @@ void DownpourWorker::TrainFiles() {
           break;
         }
       }
-      fleet_ptr_->PullSparseVarsSync(
-          *thread_scope_, tid, sparse_key_names_[tid], &features_[tid],
-          &feature_values_[tid], table.fea_dim(), sparse_value_names_[tid]);
+      if (stage_sparse_pull_ && cur_feed_buffer_ >= 0) {
+        features_[tid].swap(staged_features_[cur_feed_buffer_][tid]);
+        feature_values_[tid].swap(
+            staged_feature_values_[cur_feed_buffer_][tid]);
+      } else {
+        fleet_ptr_->PullSparseVarsSync(
+            *thread_scope_, tid, sparse_key_names_[tid], &features_[tid],
+            &feature_values_[tid], table.fea_dim(), sparse_value_names_[tid]);
+      }
       CollectLabelInfo(i);
       FillSparseValue(i);
       auto nid_iter = std::find(sparse_value_names_[tid].begin(),
@@ -812,8 +869,8 @@ void DownpourWorker::TrainFiles() {
           op->Run(*thread_scope_, place_);
         } catch (std::exception& e) {
           fprintf(stderr, "error message: %s\n", e.what());
-          auto& ins_id_vec = device_reader_->GetInsIdVec();
-          size_t batch_size = device_reader_->GetCurBatchSize();
+          auto& ins_id_vec = CurBatchInsIds();
+          size_t batch_size = CurBatchSize();
           std::string s = "";
           for (auto& ins_id : ins_id_vec) {
             if (s != "") s += ",";
@@ -1006,6 +1063,7 @@ void DownpourWorker::TrainFiles() {
     thread_scope_->DropKids();
     ++batch_cnt;
   }
+  StopFeedPipeline();
   if (need_dump_field_ || need_dump_param_) {
     writer_.Flush();
   }
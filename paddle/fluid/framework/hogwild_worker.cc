@@ -25,6 +25,8 @@ limitations under the License. */
 #include "paddle/fluid/distributed/ps/service/communicator/communicator.h"
 #endif
 
+DECLARE_int32(device_worker_feed_pipeline_depth);
+
 namespace paddle {
 namespace framework {
 
@@ -217,9 +219,11 @@ void HogwildWorker::TrainFiles() {
   int total_ins_num = 0;
   // how to accumulate fetched values here
   device_reader_->Start();
+  StartFeedPipeline(FLAGS_device_worker_feed_pipeline_depth);
+  FeedPipelineGuard feed_pipeline_guard(this);
   int cur_batch;
   int batch_cnt = 0;
-  while ((cur_batch = device_reader_->Next()) > 0) {
+  while ((cur_batch = NextBatch()) > 0) {
     for (auto &op : ops_) {
       bool need_skip = false;
       for (auto t = 0u; t < skip_ops_.size(); ++t) {
@@ -245,6 +249,7 @@ void HogwildWorker::TrainFiles() {
     PrintFetchVars();
     thread_scope_->DropKids();
   }
+  StopFeedPipeline();
   timeline.Pause();
   VLOG(3) << "worker " << thread_id_ << " train cost " << timeline.ElapsedSec()
           << " seconds, ins_num: " << total_ins_num;
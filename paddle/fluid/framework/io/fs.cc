@@ -14,10 +14,15 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/io/fs.h"
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <algorithm>
+#include <future>  // NOLINT
 #include <memory>
+#include <thread>  // NOLINT
 
 #include "glog/logging.h"
+#include "paddle/fluid/framework/channel.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -520,5 +525,143 @@ void fs_mv(const std::string& src, const std::string& dest) {
   }
 }
 
+struct FilePrefetcher::PrefetchedFile {
+  std::shared_ptr<ChannelObject<std::string>> blocks;
+  std::thread thread;
+  // set by the deleter of the pipe, after the command exits
+  int err_no = 0;
+  // false if fs_open_read failed
+  std::future<bool> opened;
+  // the block being read by the stream
+  std::string block;
+  size_t pos = 0;
+};
+
+FilePrefetcher::FilePrefetcher(size_t file_num, size_t block_size,
+                               size_t block_num)
+    : file_num_(file_num),
+      block_size_(std::max(block_size, static_cast<size_t>(1))),
+      block_num_(std::max(block_num, static_cast<size_t>(1))) {}
+
+FilePrefetcher::~FilePrefetcher() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& item : files_) {
+    item.second->blocks->Close();
+  }
+  for (auto& item : files_) {
+    item.second->thread.join();
+  }
+}
+
+void FilePrefetcher::Prefetch(const std::string& path,
+                              const std::string& converter) {
+#if !defined(_WIN32) && !defined(__APPLE__)
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& file = files_[std::make_pair(path, converter)];
+  if (file != nullptr) {
+    return;
+  }
+  file.reset(new PrefetchedFile());
+  file->blocks = MakeChannel<std::string>(block_num_);
+  std::promise<bool> opened;
+  file->opened = opened.get_future();
+  size_t block_size = block_size_;
+  PrefetchedFile* raw_file = file.get();
+  file->thread = std::thread([raw_file, path, converter, block_size](
+      std::promise<bool> opened) {
+    std::shared_ptr<FILE> fp;
+    try {
+      fp = fs_open_read(path, &raw_file->err_no, converter);
+    } catch (...) {
+      fp = nullptr;
+    }
+    opened.set_value(fp != nullptr);
+    if (fp == nullptr) {
+      raw_file->blocks->Close();
+      return;
+    }
+    // only takes effect on regular files, pipes are read sequentially anyway
+    posix_fadvise(fileno(fp.get()), 0, 0, POSIX_FADV_SEQUENTIAL);
+    while (true) {
+      std::string block(block_size, '\0');
+      size_t len = fread(&block[0], 1, block_size, fp.get());
+      if (len == 0) {
+        break;
+      }
+      block.resize(len);
+      // closed by the reader
+      if (!raw_file->blocks->Put(std::move(block))) {
+        break;
+      }
+    }
+    fp = nullptr;
+    raw_file->blocks->Close();
+  }, std::move(opened));
+  VLOG(3) << "Prefetching file[" << path << "]";
+#endif
+}
+
+std::shared_ptr<FILE> FilePrefetcher::Open(const std::string& path,
+                                           int* err_no,
+                                           const std::string& converter) {
+#if !defined(_WIN32) && !defined(__APPLE__)
+  std::unique_ptr<PrefetchedFile> file;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(std::make_pair(path, converter));
+    if (it != files_.end()) {
+      file = std::move(it->second);
+      files_.erase(it);
+    }
+  }
+  if (file != nullptr) {
+    if (file->opened.get()) {
+      cookie_io_functions_t funcs;
+      memset(&funcs, 0, sizeof(funcs));
+      funcs.read = [](void* cookie, char* buf, size_t size) -> ssize_t {
+        auto* file = static_cast<PrefetchedFile*>(cookie);
+        size_t total = 0;
+        while (total < size) {
+          if (file->pos == file->block.size()) {
+            // do not wait for the next block if some bytes are read
+            if (total > 0 || !file->blocks->Get(file->block)) {
+              break;
+            }
+            file->pos = 0;
+          }
+          size_t len = std::min(size - total, file->block.size() - file->pos);
+          memcpy(buf + total, &file->block[file->pos], len);
+          total += len;
+          file->pos += len;
+        }
+        return total;
+      };
+      funcs.close = [](void* cookie) -> int {
+        auto* file = static_cast<PrefetchedFile*>(cookie);
+        // stops the thread if the file is not read to the end
+        file->blocks->Close();
+        file->thread.join();
+        if (file->err_no != 0) {
+          LOG(WARNING) << "Prefetched file is closed with err_no "
+                       << file->err_no;
+        }
+        delete file;
+        return 0;
+      };
+      FILE* fp = fopencookie(file.get(), "r", funcs);
+      if (fp != nullptr) {
+        file.release();
+        return {fp, [](FILE* fp) { fclose(fp); }};
+      }
+      file->blocks->Close();
+    }
+    file->thread.join();
+    // open it again to report the error in the thread of the reader
+    VLOG(3) << "Failed to prefetch file[" << path << "]";
+  }
+#endif
+  return fs_open_read(path, err_no, converter);
+}
+
 }  // end namespace framework
 }  // end namespace paddle
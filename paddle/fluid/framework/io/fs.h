@@ -16,8 +16,11 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "glog/logging.h"
@@ -110,5 +113,43 @@ extern void fs_mkdir(const std::string& path);
 
 extern void fs_mv(const std::string& src, const std::string& dest);
 
+// Reads files in background threads ahead of their readers.
+//
+// A prefetched file is opened by fs_open_read, so the shell command of a
+// pipe starts early, and read into a queue of at most block_num blocks of
+// block_size bytes. Open returns a stream over the queue, so the reader
+// finds the head of the file in memory while the rest keeps being read.
+// The streams only support reading, and are not available on Windows and
+// MacOS, where Open just calls fs_open_read.
+class FilePrefetcher {
+ public:
+  FilePrefetcher(size_t file_num, size_t block_size, size_t block_num);
+
+  // Stops reading the files which are not opened.
+  ~FilePrefetcher();
+
+  // The number of files to read ahead of the one being opened.
+  size_t file_num() const { return file_num_; }
+
+  // Starts reading path in the background, if it is not being read.
+  void Prefetch(const std::string& path, const std::string& converter);
+
+  // Returns the stream of path if it is prefetched, otherwise opens it with
+  // fs_open_read. Each prefetched file is opened only once.
+  std::shared_ptr<FILE> Open(const std::string& path, int* err_no,
+                             const std::string& converter);
+
+ private:
+  struct PrefetchedFile;
+
+  size_t file_num_;
+  size_t block_size_;
+  size_t block_num_;
+  std::mutex mutex_;
+  std::map<std::pair<std::string, std::string>,
+           std::unique_ptr<PrefetchedFile>>
+      files_;
+};
+
 }  // namespace framework
 }  // namespace paddle
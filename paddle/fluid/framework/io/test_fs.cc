@@ -45,3 +45,47 @@ TEST(FS, mv) {
   }
 #endif
 }
+
+TEST(FS, prefetch) {
+#ifdef _LINUX
+  std::string content;
+  for (int i = 0; i < 1000; ++i) {
+    content += std::to_string(i) + "\n";
+  }
+  std::vector<std::string> files = {"prefetch_a.txt", "prefetch_b.txt",
+                                    "prefetch_c.txt"};
+  for (auto& file : files) {
+    std::ofstream out(file);
+    out << content;
+  }
+  {
+    // blocks of 16 bytes, so the readers wait for the thread of each file
+    paddle::framework::FilePrefetcher prefetcher(2, 16, 4);
+    prefetcher.Prefetch(files[0], "");
+    prefetcher.Prefetch(files[1], "");
+    // a file which is not prefetched, and a file which is never opened
+    prefetcher.Prefetch(files[2], "cat");
+    for (auto& file : files) {
+      int err_no = 0;
+      auto fp = prefetcher.Open(file, &err_no, "");
+      ASSERT_NE(fp, nullptr);
+      std::string read;
+      char buf[100];
+      size_t len = 0;
+      while ((len = fread(buf, 1, sizeof(buf), fp.get())) > 0) {
+        read.append(buf, len);
+      }
+      ASSERT_EQ(read, content);
+    }
+    // prefetched files can only be opened once
+    int err_no = 0;
+    auto fp = prefetcher.Open(files[0], &err_no, "");
+    char c = 0;
+    ASSERT_EQ(fread(&c, 1, 1, fp.get()), 1UL);
+    ASSERT_EQ(c, '0');
+  }
+  for (auto& file : files) {
+    paddle::framework::fs_remove(file);
+  }
+#endif
+}
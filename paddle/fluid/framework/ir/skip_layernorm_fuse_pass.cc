@@ -134,6 +134,19 @@ void SkipLayerNormFusePass::ApplyImpl(ir::Graph *graph) const {
       return;
     }
 
+    // The CPU kernel of skip_layernorm does not broadcast Y.
+    bool use_gpu = Has("use_gpu") ? Get<bool>("use_gpu") : true;
+    if (!use_gpu) {
+      auto *x_var = subgraph.at(x)->Var();
+      auto *y_var = subgraph.at(y)->Var();
+      if (x_var == nullptr || y_var == nullptr ||
+          x_var->GetShape() != y_var->GetShape()) {
+        VLOG(3) << "skip_layernorm pass on CPU requires X and Y of "
+                   "elementwise_add with the same shape.";
+        return;
+      }
+    }
+
     VLOG(4) << "handle SkipLayerNorm fuse";
     GET_IR_NODE_FROM_SUBGRAPH(elementwise, elementwise, fused_pattern);
     GET_IR_NODE_FROM_SUBGRAPH(elementwise_out, elementwise_out, fused_pattern);
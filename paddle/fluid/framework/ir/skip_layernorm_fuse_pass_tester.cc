@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/ir/skip_layernorm_fuse_pass.h"
 
 #include <gtest/gtest.h>
+#include <vector>
 #include "paddle/fluid/framework/ir/pass_tester_helper.h"
 #include "paddle/fluid/framework/op_version_registry.h"
 
@@ -57,6 +58,38 @@ TEST(SkipLayerNormFusePass, basic) {
           "The number of fusion nodes does not meet expectations after fuse"));
 }
 
+// Apply the pass to elementwise_add(x, y) + layer_norm and return the
+// number of the fused skip_layernorm ops.
+static int FuseSkipLayerNorm(const std::vector<int64_t>& x_shape,
+                             const std::vector<int64_t>& y_shape,
+                             bool use_gpu) {
+  Layers layers;
+  auto* x = layers.data("x", x_shape);
+  auto* y = layers.data("y", y_shape);
+  auto* elementwise_out = layers.elementwise_add(x, y);
+  auto* scale = layers.data("scale", {x_shape.back()}, true);
+  auto* bias = layers.data("bias", {x_shape.back()}, true);
+  layers.layer_norm(elementwise_out, scale, bias);
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  graph->Set(kEmbEltwiseLayernormPass, new bool(true));
+  graph->Set(kMultiheadMatmulPass, new bool(true));
+  auto pass = PassRegistry::Instance().Get("skip_layernorm_fuse_pass");
+  pass->Set("use_gpu", new bool(use_gpu));
+  graph.reset(pass->Apply(graph.release()));
+  return GetNumOpNodes(graph, "skip_layernorm");
+}
+
+TEST(SkipLayerNormFusePass, cpu_requires_same_shape) {
+  EXPECT_EQ(FuseSkipLayerNorm({2, 128, 768}, {2, 128, 768}, false), 1);
+  EXPECT_EQ(FuseSkipLayerNorm({128, 768}, {128, 768}, false), 1);
+  // the CPU kernel does not broadcast Y
+  EXPECT_EQ(FuseSkipLayerNorm({2, 128, 768}, {768}, false), 0);
+  EXPECT_EQ(FuseSkipLayerNorm({2, 128, 768}, {1, 128, 768}, false), 0);
+  // the shapes are not checked for GPU and TensorRT
+  EXPECT_EQ(FuseSkipLayerNorm({2, 128, 768}, {768}, true), 1);
+}
+
 TEST(SkipLayerNormFusePass, pass_op_version_check) {
   ASSERT_TRUE(
       paddle::framework::compatible::PassVersionCheckerRegistrar::GetInstance()
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/new_executor/interpretercore.h"
+#include <algorithm>
 #include <unordered_set>
 #include "paddle/fluid/framework/details/nan_inf_utils.h"
 #include "paddle/fluid/framework/details/share_tensor_buffer_functor.h"
@@ -31,6 +32,14 @@ PADDLE_DEFINE_EXPORTED_bool(new_executor_use_inplace, true,
 PADDLE_DEFINE_EXPORTED_bool(new_executor_use_local_scope, true,
                             "Use local_scope in new executor(especially used "
                             "in UT), can turn off for better performance");
+PADDLE_DEFINE_EXPORTED_bool(
+    new_executor_use_critical_path_schedule, false,
+    "Schedule ready instructions by the length of their critical path, which "
+    "is estimated from the op costs measured in the first steps");
+PADDLE_DEFINE_EXPORTED_int32(
+    new_executor_cost_profile_steps, 3,
+    "Number of steps used to measure op costs before critical-path "
+    "scheduling takes effect");
 
 DECLARE_bool(check_nan_inf);
 DECLARE_bool(benchmark);
@@ -84,6 +93,9 @@ InterpreterCore::InterpreterCore(const platform::Place& place,
   }
   VLOG(4) << "create_local_scope_ is " << create_local_scope_;
 
+  use_critical_path_schedule_ = FLAGS_new_executor_use_critical_path_schedule;
+  VLOG(4) << "use_critical_path_schedule_ is " << use_critical_path_schedule_;
+
   // prune
 
   // optmize graph pass
@@ -204,6 +216,25 @@ void InterpreterCore::BuildOperatorDependences() {
   }
 }
 
+void InterpreterCore::BuildCriticalPathPriority() {
+  auto op_nums = vec_instruction_.size();
+  std::vector<double> avg_cost(op_nums, 0.);
+  for (size_t i = 0; i < op_nums; ++i) {
+    avg_cost[i] = instr_cost_[i] / profiled_steps_;
+  }
+  instr_priority_ =
+      interpreter::build_critical_path_priority(vec_instruction_, avg_cost);
+  VLOG(4) << "Build critical path priority after " << profiled_steps_
+          << " steps, op_nums: " << op_nums;
+}
+
+void InterpreterCore::SortByPriority(std::vector<size_t>* instr_ids) const {
+  if (instr_priority_.empty() || instr_ids->size() < 2) {
+    return;
+  }
+  interpreter::sort_by_priority(instr_priority_, instr_ids);
+}
+
 void InterpreterCore::Convert(
     std::vector<paddle::framework::OpFuncNode>* op_func_nodes) {
   auto& vec_meta_info = global_scope_->MutableVecMetaInfo();
@@ -523,18 +554,41 @@ void InterpreterCore::ExecuteInstructionList(
 
   exception_holder_.Clear();
 
+  is_profiling_cost_ =
+      use_critical_path_schedule_ && instr_priority_.empty() &&
+      profiled_steps_ < static_cast<size_t>(std::max(
+                            FLAGS_new_executor_cost_profile_steps, 1));
+  if (is_profiling_cost_ && instr_cost_.size() != vec_instr.size()) {
+    instr_cost_.assign(vec_instr.size(), 0.);
+  }
+
+  std::vector<size_t> first_ops;
   for (size_t i = 0; i < dependecy_count_.size(); ++i) {
     if (dependecy_count_[i] == 0) {
-      async_work_queue_->AddTask(vec_instr.at(i).KernelType(), [
-        this, i, atomic_deps = atomic_deps.get(),
-        atomic_var_ref = atomic_var_ref.get()
-      ] { RunInstructionAsync(i, atomic_deps, atomic_var_ref); });
+      first_ops.push_back(i);
     }
   }
+  SortByPriority(&first_ops);
+  for (auto i : first_ops) {
+    async_work_queue_->AddTask(vec_instr.at(i).KernelType(), [
+      this, i, atomic_deps = atomic_deps.get(),
+      atomic_var_ref = atomic_var_ref.get()
+    ] { RunInstructionAsync(i, atomic_deps, atomic_var_ref); });
+  }
 
   auto event_name = main_thread_blocker_.WaitEvent();
   VLOG(1) << "event_name: " << event_name;
 
+  if (is_profiling_cost_ && !exception_holder_.IsCaught()) {
+    is_profiling_cost_ = false;
+    ++profiled_steps_;
+    if (profiled_steps_ >=
+        static_cast<size_t>(
+            std::max(FLAGS_new_executor_cost_profile_steps, 1))) {
+      BuildCriticalPathPriority();
+    }
+  }
+
   if (UNLIKELY(exception_holder_.IsCaught())) {
     VLOG(1) << "Exception caught " << exception_holder_.Type();
     // Graceful exit when the executor encountered a fatal error.
@@ -567,56 +621,77 @@ void InterpreterCore::RunNextInstructions(
 
   if (instr.KernelType() == OpFuncType::kQueueAsync) {
     // move all sync_ops into other threads
+    std::vector<size_t> ready_sync_ops;
     for (auto next_id : next_instr.SyncRunIds()) {
       if (IsReady(next_id)) {
-        async_work_queue_->AddTask(
-            vec_instruction_[next_id].KernelType(),
-            [this, next_id, atomic_deps, atomic_var_ref]() {
-              RunInstructionAsync(next_id, atomic_deps, atomic_var_ref);
-            });
+        ready_sync_ops.push_back(next_id);
       }
     }
+    SortByPriority(&ready_sync_ops);
+    for (auto next_id : ready_sync_ops) {
+      async_work_queue_->AddTask(
+          vec_instruction_[next_id].KernelType(),
+          [this, next_id, atomic_deps, atomic_var_ref]() {
+            RunInstructionAsync(next_id, atomic_deps, atomic_var_ref);
+          });
+    }
     // keep all async_ops running in current thread
+    std::vector<size_t> ready_async_ops;
     for (auto next_id : next_instr.DirectRunIds()) {
       if (IsReady(next_id)) {
-        reserved_next_ops->push(next_id);
+        ready_async_ops.push_back(next_id);
       }
     }
     for (auto next_id : next_instr.EventRunIds()) {
       if (IsReady(next_id)) {
-        reserved_next_ops->push(next_id);
+        ready_async_ops.push_back(next_id);
       }
     }
+    SortByPriority(&ready_async_ops);
+    for (auto next_id : ready_async_ops) {
+      reserved_next_ops->push(next_id);
+    }
   } else {
     // move async_ops into async_thread
+    std::vector<size_t> ready_event_ops;
     for (auto next_id : next_instr.EventRunIds()) {
       if (IsReady(next_id)) {
-        async_work_queue_->AddTask(
-            vec_instruction_[next_id].KernelType(),
-            [this, next_id, atomic_deps, atomic_var_ref] {
-              RunInstructionAsync(next_id, atomic_deps, atomic_var_ref);
-            });
+        ready_event_ops.push_back(next_id);
       }
     }
+    SortByPriority(&ready_event_ops);
+    for (auto next_id : ready_event_ops) {
+      async_work_queue_->AddTask(
+          vec_instruction_[next_id].KernelType(),
+          [this, next_id, atomic_deps, atomic_var_ref] {
+            RunInstructionAsync(next_id, atomic_deps, atomic_var_ref);
+          });
+    }
     auto direct_run_ops = interpreter::merge_vector(next_instr.SyncRunIds(),
                                                     next_instr.DirectRunIds());
-    size_t first_op = 0;
+    std::vector<size_t> ready_direct_ops;
     for (auto next_id : direct_run_ops) {
       if (IsReady(next_id)) {
-        // only keep one op running in current thread
-        if (first_op == 0) {
-          first_op = next_id;
-          continue;
-        }
-        // move rest ops into other threads
-        async_work_queue_->AddTask(
-            vec_instruction_[next_id].KernelType(),
-            [this, next_id, atomic_deps, atomic_var_ref] {
-              RunInstructionAsync(next_id, atomic_deps, atomic_var_ref);
-            });
+        ready_direct_ops.push_back(next_id);
       }
     }
-    if (first_op != 0) reserved_next_ops->push(first_op);
+    if (ready_direct_ops.empty()) {
+      return;
+    }
+    // NOTE: with critical-path scheduling, the op with the longest remaining
+    // path is kept in current thread, otherwise the first ready op is kept.
+    SortByPriority(&ready_direct_ops);
+    // move rest ops into other threads
+    for (size_t i = 1; i < ready_direct_ops.size(); ++i) {
+      auto next_id = ready_direct_ops[i];
+      async_work_queue_->AddTask(
+          vec_instruction_[next_id].KernelType(),
+          [this, next_id, atomic_deps, atomic_var_ref] {
+            RunInstructionAsync(next_id, atomic_deps, atomic_var_ref);
+          });
+    }
+    // only keep one op running in current thread
+    reserved_next_ops->push(ready_direct_ops[0]);
   }
 }
 
@@ -643,7 +718,17 @@ void InterpreterCore::RunInstructionAsync(
     try {
       interpreter::WaitEvent(instr_node, place_);
 
-      RunInstruction(instr_node);
+      if (UNLIKELY(is_profiling_cost_)) {
+        platform::Timer timer;
+        timer.Start();
+        RunInstruction(instr_node);
+        timer.Pause();
+        // NOTE: each instruction runs exactly once per step, so different
+        // threads never write the same slot.
+        instr_cost_[instr_id] += timer.ElapsedMS();
+      } else {
+        RunInstruction(instr_node);
+      }
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
       RecordStreamForGC(instr_node);
@@ -89,6 +89,10 @@ class InterpreterCore {
 
   void BuildSkipShareLoDInfo();
 
+  void BuildCriticalPathPriority();
+
+  void SortByPriority(std::vector<size_t>* instr_ids) const;
+
   void BuildOperatorDependences();
 
   void SetFeedVarsInplaceSkip(const std::vector<std::string>& feed_names);
@@ -124,6 +128,15 @@ class InterpreterCore {
   std::vector<paddle::platform::DeviceEvent> gc_event_;
   bool create_local_scope_{true};
   Scope* local_scope_{nullptr};  // not owned
+
+  // For critical-path scheduling: the host time of each instruction is
+  // accumulated during the first profiled steps, then converted into a
+  // priority (longest cost weighted path to the end of the program).
+  bool use_critical_path_schedule_{false};
+  bool is_profiling_cost_{false};
+  size_t profiled_steps_{0};
+  std::vector<double> instr_cost_;      // ms, indexed by instruction id
+  std::vector<double> instr_priority_;  // empty until profiling finishes
 };
 }  // namespace framework
 }  // namespace paddle
@@ -28,6 +28,10 @@
 PADDLE_DEFINE_EXPORTED_bool(
     new_executor_sequential_run, false,
     "Enable sequential execution for standalone executor, used for debug");
+PADDLE_DEFINE_EXPORTED_bool(
+    new_executor_bind_cpu, false,
+    "Bind the host threads of standalone executor to cpus, and restrict work "
+    "stealing to the threads on the same NUMA node");
 
 namespace paddle {
 namespace framework {
@@ -35,6 +39,35 @@ namespace interpreter {
 
 constexpr size_t kPrepareWorkQueueIdx = 2;
 
+AsyncWorkQueue::AsyncWorkQueue(size_t host_num_threads,
+                               size_t deivce_num_threads, EventsWaiter* waiter)
+    : host_num_thread_(host_num_threads) {
+  std::vector<WorkQueueOptions> group_options;
+  // for execute host Kernel
+  group_options.emplace_back(/*name*/ "HostTasks",
+                             /*num_threads*/ host_num_threads,
+                             /*allow_spinning*/ true,
+                             /*track_task*/ false,
+                             /*detached*/ true,
+                             /*events_waiter*/ waiter);
+  group_options.back().bind_cpu = FLAGS_new_executor_bind_cpu;
+  // for launch device Kernel
+  group_options.emplace_back(/*name*/ "DeviceKernelLaunch",
+                             /*num_threads*/ deivce_num_threads,
+                             /*allow_spinning*/ true,
+                             /*track_task*/ false,
+                             /*detached*/ true,
+                             /*events_waiter*/ waiter);
+  // for prepare deps and others
+  group_options.emplace_back(/*name*/ "Prepare",
+                             /*num_threads*/ 1,
+                             /*allow_spinning*/ true,
+                             /*track_task*/ false,
+                             /*detached*/ true,
+                             /*events_waiter*/ waiter);
+  queue_group_ = CreateWorkQueueGroup(group_options);
+}
+
 void AsyncWorkQueue::AddTask(const OpFuncType& op_func_type,
                              std::function<void()> fn) {
   // NOTE(zhiqiu): use thhe second queue of size of, so only one thread is used.
@@ -711,6 +744,43 @@ std::map<int, std::list<int>> build_op_downstream_map(
   return std::move(get_downstream_map(op2dependences));
 }
 
+std::vector<double> build_critical_path_priority(
+    const std::vector<Instruction>& vec_instruction,
+    const std::vector<double>& op_costs) {
+  PADDLE_ENFORCE_EQ(
+      vec_instruction.size(), op_costs.size(),
+      platform::errors::InvalidArgument(
+          "The size of op_costs(%d) should be equal to the number of "
+          "instructions(%d).",
+          op_costs.size(), vec_instruction.size()));
+  // NOTE: downstream ops always have larger ids than their upstream ops (see
+  // build_op_downstream_map), so a reverse traversal visits every op after
+  // all of its successors, and the longest remaining path from each op can be
+  // computed in one pass.
+  std::vector<double> priority(vec_instruction.size(), 0.);
+  for (size_t i = vec_instruction.size(); i > 0; --i) {
+    size_t op_idx = i - 1;
+    auto& next_instr = vec_instruction[op_idx].NextInstructions();
+    double max_successor = 0.;
+    for (auto* ids : {&next_instr.DirectRunIds(), &next_instr.EventRunIds(),
+                      &next_instr.SyncRunIds()}) {
+      for (auto next_id : *ids) {
+        max_successor = std::max(max_successor, priority[next_id]);
+      }
+    }
+    priority[op_idx] = op_costs[op_idx] + max_successor;
+  }
+  return priority;
+}
+
+void sort_by_priority(const std::vector<double>& priority,
+                      std::vector<size_t>* instr_ids) {
+  std::stable_sort(instr_ids->begin(), instr_ids->end(),
+                   [&priority](size_t lhs, size_t rhs) {
+                     return priority[lhs] > priority[rhs];
+                   });
+}
+
 }  // namespace interpreter
 }  // namespace framework
 }  // namespace paddle
@@ -56,32 +56,7 @@ using AtomicVectorSizeT =
 class AsyncWorkQueue {
  public:
   AsyncWorkQueue(size_t host_num_threads, size_t deivce_num_threads,
-                 EventsWaiter* waiter)
-      : host_num_thread_(host_num_threads) {
-    std::vector<WorkQueueOptions> group_options;
-    // for execute host Kernel
-    group_options.emplace_back(/*name*/ "HostTasks",
-                               /*num_threads*/ host_num_threads,
-                               /*allow_spinning*/ true,
-                               /*track_task*/ false,
-                               /*detached*/ true,
-                               /*events_waiter*/ waiter);
-    // for launch device Kernel
-    group_options.emplace_back(/*name*/ "DeviceKernelLaunch",
-                               /*num_threads*/ deivce_num_threads,
-                               /*allow_spinning*/ true,
-                               /*track_task*/ false,
-                               /*detached*/ true,
-                               /*events_waiter*/ waiter);
-    // for prepare deps and others
-    group_options.emplace_back(/*name*/ "Prepare",
-                               /*num_threads*/ 1,
-                               /*allow_spinning*/ true,
-                               /*track_task*/ false,
-                               /*detached*/ true,
-                               /*events_waiter*/ waiter);
-    queue_group_ = CreateWorkQueueGroup(group_options);
-  }
+                 EventsWaiter* waiter);
 
   void PrepareAtomicDeps(const std::vector<size_t>& dependecy_count);
   void PrepareAtomicVarRef(const std::vector<VariableMetaInfo>& vec_meta_info);
@@ -121,6 +96,18 @@ std::map<int, std::list<int>> build_op_downstream_map(
 void add_fetch(const std::vector<std::string>& fetch_names,
                framework::BlockDesc* block);
 
+// Return the length of the longest (cost weighted) path from each instruction
+// to the end of the program, including the instruction itself. Instructions
+// with larger values lie on the critical path and should be scheduled first.
+std::vector<double> build_critical_path_priority(
+    const std::vector<Instruction>& vec_instruction,
+    const std::vector<double>& op_costs);
+
+// Sort instr_ids in descending priority, keeping the order of instructions
+// with equal priorities.
+void sort_by_priority(const std::vector<double>& priority,
+                      std::vector<size_t>* instr_ids);
+
 std::vector<size_t> merge_vector(const std::vector<size_t>& first,
                                  const std::vector<size_t>& second);
 
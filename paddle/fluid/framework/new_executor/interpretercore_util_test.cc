@@ -0,0 +1,78 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/interpretercore_util.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+// The DAG below, linked by all three kinds of next instructions, with the
+// cost of each instruction in brackets:
+//
+//   0(1) -direct-> 1(2) -direct-> 3(1) -sync-> 5(1)
+//   0(1) -event--> 2(2) -direct-> 3(1)
+//                  4(3) -event---------------> 5(1)
+static std::vector<Instruction> BuildTestInstructions(
+    const platform::DeviceContext& dev_ctx) {
+  std::vector<Instruction> instructions;
+  for (size_t i = 0; i < 6; ++i) {
+    instructions.emplace_back(i, OpFuncNode(), dev_ctx);
+  }
+  instructions[0].NextInstructions().AddDirectRun(1);
+  instructions[0].NextInstructions().ADDEventRun(2);
+  instructions[1].NextInstructions().AddDirectRun(3);
+  instructions[2].NextInstructions().AddDirectRun(3);
+  instructions[3].NextInstructions().AddSyncRun(5);
+  instructions[4].NextInstructions().ADDEventRun(5);
+  return instructions;
+}
+
+TEST(InterpreterCoreUtil, CriticalPathPriority) {
+  platform::CPUDeviceContext dev_ctx;
+  auto instructions = BuildTestInstructions(dev_ctx);
+  auto priority =
+      build_critical_path_priority(instructions, {1., 2., 2., 1., 3., 1.});
+  EXPECT_EQ(priority, std::vector<double>({5., 4., 4., 2., 4., 1.}));
+
+  std::vector<size_t> ids = {5, 3, 2, 0, 4, 1};
+  sort_by_priority(priority, &ids);
+  // 2, 4 and 1 tie on the priority 4 and keep their order
+  EXPECT_EQ(ids, std::vector<size_t>({0, 2, 4, 1, 3, 5}));
+
+  ids = {4, 1, 2};
+  sort_by_priority(priority, &ids);
+  EXPECT_EQ(ids, std::vector<size_t>({4, 1, 2}));
+
+  // a zero cost instruction inherits the priority of its successors
+  priority =
+      build_critical_path_priority(instructions, {0., 0., 0., 0., 0., 1.});
+  EXPECT_EQ(priority, std::vector<double>({1., 1., 1., 1., 1., 1.}));
+}
+
+TEST(InterpreterCoreUtil, CriticalPathPriorityCostsMismatch) {
+  platform::CPUDeviceContext dev_ctx;
+  auto instructions = BuildTestInstructions(dev_ctx);
+  EXPECT_THROW(build_critical_path_priority(instructions, {1., 2.}),
+               platform::EnforceNotMet);
+}
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
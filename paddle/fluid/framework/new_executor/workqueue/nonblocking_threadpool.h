@@ -11,11 +11,16 @@
 
 #include <atomic>
 #include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
 #include <vector>
 #include "glog/logging.h"
 #include "paddle/fluid/framework/new_executor/workqueue/event_count.h"
 #include "paddle/fluid/framework/new_executor/workqueue/run_queue.h"
 #include "paddle/fluid/framework/new_executor/workqueue/thread_environment.h"
+#include "paddle/fluid/framework/new_executor/workqueue/workqueue_utils.h"
+#include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/os_info.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 
@@ -30,9 +35,22 @@ class ThreadPoolTempl {
 
   ThreadPoolTempl(const std::string& name, int num_threads, bool allow_spinning,
                   Environment env = Environment())
+      : ThreadPoolTempl(name, num_threads, allow_spinning, {}, {}, 0, env) {}
+
+  // bind_cpus: the logical cpu of each worker thread, empty for no binding.
+  // steal_partitions: the [start, limit) range of workers each worker steals
+  // from, empty for stealing from all workers.
+  // scratch_bytes: the size of the scratch buffer allocated by each worker
+  // thread itself (after binding), so that its pages are first touched on
+  // the local NUMA node.
+  ThreadPoolTempl(const std::string& name, int num_threads, bool allow_spinning,
+                  const std::vector<int>& bind_cpus,
+                  const std::vector<std::pair<unsigned, unsigned>>&
+                      steal_partitions,
+                  size_t scratch_bytes, Environment env = Environment())
       : env_(env),
         allow_spinning_(allow_spinning),
-        global_steal_partition_(EncodePartition(0, num_threads_)),
+        global_steal_partition_(EncodePartition(0, num_threads)),
         blocked_(0),
         num_tasks_(0),
         spinning_(0),
@@ -41,6 +59,8 @@ class ThreadPoolTempl {
         ec_(num_threads),
         num_threads_(num_threads),
         thread_data_(num_threads),
+        bind_cpus_(bind_cpus),
+        scratch_bytes_(scratch_bytes),
         name_(name) {
     // Calculate coprimes of all numbers [1, num_threads].
     // Coprimes are used for random walks over all threads in Steal
@@ -56,8 +76,18 @@ class ThreadPoolTempl {
       all_coprimes_.back().push_back(i);
       ComputeCoprimes(i, &(all_coprimes_.back()));
     }
+    assert(bind_cpus_.empty() ||
+           bind_cpus_.size() == static_cast<size_t>(num_threads_));
+    assert(steal_partitions.empty() ||
+           steal_partitions.size() == static_cast<size_t>(num_threads_));
     for (int i = 0; i < num_threads_; i++) {
-      SetStealPartition(i, EncodePartition(0, num_threads_));
+      if (steal_partitions.empty()) {
+        SetStealPartition(i, EncodePartition(0, num_threads_));
+      } else {
+        const auto& pair = steal_partitions[i];
+        AssertBounds(pair.first, pair.second);
+        SetStealPartition(i, EncodePartition(pair.first, pair.second));
+      }
       thread_data_[i].thread.reset(
           env_.CreateThread([this, i]() { WorkerLoop(i); }));
     }
@@ -83,6 +113,11 @@ class ThreadPoolTempl {
     for (size_t i = 0; i < thread_data_.size(); ++i) {
       thread_data_[i].thread.reset();
     }
+    for (size_t i = 0; i < thread_data_.size(); ++i) {
+      if (thread_data_[i].scratch != nullptr) {
+        AlignedFree(thread_data_[i].scratch);
+      }
+    }
   }
 
   void SetStealPartitions(
@@ -155,6 +190,19 @@ class ThreadPoolTempl {
 
   size_t NumThreads() const { return num_threads_; }
 
+  // Return the scratch buffer of the calling worker thread, or nullptr if
+  // the calling thread is not a worker of this pool or no scratch buffer is
+  // requested.
+  void* CurrentThreadScratch() const {
+    int thread_id = CurrentThreadId();
+    if (thread_id < 0) {
+      return nullptr;
+    }
+    return thread_data_[thread_id].scratch;
+  }
+
+  size_t ScratchBytes() const { return scratch_bytes_; }
+
   int CurrentThreadId() const {
     const PerThread* pt = const_cast<ThreadPoolTempl*>(this)->GetPerThread();
     if (pt->pool == this) {
@@ -225,10 +273,12 @@ class ThreadPoolTempl {
   };
 
   struct ThreadData {
-    constexpr ThreadData() : thread(), steal_partition(0), queue() {}
+    constexpr ThreadData()
+        : thread(), steal_partition(0), queue(), scratch(nullptr) {}
     std::unique_ptr<Thread> thread;
     std::atomic<unsigned> steal_partition;
     Queue queue;
+    void* scratch;  // owned, allocated by the worker thread
   };
 
   Environment env_;
@@ -243,6 +293,8 @@ class ThreadPoolTempl {
   EventCount ec_;
   const int num_threads_;
   std::vector<ThreadData> thread_data_;
+  std::vector<int> bind_cpus_;
+  size_t scratch_bytes_;
   std::string name_;
 
   // Main worker thread loop.
@@ -250,6 +302,23 @@ class ThreadPoolTempl {
     std::string thr_name = name_ + "_thread_" + std::to_string(thread_id);
     VLOG(1) << thr_name << " started ";
     platform::SetCurrentThreadName(thr_name);
+    if (!bind_cpus_.empty()) {
+      int cpu_id = bind_cpus_[thread_id];
+      if (platform::BindCurrentThreadToCpu(cpu_id)) {
+        VLOG(1) << thr_name << " is bound to cpu " << cpu_id;
+      } else {
+        LOG(WARNING) << "Failed to bind " << thr_name << " to cpu " << cpu_id;
+      }
+    }
+    if (scratch_bytes_ > 0) {
+      // NOTE: allocate and touch the scratch buffer in the worker thread
+      // after binding, so that it is placed on the local NUMA node.
+      void* scratch = AlignedMalloc(scratch_bytes_, 64);
+      if (scratch != nullptr) {
+        std::memset(scratch, 0, scratch_bytes_);
+      }
+      thread_data_[thread_id].scratch = scratch;
+    }
     PerThread* pt = GetPerThread();
     pt->pool = this;
     pt->rand = GlobalThreadIdHash();
@@ -287,14 +356,36 @@ class ThreadPoolTempl {
         }
       }
     } else {
+      // With a steal partition narrower than the pool (the threads of a NUMA
+      // node), spin on the partition and steal from the other nodes only once
+      // it stays empty, right before sleeping. WaitForWork still checks all
+      // the queues, otherwise a task pushed to a sleeping thread could be
+      // left behind when the thread woken for it is on another node.
+      const bool partitioned =
+          GetStealPartition(thread_id) != global_steal_partition_;
       while (!cancelled_) {
         Task t = q.PopFront();
         if (!t.f) {
           t = LocalSteal();
           if (!t.f) {
-            t = GlobalSteal();
-            if (!t.f) {
+            if (partitioned) {
               if (allow_spinning_) {
+                for (int i = 0; i < spin_count && !t.f; i++) {
+                  if (!cancelled_.load(std::memory_order_relaxed)) {
+                    t = LocalSteal();
+                  } else {
+                    return;
+                  }
+                }
+              }
+              if (!t.f) {
+                t = GlobalSteal();
+              }
+            } else {
+              t = GlobalSteal();
+            }
+            if (!t.f) {
+              if (allow_spinning_ && !partitioned) {
                 for (int i = 0; i < spin_count && !t.f; i++) {
                   if (!cancelled_.load(std::memory_order_relaxed)) {
                     t = GlobalSteal();
@@ -27,6 +27,32 @@ namespace {
 
 using TaskTracker = TaskTracker<EventsWaiter::EventNotifier>;
 
+std::vector<int> GetBindCpus(
+    const WorkQueueOptions& options,
+    std::vector<std::pair<unsigned, unsigned>>* steal_partitions) {
+  if (!options.bind_cpu || options.num_threads == 0) {
+    return {};
+  }
+  auto bind_cpus = AssignThreadCpus(options.num_threads, steal_partitions);
+  VLOG(1) << options.name << " binds " << options.num_threads
+          << " threads to cpus, starting from cpu " << bind_cpus.front();
+  return bind_cpus;
+}
+
+NonblockingThreadPool* CreateThreadPool(const WorkQueueOptions& options,
+                                        void* storage = nullptr) {
+  std::vector<std::pair<unsigned, unsigned>> steal_partitions;
+  auto bind_cpus = GetBindCpus(options, &steal_partitions);
+  if (storage == nullptr) {
+    return new NonblockingThreadPool(
+        options.name, options.num_threads, options.allow_spinning, bind_cpus,
+        steal_partitions, options.scratch_bytes_per_thread);
+  }
+  return new (storage) NonblockingThreadPool(
+      options.name, options.num_threads, options.allow_spinning, bind_cpus,
+      steal_partitions, options.scratch_bytes_per_thread);
+}
+
 class WorkQueueImpl : public WorkQueue {
  public:
   explicit WorkQueueImpl(const WorkQueueOptions& options) : WorkQueue(options) {
@@ -39,8 +65,7 @@ class WorkQueueImpl : public WorkQueue {
       destruct_notifier_ =
           options.events_waiter->RegisterEvent(kQueueDestructEvent);
     }
-    queue_ = new NonblockingThreadPool(options_.name, options_.num_threads,
-                                       options_.allow_spinning);
+    queue_ = CreateThreadPool(options_);
   }
 
   virtual ~WorkQueueImpl() {
@@ -74,6 +99,10 @@ class WorkQueueImpl : public WorkQueue {
 
   size_t NumThreads() const override { return queue_->NumThreads(); }
 
+  void* CurrentThreadScratch() const override {
+    return queue_->CurrentThreadScratch();
+  }
+
  private:
   NonblockingThreadPool* queue_{nullptr};
   TaskTracker* tracker_{nullptr};
@@ -94,6 +123,8 @@ class WorkQueueGroupImpl : public WorkQueueGroup {
 
   size_t QueueGroupNumThreads() const override;
 
+  void* CurrentThreadScratch(size_t queue_idx) const override;
+
   void Cancel() override;
 
  private:
@@ -126,8 +157,7 @@ WorkQueueGroupImpl::WorkQueueGroupImpl(
       destruct_notifier_ =
           options.events_waiter->RegisterEvent(kQueueDestructEvent);
     }
-    queues_[idx] = new (&queues_storage_[idx]) NonblockingThreadPool(
-        options.name, options.num_threads, options.allow_spinning);
+    queues_[idx] = CreateThreadPool(options, &queues_storage_[idx]);
   }
 }
 
@@ -172,6 +202,11 @@ size_t WorkQueueGroupImpl::QueueGroupNumThreads() const {
   return total_num;
 }
 
+void* WorkQueueGroupImpl::CurrentThreadScratch(size_t queue_idx) const {
+  assert(queue_idx < queues_.size());
+  return queues_.at(queue_idx)->CurrentThreadScratch();
+}
+
 void WorkQueueGroupImpl::Cancel() {
   for (auto queue : queues_) {
     queue->Cancel();
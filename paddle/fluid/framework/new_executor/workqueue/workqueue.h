@@ -90,6 +90,15 @@ struct WorkQueueOptions {
   // false and set events_waiter.
   bool detached{true};
   EventsWaiter* events_waiter{nullptr};  // not owned
+  // If you need to pin each thread to a logical cpu, set bind_cpu = true.
+  // Threads are then placed NUMA node by node on the cpus the process may
+  // run on, and a thread steals from the other NUMA nodes only after its own
+  // node has no work for a whole spin, or right before it sleeps.
+  bool bind_cpu{false};
+  // If you need a per-thread scratch buffer, set scratch_bytes_per_thread > 0.
+  // The buffer is allocated and first touched by the thread itself, so it is
+  // local to the NUMA node of the thread if bind_cpu = true.
+  size_t scratch_bytes_per_thread{0};
 };
 
 class WorkQueue {
@@ -125,6 +134,10 @@ class WorkQueue {
 
   virtual size_t NumThreads() const = 0;
 
+  // Return the scratch buffer of the calling thread if it is a thread of this
+  // queue, otherwise nullptr. See WorkQueueOptions.scratch_bytes_per_thread.
+  virtual void* CurrentThreadScratch() const = 0;
+
   virtual void Cancel() = 0;
 
  protected:
@@ -167,6 +180,8 @@ class WorkQueueGroup {
 
   virtual size_t QueueGroupNumThreads() const = 0;
 
+  virtual void* CurrentThreadScratch(size_t queue_idx) const = 0;
+
   virtual void Cancel() = 0;
 
  protected:
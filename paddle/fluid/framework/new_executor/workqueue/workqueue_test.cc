@@ -13,11 +13,13 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/new_executor/workqueue/workqueue.h"
+#include <algorithm>
 #include <atomic>
 #include <thread>
 #include "glog/logging.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/new_executor/workqueue/workqueue_utils.h"
+#include "paddle/fluid/platform/cpu_info.h"
 
 TEST(WorkQueueUtils, TestEventsWaiter) {
   using paddle::framework::EventsWaiter;
@@ -173,3 +175,54 @@ TEST(WorkQueue, TestWorkQueueGroup) {
   queue_group.reset();
   waiter_thread.join();
 }
+
+TEST(WorkQueue, TestBindCpuWorkQueue) {
+  using paddle::framework::WorkQueueOptions;
+  using paddle::framework::CreateMultiThreadedWorkQueue;
+  using paddle::framework::EventsWaiter;
+  constexpr unsigned kTaskNum = 100;
+  constexpr size_t kScratchBytes = 4096;
+  std::atomic<unsigned> scratch_counter{0};
+  EventsWaiter events_waiter;
+  WorkQueueOptions options(/*name*/ "BindCpuWorkQueueForTesting",
+                           /*num_threads*/ 4, /*allow_spinning*/ true,
+                           /*track_task*/ true, /*detached*/ true,
+                           &events_waiter);
+  options.bind_cpu = true;
+  options.scratch_bytes_per_thread = kScratchBytes;
+  auto work_queue = CreateMultiThreadedWorkQueue(options);
+  EXPECT_EQ(work_queue->NumThreads(), 4u);
+  // Not a thread of work_queue
+  EXPECT_EQ(work_queue->CurrentThreadScratch(), nullptr);
+  auto* queue = work_queue.get();
+  for (unsigned i = 0; i < kTaskNum; ++i) {
+    work_queue->AddTask([queue, &scratch_counter]() {
+      auto* scratch = static_cast<char*>(queue->CurrentThreadScratch());
+      if (scratch != nullptr && scratch[kScratchBytes - 1] == 0) {
+        ++scratch_counter;
+      }
+    });
+  }
+  EXPECT_EQ(events_waiter.WaitEvent(), paddle::framework::kQueueEmptyEvent);
+  EXPECT_EQ(scratch_counter.load(), kTaskNum);
+}
+
+TEST(WorkQueueUtils, TestAssignThreadCpus) {
+  std::vector<std::pair<unsigned, unsigned>> partitions;
+  auto cpus = paddle::framework::AssignThreadCpus(8, &partitions);
+  EXPECT_EQ(cpus.size(), 8u);
+  EXPECT_EQ(partitions.size(), 8u);
+  for (size_t i = 0; i < partitions.size(); ++i) {
+    EXPECT_LE(partitions[i].first, i);
+    EXPECT_LT(i, partitions[i].second);
+    EXPECT_LE(partitions[i].second, 8u);
+  }
+  // only the cpus in the affinity of the process are assigned
+  auto allowed_cpus = paddle::platform::ProcessAllowedCpus();
+  if (!allowed_cpus.empty()) {
+    for (auto cpu : cpus) {
+      EXPECT_NE(std::find(allowed_cpus.begin(), allowed_cpus.end(), cpu),
+                allowed_cpus.end());
+    }
+  }
+}
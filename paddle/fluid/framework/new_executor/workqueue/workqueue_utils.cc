@@ -13,8 +13,10 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/new_executor/workqueue/workqueue_utils.h"
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include "paddle/fluid/platform/cpu_info.h"
 
 namespace paddle {
 namespace framework {
@@ -55,5 +57,57 @@ void AlignedFree(void* mem_ptr) {
 #endif
 }
 
+std::vector<int> AssignThreadCpus(
+    size_t num_threads,
+    std::vector<std::pair<unsigned, unsigned>>* steal_partitions) {
+  static std::atomic<size_t> next_cpu_idx{0};
+  auto node_ids = platform::CpuNumaNodeIds();
+  auto allowed_cpus = platform::ProcessAllowedCpus();
+  // online cpus the process may run on, ordered by (numa node, cpu id)
+  std::vector<int> cpus;
+  for (size_t cpu = 0; cpu < node_ids.size(); ++cpu) {
+    if (node_ids[cpu] >= 0 &&
+        (allowed_cpus.empty() ||
+         std::binary_search(allowed_cpus.begin(), allowed_cpus.end(),
+                            static_cast<int>(cpu)))) {
+      cpus.push_back(static_cast<int>(cpu));
+    }
+  }
+  std::stable_sort(cpus.begin(), cpus.end(), [&node_ids](int a, int b) {
+    return node_ids[a] < node_ids[b];
+  });
+  PADDLE_ENFORCE_GT(
+      cpus.size(), 0,
+      platform::errors::Unavailable(
+          "No online cpu is found in the cpu affinity of the process."));
+
+  size_t start = next_cpu_idx.fetch_add(num_threads);
+  std::vector<int> thread_cpus(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    thread_cpus[i] = cpus[(start + i) % cpus.size()];
+  }
+  // keep the threads of the same numa node contiguous after wrapping around
+  std::stable_sort(thread_cpus.begin(), thread_cpus.end(),
+                   [&node_ids](int a, int b) {
+                     return node_ids[a] < node_ids[b];
+                   });
+
+  steal_partitions->resize(num_threads);
+  size_t begin = 0;
+  while (begin < num_threads) {
+    size_t end = begin + 1;
+    while (end < num_threads &&
+           node_ids[thread_cpus[end]] == node_ids[thread_cpus[begin]]) {
+      ++end;
+    }
+    for (size_t i = begin; i < end; ++i) {
+      (*steal_partitions)[i] = std::make_pair(static_cast<unsigned>(begin),
+                                              static_cast<unsigned>(end));
+    }
+    begin = end;
+  }
+  return thread_cpus;
+}
+
 }  // namespace framework
 }  // namespace paddle
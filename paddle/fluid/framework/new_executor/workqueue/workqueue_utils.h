@@ -21,6 +21,8 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 #include "paddle/fluid/framework/new_executor/workqueue/events_waiter.h"
 #include "paddle/fluid/platform/enforce.h"
 
@@ -68,6 +70,15 @@ void* AlignedMalloc(size_t size, size_t alignment);
 
 void AlignedFree(void* memory_ptr);
 
+// Assign a logical cpu to each of num_threads threads. Cpus are handed out
+// NUMA node by node, continuing from where the previous call stopped, so that
+// different queues do not pile up on the same cpus. The threads of each NUMA
+// node are kept contiguous, and steal_partitions is filled with the [start,
+// limit) range of threads on the same node for each thread.
+std::vector<int> AssignThreadCpus(
+    size_t num_threads,
+    std::vector<std::pair<unsigned, unsigned>>* steal_partitions);
+
 template <typename Notifier>
 class TaskTracker {
  public:
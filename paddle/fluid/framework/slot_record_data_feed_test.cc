@@ -0,0 +1,187 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "google/protobuf/text_format.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/data_feed.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+
+class TestSlotRecordDataFeed : public SlotRecordInMemoryDataFeed {
+ public:
+  using SlotRecordInMemoryDataFeed::PutToFeedVec;
+};
+
+// The feed tensor and the LoD of a slot, assembled as PutToFeedVec did
+// before it copied the values in bulk: value by value, with 0 for an empty
+// uint64 slot and nothing for an empty float slot.
+template <typename T>
+static void ExpectedSlot(const std::vector<std::vector<T>>& ins_values,
+                         std::vector<T>* values, std::vector<size_t>* lod) {
+  lod->assign(1, 0);
+  for (auto& ins : ins_values) {
+    if (ins.empty() && std::is_same<T, uint64_t>::value) {
+      values->push_back(0);
+    }
+    values->insert(values->end(), ins.begin(), ins.end());
+    lod->push_back(values->size());
+  }
+}
+
+TEST(SlotRecordInMemoryDataFeed, PutToFeedVec) {
+  DataFeedDesc desc;
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(
+      "name: \"SlotRecordInMemoryDataFeed\"\n"
+      "batch_size: 4\n"
+      "multi_slot_desc {\n"
+      "  slots { name: \"u0\" type: \"uint64\" is_used: true }\n"
+      "  slots { name: \"unused\" type: \"uint64\" is_used: false }\n"
+      "  slots { name: \"f0\" type: \"float\" is_used: true }\n"
+      "  slots { name: \"u1\" type: \"uint64\" is_used: true }\n"
+      "}\n",
+      &desc));
+  TestSlotRecordDataFeed feed;
+  feed.Init(desc);
+  feed.SetPlace(platform::CPUPlace());
+  Scope scope;
+  for (auto name : {"u0", "f0", "u1"}) {
+    feed.AddFeedVar(scope.Var(name), name);
+  }
+
+  // the slots of each instance, mixing empty and non-empty ones
+  std::vector<std::vector<std::vector<uint64_t>>> uint64_slots = {
+      {{1, 2, 3}, {}}, {{}, {10}}, {{4}, {11, 12}}, {{}, {}}};
+  std::vector<std::vector<std::vector<float>>> float_slots = {
+      {{0.5f}}, {{}}, {{1.5f, 2.5f}}, {{}}};
+  std::vector<std::unique_ptr<SlotRecordObject>> records;
+  std::vector<SlotRecord> ins_vec;
+  for (size_t i = 0; i < uint64_slots.size(); ++i) {
+    records.emplace_back(new SlotRecordObject());
+    records.back()->slot_uint64_feasigns_.add_slot_feasigns(uint64_slots[i],
+                                                            0);
+    records.back()->slot_float_feasigns_.add_slot_feasigns(float_slots[i], 0);
+    ins_vec.push_back(records.back().get());
+  }
+  // a smaller batch first, whose values must not leak into the next one
+  feed.PutToFeedVec(ins_vec.data(), 1);
+  feed.PutToFeedVec(ins_vec.data(), static_cast<int>(ins_vec.size()));
+
+  for (int slot = 0; slot < 2; ++slot) {
+    std::vector<std::vector<uint64_t>> ins_values;
+    for (auto& ins : uint64_slots) {
+      ins_values.push_back(ins[slot]);
+    }
+    std::vector<uint64_t> values;
+    std::vector<size_t> lod;
+    ExpectedSlot(ins_values, &values, &lod);
+    auto& tensor = scope.FindVar(slot == 0 ? "u0" : "u1")->Get<LoDTensor>();
+    ASSERT_EQ(tensor.numel(), static_cast<int64_t>(values.size()));
+    ASSERT_EQ(tensor.dims()[1], 1);
+    ASSERT_EQ(tensor.lod().size(), 1UL);
+    ASSERT_EQ(tensor.lod()[0], lod) << "slot " << slot;
+    for (size_t i = 0; i < values.size(); ++i) {
+      ASSERT_EQ(static_cast<uint64_t>(tensor.data<int64_t>()[i]), values[i]);
+    }
+  }
+
+  std::vector<std::vector<float>> ins_values;
+  for (auto& ins : float_slots) {
+    ins_values.push_back(ins[0]);
+  }
+  std::vector<float> values;
+  std::vector<size_t> lod;
+  ExpectedSlot(ins_values, &values, &lod);
+  auto& tensor = scope.FindVar("f0")->Get<LoDTensor>();
+  ASSERT_EQ(tensor.numel(), static_cast<int64_t>(values.size()));
+  ASSERT_EQ(tensor.lod()[0], lod);
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(tensor.data<float>()[i], values[i]);
+  }
+}
+
+TEST(SlotRecordBatch, Build) {
+  std::vector<UsedSlotInfo> used_slots(3);
+  used_slots[0].type = "uint64";
+  used_slots[0].slot_value_idx = 1;
+  used_slots[1].type = "float";
+  used_slots[1].slot_value_idx = 0;
+  used_slots[2].type = "uint64";
+  used_slots[2].slot_value_idx = 0;
+
+  std::vector<std::vector<std::vector<uint64_t>>> uint64_slots = {
+      {{7}, {1, 2}}, {{8, 9}, {}}, {{}, {3}}};
+  std::vector<std::vector<std::vector<float>>> float_slots = {
+      {{}}, {{0.5f, 1.5f}}, {{2.5f}}};
+  std::vector<std::unique_ptr<SlotRecordObject>> records;
+  std::vector<SlotRecord> ins_vec;
+  for (size_t i = 0; i < uint64_slots.size(); ++i) {
+    records.emplace_back(new SlotRecordObject());
+    records.back()->slot_uint64_feasigns_.add_slot_feasigns(uint64_slots[i],
+                                                            0);
+    records.back()->slot_float_feasigns_.add_slot_feasigns(float_slots[i], 0);
+    ins_vec.push_back(records.back().get());
+  }
+
+  SlotRecordBatch batch;
+  batch.Build(ins_vec.data(), static_cast<int>(ins_vec.size()), used_slots);
+  ASSERT_EQ(batch.size(), 3);
+  for (int j : {0, 2}) {
+    std::vector<std::vector<uint64_t>> ins_values;
+    for (auto& ins : uint64_slots) {
+      ins_values.push_back(ins[used_slots[j].slot_value_idx]);
+    }
+    std::vector<uint64_t> values;
+    std::vector<size_t> lod;
+    ExpectedSlot(ins_values, &values, &lod);
+    auto& column = batch.column(j);
+    ASSERT_EQ(column.offsets, lod) << "slot " << j;
+    auto* column_values = static_cast<const uint64_t*>(column.values);
+    EXPECT_EQ(std::vector<uint64_t>(column_values,
+                                    column_values + values.size()),
+              values);
+  }
+  std::vector<std::vector<float>> ins_values;
+  for (auto& ins : float_slots) {
+    ins_values.push_back(ins[0]);
+  }
+  std::vector<float> values;
+  std::vector<size_t> lod;
+  ExpectedSlot(ins_values, &values, &lod);
+  auto& column = batch.column(1);
+  ASSERT_EQ(column.offsets, lod);
+  auto* column_values = static_cast<const float*>(column.values);
+  EXPECT_EQ(std::vector<float>(column_values, column_values + values.size()),
+            values);
+
+  // a smaller batch reuses the arena, and the columns do not overlap
+  size_t arena_size = batch.arena_size();
+  batch.Build(ins_vec.data() + 1, 2, used_slots);
+  EXPECT_EQ(batch.arena_size(), arena_size);
+  EXPECT_EQ(batch.column(0).offsets, std::vector<size_t>({0, 1, 2}));
+  EXPECT_EQ(static_cast<const uint64_t*>(batch.column(0).values)[0], 0UL);
+  EXPECT_EQ(batch.column(2).offsets, std::vector<size_t>({0, 2, 3}));
+  auto* uint64_values = static_cast<const uint64_t*>(batch.column(2).values);
+  EXPECT_EQ(std::vector<uint64_t>(uint64_values, uint64_values + 3),
+            std::vector<uint64_t>({8, 9, 0}));
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/imperative/prepared_operator.h"
 
+#include <unordered_map>
+
 #include "paddle/fluid/eager/eager_tensor.h"
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/details/nan_inf_utils.h"
@@ -32,6 +34,7 @@
 DECLARE_bool(check_nan_inf);
 DECLARE_bool(benchmark);
 DECLARE_bool(run_kp_kernel);
+DECLARE_int32(dygraph_kernel_cache_capacity);
 
 namespace paddle {
 namespace imperative {
@@ -125,6 +128,18 @@ PreparedOp::PreparedOp(const framework::OperatorBase& op,
       pt_kernel_signature_(kernel_signature),
       pt_kernel_(pt_kernel) {}
 
+PreparedOp::PreparedOp(const framework::OperatorBase& op,
+                       const PreparedOp& prepared_op)
+    : op_(op),
+      ctx_(prepared_op.ctx_),
+      kernel_type_(prepared_op.kernel_type_),
+      func_(prepared_op.func_),
+      dev_ctx_(prepared_op.dev_ctx_),
+      run_phi_kernel_(prepared_op.run_phi_kernel_),
+      run_kp_kernel_(prepared_op.run_kp_kernel_),
+      pt_kernel_signature_(prepared_op.pt_kernel_signature_),
+      pt_kernel_(prepared_op.pt_kernel_) {}
+
 template <typename VarType>
 PreparedOp PrepareImpl(const NameVarMap<VarType>& ins,
                        const NameVarMap<VarType>& outs,
@@ -344,13 +359,178 @@ PreparedOp PrepareImpl(const NameVarMap<VarType>& ins,
   return PreparedOp(op, ctx, expected_kernel_key, kernel_iter->second, dev_ctx);
 }
 
+template <typename T>
+static inline void HashCombine(size_t* seed, const T& value) {
+  *seed ^= std::hash<T>()(value) + 0x9e3779b9 + (*seed << 6) + (*seed >> 2);
+}
+
+struct AttributeHasher : public boost::static_visitor<size_t> {
+  size_t operator()(const boost::blank&) const { return 0; }
+
+  template <typename T>
+  size_t operator()(const T& value) const {
+    return std::hash<T>()(value);
+  }
+
+  template <typename T>
+  size_t operator()(const std::vector<T>& values) const {
+    size_t seed = values.size();
+    for (size_t i = 0; i < values.size(); ++i) {
+      // copies the elements out of std::vector<bool>
+      T value = values[i];
+      HashCombine(&seed, value);
+    }
+    return seed;
+  }
+};
+
+template <typename T>
+static inline void AppendKeyField(std::string* key, const T& value) {
+  key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Appends the names of vars, their var types, and the dtypes, layouts,
+// places and emptiness of their tensors to key. Returns false if an input is
+// neither a LoDTensor nor a SelectedRows, whose kernel is not cached.
+template <typename VarType>
+static bool AppendVarsKey(const NameVarMap<VarType>& vars, bool is_input,
+                          std::string* key) {
+  for (auto& pair : vars) {
+    key->append(pair.first);
+    AppendKeyField(key, pair.second.size());
+    for (auto& var : pair.second) {
+      if (var == nullptr || !var->Var().IsInitialized()) {
+        AppendKeyField(key, -1);
+        continue;
+      }
+      AppendKeyField(key, var->Var().Type());
+      const framework::Tensor* tensor = GetTensorFromVar(var->Var());
+      if (tensor == nullptr) {
+        if (is_input) {
+          return false;
+        }
+        continue;
+      }
+      AppendKeyField(key, static_cast<int>(tensor->dtype()));
+      AppendKeyField(key, static_cast<int>(tensor->layout()));
+      AppendKeyField(key, tensor->IsInitialized());
+      if (tensor->IsInitialized()) {
+        // the hash value of a place packs all of its fields
+        AppendKeyField(key, tensor->place().HashValue());
+        AppendKeyField(key, tensor->numel() == 0);
+      }
+    }
+  }
+  return true;
+}
+
+// The kernel chosen by PrepareImpl depends on the op type, the place, the
+// inputs, the var types of the outputs and the attributes. All of them make
+// up the key of the kernel cache, and a hit compares them in full, so that
+// two ops whose keys collide in the hash never share a kernel.
+struct KernelCacheKey {
+  std::string op_type;
+  platform::Place place;
+  bool run_kp_kernel;
+  std::string vars;
+
+  bool operator==(const KernelCacheKey& other) const {
+    return op_type == other.op_type && place == other.place &&
+           run_kp_kernel == other.run_kp_kernel && vars == other.vars;
+  }
+};
+
+template <typename VarType>
+static bool GetKernelCacheKey(const NameVarMap<VarType>& ins,
+                              const NameVarMap<VarType>& outs,
+                              const framework::OperatorWithKernel& op,
+                              const platform::Place& place,
+                              KernelCacheKey* key) {
+  key->op_type = op.Type();
+  key->place = place;
+  key->run_kp_kernel = FLAGS_run_kp_kernel;
+  key->vars.reserve(256);
+  return AppendVarsKey<VarType>(ins, true, &key->vars) &&
+         AppendVarsKey<VarType>(outs, false, &key->vars);
+}
+
+static size_t HashKernelCacheKey(const KernelCacheKey& key,
+                                 const framework::AttributeMap& attrs) {
+  size_t seed = 0;
+  HashCombine(&seed, key.op_type);
+  HashCombine(&seed, key.place.HashValue());
+  HashCombine(&seed, key.run_kp_kernel);
+  HashCombine(&seed, key.vars);
+  // the attributes are hashed regardless of their order
+  size_t attrs_hash = 0;
+  for (auto& pair : attrs) {
+    size_t attr_seed = std::hash<std::string>()(pair.first);
+    HashCombine(&attr_seed,
+                boost::apply_visitor(AttributeHasher(), pair.second));
+    attrs_hash += attr_seed;
+  }
+  HashCombine(&seed, attrs_hash);
+  return seed;
+}
+
+struct KernelCacheEntry {
+  KernelCacheKey key;
+  framework::AttributeMap attrs;
+  // NOTE: op_ of the cached PreparedOp refers to the op it was prepared
+  // for, which is released after the call, so it is only bound to new ops.
+  std::unique_ptr<PreparedOp> prepared_op;
+};
+
+static thread_local size_t kernel_cache_hit_count = 0;
+
+size_t KernelCacheHitCount() { return kernel_cache_hit_count; }
+
+// Looks up the kernel of op in the kernel cache of this thread first, and
+// chooses it by PrepareImpl only if it misses.
+template <typename VarType>
+PreparedOp PrepareWithKernelCache(
+    const NameVarMap<VarType>& ins, const NameVarMap<VarType>& outs,
+    const framework::OperatorWithKernel& op, const platform::Place& place,
+    const framework::AttributeMap& attrs,
+    const framework::AttributeMap& default_attrs) {
+  KernelCacheKey key;
+  // MKLDNN chooses the kernels by the dims and formats of the inputs
+  if (FLAGS_dygraph_kernel_cache_capacity <= 0 || FLAGS_use_mkldnn ||
+      !GetKernelCacheKey<VarType>(ins, outs, op, place, &key)) {
+    return PrepareImpl<VarType>(ins, outs, op, place, attrs, default_attrs);
+  }
+  size_t hash = HashKernelCacheKey(key, attrs);
+  thread_local std::unordered_map<size_t, KernelCacheEntry> kernel_cache;
+  auto iter = kernel_cache.find(hash);
+  if (iter != kernel_cache.end() && iter->second.key == key &&
+      iter->second.attrs == attrs) {
+    ++kernel_cache_hit_count;
+    return PreparedOp(op, *iter->second.prepared_op);
+  }
+  auto prepared_op =
+      PrepareImpl<VarType>(ins, outs, op, place, attrs, default_attrs);
+  if (kernel_cache.size() >=
+      static_cast<size_t>(FLAGS_dygraph_kernel_cache_capacity)) {
+    VLOG(3) << "Clear the dygraph kernel cache of " << kernel_cache.size()
+            << " kernels";
+    kernel_cache.clear();
+  }
+  // a colliding entry is replaced
+  auto& entry = kernel_cache[hash];
+  entry.key = std::move(key);
+  entry.attrs = attrs;
+  entry.prepared_op.reset(new PreparedOp(prepared_op));
+  return prepared_op;
+}
+
 PreparedOp PreparedOp::Prepare(const NameVarMap<VarBase>& ins,
                                const NameVarMap<VarBase>& outs,
                                const framework::OperatorWithKernel& op,
                                const platform::Place& place,
                                const framework::AttributeMap& attrs,
                                const framework::AttributeMap& default_attrs) {
-  return PrepareImpl<VarBase>(ins, outs, op, place, attrs, default_attrs);
+  return PrepareWithKernelCache<VarBase>(ins, outs, op, place, attrs,
+                                        default_attrs);
 }
 
 PreparedOp PreparedOp::Prepare(const NameVarMap<VariableWrapper>& ins,
@@ -359,8 +539,8 @@ PreparedOp PreparedOp::Prepare(const NameVarMap<VariableWrapper>& ins,
                                const platform::Place& place,
                                const framework::AttributeMap& attrs,
                                const framework::AttributeMap& default_attrs) {
-  return PrepareImpl<VariableWrapper>(ins, outs, op, place, attrs,
-                                      default_attrs);
+  return PrepareWithKernelCache<VariableWrapper>(ins, outs, op, place, attrs,
+                                                 default_attrs);
 }
 
 PreparedOp PreparedOp::Prepare(const NameVarMap<egr::EagerVariable>& ins,
@@ -369,8 +549,8 @@ PreparedOp PreparedOp::Prepare(const NameVarMap<egr::EagerVariable>& ins,
                                const platform::Place& place,
                                const framework::AttributeMap& attrs,
                                const framework::AttributeMap& default_attrs) {
-  return PrepareImpl<egr::EagerVariable>(ins, outs, op, place, attrs,
-                                         default_attrs);
+  return PrepareWithKernelCache<egr::EagerVariable>(ins, outs, op, place,
+                                                    attrs, default_attrs);
 }
 template <typename VarType>
 static void PreparedOpRunImpl(
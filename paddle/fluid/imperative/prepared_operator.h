@@ -40,6 +40,10 @@ namespace imperative {
 
 const framework::Tensor* GetTensorFromVar(const framework::Variable& var);
 
+// The number of the kernels PreparedOp::Prepare has found in the kernel
+// cache of the calling thread.
+size_t KernelCacheHitCount();
+
 template <typename VarType>
 static void SetForwardDataTypeOfGradVar(const std::shared_ptr<VarType>& var);
 
@@ -157,6 +161,9 @@ class PreparedOp {
              const framework::KernelSignature& kernel_signature,
              const phi::Kernel& pt_kernel, platform::DeviceContext* dev_ctx);
 
+  // Binds the kernel prepared for another instance of the same op to op.
+  PreparedOp(const framework::OperatorBase& op, const PreparedOp& prepared_op);
+
   static PreparedOp Prepare(const NameVarMap<VarBase>& ins,
                             const NameVarMap<VarBase>& outs,
                             const framework::OperatorWithKernel& op,
@@ -106,6 +106,43 @@ TEST(test_prepare_op, test_prepare_op) {
                               place, split_attr_map, {}));
 }
 
+TEST(test_prepare_op, test_prepare_op_kernel_cache) {
+  platform::CPUPlace place;
+  framework::AttributeMap split_attr_map;
+  const auto& info = framework::OpInfoMap::Instance().Get("split");
+  if (info.Checker()) info.Checker()->Check(&split_attr_map);
+  auto prepare = [&](framework::proto::VarType::Type dtype) {
+    std::shared_ptr<imperative::VarBase> vin(
+        new imperative::VarBase(false, "vin"));
+    std::shared_ptr<imperative::VarBase> vout(
+        new imperative::VarBase(false, "vout"));
+    auto* tensor = vin->MutableVar()->GetMutable<framework::LoDTensor>();
+    tensor->Resize(phi::make_ddim({2, 5}));
+    tensor->mutable_data(place, framework::TransToPhiDataType(dtype));
+    imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, vin))};
+    imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, vout))};
+    auto op = framework::OpRegistry::CreateOp(
+        "split", CreateVarNameMap(info, "split", ins, true),
+        CreateVarNameMap(info, "split", outs, false), split_attr_map);
+    return PreparedOp::Prepare(
+               ins, outs, dynamic_cast<framework::OperatorWithKernel&>(*op),
+               place, split_attr_map, {})
+        .kernel_type();
+  };
+  auto fp32_kernel_type = prepare(framework::proto::VarType::FP32);
+  ASSERT_EQ(fp32_kernel_type.data_type_, framework::proto::VarType::FP32);
+  // the second call hits the kernel cache
+  size_t hit_count = KernelCacheHitCount();
+  ASSERT_EQ(prepare(framework::proto::VarType::FP32), fp32_kernel_type);
+  ASSERT_EQ(KernelCacheHitCount(), hit_count + 1);
+  // a new dtype misses it
+  auto fp64_kernel_type = prepare(framework::proto::VarType::FP64);
+  ASSERT_EQ(fp64_kernel_type.data_type_, framework::proto::VarType::FP64);
+  ASSERT_EQ(KernelCacheHitCount(), hit_count + 1);
+  ASSERT_EQ(prepare(framework::proto::VarType::FP32), fp32_kernel_type);
+  ASSERT_EQ(KernelCacheHitCount(), hit_count + 2);
+}
+
 const framework::Tensor* GetTensorFromVar(const framework::Variable& var);
 
 TEST(test_prepare_op, test_get_tensor_from_var) {
@@ -241,6 +241,9 @@ void IRPassManager::CreatePasses(Argument *argument,
                 new std::vector<std::string>(
                     argument->nnadapter_model_cache_token()));
     }
+    if (pass_name == "skip_layernorm_fuse_pass") {
+      pass->Set("use_gpu", new bool(argument->use_gpu()));
+    }
     if (pass_name == "fc_fuse_pass") {
       pass->Set("use_gpu", new bool(argument->use_gpu()));
       bool fc_mkldnn_pass = 0;
@@ -388,9 +388,34 @@ bool AnalysisPredictor::PrepareExecutor() {
                           platform::errors::PreconditionNotMet(
                               "The sub_scope should not be nullptr."));
 
+  if (config_.static_memory_plan_enabled() &&
+      !config_.shape_range_info_collected()) {
+    PrepareStaticMemoryPlan();
+  }
+
   return true;
 }
 
+void AnalysisPredictor::PrepareStaticMemoryPlan() {
+  std::map<std::string, std::vector<int32_t>> min_shapes;
+  std::map<std::string, std::vector<int32_t>> max_shapes;
+  std::map<std::string, std::vector<int32_t>> opt_shapes;
+  inference::DeserializeShapeRangeInfo(config_.shape_range_info_path(),
+                                       &min_shapes, &max_shapes, &opt_shapes);
+  std::vector<std::string> feed_names;
+  for (auto &item : idx2feeds_) {
+    feed_names.push_back(item.second);
+  }
+  std::vector<std::string> fetch_names;
+  for (auto &item : idx2fetches_) {
+    fetch_names.push_back(item.second);
+  }
+  static_memory_plan_.reset(new details::StaticMemoryPlan());
+  static_memory_plan_->Build(*inference_program_, max_shapes, feed_names,
+                             fetch_names);
+  static_memory_plan_->Apply(sub_scope_, place_);
+}
+
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
 bool AnalysisPredictor::PrepareFleetExecutor() {
   VLOG(3) << "AnalysisPredictor::PrepareFleetExecutor()";
@@ -1527,6 +1552,8 @@ bool AnalysisPredictor::LoadParameters() {
 }
 
 uint64_t AnalysisPredictor::TryShrinkMemory() {
+  // Give the arena back, the following runs allocate the tensors on demand.
+  static_memory_plan_.reset();
   ClearIntermediateTensor();
   return paddle::memory::Release(place_);
 }
@@ -1548,6 +1575,9 @@ void AnalysisPredictor::ClearIntermediateTensor() {
       }
     }
   }
+  if (static_memory_plan_ != nullptr) {
+    static_memory_plan_->Apply(executor_->scope(), place_);
+  }
 }
 
 #if PADDLE_WITH_TENSORRT
@@ -26,6 +26,7 @@
 #include "paddle/fluid/inference/analysis/analyzer.h"
 #include "paddle/fluid/inference/api/api_impl.h"
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
+#include "paddle/fluid/inference/api/details/static_memory_plan.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/platform/device/gpu/gpu_types.h"
@@ -295,6 +296,11 @@ class AnalysisPredictor : public PaddlePredictor {
   /// \return Whether the function executed successfully
   ///
   bool PrepareExecutor();
+  ///
+  /// \brief Plan the intermediate tensors of sub_scope_ into one arena, with
+  /// the shape info of config_.
+  ///
+  void PrepareStaticMemoryPlan();
 
   ///
   /// \brief Load model program.
@@ -455,6 +461,7 @@ class AnalysisPredictor : public PaddlePredictor {
   std::map<size_t, std::string> idx2feeds_;
   std::vector<framework::OpDesc *> fetches_;
   std::map<size_t, std::string> idx2fetches_;
+  std::unique_ptr<details::StaticMemoryPlan> static_memory_plan_;
 
 #if PADDLE_WITH_MKLDNN
   // Helper class to perform quantization
@@ -0,0 +1,211 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/details/static_memory_plan.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+#include <utility>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/convert_utils.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/memory/malloc.h"
+
+namespace paddle {
+namespace details {
+
+constexpr size_t StaticMemoryPlan::kAlignment;
+
+// A slice of the arena, which keeps the arena alive.
+class ArenaSlice : public phi::Allocation {
+ public:
+  ArenaSlice(const std::shared_ptr<phi::Allocation>& arena, size_t offset,
+             size_t size)
+      : phi::Allocation(static_cast<uint8_t*>(arena->ptr()) + offset, size,
+                        arena->place()),
+        arena_(arena) {}
+
+ private:
+  std::shared_ptr<phi::Allocation> arena_;
+};
+
+static bool IsUnplannedOp(const framework::OpDesc& op) {
+  // Ops which may share buffers between their inputs and outputs, or run
+  // other ops or engines out of the op order of block 0.
+  static const std::unordered_set<std::string> unplanned_ops = {
+      "while",           "conditional_block", "conditional_block_infer",
+      "recurrent",       "tensorrt_engine",   "lite_engine",
+      "share_data",      "share_buffer",      "transfer_layout",
+      "coalesce_tensor", "merge_lod_tensor",  "merge_lod_tensor_infer",
+      "split_lod_tensor"};
+  return unplanned_ops.count(op.Type()) || op.HasAttr("sub_block") ||
+         op.HasAttr("sub_blocks");
+}
+
+static size_t AlignedSize(size_t size) {
+  return (size + StaticMemoryPlan::kAlignment - 1) /
+         StaticMemoryPlan::kAlignment * StaticMemoryPlan::kAlignment;
+}
+
+void StaticMemoryPlan::Build(
+    const framework::ProgramDesc& program,
+    const std::map<std::string, std::vector<int32_t>>& max_shapes,
+    const std::vector<std::string>& feed_names,
+    const std::vector<std::string>& fetch_names) {
+  blocks_.clear();
+  arena_size_ = 0;
+  auto& global_block = program.Block(0);
+  auto ops = global_block.AllOps();
+  int op_num = static_cast<int>(ops.size());
+
+  std::map<std::string, std::pair<int, int>> lifetimes;
+  std::unordered_set<std::string> unplanned_vars;
+  for (int i = 0; i < op_num; ++i) {
+    auto* op = ops[i];
+    if (op->Type() == "feed" || op->Type() == "fetch") continue;
+    bool unplanned = IsUnplannedOp(*op);
+    auto names = op->InputArgumentNames();
+    auto outputs = op->OutputArgumentNames();
+    names.insert(names.end(), outputs.begin(), outputs.end());
+    for (auto& name : names) {
+      if (unplanned) {
+        unplanned_vars.insert(name);
+        continue;
+      }
+      auto it = lifetimes.find(name);
+      if (it == lifetimes.end()) {
+        lifetimes.emplace(name, std::make_pair(i, i));
+      } else {
+        it->second.second = i;
+      }
+    }
+  }
+  for (auto& name : feed_names) {
+    auto it = lifetimes.find(name);
+    if (it != lifetimes.end()) it->second.first = 0;
+  }
+  for (auto& name : fetch_names) {
+    auto it = lifetimes.find(name);
+    if (it != lifetimes.end()) it->second.second = op_num;
+  }
+
+  for (auto& lifetime : lifetimes) {
+    auto& name = lifetime.first;
+    if (unplanned_vars.count(name)) continue;
+    auto* var = global_block.FindVar(name);
+    if (var == nullptr || var->Persistable() ||
+        var->GetType() != framework::proto::VarType::LOD_TENSOR) {
+      continue;
+    }
+    auto shape_it = max_shapes.find(name);
+    if (shape_it == max_shapes.end()) {
+      VLOG(3) << "No max shape of " << name << ", leave it out of the "
+              << "static memory plan.";
+      continue;
+    }
+    int64_t numel = 1;
+    for (auto dim : shape_it->second) {
+      numel = dim > 0 ? numel * dim : 0;
+    }
+    if (numel == 0) continue;
+
+    StaticMemoryBlock block;
+    block.name = name;
+    block.dtype = var->GetDataType();
+    block.size = AlignedSize(numel * framework::SizeOfType(var->GetDataType()));
+    block.first_use = lifetime.second.first;
+    block.last_use = lifetime.second.second;
+    blocks_.emplace_back(std::move(block));
+  }
+  arena_size_ = AssignOffsets(&blocks_);
+}
+
+size_t StaticMemoryPlan::AssignOffsets(std::vector<StaticMemoryBlock>* blocks) {
+  std::vector<StaticMemoryBlock*> order;
+  for (auto& block : *blocks) {
+    order.push_back(&block);
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [](const StaticMemoryBlock* a, const StaticMemoryBlock* b) {
+                     return a->size > b->size;
+                   });
+
+  size_t arena_size = 0;
+  std::vector<const StaticMemoryBlock*> placed;
+  std::vector<const StaticMemoryBlock*> alive;
+  for (auto* block : order) {
+    alive.clear();
+    for (auto* other : placed) {
+      if (other->first_use <= block->last_use &&
+          block->first_use <= other->last_use) {
+        alive.push_back(other);
+      }
+    }
+    std::sort(alive.begin(), alive.end(),
+              [](const StaticMemoryBlock* a, const StaticMemoryBlock* b) {
+                return a->offset < b->offset;
+              });
+    // Take the smallest gap between the alive blocks which fits, or the end.
+    size_t best_offset = 0;
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t prev_end = 0;
+    for (auto* other : alive) {
+      if (other->offset >= prev_end) {
+        size_t gap = other->offset - prev_end;
+        if (gap >= block->size && gap < best_gap) {
+          best_gap = gap;
+          best_offset = prev_end;
+        }
+      }
+      prev_end = std::max(prev_end, other->offset + other->size);
+    }
+    block->offset = best_gap == std::numeric_limits<size_t>::max()
+                        ? prev_end
+                        : best_offset;
+    arena_size = std::max(arena_size, block->offset + block->size);
+    placed.push_back(block);
+  }
+  return arena_size;
+}
+
+void StaticMemoryPlan::Apply(framework::Scope* scope,
+                             const platform::Place& place) {
+  if (blocks_.empty()) return;
+  if (arena_ == nullptr) {
+    arena_ = memory::AllocShared(place, arena_size_);
+  }
+  size_t bound_num = 0;
+  size_t unshared_size = 0;
+  for (auto& block : blocks_) {
+    auto* var = scope->FindLocalVar(block.name);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) continue;
+    auto* tensor = var->GetMutable<framework::LoDTensor>();
+    if (tensor->IsInitialized()) continue;
+    // The tensor counts as initialized from now on, so it needs a dtype.
+    tensor->ResetHolderWithType(
+        std::make_shared<ArenaSlice>(arena_, block.offset, block.size),
+        framework::TransToPhiDataType(block.dtype));
+    ++bound_num;
+    unshared_size += block.size;
+  }
+  VLOG(3) << "Static memory plan: " << bound_num << " tensors in an arena "
+          << "of " << arena_size_ << " bytes on " << place << ", "
+          << unshared_size << " bytes without sharing.";
+}
+
+}  // namespace details
+}  // namespace paddle
@@ -0,0 +1,89 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/place.h"
+#include "paddle/phi/core/allocator.h"
+
+namespace paddle {
+namespace details {
+
+// A tensor placed in the arena. Lifetimes are indexes of the ops of block 0,
+// both ends included.
+struct StaticMemoryBlock {
+  std::string name;
+  framework::proto::VarType::Type dtype{framework::proto::VarType::FP32};
+  size_t size{0};
+  int first_use{0};
+  int last_use{0};
+  size_t offset{0};
+};
+
+// Plans the intermediate tensors of an inference program into one arena.
+//
+// The size of every tensor is taken from its max shape, the lifetime from
+// the op order of the final program, and tensors whose lifetimes do not
+// overlap share the same bytes of the arena. After Apply, the planned
+// tensors hold slices of the arena, so that the kernels write into it
+// without calling the allocator as long as a tensor does not outgrow its max
+// shape. A tensor which does outgrow it, or whose holder is replaced by a
+// kernel, just leaves its slice and falls back to the allocator.
+//
+// NOTE: The lifetimes assume that an output does not share the buffer of an
+// input. The ops whose kernels may do so, like share_data, or transfer_layout
+// on the MKLDNN path, are left out of the plan together with the ops with
+// sub-blocks.
+class StaticMemoryPlan {
+ public:
+  static constexpr size_t kAlignment = 256;
+
+  // Plans the LoDTensors of block 0 of program which have a max shape in
+  // max_shapes. The feed targets are alive from the beginning of the program
+  // and the fetch targets until its end.
+  void Build(const framework::ProgramDesc& program,
+             const std::map<std::string, std::vector<int32_t>>& max_shapes,
+             const std::vector<std::string>& feed_names,
+             const std::vector<std::string>& fetch_names);
+
+  // Reserves the arena on place at the first call, and binds the planned
+  // tensors of scope which hold no memory to it, with the dtype of their
+  // variables. It should be called before
+  // the first run of the program, and again after the tensors are cleared.
+  void Apply(framework::Scope* scope, const platform::Place& place);
+
+  // Assigns the offsets of blocks, greedily by size with best fit, and
+  // returns the arena size.
+  static size_t AssignOffsets(std::vector<StaticMemoryBlock>* blocks);
+
+  const std::vector<StaticMemoryBlock>& blocks() const { return blocks_; }
+
+  size_t arena_size() const { return arena_size_; }
+
+ private:
+  std::vector<StaticMemoryBlock> blocks_;
+  size_t arena_size_{0};
+  std::shared_ptr<phi::Allocation> arena_;
+};
+
+}  // namespace details
+}  // namespace paddle
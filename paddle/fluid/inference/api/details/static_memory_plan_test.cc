@@ -0,0 +1,131 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/details/static_memory_plan.h"
+
+#include <gtest/gtest.h>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace details {
+
+static void AddOp(framework::BlockDesc* block, const std::string& type,
+                  const std::string& x, const std::string& out) {
+  auto* op = block->AppendOp();
+  op->SetType(type);
+  op->SetInput("X", {x});
+  op->SetOutput("Out", {out});
+}
+
+static void AddVar(framework::BlockDesc* block, const std::string& name,
+                   bool persistable = false) {
+  auto* var = block->Var(name);
+  var->SetType(framework::proto::VarType::LOD_TENSOR);
+  var->SetDataType(framework::proto::VarType::FP32);
+  var->SetPersistable(persistable);
+}
+
+static bool Overlap(const StaticMemoryBlock& a, const StaticMemoryBlock& b) {
+  bool alive = a.first_use <= b.last_use && b.first_use <= a.last_use;
+  bool placed = a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+  return alive && placed;
+}
+
+TEST(StaticMemoryPlan, assign_offsets) {
+  std::vector<StaticMemoryBlock> blocks(6);
+  int lifetimes[6][2] = {{0, 2}, {1, 3}, {2, 4}, {3, 5}, {0, 5}, {4, 4}};
+  size_t sizes[6] = {1024, 512, 1024, 256, 256, 2048};
+  for (int i = 0; i < 6; ++i) {
+    blocks[i].name = "x" + std::to_string(i);
+    blocks[i].size = sizes[i];
+    blocks[i].first_use = lifetimes[i][0];
+    blocks[i].last_use = lifetimes[i][1];
+  }
+  size_t arena_size = StaticMemoryPlan::AssignOffsets(&blocks);
+  size_t total_size = 0;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    total_size += blocks[i].size;
+    ASSERT_LE(blocks[i].offset + blocks[i].size, arena_size);
+    for (size_t j = i + 1; j < blocks.size(); ++j) {
+      ASSERT_FALSE(Overlap(blocks[i], blocks[j]))
+          << blocks[i].name << " and " << blocks[j].name;
+    }
+  }
+  ASSERT_LT(arena_size, total_size);
+}
+
+TEST(StaticMemoryPlan, build_and_apply) {
+  framework::ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  for (auto name : {"x", "w", "a", "b", "c", "d", "out"}) {
+    AddVar(block, name, std::string(name) == "w");
+  }
+  AddOp(block, "feed", "feed", "x");
+  AddOp(block, "relu", "x", "a");
+  AddOp(block, "relu", "a", "b");
+  AddOp(block, "relu", "b", "c");
+  AddOp(block, "share_data", "c", "d");
+  AddOp(block, "relu", "d", "out");
+  AddOp(block, "fetch", "out", "fetch");
+
+  std::map<std::string, std::vector<int32_t>> max_shapes = {
+      {"x", {4, 64}}, {"w", {64}},    {"a", {4, 64}},  {"b", {4, 64}},
+      {"c", {4, 64}}, {"d", {4, 64}}, {"out", {4, 64}}};
+  StaticMemoryPlan plan;
+  plan.Build(program, max_shapes, {"x"}, {"out"});
+
+  // w is persistable, c and d are used by share_data.
+  std::map<std::string, StaticMemoryBlock> planned;
+  for (auto& item : plan.blocks()) {
+    planned[item.name] = item;
+  }
+  ASSERT_EQ(planned.size(), 4UL);
+  ASSERT_EQ(planned.count("w"), 0UL);
+  ASSERT_EQ(planned.count("c"), 0UL);
+  ASSERT_EQ(planned.count("d"), 0UL);
+  ASSERT_EQ(planned["x"].first_use, 0);
+  ASSERT_EQ(planned["x"].last_use, 1);
+  ASSERT_EQ(planned["out"].last_use, 7);
+  // a dies before out is written, so out reuses its bytes.
+  ASSERT_EQ(planned["out"].offset, planned["a"].offset);
+  ASSERT_EQ(plan.arena_size(), 2 * 4 * 64 * sizeof(float));
+
+  framework::Scope scope;
+  for (auto& item : planned) {
+    scope.Var(item.first)->GetMutable<framework::LoDTensor>();
+  }
+  platform::CPUPlace place;
+  plan.Apply(&scope, place);
+  auto* a = scope.FindVar("a")->GetMutable<framework::LoDTensor>();
+  auto* out = scope.FindVar("out")->GetMutable<framework::LoDTensor>();
+  ASSERT_TRUE(a->IsInitialized());
+  ASSERT_EQ(a->dtype(), phi::DataType::FLOAT32);
+  a->Resize({4, 64});
+  out->Resize({2, 64});
+  ASSERT_EQ(a->mutable_data<float>(place), out->mutable_data<float>(place));
+
+  // A tensor growing beyond its max shape leaves the arena.
+  out->Resize({8, 64});
+  ASSERT_NE(a->data<float>(), out->mutable_data<float>(place));
+
+  // The cleared tensors are bound to the same arena again.
+  float* a_data = a->data<float>();
+  a->clear();
+  plan.Apply(&scope, place);
+  ASSERT_EQ(a->mutable_data<float>(place), a_data);
+}
+
+}  // namespace details
+}  // namespace paddle
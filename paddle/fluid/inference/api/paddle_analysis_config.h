@@ -789,6 +789,25 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool enable_memory_optim() const;
 
+  ///
+  /// \brief Plan the intermediate tensors into one arena reserved before the
+  /// first run, with the max shapes collected by CollectShapeRangeInfo. The
+  /// tensors whose lifetimes do not overlap share the same bytes, and the
+  /// runs do not call the allocator for the planned tensors.
+  /// NOTE: just experimental, only tensors of block 0 are planned.
+  ///
+  /// \param shape_range_info_path the shape info collected by
+  /// CollectShapeRangeInfo.
+  ///
+  void EnableStaticMemoryPlan(const std::string& shape_range_info_path);
+  ///
+  /// \brief A boolean state telling whether the static memory plan is
+  /// activated.
+  ///
+  /// \return bool Whether the static memory plan is activated.
+  ///
+  bool static_memory_plan_enabled() const;
+
   ///
   /// \brief Turn on profiling report.
   /// If not turned on, no profiling report will be generated.
@@ -933,6 +952,7 @@ struct PD_INFER_DECL AnalysisConfig {
 
   // memory reuse related.
   bool enable_memory_optim_{false};
+  bool static_memory_plan_{false};
 
   bool use_mkldnn_{false};
   std::unordered_set<std::string> mkldnn_enabled_op_types_;
@@ -223,6 +223,9 @@ CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
   // not be damaged by smaller ones.
   passes_.assign({"simplify_with_basic_ops_pass",  //
                   "layer_norm_fuse_pass",
+                  "embedding_eltwise_layernorm_fuse_pass",  //
+                  "multihead_matmul_fuse_pass_v2",          //
+                  "skip_layernorm_fuse_pass",               //
                   "attention_lstm_fuse_pass",       //
                   "seqconv_eltadd_relu_fuse_pass",  //
                   // "seqpool_concat_fuse_pass",    //
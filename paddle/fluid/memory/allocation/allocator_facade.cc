@@ -20,9 +20,11 @@
 #include "paddle/fluid/memory/allocation/allocator_strategy.h"
 #include "paddle/fluid/memory/allocation/auto_growth_best_fit_allocator.h"
 #include "paddle/fluid/memory/allocation/cpu_allocator.h"
+#include "paddle/fluid/memory/allocation/memory_stat_reporter.h"
 #include "paddle/fluid/memory/allocation/naive_best_fit_allocator.h"
 #include "paddle/fluid/memory/allocation/retry_allocator.h"
 #include "paddle/fluid/memory/allocation/stat_allocator.h"
+#include "paddle/fluid/memory/allocation/thread_cached_cpu_allocator.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/place.h"
 
@@ -82,6 +84,12 @@ PADDLE_DEFINE_EXPORTED_bool(
 PADDLE_DEFINE_EXPORTED_bool(use_virtual_memory_auto_growth, false,
                             "Use VirtualMemoryAutoGrowthBestFitAllocator.");
 
+PADDLE_DEFINE_EXPORTED_bool(
+    use_thread_cached_cpu_allocator, false,
+    "Whether to use ThreadCachedCPUAllocator for CPUPlace instead of the "
+    "allocator of FLAGS_allocator_strategy. It serves small requests from "
+    "per-thread size-class caches and suits multi-threaded CPU inference.");
+
 // NOTE(Ruibiao): This FLAGS is just to be compatibled with
 // the old single-stream CUDA allocator. It will be removed
 // after StreamSafeCudaAllocator has been fully tested.
@@ -309,6 +317,9 @@ class AllocatorFacadePrivate {
             "Unsupported allocator strategy: %d", static_cast<int>(strategy_)));
       }
     }
+    if (FLAGS_use_thread_cached_cpu_allocator) {
+      InitThreadCachedCPUAllocator();
+    }
     InitZeroSizeAllocators();
     InitSystemAllocators();
 
@@ -320,6 +331,12 @@ class AllocatorFacadePrivate {
 
     CheckAllocThreadSafe();
 
+    std::vector<platform::Place> places;
+    for (auto& pair : allocators_) {
+      places.emplace_back(pair.first);
+    }
+    StartMemoryStatDump(places);
+
 #ifdef PADDLE_WITH_CUDA
     // No need to wrap CUDAGraphAllocator for StreamSafeCUDAAllocator
     if (!is_stream_safe_cuda_allocator_used_ &&
@@ -471,6 +488,11 @@ class AllocatorFacadePrivate {
         std::make_shared<NaiveBestFitAllocator>(platform::CPUPlace());
   }
 
+  void InitThreadCachedCPUAllocator() {
+    allocators_[platform::CPUPlace()] =
+        std::make_shared<ThreadCachedCPUAllocator>();
+  }
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   void InitNaiveBestFitCUDAPinnedAllocator() {
     allocators_[platform::CUDAPinnedPlace()] =
@@ -719,7 +741,7 @@ class AllocatorFacadePrivate {
 
   void WrapStatAllocator(platform::CUDAPlace p, gpuStream_t stream) {
     std::shared_ptr<Allocator>& allocator = cuda_allocators_[p][stream];
-    allocator = std::make_shared<StatAllocator>(allocator);
+    allocator = std::make_shared<StatAllocator>(allocator, p);
   }
 
 #ifdef PADDLE_WITH_CUDA
@@ -904,9 +926,11 @@ class AllocatorFacadePrivate {
 
   void WrapStatAllocator() {
     for (auto& pair : allocators_) {
-      // Now memory stats is only supported for GPU
-      if (platform::is_gpu_place(pair.first)) {
-        pair.second = std::make_shared<StatAllocator>(pair.second);
+      bool is_host = platform::is_cpu_place(pair.first) ||
+                     platform::is_cuda_pinned_place(pair.first);
+      if (platform::is_gpu_place(pair.first) ||
+          (is_host && FLAGS_memory_stat_host_allocated)) {
+        pair.second = std::make_shared<StatAllocator>(pair.second, pair.first);
       }
     }
   }
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <mutex>  // NOLINT
+#include <unordered_set>
 #include "paddle/fluid/memory/allocation/aligned_allocator.h"
 #include "paddle/fluid/platform/flags.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
@@ -38,13 +39,36 @@ namespace paddle {
 namespace memory {
 namespace allocation {
 
+// The live allocators, so that the free blocks of a place can be reported
+// without going through the AllocatorFacade. Never destroyed, as allocators
+// may be released during static destruction.
+struct LiveAutoGrowthAllocators {
+  std::mutex mutex;
+  std::unordered_set<AutoGrowthBestFitAllocator *> allocators;
+};
+
+static LiveAutoGrowthAllocators *GetLiveAllocators() {
+  static auto *registry = new LiveAutoGrowthAllocators();
+  return registry;
+}
+
 AutoGrowthBestFitAllocator::AutoGrowthBestFitAllocator(
     const std::shared_ptr<Allocator> &underlying_allocator, size_t alignment,
     size_t chunk_size, bool allow_free_idle_chunk)
     : underlying_allocator_(underlying_allocator),
       alignment_(alignment),
       chunk_size_(std::max(AlignedSize(chunk_size, alignment), alignment)),
-      allow_free_idle_chunk_(allow_free_idle_chunk) {}
+      allow_free_idle_chunk_(allow_free_idle_chunk) {
+  auto *registry = GetLiveAllocators();
+  std::lock_guard<std::mutex> guard(registry->mutex);
+  registry->allocators.insert(this);
+}
+
+AutoGrowthBestFitAllocator::~AutoGrowthBestFitAllocator() {
+  auto *registry = GetLiveAllocators();
+  std::lock_guard<std::mutex> guard(registry->mutex);
+  registry->allocators.erase(this);
+}
 
 phi::Allocation *AutoGrowthBestFitAllocator::AllocateImpl(
     size_t unaligned_size) {
@@ -152,6 +176,47 @@ void AutoGrowthBestFitAllocator::FreeImpl(phi::Allocation *allocation) {
   }
 }
 
+AutoGrowthBestFitAllocator::FreeBlockStat
+AutoGrowthBestFitAllocator::GetFreeBlockStat() {
+  std::lock_guard<SpinLock> guard(spinlock_);
+  FreeBlockStat stat;
+  for (auto &chunk : chunks_) {
+    stat.chunk_bytes += chunk.allocation_->size();
+  }
+  for (auto &pair : free_blocks_) {
+    stat.free_bytes += pair.first.first;
+  }
+  stat.free_block_num = free_blocks_.size();
+  if (!free_blocks_.empty()) {
+    stat.largest_free_block = free_blocks_.rbegin()->first.first;
+  }
+  return stat;
+}
+
+AutoGrowthBestFitAllocator::FreeBlockStat
+AutoGrowthBestFitAllocator::CollectFreeBlockStat(
+    const platform::Place &place) {
+  auto *registry = GetLiveAllocators();
+  std::lock_guard<std::mutex> guard(registry->mutex);
+  FreeBlockStat total;
+  for (auto *allocator : registry->allocators) {
+    {
+      std::lock_guard<SpinLock> guard(allocator->spinlock_);
+      if (allocator->chunks_.empty() ||
+          allocator->chunks_.front().allocation_->place() != place) {
+        continue;
+      }
+    }
+    auto stat = allocator->GetFreeBlockStat();
+    total.chunk_bytes += stat.chunk_bytes;
+    total.free_bytes += stat.free_bytes;
+    total.free_block_num += stat.free_block_num;
+    total.largest_free_block =
+        std::max(total.largest_free_block, stat.largest_free_block);
+  }
+  return total;
+}
+
 uint64_t AutoGrowthBestFitAllocator::FreeIdleChunks() {
   if (!allow_free_idle_chunk_) {
     return 0;
@@ -33,8 +33,31 @@ class AutoGrowthBestFitAllocator : public Allocator {
       const std::shared_ptr<Allocator> &underlying_allocator, size_t alignment,
       size_t chunk_size = 0, bool allow_free_idle_chunk = true);
 
+  ~AutoGrowthBestFitAllocator();
+
   bool IsAllocThreadSafe() const override { return true; }
 
+  struct FreeBlockStat {
+    size_t chunk_bytes{0};
+    size_t free_bytes{0};
+    size_t free_block_num{0};
+    size_t largest_free_block{0};
+
+    // The share of free memory which can not be handed out in a single
+    // request of the largest free block size, 0 when nothing is free.
+    double FragmentationRatio() const {
+      return free_bytes == 0 ? 0.0
+                             : 1.0 - static_cast<double>(largest_free_block) /
+                                         static_cast<double>(free_bytes);
+    }
+  };
+
+  FreeBlockStat GetFreeBlockStat();
+
+  // Sums up the free blocks of all the live AutoGrowthBestFitAllocators
+  // holding chunks on the given place.
+  static FreeBlockStat CollectFreeBlockStat(const platform::Place &place);
+
  protected:
   phi::Allocation *AllocateImpl(size_t size) override;
 
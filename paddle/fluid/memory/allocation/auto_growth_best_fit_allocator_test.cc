@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <cstdlib>
+#include <vector>
 
 #include "paddle/fluid/memory/allocation/aligned_allocator.h"
 #include "paddle/fluid/memory/allocation/auto_growth_best_fit_allocator.h"
@@ -171,6 +172,46 @@ TEST(test_auto_growth_allocator, test_free_when_no_cache_hit) {
   TestFreeWhenNoCacheHit(true);
 }
 
+TEST(test_auto_growth_allocator, test_free_block_stat) {
+  FLAGS_free_idle_chunk = false;
+  FLAGS_free_when_no_cache_hit = false;
+  size_t alignment = 256;
+  size_t chunk_size = 1 << 20;
+  auto ag_allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+      std::make_shared<RecordedAllocator>(), alignment, chunk_size);
+
+  std::vector<AllocationPtr> allocations;
+  for (size_t i = 0; i < 4; ++i) {
+    allocations.emplace_back(ag_allocator->Allocate(1000));
+  }
+  // free two blocks which are not adjacent to each other
+  allocations[0].reset();
+  allocations[2].reset();
+
+  auto stat = ag_allocator->GetFreeBlockStat();
+  ASSERT_EQ(stat.chunk_bytes, chunk_size);
+  ASSERT_EQ(stat.free_block_num, 3UL);
+  ASSERT_EQ(stat.free_bytes, chunk_size - 2 * 1024);
+  ASSERT_EQ(stat.largest_free_block, chunk_size - 4 * 1024);
+  ASSERT_DOUBLE_EQ(stat.FragmentationRatio(),
+                   1.0 - static_cast<double>(chunk_size - 4 * 1024) /
+                             (chunk_size - 2 * 1024));
+
+  auto place_stat =
+      AutoGrowthBestFitAllocator::CollectFreeBlockStat(platform::CPUPlace());
+  ASSERT_EQ(place_stat.free_bytes, stat.free_bytes);
+  ASSERT_EQ(place_stat.largest_free_block, stat.largest_free_block);
+  ASSERT_EQ(AutoGrowthBestFitAllocator::CollectFreeBlockStat(
+                platform::CUDAPinnedPlace())
+                .chunk_bytes,
+            0UL);
+
+  allocations.clear();
+  stat = ag_allocator->GetFreeBlockStat();
+  ASSERT_EQ(stat.free_block_num, 1UL);
+  ASSERT_EQ(stat.FragmentationRatio(), 0.0);
+}
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
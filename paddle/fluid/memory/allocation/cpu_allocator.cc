@@ -16,6 +16,7 @@
 
 #include <stdlib.h>
 
+#include "paddle/fluid/memory/stats.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -31,6 +32,8 @@ void CPUAllocator::FreeImpl(phi::Allocation *allocation) {
 #else
   free(p);
 #endif
+  HOST_MEMORY_STAT_UPDATE(Reserved, kCPUMemoryStatId,
+                          -static_cast<int64_t>(allocation->size()));
   delete allocation;
 }
 
@@ -45,6 +48,7 @@ phi::Allocation *CPUAllocator::AllocateImpl(size_t size) {
       platform::errors::ResourceExhausted(
           "Fail to alloc memory of %ld size, error code is %d.", size, error));
 #endif
+  HOST_MEMORY_STAT_UPDATE(Reserved, kCPUMemoryStatId, size);
   return new Allocation(p, size, platform::CPUPlace());
 }
 }  // namespace allocation
@@ -0,0 +1,330 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/memory_stat_reporter.h"
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <map>
+#include <memory>
+#include <sstream>
+#include <thread>  // NOLINT
+
+#include "paddle/fluid/memory/stats.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/flags.h"
+
+PADDLE_DEFINE_EXPORTED_int64(
+    memory_stat_sample_interval, 0,
+    "Record the call site of one in every N allocations for the memory stat "
+    "report. 0 means not to sample any call site. The sampled allocations "
+    "which are still alive can be used to find memory leaks.");
+
+PADDLE_DEFINE_EXPORTED_bool(
+    memory_stat_size_histogram, false,
+    "Count the allocations of every place by size for the memory stat "
+    "report. The counters are shared by all threads, so it is off by "
+    "default to keep them out of the allocation path.");
+
+PADDLE_DEFINE_EXPORTED_bool(
+    memory_stat_host_allocated, false,
+    "Count the memory allocated on CPUPlace and CUDAPinnedPlace, and profile "
+    "their allocations, by wrapping their allocators in StatAllocator. It is "
+    "off by default to keep the counting out of the host allocation path. "
+    "The reserved host memory is always counted.");
+
+PADDLE_DEFINE_EXPORTED_int64(
+    memory_stat_dump_interval, 0,
+    "Log the memory stat report of every place each N seconds. 0 means not "
+    "to dump the report.");
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// Call sites beyond this number are counted in the last, unnamed site.
+static constexpr size_t kMaxCallSiteNum = 4096;
+static constexpr int kMaxSampledFrameNum = 16;
+// Skip the frames of CaptureStack and AllocationProfile::SampleAllocate.
+static constexpr int kSkippedFrameNum = 2;
+
+constexpr size_t AllocationProfile::kHistogramBucketNum;
+
+AllocationProfile* AllocationProfile::GetInstance(
+    const platform::Place& place) {
+  // Never destroyed, allocations may be freed during static destruction.
+  static auto* mutex = new std::mutex();
+  static auto* profiles =
+      new std::map<platform::Place, std::unique_ptr<AllocationProfile>>();
+  std::lock_guard<std::mutex> guard(*mutex);
+  auto& profile = (*profiles)[place];
+  if (profile == nullptr) {
+    profile.reset(new AllocationProfile());
+  }
+  return profile.get();
+}
+
+size_t AllocationProfile::HistogramBucket(size_t size) {
+  size_t bucket = 0;
+  while (size != 0) {
+    size >>= 1;
+    ++bucket;
+  }
+  return std::min(bucket, kHistogramBucketNum - 1);
+}
+
+bool AllocationProfile::NeedSample() {
+  int64_t interval = FLAGS_memory_stat_sample_interval;
+  if (interval <= 0) return false;
+  static thread_local int64_t countdown = 0;
+  if (--countdown > 0) return false;
+  countdown = interval;
+  return true;
+}
+
+static std::string CaptureStack() {
+#if !defined(_WIN32) && !defined(PADDLE_WITH_MUSL)
+  void* frames[kMaxSampledFrameNum + kSkippedFrameNum];
+  int size = backtrace(frames, kMaxSampledFrameNum + kSkippedFrameNum);
+  if (size <= kSkippedFrameNum) return std::string();
+  return std::string(reinterpret_cast<const char*>(frames + kSkippedFrameNum),
+                     (size - kSkippedFrameNum) * sizeof(void*));
+#else
+  return std::string();
+#endif
+}
+
+static std::string SymbolizeStack(const std::string& key) {
+  if (key.empty()) return "<unknown>";
+  std::ostringstream sout;
+#if !defined(_WIN32) && !defined(PADDLE_WITH_MUSL)
+  auto* frames = reinterpret_cast<void* const*>(key.data());
+  size_t size = key.size() / sizeof(void*);
+  Dl_info info;
+  for (size_t i = 0; i < size; ++i) {
+    if (i > 0) sout << "\n";
+    if (dladdr(frames[i], &info) && info.dli_sname) {
+      sout << platform::demangle(info.dli_sname);
+    } else {
+      sout << frames[i];
+    }
+  }
+#endif
+  return sout.str();
+}
+
+void AllocationProfile::SampleAllocate(void* ptr, size_t size) {
+  if (ptr == nullptr) return;
+  std::string stack = CaptureStack();
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (sites_.size() >= kMaxCallSiteNum && sites_.count(stack) == 0) {
+    stack.clear();
+  }
+  auto& site = sites_[stack];
+  ++site.sampled_num;
+  site.sampled_bytes += size;
+  auto& live = live_samples_[ptr];
+  if (live.first == nullptr) {
+    live_sample_num_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    // The previous block at ptr was freed without passing RecordFree
+    --live.first->live_num;
+    live.first->live_bytes -= live.second;
+  }
+  live = std::make_pair(&site, size);
+  ++site.live_num;
+  site.live_bytes += size;
+}
+
+void AllocationProfile::SampleFree(void* ptr) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = live_samples_.find(ptr);
+  if (it == live_samples_.end()) return;
+  --it->second.first->live_num;
+  it->second.first->live_bytes -= it->second.second;
+  live_samples_.erase(it);
+  live_sample_num_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::vector<int64_t> AllocationProfile::SizeHistogram() const {
+  std::vector<int64_t> histogram(kHistogramBucketNum);
+  for (size_t i = 0; i < kHistogramBucketNum; ++i) {
+    histogram[i] = histogram_[i].load(std::memory_order_relaxed);
+  }
+  return histogram;
+}
+
+std::vector<AllocationProfile::CallSite> AllocationProfile::TopCallSites(
+    size_t top_k) const {
+  std::vector<std::pair<std::string, SiteStat>> sites;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    sites.assign(sites_.begin(), sites_.end());
+  }
+  auto by_live_bytes = [](const std::pair<std::string, SiteStat>& a,
+                          const std::pair<std::string, SiteStat>& b) {
+    if (a.second.live_bytes != b.second.live_bytes) {
+      return a.second.live_bytes > b.second.live_bytes;
+    }
+    return a.second.sampled_bytes > b.second.sampled_bytes;
+  };
+  top_k = std::min(top_k, sites.size());
+  std::partial_sort(sites.begin(), sites.begin() + top_k, sites.end(),
+                    by_live_bytes);
+  std::vector<CallSite> result(top_k);
+  for (size_t i = 0; i < top_k; ++i) {
+    result[i].stack = SymbolizeStack(sites[i].first);
+    result[i].sampled_num = sites[i].second.sampled_num;
+    result[i].sampled_bytes = sites[i].second.sampled_bytes;
+    result[i].live_num = sites[i].second.live_num;
+    result[i].live_bytes = sites[i].second.live_bytes;
+  }
+  return result;
+}
+
+void AllocationProfile::Reset() {
+  for (auto& bucket : histogram_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  sites_.clear();
+  live_samples_.clear();
+  live_sample_num_.store(0, std::memory_order_relaxed);
+}
+
+MemoryStatSnapshot GetMemoryStatSnapshot(const platform::Place& place,
+                                         size_t top_k) {
+  MemoryStatSnapshot snapshot;
+  if (platform::is_gpu_place(place)) {
+    int dev_id = place.GetDeviceId();
+    snapshot.allocated_current = StatGetCurrentValue("Allocated", dev_id);
+    snapshot.allocated_peak = StatGetPeakValue("Allocated", dev_id);
+    snapshot.reserved_current = StatGetCurrentValue("Reserved", dev_id);
+    snapshot.reserved_peak = StatGetPeakValue("Reserved", dev_id);
+  } else if (platform::is_cpu_place(place) ||
+             platform::is_cuda_pinned_place(place)) {
+    int stat_id = platform::is_cpu_place(place) ? kCPUMemoryStatId
+                                                : kCUDAPinnedMemoryStatId;
+    snapshot.allocated_current =
+        HostMemoryStatCurrentValue("Allocated", stat_id);
+    snapshot.allocated_peak = HostMemoryStatPeakValue("Allocated", stat_id);
+    snapshot.reserved_current = HostMemoryStatCurrentValue("Reserved", stat_id);
+    snapshot.reserved_peak = HostMemoryStatPeakValue("Reserved", stat_id);
+  }
+  auto* profile = AllocationProfile::GetInstance(place);
+  snapshot.size_histogram = profile->SizeHistogram();
+  snapshot.free_block_stat =
+      AutoGrowthBestFitAllocator::CollectFreeBlockStat(place);
+  snapshot.top_call_sites = profile->TopCallSites(top_k);
+  return snapshot;
+}
+
+std::string MemoryStatReport(const platform::Place& place, size_t top_k) {
+  auto snapshot = GetMemoryStatSnapshot(place, top_k);
+  std::ostringstream sout;
+  sout << "Memory stat of " << place << ":\n";
+  if (!platform::is_gpu_place(place) && !FLAGS_memory_stat_host_allocated) {
+    sout << "  allocated: disabled, set FLAGS_memory_stat_host_allocated to "
+            "enable it\n";
+  } else {
+    sout << "  allocated: current " << snapshot.allocated_current << ", peak "
+         << snapshot.allocated_peak << "\n";
+  }
+  sout << "  reserved: current " << snapshot.reserved_current << ", peak "
+       << snapshot.reserved_peak << "\n";
+  sout << "  allocation size histogram:";
+  if (!FLAGS_memory_stat_size_histogram) {
+    sout << " disabled, set FLAGS_memory_stat_size_histogram to enable it";
+  }
+  sout << "\n";
+  for (size_t i = 0; i < snapshot.size_histogram.size(); ++i) {
+    if (snapshot.size_histogram[i] == 0) continue;
+    size_t lower = i == 0 ? 0 : (1UL << (i - 1));
+    sout << "    [" << lower << ", " << (1UL << i)
+         << "): " << snapshot.size_histogram[i] << "\n";
+  }
+  const auto& free_block_stat = snapshot.free_block_stat;
+  if (free_block_stat.chunk_bytes > 0) {
+    sout << "  auto growth chunks: " << free_block_stat.chunk_bytes
+         << " bytes, free " << free_block_stat.free_bytes << " bytes in "
+         << free_block_stat.free_block_num << " blocks, largest "
+         << free_block_stat.largest_free_block << ", fragmentation "
+         << free_block_stat.FragmentationRatio() << "\n";
+  }
+  if (!snapshot.top_call_sites.empty()) {
+    sout << "  top call sites, sampled one in "
+         << FLAGS_memory_stat_sample_interval << " allocations:\n";
+    for (auto& site : snapshot.top_call_sites) {
+      sout << "  - live " << site.live_bytes << " bytes in " << site.live_num
+           << " allocations, sampled " << site.sampled_bytes << " bytes in "
+           << site.sampled_num << " allocations\n";
+      std::istringstream frames(site.stack);
+      std::string frame;
+      while (std::getline(frames, frame)) {
+        sout << "      " << frame << "\n";
+      }
+    }
+  }
+  return sout.str();
+}
+
+class MemoryStatDumper {
+ public:
+  static MemoryStatDumper* GetInstance() {
+    static MemoryStatDumper instance;
+    return &instance;
+  }
+
+  void Start(const std::vector<platform::Place>& places,
+             int64_t interval_sec) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (thread_.joinable()) return;
+    thread_ = std::thread([this, places, interval_sec] {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (!cv_.wait_for(lock, std::chrono::seconds(interval_sec),
+                           [this] { return stopped_; })) {
+        for (auto& place : places) {
+          LOG(INFO) << MemoryStatReport(place);
+        }
+      }
+    });
+  }
+
+  ~MemoryStatDumper() {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      stopped_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+  }
+
+ private:
+  MemoryStatDumper() = default;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopped_{false};
+  std::thread thread_;
+};
+
+void StartMemoryStatDump(const std::vector<platform::Place>& places) {
+  if (FLAGS_memory_stat_dump_interval <= 0) return;
+  MemoryStatDumper::GetInstance()->Start(places,
+                                         FLAGS_memory_stat_dump_interval);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
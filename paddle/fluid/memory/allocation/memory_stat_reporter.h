@@ -0,0 +1,127 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/allocation/auto_growth_best_fit_allocator.h"
+#include "paddle/fluid/platform/place.h"
+
+DECLARE_bool(memory_stat_size_histogram);
+DECLARE_bool(memory_stat_host_allocated);
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// Statistics of the allocations served on one place, in addition to the
+// Allocated and Reserved values in memory/stats.h. It is fed by
+// StatAllocator and keeps
+//   1. a histogram of the allocation sizes if
+//      FLAGS_memory_stat_size_histogram is set, bucket i counts the requests
+//      of [2^(i-1), 2^i) bytes, and
+//   2. the call sites of one in every FLAGS_memory_stat_sample_interval
+//      allocations, together with the sampled allocations still alive, which
+//      are the candidates of leaks.
+class AllocationProfile {
+ public:
+  static constexpr size_t kHistogramBucketNum = 48;
+
+  struct CallSite {
+    std::string stack;
+    int64_t sampled_num{0};
+    int64_t sampled_bytes{0};
+    int64_t live_num{0};
+    int64_t live_bytes{0};
+  };
+
+  static AllocationProfile* GetInstance(const platform::Place& place);
+
+  static size_t HistogramBucket(size_t size);
+
+  void RecordAllocate(const phi::Allocation* allocation) {
+    if (UNLIKELY(FLAGS_memory_stat_size_histogram)) {
+      histogram_[HistogramBucket(allocation->size())].fetch_add(
+          1, std::memory_order_relaxed);
+    }
+    if (UNLIKELY(NeedSample())) {
+      SampleAllocate(allocation->ptr(), allocation->size());
+    }
+  }
+
+  void RecordFree(const phi::Allocation* allocation) {
+    if (UNLIKELY(live_sample_num_.load(std::memory_order_relaxed) > 0)) {
+      SampleFree(allocation->ptr());
+    }
+  }
+
+  std::vector<int64_t> SizeHistogram() const;
+
+  // The sampled call sites holding the most live bytes.
+  std::vector<CallSite> TopCallSites(size_t top_k) const;
+
+  void Reset();
+
+ private:
+  struct SiteStat {
+    int64_t sampled_num{0};
+    int64_t sampled_bytes{0};
+    int64_t live_num{0};
+    int64_t live_bytes{0};
+  };
+
+  static bool NeedSample();
+
+  void SampleAllocate(void* ptr, size_t size);
+  void SampleFree(void* ptr);
+
+  std::array<std::atomic<int64_t>, kHistogramBucketNum> histogram_{};
+
+  // Keyed by the raw return addresses of the sampled stack
+  std::unordered_map<std::string, SiteStat> sites_;
+  std::unordered_map<void*, std::pair<SiteStat*, size_t>> live_samples_;
+  std::atomic<int64_t> live_sample_num_{0};
+  mutable std::mutex mutex_;
+};
+
+struct MemoryStatSnapshot {
+  int64_t allocated_current{0};
+  int64_t allocated_peak{0};
+  int64_t reserved_current{0};
+  int64_t reserved_peak{0};
+  std::vector<int64_t> size_histogram;
+  AutoGrowthBestFitAllocator::FreeBlockStat free_block_stat;
+  std::vector<AllocationProfile::CallSite> top_call_sites;
+};
+
+MemoryStatSnapshot GetMemoryStatSnapshot(const platform::Place& place,
+                                         size_t top_k = 10);
+
+std::string MemoryStatReport(const platform::Place& place, size_t top_k = 10);
+
+// Logs MemoryStatReport of the places every FLAGS_memory_stat_dump_interval
+// seconds in a background thread, does nothing if the flag is 0.
+void StartMemoryStatDump(const std::vector<platform::Place>& places);
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
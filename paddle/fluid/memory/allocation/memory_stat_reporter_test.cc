@@ -0,0 +1,101 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/memory_stat_reporter.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+#include "paddle/fluid/memory/allocation/stat_allocator.h"
+
+DECLARE_int64(memory_stat_sample_interval);
+DECLARE_bool(memory_stat_size_histogram);
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(MemoryStatReporter, histogram_bucket) {
+  ASSERT_EQ(AllocationProfile::HistogramBucket(0), 0UL);
+  ASSERT_EQ(AllocationProfile::HistogramBucket(1), 1UL);
+  ASSERT_EQ(AllocationProfile::HistogramBucket(2), 2UL);
+  ASSERT_EQ(AllocationProfile::HistogramBucket(3), 2UL);
+  ASSERT_EQ(AllocationProfile::HistogramBucket(4096), 13UL);
+  ASSERT_EQ(AllocationProfile::HistogramBucket(~size_t(0)),
+            AllocationProfile::kHistogramBucketNum - 1);
+}
+
+TEST(MemoryStatReporter, cpu_stat_allocator) {
+  platform::CPUPlace place;
+  AllocationProfile::GetInstance(place)->Reset();
+  FLAGS_memory_stat_sample_interval = 2;
+  FLAGS_memory_stat_size_histogram = true;
+
+  int64_t allocated = HostMemoryStatCurrentValue("Allocated", kCPUMemoryStatId);
+  int64_t reserved = HostMemoryStatCurrentValue("Reserved", kCPUMemoryStatId);
+  auto allocator =
+      std::make_shared<StatAllocator>(std::make_shared<CPUAllocator>(), place);
+  std::vector<AllocationPtr> allocations;
+  for (int i = 0; i < 10; ++i) {
+    allocations.emplace_back(allocator->Allocate(4096));
+  }
+  ASSERT_EQ(HostMemoryStatCurrentValue("Allocated", kCPUMemoryStatId),
+            allocated + 10 * 4096);
+  ASSERT_EQ(HostMemoryStatCurrentValue("Reserved", kCPUMemoryStatId),
+            reserved + 10 * 4096);
+  ASSERT_GE(HostMemoryStatPeakValue("Allocated", kCPUMemoryStatId),
+            allocated + 10 * 4096);
+
+  auto snapshot = GetMemoryStatSnapshot(place, 1);
+  ASSERT_EQ(snapshot.size_histogram[AllocationProfile::HistogramBucket(4096)],
+            10);
+  ASSERT_EQ(snapshot.top_call_sites.size(), 1UL);
+  ASSERT_EQ(snapshot.top_call_sites[0].sampled_num, 5);
+  ASSERT_EQ(snapshot.top_call_sites[0].live_bytes, 5 * 4096);
+
+  allocations.resize(4);
+  snapshot = GetMemoryStatSnapshot(place, 1);
+  ASSERT_EQ(snapshot.top_call_sites[0].sampled_num, 5);
+  ASSERT_EQ(snapshot.top_call_sites[0].live_num, 2);
+  // the AllocatorFacade only wraps the host allocators in StatAllocator
+  // with FLAGS_memory_stat_host_allocated
+  FLAGS_memory_stat_host_allocated = false;
+  ASSERT_NE(MemoryStatReport(place).find("allocated: disabled"),
+            std::string::npos);
+  FLAGS_memory_stat_host_allocated = true;
+  ASSERT_NE(MemoryStatReport(place).find("allocated: current"),
+            std::string::npos);
+  FLAGS_memory_stat_host_allocated = false;
+
+  allocations.clear();
+  ASSERT_EQ(HostMemoryStatCurrentValue("Allocated", kCPUMemoryStatId),
+            allocated);
+  ASSERT_EQ(HostMemoryStatCurrentValue("Reserved", kCPUMemoryStatId),
+            reserved);
+  FLAGS_memory_stat_sample_interval = 0;
+  FLAGS_memory_stat_size_histogram = false;
+
+  // the sizes are not counted by default
+  {
+    auto allocation = allocator->Allocate(4096);
+  }
+  snapshot = GetMemoryStatSnapshot(place, 1);
+  ASSERT_EQ(snapshot.size_histogram[AllocationProfile::HistogramBucket(4096)],
+            10);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/memory/allocation/pinned_allocator.h"
 
+#include "paddle/fluid/memory/stats.h"
+
 namespace paddle {
 namespace memory {
 namespace allocation {
@@ -24,6 +26,8 @@ void CPUPinnedAllocator::FreeImpl(phi::Allocation *allocation) {
 #else
   PADDLE_ENFORCE_GPU_SUCCESS(cudaFreeHost(allocation->ptr()));
 #endif
+  HOST_MEMORY_STAT_UPDATE(Reserved, kCUDAPinnedMemoryStatId,
+                          -static_cast<int64_t>(allocation->size()));
   delete allocation;
 }
 phi::Allocation *CPUPinnedAllocator::AllocateImpl(size_t size) {
@@ -33,6 +37,7 @@ phi::Allocation *CPUPinnedAllocator::AllocateImpl(size_t size) {
 #else
   PADDLE_ENFORCE_GPU_SUCCESS(cudaHostAlloc(&ptr, size, cudaHostAllocPortable));
 #endif
+  HOST_MEMORY_STAT_UPDATE(Reserved, kCUDAPinnedMemoryStatId, size);
   return new Allocation(ptr, size, platform::CUDAPinnedPlace());
 }
 }  // namespace allocation
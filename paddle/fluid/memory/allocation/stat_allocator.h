@@ -15,6 +15,7 @@
 #pragma once
 
 #include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/allocation/memory_stat_reporter.h"
 #include "paddle/fluid/memory/stats.h"
 
 namespace paddle {
@@ -23,23 +24,30 @@ namespace allocation {
 
 class StatAllocator : public Allocator {
  public:
-  explicit StatAllocator(std::shared_ptr<Allocator> underlying_allocator)
-      : underlying_allocator_(std::move(underlying_allocator)) {}
+  StatAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                const platform::Place& place)
+      : underlying_allocator_(std::move(underlying_allocator)),
+        is_host_(platform::is_cpu_place(place) ||
+                 platform::is_cuda_pinned_place(place)),
+        host_stat_id_(platform::is_cpu_place(place)
+                          ? kCPUMemoryStatId
+                          : kCUDAPinnedMemoryStatId),
+        profile_(AllocationProfile::GetInstance(place)) {}
 
   bool IsAllocThreadSafe() const override { return true; }
 
  protected:
   void FreeImpl(phi::Allocation* allocation) override {
-    MEMORY_STAT_UPDATE(Allocated, allocation->place().GetDeviceId(),
-                       -allocation->size());
+    profile_->RecordFree(allocation);
+    UpdateAllocated(allocation, -static_cast<int64_t>(allocation->size()));
     underlying_allocator_->Free(allocation);
   }
 
   phi::Allocation* AllocateImpl(size_t size) override {
     phi::Allocator::AllocationPtr allocation =
         underlying_allocator_->Allocate(size);
-    MEMORY_STAT_UPDATE(Allocated, allocation->place().GetDeviceId(),
-                       allocation->size());
+    UpdateAllocated(allocation.get(), allocation->size());
+    profile_->RecordAllocate(allocation.get());
     return allocation.release();
   }
 
@@ -47,8 +55,21 @@ class StatAllocator : public Allocator {
     return underlying_allocator_->Release(place);
   }
 
+ private:
+  void UpdateAllocated(phi::Allocation* allocation, int64_t increment) {
+    if (is_host_) {
+      HOST_MEMORY_STAT_UPDATE(Allocated, host_stat_id_, increment);
+    } else {
+      MEMORY_STAT_UPDATE(Allocated, allocation->place().GetDeviceId(),
+                         increment);
+    }
+  }
+
  private:
   std::shared_ptr<Allocator> underlying_allocator_;
+  bool is_host_;
+  int host_stat_id_;
+  AllocationProfile* profile_;
 };
 
 }  // namespace allocation
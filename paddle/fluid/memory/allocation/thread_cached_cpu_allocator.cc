@@ -0,0 +1,417 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/thread_cached_cpu_allocator.h"
+
+#include <stdlib.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+#include "paddle/fluid/memory/stats.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// Size classes are multiples of 64 bytes up to 1KB, then four classes per
+// power of two up to kMaxCachedSize.
+static constexpr size_t kSmallClassNum = 16;
+static constexpr size_t kSmallClassMax = kSmallClassNum * 64;
+static constexpr size_t kLog2SmallClassMax = 10;
+static constexpr size_t kClassNum = kSmallClassNum + (22 - 10) * 4;
+
+// Blocks move between a thread cache and the central cache in batches of
+// about kBatchBytes.
+static constexpr size_t kBatchBytes = 128UL << 10;
+static constexpr size_t kMaxBatchNum = 32;
+// Upper bound of the memory a single thread cache keeps idle.
+static constexpr size_t kMaxThreadCacheBytes = 16UL << 20;
+static constexpr size_t kArenaSize = 2UL << 20;
+
+static inline size_t Log2Floor(size_t x) {
+  size_t r = 0;
+  while (x >>= 1) ++r;
+  return r;
+}
+
+constexpr size_t ThreadCachedCPUAllocator::kAlignment;
+constexpr size_t ThreadCachedCPUAllocator::kMaxCachedSize;
+
+size_t ThreadCachedCPUAllocator::SizeClassNum() { return kClassNum; }
+
+size_t ThreadCachedCPUAllocator::SizeClassIndex(size_t size) {
+  if (size <= kSmallClassMax) {
+    return size == 0 ? 0 : (size - 1) / 64;
+  }
+  size_t lg = Log2Floor(size - 1);
+  size_t sub = ((size - 1) >> (lg - 2)) & 3;
+  return kSmallClassNum + (lg - kLog2SmallClassMax) * 4 + sub;
+}
+
+size_t ThreadCachedCPUAllocator::SizeOfClass(size_t index) {
+  if (index < kSmallClassNum) {
+    return (index + 1) * 64;
+  }
+  size_t lg = kLog2SmallClassMax + (index - kSmallClassNum) / 4;
+  size_t sub = (index - kSmallClassNum) % 4;
+  return (1UL << lg) + ((sub + 1) << (lg - 2));
+}
+
+static inline size_t BatchNum(size_t index) {
+  size_t num = kBatchBytes / ThreadCachedCPUAllocator::SizeOfClass(index);
+  return std::min(std::max<size_t>(num, 1), kMaxBatchNum);
+}
+
+// Free blocks are chained through their first word.
+static inline void*& NextOf(void* block) {
+  return *reinterpret_cast<void**>(block);
+}
+
+static void* AllocateArena(size_t size) {
+#ifdef __linux__
+  void* p = mmap(nullptr, size + kArenaSize, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) return nullptr;
+  uintptr_t begin = reinterpret_cast<uintptr_t>(p);
+  uintptr_t aligned = (begin + kArenaSize - 1) & ~(kArenaSize - 1);
+  if (aligned > begin) munmap(p, aligned - begin);
+  size_t tail = begin + size + kArenaSize - (aligned + size);
+  if (tail > 0) munmap(reinterpret_cast<void*>(aligned + size), tail);
+#ifdef MADV_HUGEPAGE
+  madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+#endif
+  return reinterpret_cast<void*>(aligned);
+#elif defined(_WIN32)
+  return _aligned_malloc(size, kArenaSize);
+#else
+  void* p = nullptr;
+  if (posix_memalign(&p, kArenaSize, size) != 0) return nullptr;
+  return p;
+#endif
+}
+
+static void FreeArena(void* p, size_t size) {
+#ifdef __linux__
+  munmap(p, size);
+#elif defined(_WIN32)
+  _aligned_free(p);
+#else
+  free(p);
+#endif
+}
+
+class ThreadCachedCPUAllocator::CentralCache {
+ public:
+  CentralCache() {}
+
+  ~CentralCache() {
+    for (auto& arena : arenas_) {
+      FreeArena(arena.first, arena.second);
+      HOST_MEMORY_STAT_UPDATE(Reserved, kCPUMemoryStatId,
+                              -static_cast<int64_t>(arena.second));
+    }
+  }
+
+  // Chains up to num free blocks of class index to *head, returns how many
+  // blocks were fetched.
+  size_t Fetch(size_t index, size_t num, void** head) {
+    auto& list = lists_[index];
+    size_t fetched = 0;
+    {
+      std::lock_guard<SpinLock> guard(list.lock);
+      while (fetched < num && list.head != nullptr) {
+        void* block = list.head;
+        list.head = NextOf(block);
+        NextOf(block) = *head;
+        *head = block;
+        ++fetched;
+      }
+      list.length -= fetched;
+      list.untrimmed -= std::min(list.untrimmed, fetched);
+    }
+    if (fetched > 0) return fetched;
+
+    size_t block_size = SizeOfClass(index);
+    char* span = reinterpret_cast<char*>(AllocateSpan(num * block_size));
+    if (span == nullptr) return 0;
+    for (size_t i = 0; i < num; ++i) {
+      void* block = span + i * block_size;
+      NextOf(block) = *head;
+      *head = block;
+    }
+    return num;
+  }
+
+  // Takes back a chain of num blocks of class index.
+  void Release(size_t index, void* head, void* tail, size_t num) {
+    auto& list = lists_[index];
+    std::lock_guard<SpinLock> guard(list.lock);
+    NextOf(tail) = list.head;
+    list.head = head;
+    list.length += num;
+    list.untrimmed += num;
+  }
+
+  // Gives the pages inside the free blocks back to the system, except the
+  // page holding the free list link of each block. The blocks stay on the
+  // free lists, their pages are faulted in again when they are reused. The
+  // lists are stacks, so the blocks trimmed before are below the untrimmed
+  // ones and are not advised twice. Returns the number of bytes released.
+  uint64_t Trim() {
+    uint64_t released = 0;
+#ifdef __linux__
+    const uintptr_t page = sysconf(_SC_PAGESIZE);
+    for (size_t index = 0; index < kClassNum; ++index) {
+      size_t block_size = SizeOfClass(index);
+      if (block_size < 2 * page) continue;
+      auto& list = lists_[index];
+      std::lock_guard<SpinLock> guard(list.lock);
+      void* block = list.head;
+      for (size_t i = 0; i < list.untrimmed; ++i, block = NextOf(block)) {
+        uintptr_t addr = reinterpret_cast<uintptr_t>(block);
+        uintptr_t begin = (addr + sizeof(void*) + page - 1) & ~(page - 1);
+        uintptr_t end = (addr + block_size) & ~(page - 1);
+        if (end > begin &&
+            madvise(reinterpret_cast<void*>(begin), end - begin,
+                    MADV_DONTNEED) == 0) {
+          released += end - begin;
+        }
+      }
+      list.untrimmed = 0;
+    }
+#endif
+    return released;
+  }
+
+ private:
+  void* AllocateSpan(size_t size) {
+    std::lock_guard<std::mutex> guard(arena_mutex_);
+    if (arena_end_ - arena_cur_ < static_cast<ptrdiff_t>(size)) {
+      size_t arena_size =
+          (std::max(size, kArenaSize) + kArenaSize - 1) & ~(kArenaSize - 1);
+      void* arena = AllocateArena(arena_size);
+      if (arena == nullptr) return nullptr;
+      HOST_MEMORY_STAT_UPDATE(Reserved, kCPUMemoryStatId, arena_size);
+      arenas_.emplace_back(arena, arena_size);
+      arena_cur_ = reinterpret_cast<char*>(arena);
+      arena_end_ = arena_cur_ + arena_size;
+    }
+    void* span = arena_cur_;
+    arena_cur_ += size;
+    return span;
+  }
+
+  struct FreeList {
+    SpinLock lock;
+    void* head = nullptr;
+    size_t length = 0;
+    // the number of blocks on top of the list not trimmed yet
+    size_t untrimmed = 0;
+  };
+  std::array<FreeList, kClassNum> lists_;
+
+  std::mutex arena_mutex_;
+  std::vector<std::pair<void*, size_t>> arenas_;
+  char* arena_cur_ = nullptr;
+  char* arena_end_ = nullptr;
+};
+
+class ThreadCachedCPUAllocator::ThreadCache {
+ public:
+  explicit ThreadCache(std::shared_ptr<CentralCache> central)
+      : central_(std::move(central)) {}
+
+  ~ThreadCache() { ReleaseAll(); }
+
+  void ReleaseAll() {
+    for (size_t i = 0; i < kClassNum; ++i) {
+      ReleaseToCentral(i, lists_[i].length);
+    }
+  }
+
+  void* Allocate(size_t index) {
+    auto& list = lists_[index];
+    if (list.head == nullptr) {
+      list.length += central_->Fetch(index, BatchNum(index), &list.head);
+      if (list.head == nullptr) return nullptr;
+      cached_bytes_ += list.length * SizeOfClass(index);
+    }
+    void* block = list.head;
+    list.head = NextOf(block);
+    --list.length;
+    cached_bytes_ -= SizeOfClass(index);
+    return block;
+  }
+
+  void Free(void* block, size_t index) {
+    auto& list = lists_[index];
+    NextOf(block) = list.head;
+    list.head = block;
+    ++list.length;
+    cached_bytes_ += SizeOfClass(index);
+    size_t batch = BatchNum(index);
+    if (list.length > 2 * batch) {
+      ReleaseToCentral(index, batch);
+    } else if (cached_bytes_ > kMaxThreadCacheBytes) {
+      ReleaseToCentral(index, (list.length + 1) / 2);
+    }
+  }
+
+ private:
+  void ReleaseToCentral(size_t index, size_t num) {
+    auto& list = lists_[index];
+    num = std::min(num, list.length);
+    if (num == 0) return;
+    void* head = list.head;
+    void* tail = head;
+    for (size_t i = 1; i < num; ++i) tail = NextOf(tail);
+    list.head = NextOf(tail);
+    list.length -= num;
+    cached_bytes_ -= num * SizeOfClass(index);
+    central_->Release(index, head, tail, num);
+  }
+
+  struct FreeList {
+    void* head = nullptr;
+    size_t length = 0;
+  };
+  std::shared_ptr<CentralCache> central_;
+  std::array<FreeList, kClassNum> lists_;
+  size_t cached_bytes_ = 0;
+};
+
+ThreadCachedCPUAllocator::ThreadCachedCPUAllocator()
+    : central_(std::make_shared<CentralCache>()) {}
+
+// The per-thread caches are kept behind trivially destructible thread_local
+// pointers, so that allocations freed during thread or process teardown,
+// after the holder has flushed the caches, can still reach the central cache.
+using ThreadCacheMap =
+    std::unordered_map<const ThreadCachedCPUAllocator::CentralCache*,
+                       std::unique_ptr<ThreadCachedCPUAllocator::ThreadCache>>;
+static thread_local ThreadCacheMap* tls_caches = nullptr;
+static thread_local bool tls_caches_destroyed = false;
+static thread_local const ThreadCachedCPUAllocator::CentralCache*
+    tls_last_central = nullptr;
+static thread_local ThreadCachedCPUAllocator::ThreadCache* tls_last_cache =
+    nullptr;
+
+struct ThreadCacheMapHolder {
+  ~ThreadCacheMapHolder() {
+    tls_caches_destroyed = true;
+    tls_last_central = nullptr;
+    tls_last_cache = nullptr;
+    delete tls_caches;
+    tls_caches = nullptr;
+  }
+};
+static thread_local ThreadCacheMapHolder tls_holder;
+
+ThreadCachedCPUAllocator::ThreadCache*
+ThreadCachedCPUAllocator::GetThreadCache() {
+  if (tls_last_central == central_.get()) {
+    return tls_last_cache;
+  }
+  if (tls_caches_destroyed) return nullptr;
+  if (tls_caches == nullptr) {
+    (void)tls_holder;
+    tls_caches = new ThreadCacheMap();
+  }
+  // A thread cache keeps its central cache alive, so the key of a live
+  // entry can not be reused by another allocator.
+  auto& cache = (*tls_caches)[central_.get()];
+  if (cache == nullptr) {
+    cache.reset(new ThreadCache(central_));
+  }
+  tls_last_central = central_.get();
+  tls_last_cache = cache.get();
+  return tls_last_cache;
+}
+
+phi::Allocation* ThreadCachedCPUAllocator::AllocateImpl(size_t size) {
+  void* p = nullptr;
+  if (size <= kMaxCachedSize) {
+    size_t index = SizeClassIndex(size);
+    auto* cache = GetThreadCache();
+    if (LIKELY(cache != nullptr)) {
+      p = cache->Allocate(index);
+    } else if (central_->Fetch(index, 1, &p) == 0) {
+      p = nullptr;
+    }
+    PADDLE_ENFORCE_NOT_NULL(
+        p, platform::errors::ResourceExhausted(
+               "Fail to alloc memory of %ld size from thread cached "
+               "CPU allocator.",
+               size));
+  } else {
+#ifdef _WIN32
+    p = _aligned_malloc(size, CPUAllocator::kAlignment);
+    PADDLE_ENFORCE_NOT_NULL(
+        p, platform::errors::ResourceExhausted(
+               "Fail to alloc memory of %ld size.", size));
+#else
+    int error = posix_memalign(&p, CPUAllocator::kAlignment, size);
+    PADDLE_ENFORCE_EQ(error, 0,
+                      platform::errors::ResourceExhausted(
+                          "Fail to alloc memory of %ld size, error code is %d.",
+                          size, error));
+#endif
+    HOST_MEMORY_STAT_UPDATE(Reserved, kCPUMemoryStatId, size);
+  }
+  return new Allocation(p, size, platform::CPUPlace());
+}
+
+void ThreadCachedCPUAllocator::FreeImpl(phi::Allocation* allocation) {
+  void* p = allocation->ptr();
+  size_t size = allocation->size();
+  if (size <= kMaxCachedSize) {
+    size_t index = SizeClassIndex(size);
+    auto* cache = GetThreadCache();
+    if (LIKELY(cache != nullptr)) {
+      cache->Free(p, index);
+    } else {
+      central_->Release(index, p, p, 1);
+    }
+  } else {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+    HOST_MEMORY_STAT_UPDATE(Reserved, kCPUMemoryStatId,
+                            -static_cast<int64_t>(size));
+  }
+  delete allocation;
+}
+
+uint64_t ThreadCachedCPUAllocator::ReleaseImpl(const platform::Place& place) {
+  // Only the cache of the calling thread can be flushed, the caches of other
+  // threads are bounded by kMaxThreadCacheBytes.
+  auto* cache = GetThreadCache();
+  if (cache != nullptr) {
+    cache->ReleaseAll();
+  }
+  return central_->Trim();
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
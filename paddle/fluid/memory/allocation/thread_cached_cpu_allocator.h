@@ -0,0 +1,71 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/allocation/spin_lock.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// A CPU allocator in the spirit of tcmalloc. Requests up to kMaxCachedSize
+// are rounded up to a size class and served from a per-thread free list
+// without taking any lock. Each thread cache exchanges blocks with a shared
+// central cache in batches, and the central cache carves new blocks out of
+// 2MB-aligned arenas which are advised to be backed by huge pages. Larger
+// requests go straight to the system allocator.
+//
+// Memory carved from the arenas is kept for reuse until the allocator and
+// all thread caches referring to it are destroyed. Release returns the pages
+// of the free blocks cached by the central cache and the calling thread to
+// the system, while their address space stays reserved.
+class ThreadCachedCPUAllocator : public Allocator {
+ public:
+  static constexpr size_t kAlignment = 64;
+  static constexpr size_t kMaxCachedSize = 4UL << 20;
+
+  ThreadCachedCPUAllocator();
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  static size_t SizeClassNum();
+  static size_t SizeClassIndex(size_t size);
+  static size_t SizeOfClass(size_t index);
+
+  // The central cache and the thread cache are implementation details, they
+  // are declared here so that the thread cache can outlive the allocator.
+  class CentralCache;
+  class ThreadCache;
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override;
+  void FreeImpl(phi::Allocation* allocation) override;
+  uint64_t ReleaseImpl(const platform::Place& place) override;
+
+ private:
+  ThreadCache* GetThreadCache();
+
+  std::shared_ptr<CentralCache> central_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,130 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/thread_cached_cpu_allocator.h"
+
+#include <cstring>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(ThreadCachedCPUAllocator, size_class) {
+  size_t num = ThreadCachedCPUAllocator::SizeClassNum();
+  ASSERT_EQ(ThreadCachedCPUAllocator::SizeOfClass(num - 1),
+            ThreadCachedCPUAllocator::kMaxCachedSize);
+  for (size_t i = 0; i < num; ++i) {
+    size_t size = ThreadCachedCPUAllocator::SizeOfClass(i);
+    ASSERT_EQ(size % ThreadCachedCPUAllocator::kAlignment, 0UL);
+    ASSERT_EQ(ThreadCachedCPUAllocator::SizeClassIndex(size), i);
+    if (i > 0) {
+      size_t prev = ThreadCachedCPUAllocator::SizeOfClass(i - 1);
+      ASSERT_GT(size, prev);
+      ASSERT_EQ(ThreadCachedCPUAllocator::SizeClassIndex(prev + 1), i);
+    }
+  }
+}
+
+TEST(ThreadCachedCPUAllocator, alloc_and_reuse) {
+  ThreadCachedCPUAllocator allocator;
+  std::vector<size_t> sizes = {1, 63, 64, 65, 1000, 1025, 4096, 100000,
+                               ThreadCachedCPUAllocator::kMaxCachedSize,
+                               ThreadCachedCPUAllocator::kMaxCachedSize + 1};
+  for (auto size : sizes) {
+    auto allocation = allocator.Allocate(size);
+    ASSERT_NE(allocation->ptr(), nullptr);
+    ASSERT_EQ(allocation->size(), size);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(allocation->ptr()) %
+                  ThreadCachedCPUAllocator::kAlignment,
+              0UL);
+    memset(allocation->ptr(), 0xab, size);
+    void *ptr = allocation->ptr();
+    allocation.reset();
+    if (size <= ThreadCachedCPUAllocator::kMaxCachedSize) {
+      // the block just freed is on top of the thread cache
+      auto again = allocator.Allocate(size);
+      ASSERT_EQ(again->ptr(), ptr);
+    }
+  }
+}
+
+TEST(ThreadCachedCPUAllocator, release) {
+  ThreadCachedCPUAllocator allocator;
+  const size_t size = 256 << 10;
+  std::vector<AllocationPtr> live;
+  for (int i = 0; i < 64; ++i) {
+    live.emplace_back(allocator.Allocate(size));
+    memset(live.back()->ptr(), 0xab, size);
+  }
+  live.clear();
+#ifdef __linux__
+  ASSERT_GT(allocator.Release(platform::CPUPlace()), 0UL);
+#else
+  allocator.Release(platform::CPUPlace());
+#endif
+  // the blocks are trimmed only once
+  ASSERT_EQ(allocator.Release(platform::CPUPlace()), 0UL);
+
+  // the trimmed blocks are still usable
+  for (int i = 0; i < 64; ++i) {
+    live.emplace_back(allocator.Allocate(size));
+    auto *p = reinterpret_cast<uint8_t *>(live.back()->ptr());
+    memset(p, 0xcd, size);
+    ASSERT_EQ(p[size - 1], 0xcd);
+  }
+}
+
+TEST(ThreadCachedCPUAllocator, multi_thread) {
+  ThreadCachedCPUAllocator allocator;
+  const int thread_num = 8;
+  std::vector<std::vector<AllocationPtr>> handover(thread_num);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; ++t) {
+    threads.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      std::uniform_int_distribution<size_t> dist(1, 256 << 10);
+      std::vector<AllocationPtr> live;
+      for (int i = 0; i < 20000; ++i) {
+        size_t size = dist(rng);
+        live.emplace_back(allocator.Allocate(size));
+        auto *p = reinterpret_cast<uint8_t *>(live.back()->ptr());
+        p[0] = static_cast<uint8_t>(t);
+        p[size - 1] = static_cast<uint8_t>(t);
+        if (live.size() > 64) {
+          size_t victim = rng() % live.size();
+          auto &a = live[victim];
+          auto *q = reinterpret_cast<uint8_t *>(a->ptr());
+          ASSERT_EQ(q[0], static_cast<uint8_t>(t));
+          ASSERT_EQ(q[a->size() - 1], static_cast<uint8_t>(t));
+          std::swap(a, live.back());
+          live.pop_back();
+        }
+      }
+      // leave some blocks to be freed by another thread
+      handover[t] = std::move(live);
+    });
+  }
+  for (auto &th : threads) th.join();
+  // free from the main thread, after the owners have exited
+  for (auto &live : handover) live.clear();
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
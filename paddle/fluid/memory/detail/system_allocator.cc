@@ -26,6 +26,7 @@ limitations under the License. */
 #endif
 #include "gflags/gflags.h"
 #include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/stats.h"
 #include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/device/gpu/gpu_info.h"
 #include "paddle/fluid/platform/device/npu/npu_info.h"
@@ -82,6 +83,7 @@ void* CPUAllocator::Alloc(size_t* index, size_t size) {
   void* p = AlignedMalloc(size);
 
   if (p != nullptr) {
+    HOST_MEMORY_STAT_UPDATE(Reserved, kCPUMemoryStatId, size);
     if (FLAGS_use_pinned_memory) {
       *index = 1;
 #ifdef _WIN32
@@ -96,6 +98,10 @@ void* CPUAllocator::Alloc(size_t* index, size_t size) {
 }
 
 void CPUAllocator::Free(void* p, size_t size, size_t index) {
+  if (p != nullptr) {
+    HOST_MEMORY_STAT_UPDATE(Reserved, kCPUMemoryStatId,
+                            -static_cast<int64_t>(size));
+  }
   if (p != nullptr && index == 1) {
 #ifdef _WIN32
     VirtualUnlock(p, size);
@@ -205,6 +211,7 @@ void* CUDAPinnedAllocator::Alloc(size_t* index, size_t size) {
   if (result == gpuSuccess) {
     *index = 1;  // PINNED memory
     cuda_pinnd_alloc_size_ += size;
+    HOST_MEMORY_STAT_UPDATE(Reserved, kCUDAPinnedMemoryStatId, size);
     return p;
   } else {
     LOG(WARNING) << "cudaHostAlloc failed.";
@@ -225,6 +232,8 @@ void CUDAPinnedAllocator::Free(void* p, size_t size, size_t index) {
                         "allocated cuda pinned memory (%d)",
                         size, cuda_pinnd_alloc_size_));
   cuda_pinnd_alloc_size_ -= size;
+  HOST_MEMORY_STAT_UPDATE(Reserved, kCUDAPinnedMemoryStatId,
+                          -static_cast<int64_t>(size));
 #ifdef PADDLE_WITH_HIP
   err = hipHostFree(p);
   if (err != hipErrorDeinitialized) {
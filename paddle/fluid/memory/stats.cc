@@ -14,6 +14,8 @@ limitations under the License. */
 
 #include "paddle/fluid/memory/stats.h"
 
+#include <mutex>  // NOLINT
+
 #include "paddle/fluid/memory/allocation/spin_lock.h"
 #include "paddle/fluid/platform/variant.h"
 
@@ -28,19 +30,21 @@ class StatRegistry {
   }
 
   StatBase* GetStat(const std::string& stat_type, int dev_id) {
-    auto it = stat_map_.find(GetStatKey(stat_type, dev_id));
-    if (it == stat_map_.end()) {
-      PADDLE_THROW(platform::errors::InvalidArgument(
-          "The STAT type \"%s\" for device %d has not been regeistered.",
-          stat_type.c_str(), dev_id));
-    }
-    return it->second;
+    return GetStatByKey(GetStatKey(stat_type, dev_id));
+  }
+
+  StatBase* GetHostStat(const std::string& stat_type, int stat_id) {
+    return GetStatByKey(GetHostStatKey(stat_type, stat_id));
   }
 
   std::string GetStatKey(const std::string& stat_type, int dev_id) {
     return "STAT_Device" + std::to_string(dev_id) + "_" + stat_type;
   }
 
+  std::string GetHostStatKey(const std::string& stat_type, int stat_id) {
+    return "STAT_Host" + std::to_string(stat_id) + "_" + stat_type;
+  }
+
   int64_t GetCurrentValue(const std::string& stat_type, int dev_id) {
     return GetStat(stat_type, dev_id)->GetCurrentValue();
   }
@@ -54,6 +58,12 @@ class StatRegistry {
     stat_map_[GetStatKey(stat_type, dev_id)] = stat;
   }
 
+  void RegisterHost(const std::string& stat_type, int stat_id,
+                    StatBase* stat) {
+    std::lock_guard<SpinLock> lock_guard(stat_map_lock_);
+    stat_map_[GetHostStatKey(stat_type, stat_id)] = stat;
+  }
+
   void Unregister(const std::string& stat_type, int dev_id) {
     std::lock_guard<SpinLock> lock_guard(stat_map_lock_);
     stat_map_.erase(GetStatKey(stat_type, dev_id));
@@ -66,6 +76,15 @@ class StatRegistry {
  private:
   StatRegistry() = default;
 
+  StatBase* GetStatByKey(const std::string& key) {
+    auto it = stat_map_.find(key);
+    if (it == stat_map_.end()) {
+      PADDLE_THROW(platform::errors::InvalidArgument(
+          "The STAT \"%s\" has not been regeistered.", key.c_str()));
+    }
+    return it->second;
+  }
+
   DISABLE_COPY_AND_ASSIGN(StatRegistry);
 
   std::unordered_map<std::string, StatBase*> stat_map_;
@@ -84,6 +103,22 @@ void StatUpdate(const std::string& stat_type, int dev_id, int64_t increment) {
   StatRegistry::GetInstance()->Update(stat_type, dev_id, increment);
 }
 
+int64_t HostMemoryStatCurrentValue(const std::string& stat_type, int stat_id) {
+  return StatRegistry::GetInstance()->GetHostStat(stat_type, stat_id)
+      ->GetCurrentValue();
+}
+
+int64_t HostMemoryStatPeakValue(const std::string& stat_type, int stat_id) {
+  return StatRegistry::GetInstance()->GetHostStat(stat_type, stat_id)
+      ->GetPeakValue();
+}
+
+void HostMemoryStatUpdate(const std::string& stat_type, int stat_id,
+                          int64_t increment) {
+  StatRegistry::GetInstance()->GetHostStat(stat_type, stat_id)->Update(
+      increment);
+}
+
 #define MEMORY_STAT_REGISTER_WITH_ID(item, id) \
   StatRegistry::GetInstance()->Register(       \
       #item, id, Stat<ThreadLocalStatDevice##id##item>::GetInstance());
@@ -106,9 +141,19 @@ void StatUpdate(const std::string& stat_type, int dev_id, int64_t increment) {
   MEMORY_STAT_REGISTER_WITH_ID(item, 14); \
   MEMORY_STAT_REGISTER_WITH_ID(item, 15)
 
+#define HOST_MEMORY_STAT_REGISTER_WITH_ID(item, id) \
+  StatRegistry::GetInstance()->RegisterHost(        \
+      #item, id, Stat<ThreadLocalStatHost##id##item>::GetInstance());
+
+#define HOST_MEMORY_STAT_REGISTER(item)       \
+  HOST_MEMORY_STAT_REGISTER_WITH_ID(item, 0); \
+  HOST_MEMORY_STAT_REGISTER_WITH_ID(item, 1)
+
 int RegisterAllStats() {
   MEMORY_STAT_REGISTER(Allocated);
   MEMORY_STAT_REGISTER(Reserved);
+  HOST_MEMORY_STAT_REGISTER(Allocated);
+  HOST_MEMORY_STAT_REGISTER(Reserved);
   return 0;
 }
 
@@ -17,7 +17,6 @@ limitations under the License. */
 #include <atomic>
 #include <map>
 #include <string>
-#include "paddle/fluid/framework/new_executor/workqueue/thread_data_registry.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/errors.h"
 #include "paddle/fluid/platform/macros.h"
@@ -25,8 +24,6 @@ limitations under the License. */
 namespace paddle {
 namespace memory {
 
-using framework::ThreadDataRegistry;
-
 struct ThreadLocalStatBase {
   int64_t current{0};
   int64_t peak{0};
@@ -45,6 +42,11 @@ class StatBase {
   DISABLE_COPY_AND_ASSIGN(StatBase);
 };
 
+// The current value of a stat is a single atomic counter, so that the peak
+// is updated without visiting the other threads, and the allocations of a
+// thread still count after the thread exits (e.g. tensors created by a
+// reader thread and freed by the trainer). ThreadLocalStatType only tells
+// the stats apart.
 template <typename ThreadLocalStatType>
 class Stat : public StatBase {
  public:
@@ -54,40 +56,25 @@ class Stat : public StatBase {
   }
 
   int64_t GetCurrentValue() override {
-    std::unordered_map<uint64_t, ThreadLocalStatType> thread_local_stats =
-        ThreadDataRegistry<ThreadLocalStatType>::GetInstance()
-            .GetAllThreadDataByValue();
-    int64_t current_value = 0;
-    for (auto pair : thread_local_stats) {
-      current_value += pair.second.current;
-    }
-    return current_value;
+    return current_value_.load(std::memory_order_relaxed);
   }
 
   int64_t GetPeakValue() override { return peak_value_; }
 
   void Update(int64_t increment) override {
-    auto& thread_data_registry =
-        ThreadDataRegistry<ThreadLocalStatType>::GetInstance();
-    ThreadLocalStatType* thread_local_stat =
-        thread_data_registry.GetMutableCurrentThreadData();
-    thread_local_stat->current += increment;
-
-    if (thread_local_stat->current > thread_local_stat->peak) {
-      thread_local_stat->peak = thread_local_stat->current;
-      int64_t current_value = GetCurrentValue();
-      int64_t prev_value = peak_value_;
-      while (prev_value < current_value &&
-             !peak_value_.compare_exchange_weak(prev_value, current_value)) {
-      }
-      VLOG(8) << "Update peak_value, after update, peak_value = " << peak_value_
-              << " , current value = " << current_value;
+    int64_t current_value =
+        current_value_.fetch_add(increment, std::memory_order_relaxed) +
+        increment;
+    int64_t prev_value = peak_value_.load(std::memory_order_relaxed);
+    while (prev_value < current_value &&
+           !peak_value_.compare_exchange_weak(prev_value, current_value)) {
     }
   }
 
  private:
   Stat() {}
   ~Stat() {}
+  std::atomic<int64_t> current_value_{0};
   std::atomic<int64_t> peak_value_{0};
 };
 
@@ -100,6 +87,16 @@ int64_t StatGetCurrentValue(const std::string& stat_type, int dev_id);
 int64_t StatGetPeakValue(const std::string& stat_type, int dev_id);
 void StatUpdate(const std::string& stat_type, int dev_id, int64_t increment);
 
+// Host memory is not attached to a device, its stats are kept per kind of
+// host place instead, identified by the ids below.
+constexpr int kCPUMemoryStatId = 0;
+constexpr int kCUDAPinnedMemoryStatId = 1;
+
+int64_t HostMemoryStatCurrentValue(const std::string& stat_type, int stat_id);
+int64_t HostMemoryStatPeakValue(const std::string& stat_type, int stat_id);
+void HostMemoryStatUpdate(const std::string& stat_type, int stat_id,
+                          int64_t increment);
+
 #define MEMORY_STAT_FUNC_SWITHCH_CASE(item, id)                          \
   case id:                                                               \
     stat = paddle::memory::Stat<                                         \
@@ -143,6 +140,35 @@ void StatUpdate(const std::string& stat_type, int dev_id, int64_t increment);
 #define MEMORY_STAT_UPDATE(item, id, increment) \
   MEMORY_STAT_FUNC(item, id, Update, increment)
 
+#define HOST_MEMORY_STAT_FUNC_SWITHCH_CASE(item, id)                   \
+  case id:                                                             \
+    stat = paddle::memory::Stat<                                       \
+        paddle::memory::ThreadLocalStatHost##id##item>::GetInstance(); \
+    break
+
+#define HOST_MEMORY_STAT_FUNC(item, id, func, ...)                      \
+  do {                                                                  \
+    paddle::memory::StatBase* stat = nullptr;                           \
+    switch (id) {                                                       \
+      HOST_MEMORY_STAT_FUNC_SWITHCH_CASE(item, 0);                      \
+      HOST_MEMORY_STAT_FUNC_SWITHCH_CASE(item, 1);                      \
+      default:                                                          \
+        PADDLE_THROW(paddle::platform::errors::OutOfRange(              \
+            "Only support host stat id between [0, 1] in memory stats," \
+            "not support host stat id: %d",                             \
+            id));                                                       \
+        break;                                                          \
+    }                                                                   \
+    stat->func(__VA_ARGS__);                                            \
+  } while (0)
+
+#define HOST_MEMORY_STAT_CURRENT_VALUE(item, id) \
+  HOST_MEMORY_STAT_FUNC(item, id, GetCurrentValue)
+#define HOST_MEMORY_STAT_PEAK_VALUE(item, id) \
+  HOST_MEMORY_STAT_FUNC(item, id, GetPeakValue)
+#define HOST_MEMORY_STAT_UPDATE(item, id, increment) \
+  HOST_MEMORY_STAT_FUNC(item, id, Update, increment)
+
 #define MEMORY_STAT_DECLARE_WITH_ID(item, id) \
   struct ThreadLocalStatDevice##id##item : public ThreadLocalStatBase {};
 
@@ -164,9 +190,18 @@ void StatUpdate(const std::string& stat_type, int dev_id, int64_t increment);
   MEMORY_STAT_DECLARE_WITH_ID(item, 14); \
   MEMORY_STAT_DECLARE_WITH_ID(item, 15)
 
+#define HOST_MEMORY_STAT_DECLARE_WITH_ID(item, id) \
+  struct ThreadLocalStatHost##id##item : public ThreadLocalStatBase {};
+
+#define HOST_MEMORY_STAT_DECLARE(item)       \
+  HOST_MEMORY_STAT_DECLARE_WITH_ID(item, 0); \
+  HOST_MEMORY_STAT_DECLARE_WITH_ID(item, 1)
+
 // To add a new STAT type, declare here and register in stats.cc
 MEMORY_STAT_DECLARE(Allocated);
 MEMORY_STAT_DECLARE(Reserved);
+HOST_MEMORY_STAT_DECLARE(Allocated);
+HOST_MEMORY_STAT_DECLARE(Reserved);
 
 }  // namespace memory
 }  // namespace paddle
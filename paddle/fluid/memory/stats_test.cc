@@ -44,9 +44,8 @@ TEST(stats_test, MultiThreadReadWriteTest) {
             ++ready_thread_num;
             cv.notify_one();
           }
-          // Sleep here to not exit before the main thread checking stat
-          // results, because the thread-local stat data will be destroyed when
-          // the thread exit
+          // Sleep here to check the stat results while the threads are
+          // alive, ThreadExitTest checks them after the threads exit
           std::this_thread::sleep_for(std::chrono::seconds(1));
         });
   }
@@ -62,6 +61,10 @@ TEST(stats_test, MultiThreadReadWriteTest) {
   for (size_t i = 0; i < thread_num; ++i) {
     threads[i].join();
   }
+  // the updates of the exited threads are kept, undo them for other tests
+  StatUpdate(stat_type, 0,
+             -int64_t((thread_num * data_num * (data_num - 1)) >> 1));
+  EXPECT_EQ(StatGetCurrentValue(stat_type, 0), 0);
 }
 
 TEST(stats_test, PeakValueTest) {
@@ -103,5 +106,36 @@ TEST(stats_test, PeakValueTest) {
   EXPECT_EQ(StatGetPeakValue(stat_type, 0), peak_value);
 }
 
+TEST(stats_test, ThreadExitTest) {
+  std::string stat_type = "Reserved";
+  int64_t current = StatGetCurrentValue(stat_type, 1);
+  // the memory allocated in a thread stays counted after the thread exits,
+  // until another thread frees it
+  std::thread allocating_thread([&stat_type] {
+    for (int i = 0; i < 100; ++i) {
+      StatUpdate(stat_type, 1, 1024);
+    }
+  });
+  allocating_thread.join();
+  EXPECT_EQ(StatGetCurrentValue(stat_type, 1), current + 100 * 1024);
+  EXPECT_GE(StatGetPeakValue(stat_type, 1), current + 100 * 1024);
+  StatUpdate(stat_type, 1, -100 * 1024);
+  EXPECT_EQ(StatGetCurrentValue(stat_type, 1), current);
+}
+
+TEST(stats_test, HostStatTest) {
+  for (int stat_id : {kCPUMemoryStatId, kCUDAPinnedMemoryStatId}) {
+    int64_t current = HostMemoryStatCurrentValue("Reserved", stat_id);
+    HostMemoryStatUpdate("Reserved", stat_id, 1024);
+    HOST_MEMORY_STAT_UPDATE(Reserved, stat_id, 1024);
+    EXPECT_EQ(HostMemoryStatCurrentValue("Reserved", stat_id), current + 2048);
+    EXPECT_GE(HostMemoryStatPeakValue("Reserved", stat_id), current + 2048);
+    HOST_MEMORY_STAT_UPDATE(Reserved, stat_id, -2048);
+    EXPECT_EQ(HostMemoryStatCurrentValue("Reserved", stat_id), current);
+  }
+  // host stats are kept apart from the device stats
+  EXPECT_EQ(StatGetCurrentValue("Reserved", 0), 0);
+}
+
 }  // namespace memory
 }  // namespace paddle
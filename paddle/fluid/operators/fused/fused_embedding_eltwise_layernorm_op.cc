@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <cmath>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/platform/errors.h"
@@ -152,6 +153,81 @@ Not suggest to use in other case except has same structure as ernie.
   }
 };
 
+template <typename DeviceContext, typename T>
+class EmbeddingEltWiseLayerNormCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto ids = context.MultiInput<framework::Tensor>("Ids");
+    auto embs = context.MultiInput<framework::Tensor>("Embs");
+    int input_num = static_cast<int>(ids.size());
+
+    auto* bias = context.Input<framework::Tensor>("Bias");
+    auto* scale = context.Input<framework::Tensor>("Scale");
+    auto* out = context.Output<framework::Tensor>("Out");
+
+    // should be (B * S * hidden)
+    auto id0_dims = ids[0]->dims();
+    auto emb0_dims = embs[0]->dims();
+
+    int64_t positions = id0_dims[0] * id0_dims[1];
+    int64_t hidden = emb0_dims[1];
+
+    std::vector<const int64_t*> ids_d(input_num);
+    std::vector<const T*> embs_d(input_num);
+    for (int i = 0; i < input_num; ++i) {
+      ids_d[i] = ids[i]->data<int64_t>();
+      embs_d[i] = embs[i]->data<T>();
+      // Check the ids before entering the parallel region, an exception can
+      // not be propagated out of it.
+      int64_t height = embs[i]->dims()[0];
+      for (int64_t p = 0; p < positions; ++p) {
+        PADDLE_ENFORCE_EQ(
+            ids_d[i][p] >= 0 && ids_d[i][p] < height, true,
+            platform::errors::InvalidArgument(
+                "The id of Ids[%d] should be in [0, %d), but received %d.", i,
+                height, ids_d[i][p]));
+      }
+    }
+
+    auto* bias_d = bias->data<float>();
+    auto* scale_d = scale->data<float>();
+    auto* output_d = out->mutable_data<T>(context.GetPlace());
+    float eps = context.Attr<float>("epsilon");
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t p = 0; p < positions; ++p) {
+      T* out_row = output_d + p * hidden;
+      const T* emb_row = embs_d[0] + ids_d[0][p] * hidden;
+      for (int64_t j = 0; j < hidden; ++j) {
+        out_row[j] = emb_row[j];
+      }
+      for (int i = 1; i < input_num; ++i) {
+        emb_row = embs_d[i] + ids_d[i][p] * hidden;
+        for (int64_t j = 0; j < hidden; ++j) {
+          out_row[j] += emb_row[j];
+        }
+      }
+      T mean = static_cast<T>(0);
+      for (int64_t j = 0; j < hidden; ++j) {
+        mean += out_row[j];
+      }
+      mean /= hidden;
+      T var = static_cast<T>(0);
+      for (int64_t j = 0; j < hidden; ++j) {
+        T diff = out_row[j] - mean;
+        var += diff * diff;
+      }
+      var /= hidden;
+      T rsigma = static_cast<T>(1) / std::sqrt(var + eps);
+      for (int64_t j = 0; j < hidden; ++j) {
+        out_row[j] = scale_d[j] * (out_row[j] - mean) * rsigma + bias_d[j];
+      }
+    }
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -159,3 +235,6 @@ namespace ops = paddle::operators;
 REGISTER_OP_WITHOUT_GRADIENT(fused_embedding_eltwise_layernorm,
                              ops::EmbeddingEltWiseLayerNormOp,
                              ops::EmbeddingEltWiseLayerNormOpMaker);
+REGISTER_OP_CPU_KERNEL(fused_embedding_eltwise_layernorm,
+                       ops::EmbeddingEltWiseLayerNormCPUKernel<
+                           paddle::platform::CPUDeviceContext, float>);
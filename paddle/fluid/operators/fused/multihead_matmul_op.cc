@@ -12,9 +12,12 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/platform/errors.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
 
 namespace paddle {
 namespace operators {
@@ -111,9 +114,123 @@ Example of matrix multiplication with head_number of B
   }
 };
 
+template <typename DeviceContext, typename T>
+class MultiHeadMatMulV2CPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    using Tensor = framework::Tensor;
+    auto *input = context.Input<framework::Tensor>("Input");
+    auto *w = context.Input<framework::Tensor>("W");
+    auto *bias = context.Input<framework::Tensor>("Bias");
+    auto &bias_qk = GET_DATA_SAFELY(context.Input<framework::Tensor>("BiasQK"),
+                                    "Input", "BiasQK", "MultiHeadMatMulV2");
+
+    auto *bias_d = bias->data<T>();
+    auto *bias_qk_d = bias_qk.template data<T>();
+    T scale = static_cast<T>(context.Attr<float>("alpha"));
+    int head_number = context.Attr<int>("head_number");
+
+    auto &device_ctx = context.template device_context<DeviceContext>();
+    // should be (B * S * hidden)
+    auto input_dims = input->dims();
+    // shouble be (hidden * 3 * all_head_size)
+    auto w_dims = w->dims();
+    int batch = input_dims[0];
+    int seq_len = input_dims[1];
+    int all_head_size = w_dims[2];
+    int head_size = all_head_size / head_number;
+    // if bias_qk is [batch, 1, 1, seq_len], it is broadcasted over the heads
+    // and the query rows while computing the softmax.
+    bool broadcast_bias_qk = bias_qk.numel() == (batch * seq_len);
+
+    auto *out = context.Output<framework::Tensor>("Out");
+    out->Resize({batch, seq_len, all_head_size});
+    auto *output_d = out->mutable_data<T>(context.GetPlace());
+
+    // (B*S, hidden)
+    const Tensor input_matrix =
+        framework::ReshapeToMatrix(*input, 2 /*x_num_col_dims */);
+    // (hidden, 3 * all_head_size)
+    const Tensor w_matrix =
+        framework::ReshapeToMatrix(*w, 1 /*y_num_col_dims*/);
+
+    // (B * S, hidden) * (hidden, 3 * N * H) -> (B * S * 3 * N * H)
+    Tensor temp_out_tensor;
+    temp_out_tensor.Resize({batch * seq_len, 3 * all_head_size});
+    auto *temp_out_data = temp_out_tensor.mutable_data<T>(context.GetPlace());
+    auto blas = phi::funcs::GetBlas<DeviceContext, T>(device_ctx);
+    blas.MatMul(input_matrix, w_matrix, &temp_out_tensor);
+
+    const int qkv_stride = 3 * all_head_size;
+    const int rows = batch * seq_len;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < rows; ++i) {
+      T *row = temp_out_data + i * qkv_stride;
+      for (int j = 0; j < qkv_stride; ++j) {
+        row[j] += bias_d[j];
+      }
+    }
+
+    // Q, K and V of one head are read in place from the BxSx3xNxH buffer
+    // with a leading dimension of 3 * N * H, and the result of each head is
+    // written straight into the BxSxNxH output, so no transpose is needed.
+    Tensor qk_tensor;
+    qk_tensor.Resize({batch * head_number, seq_len, seq_len});
+    auto *qk_data = qk_tensor.mutable_data<T>(context.GetPlace());
+    const int batch_heads = batch * head_number;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int bn = 0; bn < batch_heads; ++bn) {
+      int b = bn / head_number;
+      int n = bn % head_number;
+      const T *q_ptr =
+          temp_out_data + b * seq_len * qkv_stride + n * head_size;
+      const T *k_ptr = q_ptr + all_head_size;
+      const T *v_ptr = k_ptr + all_head_size;
+      T *qk_ptr = qk_data + bn * seq_len * seq_len;
+      blas.GEMM(CblasNoTrans, CblasTrans, seq_len, seq_len, head_size, scale,
+                q_ptr, qkv_stride, k_ptr, qkv_stride, static_cast<T>(0),
+                qk_ptr, seq_len);
+
+      for (int s = 0; s < seq_len; ++s) {
+        T *qk_row = qk_ptr + s * seq_len;
+        const T *bias_row = broadcast_bias_qk
+                                ? bias_qk_d + b * seq_len
+                                : bias_qk_d + (bn * seq_len + s) * seq_len;
+        T max_val = qk_row[0] + bias_row[0];
+        for (int t = 0; t < seq_len; ++t) {
+          qk_row[t] += bias_row[t];
+          max_val = std::max(max_val, qk_row[t]);
+        }
+        T sum = static_cast<T>(0);
+        for (int t = 0; t < seq_len; ++t) {
+          qk_row[t] = std::exp(qk_row[t] - max_val);
+          sum += qk_row[t];
+        }
+        T inv_sum = static_cast<T>(1) / sum;
+        for (int t = 0; t < seq_len; ++t) {
+          qk_row[t] *= inv_sum;
+        }
+      }
+
+      blas.GEMM(CblasNoTrans, CblasNoTrans, seq_len, head_size, seq_len,
+                static_cast<T>(1), qk_ptr, seq_len, v_ptr, qkv_stride,
+                static_cast<T>(0),
+                output_d + b * seq_len * all_head_size + n * head_size,
+                all_head_size);
+    }
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
 namespace ops = paddle::operators;
 REGISTER_OP_WITHOUT_GRADIENT(multihead_matmul, ops::MultiHeadMatMulV2Op,
                              ops::MultiHeadMatMulV2OpMaker);
+REGISTER_OP_CPU_KERNEL(
+    multihead_matmul,
+    ops::MultiHeadMatMulV2CPUKernel<paddle::platform::CPUDeviceContext, float>);
@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <cmath>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/platform/errors.h"
@@ -83,9 +84,82 @@ This op is used for skip_layernorm_fuse_pass, which fuse op pattern as followed.
   }
 };
 
+template <typename DeviceContext, typename T>
+class SkipLayerNormCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *X = context.Input<framework::Tensor>("X");
+    auto *Y = context.Input<framework::Tensor>("Y");
+    auto *scale = context.Input<framework::Tensor>("Scale");
+    auto *bias = context.Input<framework::Tensor>("Bias");
+
+    auto *X_d = X->data<T>();
+    auto *Y_d = Y->data<T>();
+    auto *scale_d = scale->data<T>();
+    auto *bias_d = bias->data<T>();
+    float epsilon = context.Attr<float>("epsilon");
+
+    auto *out = context.Output<framework::Tensor>("Out");
+    out->Resize(X->dims());
+    auto *output_d = out->mutable_data<T>(context.GetPlace());
+
+    PADDLE_ENFORCE_EQ(
+        X->dims(), Y->dims(),
+        platform::errors::InvalidArgument(
+            "The CPU kernel of skip_layernorm requires X and Y of the same "
+            "shape, but got X %s and Y %s.",
+            X->dims(), Y->dims()));
+    int begin_norm_axis = context.Attr<int>("begin_norm_axis");
+    PADDLE_ENFORCE_EQ(
+        begin_norm_axis > 0 && begin_norm_axis < X->dims().size(), true,
+        platform::errors::InvalidArgument(
+            "Attr(begin_norm_axis) of skip_layernorm must be in [1, %d), but "
+            "got %d.",
+            X->dims().size(), begin_norm_axis));
+    auto matrix_dim = phi::flatten_to_2d(X->dims(), begin_norm_axis);
+    int64_t rows = matrix_dim[0];
+    int64_t hidden = matrix_dim[1];
+    PADDLE_ENFORCE_EQ(
+        scale->numel() == hidden && bias->numel() == hidden, true,
+        platform::errors::InvalidArgument(
+            "The size of Scale and Bias of skip_layernorm must be %d, but "
+            "got %d and %d.",
+            hidden, scale->numel(), bias->numel()));
+    // The residual add is fused into the statistics pass, so every row is
+    // read from X and Y once and written to Out once.
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t i = 0; i < rows; ++i) {
+      const T *x_row = X_d + i * hidden;
+      const T *y_row = Y_d + i * hidden;
+      T *out_row = output_d + i * hidden;
+      T mean = static_cast<T>(0);
+      for (int64_t j = 0; j < hidden; ++j) {
+        out_row[j] = x_row[j] + y_row[j];
+        mean += out_row[j];
+      }
+      mean /= hidden;
+      T var = static_cast<T>(0);
+      for (int64_t j = 0; j < hidden; ++j) {
+        T diff = out_row[j] - mean;
+        var += diff * diff;
+      }
+      var /= hidden;
+      T rsigma = static_cast<T>(1) / std::sqrt(var + epsilon);
+      for (int64_t j = 0; j < hidden; ++j) {
+        out_row[j] = scale_d[j] * (out_row[j] - mean) * rsigma + bias_d[j];
+      }
+    }
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
 namespace ops = paddle::operators;
 REGISTER_OP_WITHOUT_GRADIENT(skip_layernorm, ops::SkipLayerNormOp,
                              ops::SkipLayerNormOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    skip_layernorm,
+    ops::SkipLayerNormCPUKernel<paddle::platform::CPUDeviceContext, float>);
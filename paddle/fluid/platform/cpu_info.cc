@@ -30,7 +30,18 @@ limitations under the License. */
 #include <unistd.h>
 #endif  // _WIN32
 
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
 #include "paddle/fluid/platform/flags.h"
 
 DECLARE_double(fraction_of_cpu_memory_to_use);
@@ -209,5 +220,102 @@ bool MayIUse(const cpu_isa_t cpu_isa) {
 }
 #endif
 
+#ifdef __linux__
+// Parse a cpu list such as "0-23,48-71" into cpu ids.
+static std::vector<int> ParseCpuList(const std::string& cpu_list) {
+  std::vector<int> cpus;
+  std::stringstream ss(cpu_list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n") {
+      continue;
+    }
+    auto pos = range.find('-');
+    int first = std::stoi(range.substr(0, pos));
+    int last =
+        pos == std::string::npos ? first : std::stoi(range.substr(pos + 1));
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+#endif
+
+std::vector<int> CpuNumaNodeIds() {
+  int num_cpus = static_cast<int>(std::thread::hardware_concurrency());
+  std::vector<int> node_ids;
+#ifdef __linux__
+  const std::string node_root = "/sys/devices/system/node";
+  DIR* dir = opendir(node_root.c_str());
+  if (dir != nullptr) {
+    struct dirent* entry = nullptr;
+    while ((entry = readdir(dir)) != nullptr) {
+      std::string name = entry->d_name;
+      if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+          !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+        continue;
+      }
+      int node = std::stoi(name.substr(4));
+      std::ifstream fin(node_root + "/" + name + "/cpulist");
+      std::string cpu_list;
+      if (!fin || !std::getline(fin, cpu_list)) {
+        continue;
+      }
+      for (auto cpu : ParseCpuList(cpu_list)) {
+        if (cpu >= static_cast<int>(node_ids.size())) {
+          node_ids.resize(cpu + 1, -1);
+        }
+        node_ids[cpu] = node;
+      }
+    }
+    closedir(dir);
+  }
+#endif
+  if (node_ids.empty()) {
+    node_ids.assign(std::max(num_cpus, 1), 0);
+  }
+  return node_ids;
+}
+
+int CpuNumaNodeCount() {
+  auto node_ids = CpuNumaNodeIds();
+  int max_node = *std::max_element(node_ids.begin(), node_ids.end());
+  return std::max(max_node + 1, 1);
+}
+
+std::vector<int> ProcessAllowedCpus() {
+  std::vector<int> cpus;
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  // the mask of the main thread, not of the calling thread, which may be
+  // bound already
+  if (sched_getaffinity(getpid(), sizeof(cpu_set_t), &cpu_set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpu_set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+#endif
+  return cpus;
+}
+
+bool BindCurrentThreadToCpu(int cpu_id) {
+#ifdef __linux__
+  if (cpu_id < 0 || cpu_id >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu_id, &cpu_set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                                &cpu_set) == 0;
+#else
+  return false;
+#endif
+}
+
 }  // namespace platform
 }  // namespace paddle
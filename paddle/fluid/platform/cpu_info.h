@@ -16,6 +16,8 @@ limitations under the License. */
 
 #include <stddef.h>
 
+#include <vector>
+
 #ifdef _WIN32
 #if defined(__AVX2__)
 #include <immintrin.h>  // avx2
@@ -98,5 +100,22 @@ typedef enum {
 // May I use some instruction
 bool MayIUse(const cpu_isa_t cpu_isa);
 
+//! Get the NUMA node of every online logical cpu, indexed by cpu id. The node
+//! id is -1 for offline cpus. All online cpus are reported on node 0 when the
+//! topology can not be detected.
+std::vector<int> CpuNumaNodeIds();
+
+//! Get the number of NUMA nodes, at least 1.
+int CpuNumaNodeCount();
+
+//! Get the logical cpus the process may run on, i.e. the affinity mask of its
+//! main thread, which is limited by taskset, cgroup cpusets and so on. Return
+//! an empty vector if it can not be detected.
+std::vector<int> ProcessAllowedCpus();
+
+//! Bind the calling thread to a logical cpu. Return false if it is not
+//! supported on this platform or the binding fails.
+bool BindCurrentThreadToCpu(int cpu_id);
+
 }  // namespace platform
 }  // namespace paddle
@@ -30,3 +30,13 @@ TEST(CpuMemoryUsage, Print) {
                                        use_percent, memory_size)
             << std::endl;
 }
+
+TEST(CpuNumaNode, Topology) {
+  auto node_ids = paddle::platform::CpuNumaNodeIds();
+  EXPECT_GT(node_ids.size(), 0UL);
+  int num_nodes = paddle::platform::CpuNumaNodeCount();
+  EXPECT_GE(num_nodes, 1);
+  for (auto node : node_ids) {
+    EXPECT_LT(node, num_nodes);
+  }
+}
@@ -610,6 +610,102 @@ PADDLE_DEFINE_EXPORTED_int32(
     "less FLAGS_max_inplace_grad_add, than it will be use several grad_add"
     "instead of sum. Default is 0.");
 
+/**
+ * Performance related FLAG
+ * Name: eager_backward_num_threads
+ * Since Version: 2.3.0
+ * Value Range: int32, default=0
+ * Example:
+ * Note: The number of threads running the grad nodes on CPU in the eager
+ * backward. If 0, the grad nodes run one by one in the calling thread.
+ */
+PADDLE_DEFINE_EXPORTED_int32(
+    eager_backward_num_threads, 0,
+    "The number of threads running the grad nodes on CPU in the eager "
+    "backward. If 0, the grad nodes run one by one in the calling thread. "
+    "Default is 0.");
+
+/**
+ * Debug related FLAG
+ * Name: eager_backward_deterministic
+ * Since Version: 2.3.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the eager backward with multiple threads sums the gradients
+ * in the order the grad nodes are dispatched, instead of the order they
+ * finish, so that the results do not depend on the timing of the threads.
+ */
+PADDLE_DEFINE_EXPORTED_bool(
+    eager_backward_deterministic, false,
+    "Sum the gradients of the eager backward with multiple threads in the "
+    "order the grad nodes are dispatched, instead of the order they finish.");
+
+/**
+ * Performance related FLAG
+ * Name: dygraph_kernel_cache_capacity
+ * Since Version: 2.3.0
+ * Value Range: int32, default=4096
+ * Example:
+ * Note: The max number of kernels each thread caches for the ops of the
+ * dygraph mode, keyed by the op type, the place, the attributes and the var
+ * types, dtypes, layouts and places of the inputs, so that an op called with
+ * the same signature again skips choosing its kernel. The cache is cleared
+ * when it is full, and 0 disables it.
+ */
+PADDLE_DEFINE_EXPORTED_int32(
+    dygraph_kernel_cache_capacity, 4096,
+    "The max number of kernels each thread caches for the ops of the dygraph "
+    "mode, 0 to disable the cache.");
+
+/**
+ * Distributed related FLAG
+ * Name: eager_reducer_autotune_group_size
+ * Since Version: 2.3.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the reducer of the DataParallel of the dygraph mode on CPU
+ * times the allreduce of its process group when it is created, and regroups
+ * the gradients by the group size that hides the latency of the allreduce,
+ * instead of comm_buffer_size.
+ */
+PADDLE_DEFINE_EXPORTED_bool(
+    eager_reducer_autotune_group_size, false,
+    "Regroup the gradients of the dygraph DataParallel on CPU by the group "
+    "size tuned from the latency and the bandwidth of the allreduce.");
+
+/**
+ * Distributed related FLAG
+ * Name: gloo_allreduce_comm_dtype
+ * Since Version: 2.3.0
+ * Value Range: string, {"", "float16", "bfloat16"}, default=""
+ * Example: FLAGS_gloo_allreduce_comm_dtype="bfloat16"
+ * Note: If set, the float32 sum allreduce of ProcessGroupGloo, like the one
+ * of the gradients of the DataParallel of the dygraph mode, sends the tensors
+ * casted to this dtype, which halves the bytes on the wire. Each partial sum
+ * is still added in float32 before it is casted again.
+ */
+PADDLE_DEFINE_EXPORTED_string(
+    gloo_allreduce_comm_dtype, "",
+    "The dtype, float16 or bfloat16, the float32 sum allreduce of "
+    "ProcessGroupGloo sends the tensors in. Empty to send them in float32.");
+
+/**
+ * Distributed related FLAG
+ * Name: eager_reducer_topk_ratio
+ * Since Version: 2.3.0
+ * Value Range: double, [0, 1), default=0
+ * Example: FLAGS_eager_reducer_topk_ratio=0.01
+ * Note: If greater than 0, the reducer of the DataParallel of the dygraph mode
+ * on CPU exchanges only this ratio of the float32 gradients of each group,
+ * the ones of the largest magnitudes, by allgather instead of allreducing all
+ * of them. The rest is kept by each rank and added to the gradients of the
+ * next step, as the error feedback.
+ */
+PADDLE_DEFINE_EXPORTED_double(
+    eager_reducer_topk_ratio, 0.0,
+    "The ratio of the float32 gradients of the largest magnitudes the "
+    "dygraph DataParallel on CPU exchanges, 0 to allreduce all of them.");
+
 /**
  * Debug related FLAG
  * Name: tracer_mkldnn_ops_on
@@ -764,6 +860,28 @@ DEFINE_bool(enable_slotrecord_reset_shrink, false,
             "enable slotrecord obejct reset shrink memory, default false");
 DEFINE_bool(enable_ins_parser_file, false,
             "enable parser ins file , default false");
+DEFINE_bool(enable_fast_slot_parser, false,
+            "parse the feasigns of the MultiSlot text lines with the fast "
+            "parsers of string_helper instead of strtoull and strtof, which "
+            "give the same results, and skip the values of the unused slots "
+            "with skip_tokens, default false");
+DEFINE_int32(global_shuffle_max_inflight_batches, 4,
+             "The max number of batches each global shuffle thread sends "
+             "before the earlier sends finish");
+DEFINE_int32(dataset_input_channel_shard_num, 1,
+             "The number of shards of the input channel of a dataset, more "
+             "shards let more loading threads write it at once but keep "
+             "only the order of the records of each thread, default 1");
+DEFINE_int32(dataset_prefetch_file_num, 0,
+             "The number of files the dataset reads in the background ahead "
+             "of its readers, default 0 means not to prefetch");
+DEFINE_int32(dataset_prefetch_block_size, 4 * 1024 * 1024,
+             "The size of the blocks of each prefetched file, each file "
+             "keeps at most 4 blocks in memory, default 4MB");
+DEFINE_int32(device_worker_feed_pipeline_depth, 0,
+             "The number of batches the device workers read and stage in "
+             "the background ahead of the running batch, default 0 means to "
+             "read each batch in the training loop");
 
 /**
  * ProcessGroupNCCL related FLAG
@@ -776,3 +894,35 @@ DEFINE_bool(enable_ins_parser_file, false,
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 PADDLE_DEFINE_EXPORTED_bool(nccl_blocking_wait, false, "nccl blocking wait");
 #endif
+
+/**
+ * Autotune related FLAG
+ * Name: FLAGS_use_cpu_autotune
+ * Since Version: 2.3
+ * Value Range: bool, default=false
+ * Example: FLAGS_use_cpu_autotune=true
+ * Note: If True, cpu conv and matmul kernels time every candidate number of
+ * math library threads the first time an input shape is met, and run with
+ * the fastest one afterwards. The tuned results are cached in the phi
+ * AutoTuneCache.
+ */
+PADDLE_DEFINE_EXPORTED_bool(
+    use_cpu_autotune, false,
+    "Whether to tune the number of math library threads of cpu kernels for "
+    "each input shape.");
+
+/**
+ * Autotune related FLAG
+ * Name: FLAGS_cpu_autotune_cache_file
+ * Since Version: 2.3
+ * Value Range: string, default=""
+ * Example: FLAGS_cpu_autotune_cache_file=/path/to/cpu_autotune_cache
+ * Note: If not empty and FLAGS_use_cpu_autotune is True, the results of cpu
+ * autotune are loaded from this file before the first tuned kernel runs and
+ * saved to it at exit if new input shapes are tuned. A failure to save is
+ * only logged. The file is only loaded on the machine and build it is saved
+ * with.
+ */
+PADDLE_DEFINE_EXPORTED_string(
+    cpu_autotune_cache_file, "",
+    "The file to load and save the results of cpu autotune.");
@@ -210,6 +210,8 @@ void BindDataset(py::module *m) {
            py::call_guard<py::gil_scoped_release>())
       .def("set_trainer_num", &framework::Dataset::SetTrainerNum,
            py::call_guard<py::gil_scoped_release>())
+      .def("set_trainer_id", &framework::Dataset::SetTrainerId,
+           py::call_guard<py::gil_scoped_release>())
       .def("set_fleet_send_batch_size",
            &framework::Dataset::SetFleetSendBatchSize,
            py::call_guard<py::gil_scoped_release>())
@@ -249,6 +251,10 @@ void BindDataset(py::module *m) {
            py::call_guard<py::gil_scoped_release>())
       .def("wait_preload_done", &framework::Dataset::WaitPreLoadDone,
            py::call_guard<py::gil_scoped_release>())
+      .def("save_into_binary_files", &framework::Dataset::SaveIntoBinaryFiles,
+           py::call_guard<py::gil_scoped_release>())
+      .def("load_from_binary_files", &framework::Dataset::LoadFromBinaryFiles,
+           py::call_guard<py::gil_scoped_release>())
       .def("release_memory", &framework::Dataset::ReleaseMemory,
            py::call_guard<py::gil_scoped_release>())
       .def("local_shuffle", &framework::Dataset::LocalShuffle,
@@ -43,6 +43,8 @@ limitations under the License. */
 #include "paddle/phi/core/sparse_coo_tensor.h"
 #include "paddle/phi/core/sparse_csr_tensor.h"
 
+DECLARE_int32(eager_backward_num_threads);
+
 namespace paddle {
 namespace pybind {
 
@@ -107,8 +109,15 @@ static PyObject* eager_api_run_backward(PyObject* self, PyObject* args,
   EAGER_TRY
   auto tensors = CastPyArg2VectorOfTensor(PyTuple_GET_ITEM(args, 0), 0);
   auto grad_tensors = CastPyArg2VectorOfTensor(PyTuple_GET_ITEM(args, 1), 1);
-  egr::Backward(tensors, grad_tensors,
-                CastPyArg2AttrBoolean(PyTuple_GET_ITEM(args, 2), 2));
+  auto retain_graph = CastPyArg2AttrBoolean(PyTuple_GET_ITEM(args, 2), 2);
+  if (FLAGS_eager_backward_num_threads > 0) {
+    // The grad nodes running in other threads take the GIL to call the
+    // Python hooks and PyLayers.
+    py::gil_scoped_release release;
+    egr::Backward(tensors, grad_tensors, retain_graph);
+  } else {
+    egr::Backward(tensors, grad_tensors, retain_graph);
+  }
   Py_INCREF(Py_None);
   return Py_None;
   EAGER_CATCH_AND_THROW_RETURN_NULL
@@ -214,6 +214,8 @@ void BindGraphPyClient(py::module* m) {
       .def(py::init<>())
       .def("load_edge_file", &GraphPyClient::load_edge_file)
       .def("load_node_file", &GraphPyClient::load_node_file)
+      .def("save_frozen_graph", &GraphPyClient::save_frozen_graph)
+      .def("load_frozen_graph", &GraphPyClient::load_frozen_graph)
       .def("set_up", &GraphPyClient::set_up)
       .def("add_table_feat_conf", &GraphPyClient::add_table_feat_conf)
       .def("pull_graph_list", &GraphPyClient::pull_graph_list)
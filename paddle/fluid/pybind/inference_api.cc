@@ -582,6 +582,9 @@ void BindAnalysisConfig(py::module *m) {
       .def("ir_optim", &AnalysisConfig::ir_optim)
       .def("enable_memory_optim", &AnalysisConfig::EnableMemoryOptim,
            py::arg("x") = true)
+      .def("enable_static_memory_plan", &AnalysisConfig::EnableStaticMemoryPlan)
+      .def("static_memory_plan_enabled",
+           &AnalysisConfig::static_memory_plan_enabled)
       .def("enable_profile", &AnalysisConfig::EnableProfile)
       .def("disable_glog_info", &AnalysisConfig::DisableGlogInfo)
       .def("glog_info_disabled", &AnalysisConfig::glog_info_disabled)
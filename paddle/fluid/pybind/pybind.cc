@@ -67,6 +67,7 @@ limitations under the License. */
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/memory/allocation/cuda_ipc_allocator.h"
 #endif
+#include "paddle/fluid/memory/allocation/memory_stat_reporter.h"
 #include "paddle/fluid/memory/allocation/mmap_allocator.h"
 #include "paddle/fluid/operators/activation_op.h"
 #include "paddle/fluid/operators/common_infer_shape_functions.h"
@@ -534,6 +535,34 @@ static void TensorCopyFrom(framework::Tensor *dst, const framework::Tensor &src,
   }
 }
 
+template <typename PlaceType>
+static py::dict MemoryStatReport(const PlaceType &place, size_t top_k) {
+  auto snapshot = memory::allocation::GetMemoryStatSnapshot(place, top_k);
+  py::dict report;
+  report["allocated_current"] = snapshot.allocated_current;
+  report["allocated_peak"] = snapshot.allocated_peak;
+  report["reserved_current"] = snapshot.reserved_current;
+  report["reserved_peak"] = snapshot.reserved_peak;
+  report["size_histogram"] = snapshot.size_histogram;
+  report["chunk_bytes"] = snapshot.free_block_stat.chunk_bytes;
+  report["free_bytes"] = snapshot.free_block_stat.free_bytes;
+  report["free_block_num"] = snapshot.free_block_stat.free_block_num;
+  report["largest_free_block"] = snapshot.free_block_stat.largest_free_block;
+  report["fragmentation"] = snapshot.free_block_stat.FragmentationRatio();
+  py::list call_sites;
+  for (auto &site : snapshot.top_call_sites) {
+    py::dict call_site;
+    call_site["stack"] = site.stack;
+    call_site["sampled_num"] = site.sampled_num;
+    call_site["sampled_bytes"] = site.sampled_bytes;
+    call_site["live_num"] = site.live_num;
+    call_site["live_bytes"] = site.live_bytes;
+    call_sites.append(call_site);
+  }
+  report["top_call_sites"] = call_sites;
+  return report;
+}
+
 #ifdef PADDLE_WITH_AVX
 PYBIND11_MODULE(core_avx, m) {
 #else
@@ -2941,6 +2970,14 @@ All parameter, weight, gradient are variables in Paddle.
   });
   m.def("memory_stat_get_current", memory::StatGetCurrentValue);
   m.def("memory_stat_get_peak", memory::StatGetPeakValue);
+  m.def("host_memory_stat_get_current", memory::HostMemoryStatCurrentValue);
+  m.def("host_memory_stat_get_peak", memory::HostMemoryStatPeakValue);
+  m.def("memory_stat_report", MemoryStatReport<platform::CPUPlace>,
+        py::arg("place"), py::arg("top_k") = 10);
+  m.def("memory_stat_report", MemoryStatReport<platform::CUDAPlace>,
+        py::arg("place"), py::arg("top_k") = 10);
+  m.def("memory_stat_report", MemoryStatReport<platform::CUDAPinnedPlace>,
+        py::arg("place"), py::arg("top_k") = 10);
   m.def("run_cmd",
         [](const std::string &cmd, int time_out = -1,
            int sleep_inter = -1) -> const std::string {
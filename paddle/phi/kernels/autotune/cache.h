@@ -14,9 +14,21 @@
 
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "glog/logging.h"
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/core/enforce.h"
@@ -59,12 +71,12 @@ size_t GetKey(Args&&... args) {
 }
 
 // Define the cache key of operator
-size_t ConvKey(const std::vector<int64_t>& x_dims,
-               const std::vector<int64_t>& w_dims,
-               const std::vector<int>& strides,
-               const std::vector<int>& paddings,
-               const std::vector<int>& dilations,
-               phi::DataType dtype) {
+inline size_t ConvKey(const std::vector<int64_t>& x_dims,
+                      const std::vector<int64_t>& w_dims,
+                      const std::vector<int>& strides,
+                      const std::vector<int>& paddings,
+                      const std::vector<int>& dilations,
+                      phi::DataType dtype) {
   return GetKey(x_dims,
                 w_dims,
                 strides,
@@ -73,35 +85,90 @@ size_t ConvKey(const std::vector<int64_t>& x_dims,
                 static_cast<int64_t>(dtype));
 }
 
+// Every AlgorithmsCache gets an id, which identifies its snapshot in the
+// thread local storage of reader threads.
+inline uint64_t NewAlgorithmsCacheId() {
+  static std::atomic<uint64_t> next_id{0};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
 template <typename AlgorithmT>
 class AlgorithmsCache {
  public:
-  AlgorithmsCache() : cache_mutex_(new std::mutex()) { hash_.clear(); }
+  using KeyMap = std::unordered_map<size_t, AlgorithmT>;
 
-  AlgorithmT Get(size_t key) {
+  AlgorithmsCache()
+      : id_(NewAlgorithmsCacheId()),
+        cache_mutex_(new std::mutex()),
+        hash_(std::make_shared<KeyMap>()) {}
+
+  AlgorithmsCache(const AlgorithmsCache& other)
+      : id_(NewAlgorithmsCacheId()),
+        cache_mutex_(new std::mutex()),
+        hash_(other.Snapshot()),
+        cache_hits_(other.cache_hits_.load()),
+        cache_misses_(other.cache_misses_.load()) {}
+
+  AlgorithmsCache& operator=(const AlgorithmsCache& other) {
+    auto hash = other.Snapshot();
     std::lock_guard<std::mutex> lock(*cache_mutex_);
+    hash_ = std::move(hash);
+    version_.fetch_add(1, std::memory_order_release);
+    cache_hits_ = other.cache_hits_.load();
+    cache_misses_ = other.cache_misses_.load();
+    return *this;
+  }
+
+  AlgorithmT Get(size_t key) {
+    auto& hash = LocalSnapshot();
+    auto iter = hash.find(key);
     PADDLE_ENFORCE_NE(
-        hash_.find(key),
-        hash_.end(),
+        iter,
+        hash.end(),
         phi::errors::PreconditionNotMet("The key does not exist."));
-    return hash_[key];
+    return iter->second;
   }
 
+  // Find and Get do not take the lock once the calling thread has seen the
+  // latest version of the cache. The cache is an immutable map which Set
+  // replaces as a whole (read-copy-update), and every thread keeps the map
+  // it read last, so a lookup only loads version_ and refreshes the map under
+  // the lock after the cache is updated. Set is only called when a new config
+  // is tuned, which is rare compared with lookups.
   bool Find(size_t key) {
     bool ret = false;
-    std::lock_guard<std::mutex> lock(*cache_mutex_);
-    if (hash_.find(key) != hash_.end()) {
-      cache_hits_++;
+    auto& hash = LocalSnapshot();
+    if (hash.find(key) != hash.end()) {
+      cache_hits_.fetch_add(1, std::memory_order_relaxed);
       ret = true;
     } else {
-      cache_misses_++;
+      cache_misses_.fetch_add(1, std::memory_order_relaxed);
     }
     return ret;
   }
 
   void Set(size_t key, AlgorithmT algo) {
     std::lock_guard<std::mutex> lock(*cache_mutex_);
-    hash_[key] = algo;
+    auto hash = std::make_shared<KeyMap>(*hash_);
+    (*hash)[key] = algo;
+    hash_ = std::move(hash);
+    version_.fetch_add(1, std::memory_order_release);
+  }
+
+  // Insert all entries of others, the existing entries are overwritten.
+  void Merge(const KeyMap& others) {
+    std::lock_guard<std::mutex> lock(*cache_mutex_);
+    auto hash = std::make_shared<KeyMap>(*hash_);
+    for (auto& item : others) {
+      (*hash)[item.first] = item.second;
+    }
+    hash_ = std::move(hash);
+    version_.fetch_add(1, std::memory_order_release);
+  }
+
+  std::shared_ptr<const KeyMap> Snapshot() const {
+    std::lock_guard<std::mutex> lock(*cache_mutex_);
+    return hash_;
   }
 
   float CacheHitRate() const {
@@ -111,13 +178,48 @@ class AlgorithmsCache {
     return cache_hit_rate;
   }
 
-  int64_t Size() { return hash_.size(); }
+  int64_t Size() const { return LocalSnapshot().size(); }
 
  private:
-  std::unordered_map<size_t, AlgorithmT> hash_;
+  // The map is valid until the next call in the same thread. The snapshots
+  // of destroyed caches are dropped when the thread meets a new cache, so a
+  // thread keeps at most one snapshot per living cache.
+  const KeyMap& LocalSnapshot() const {
+    struct ThreadSnapshot {
+      uint64_t version = 0;
+      std::shared_ptr<const KeyMap> hash;
+      // expires when the cache is destroyed
+      std::weak_ptr<std::mutex> owner;
+    };
+    thread_local std::unordered_map<uint64_t, ThreadSnapshot> snapshots;
+    auto iter = snapshots.find(id_);
+    if (iter == snapshots.end()) {
+      for (auto it = snapshots.begin(); it != snapshots.end();) {
+        if (it->second.owner.expired()) {
+          it = snapshots.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      iter = snapshots.emplace(id_, ThreadSnapshot()).first;
+      iter->second.owner = cache_mutex_;
+    }
+    auto& snapshot = iter->second;
+    if (snapshot.hash == nullptr ||
+        snapshot.version != version_.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(*cache_mutex_);
+      snapshot.hash = hash_;
+      snapshot.version = version_.load(std::memory_order_relaxed);
+    }
+    return *snapshot.hash;
+  }
+
+  uint64_t id_;
   std::shared_ptr<std::mutex> cache_mutex_;
-  int64_t cache_hits_ = 0;
-  int64_t cache_misses_ = 0;
+  std::shared_ptr<const KeyMap> hash_;
+  std::atomic<uint64_t> version_{0};
+  std::atomic<int64_t> cache_hits_{0};
+  std::atomic<int64_t> cache_misses_{0};
 };
 
 // AlgorithmsConfigKey -> AlgorithmsID
@@ -126,6 +228,10 @@ using AlgorithmsConfigKeyMap = AlgorithmsCache<int64_t>;
 using AlgorithmsTypeMap =
     std::unordered_map<std::string, AlgorithmsConfigKeyMap>;
 
+// The version of the file format written by AutoTuneCache::Save.
+constexpr int kAutoTuneCacheFormatVersion = 1;
+constexpr const char* kAutoTuneCacheMagic = "PADDLE_AUTOTUNE_CACHE";
+
 class AutoTuneCache {
  public:
   static AutoTuneCache& Instance() {
@@ -152,8 +258,134 @@ class AutoTuneCache {
     return total;
   }
 
+  // Save all the cached configs to file, so that other processes can load
+  // them instead of tuning again. The fingerprint should identify the
+  // hardware and the versions of Paddle and the tuned libraries (e.g. device
+  // name + cuDNN version), since the tuned results and the hashed keys are
+  // only valid for the same environment. The file is written to a unique
+  // temporary file first and then renamed, so readers never see a partial
+  // file and concurrent writers do not overwrite each other's temporary file,
+  // the last renamed one wins. Saving is best-effort: a failure is logged and
+  // false is returned, the cache in memory is not affected.
+  bool Save(const std::string& path, const std::string& fingerprint) {
+    PADDLE_ENFORCE_EQ(
+        fingerprint.find('\n'),
+        std::string::npos,
+        phi::errors::InvalidArgument(
+            "The fingerprint of autotune cache should not contain '\\n'."));
+    std::string tmp_path = MakeTempFile(path);
+    if (tmp_path.empty()) {
+      LOG(WARNING) << "Cannot create a temporary file to save autotune cache "
+                   << "to " << path << ".";
+      return false;
+    }
+    bool written = false;
+    {
+      std::ofstream fout(tmp_path);
+      fout << kAutoTuneCacheMagic << " " << kAutoTuneCacheFormatVersion
+           << "\n";
+      fout << fingerprint << "\n";
+      std::lock_guard<std::mutex> lock(*autotune_cache_mutex_);
+      for (auto& v : auto_tune_map_) {
+        auto hash = v.second.Snapshot();
+        fout << v.first << " " << hash->size() << "\n";
+        for (auto& item : *hash) {
+          fout << item.first << " " << item.second << "\n";
+        }
+      }
+      fout.close();
+      written = static_cast<bool>(fout);
+    }
+    if (!written) {
+      std::remove(tmp_path.c_str());
+      LOG(WARNING) << "Failed to write autotune cache to " << tmp_path << ".";
+      return false;
+    }
+#ifdef _WIN32
+    // rename does not replace an existing file on windows.
+    std::remove(path.c_str());
+#endif
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+      std::remove(tmp_path.c_str());
+      LOG(WARNING) << "Failed to rename " << tmp_path << " to " << path
+                   << " when saving autotune cache.";
+      return false;
+    }
+    VLOG(3) << "Save " << Size() << " autotune configs to " << path;
+    return true;
+  }
+
+  // Load the configs saved by Save and merge them into the cache. Return
+  // false and leave the cache unchanged if the file does not exist, or it is
+  // written with another format version or fingerprint.
+  bool Load(const std::string& path, const std::string& fingerprint) {
+    std::ifstream fin(path);
+    if (!fin) {
+      VLOG(3) << "Autotune cache file " << path << " does not exist.";
+      return false;
+    }
+    std::string magic, file_fingerprint;
+    int version = -1;
+    fin >> magic >> version;
+    fin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    std::getline(fin, file_fingerprint);
+    if (magic != kAutoTuneCacheMagic ||
+        version != kAutoTuneCacheFormatVersion ||
+        file_fingerprint != fingerprint) {
+      LOG(WARNING) << "Skip loading autotune cache " << path
+                   << ", since it is saved with format version " << version
+                   << " and fingerprint [" << file_fingerprint
+                   << "], but expected " << kAutoTuneCacheFormatVersion
+                   << " and [" << fingerprint << "].";
+      return false;
+    }
+
+    std::unordered_map<std::string, AlgorithmsConfigKeyMap::KeyMap> loaded;
+    std::string algo_type;
+    size_t num_entries = 0;
+    while (fin >> algo_type >> num_entries) {
+      auto& entries = loaded[algo_type];
+      for (size_t i = 0; i < num_entries; ++i) {
+        size_t key = 0;
+        int64_t algo = 0;
+        PADDLE_ENFORCE_EQ(
+            static_cast<bool>(fin >> key >> algo),
+            true,
+            phi::errors::InvalidArgument(
+                "The autotune cache file %s is corrupted.", path));
+        entries[key] = algo;
+      }
+    }
+    for (auto& v : loaded) {
+      RegisterOrGet(v.first).Merge(v.second);
+    }
+    VLOG(3) << "Load autotune configs from " << path << ", total " << Size();
+    return true;
+  }
+
  private:
   AutoTuneCache() : autotune_cache_mutex_(new std::mutex()) {}
+
+  // Create an empty file named path.XXXXXX which is unique in the directory
+  // of path, and return its name, or an empty string on failure.
+  static std::string MakeTempFile(const std::string& path) {
+    std::string tmp_path = path + ".XXXXXX";
+#ifdef _WIN32
+    bool created = _mktemp_s(&tmp_path[0], tmp_path.size() + 1) == 0 &&
+                   static_cast<bool>(std::ofstream(tmp_path));
+#else
+    int fd = mkstemp(&tmp_path[0]);
+    bool created = fd >= 0;
+    if (created) {
+      // mkstemp creates the file readable by the owner only, while the
+      // cache is meant to be shared.
+      fchmod(fd, 0644);
+      close(fd);
+    }
+#endif
+    return created ? tmp_path : std::string();
+  }
+
   AlgorithmsTypeMap auto_tune_map_;
   std::shared_ptr<std::mutex> autotune_cache_mutex_;
 };
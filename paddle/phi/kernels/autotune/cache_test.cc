@@ -15,7 +15,10 @@
 #include "paddle/phi/kernels/autotune/cache.h"
 #include <gtest/gtest.h>
 #include <cmath>
+#include <cstdio>
 #include <functional>
+#include <string>
+#include <thread>
 #include "glog/logging.h"
 
 enum ConvAlgos { GEMMKernel = 0, CuDNNKernel_1 = 1, CuDNNKernel_2 = 2 };
@@ -51,3 +54,53 @@ TEST(AlgosCache, AlgosCache) {
   float cache_hit_rate = static_cast<float>(1) / static_cast<float>(3);
   EXPECT_LT(std::abs(cache_hit_rate - cache.CacheHitRate()), 1e-5);
 }
+
+TEST(AlgosCache, SaveAndLoad) {
+  auto& autotune_cache = phi::autotune::AutoTuneCache::Instance();
+  auto& cache = autotune_cache.RegisterOrGet("conv_bw");
+  cache.Set(1, ConvAlgos::CuDNNKernel_1);
+  cache.Set(2, ConvAlgos::CuDNNKernel_2);
+
+  std::string path = "autotune_cache_test.txt";
+  EXPECT_EQ(autotune_cache.Save(path, "test_device v1"), true);
+  // Clear the saved configs.
+  cache = phi::autotune::AlgorithmsConfigKeyMap();
+  EXPECT_EQ(cache.Size(), 0);
+
+  EXPECT_EQ(autotune_cache.Load(path, "test_device v2"), false);
+  EXPECT_EQ(cache.Size(), 0);
+  EXPECT_EQ(autotune_cache.Load(path, "test_device v1"), true);
+  EXPECT_EQ(cache.Size(), 2);
+  EXPECT_EQ(cache.Get(1), ConvAlgos::CuDNNKernel_1);
+  EXPECT_EQ(cache.Get(2), ConvAlgos::CuDNNKernel_2);
+  std::remove(path.c_str());
+
+  // saving is best-effort
+  EXPECT_EQ(autotune_cache.Save("not_exist_dir/autotune_cache_test.txt",
+                                "test_device v1"),
+            false);
+  EXPECT_EQ(cache.Size(), 2);
+}
+
+TEST(AlgosCache, UpdateSeenByOtherThreads) {
+  phi::autotune::AlgorithmsConfigKeyMap cache;
+  cache.Set(1, ConvAlgos::GEMMKernel);
+  std::thread reader([&cache] {
+    // the reader keeps a snapshot of the cache after the first lookup
+    EXPECT_EQ(cache.Find(1), true);
+    EXPECT_EQ(cache.Find(2), false);
+  });
+  reader.join();
+  EXPECT_EQ(cache.Find(2), false);
+
+  cache.Set(2, ConvAlgos::CuDNNKernel_1);
+  cache.Set(1, ConvAlgos::CuDNNKernel_2);
+  std::thread updated_reader([&cache] {
+    EXPECT_EQ(cache.Find(2), true);
+    EXPECT_EQ(cache.Get(1), ConvAlgos::CuDNNKernel_2);
+  });
+  updated_reader.join();
+  EXPECT_EQ(cache.Find(2), true);
+  EXPECT_EQ(cache.Get(1), ConvAlgos::CuDNNKernel_2);
+  EXPECT_EQ(cache.Size(), 2);
+}
@@ -0,0 +1,246 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/autotune/cache.h"
+#include "paddle/phi/kernels/autotune/cpu_timer.h"
+
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#include "paddle/phi/backends/dynload/mklml.h"
+#endif
+
+#ifdef PADDLE_USE_OPENBLAS
+#include <cblas.h>
+#endif
+
+DECLARE_bool(use_cpu_autotune);
+DECLARE_string(cpu_autotune_cache_file);
+
+namespace phi {
+namespace autotune {
+
+// Return the number of threads the cpu math library uses in calling thread.
+inline int GetCpuMathThreads() {
+#if defined(PADDLE_WITH_MKLML)
+  return phi::dynload::MKL_Get_Max_Threads();
+#elif defined(PADDLE_USE_OPENBLAS)
+  return openblas_get_num_threads();
+#else
+  return 1;
+#endif
+}
+
+// Set the number of threads of the cpu math library within the scope. With
+// MKLML only the calling thread is affected, so concurrent predictors do not
+// interfere with each other.
+class ScopedCpuMathThreads {
+ public:
+  explicit ScopedCpuMathThreads(int num_threads) {
+#if defined(PADDLE_WITH_MKLML)
+    prev_threads_ = phi::dynload::MKL_Set_Num_Threads_Local(num_threads);
+    prev_omp_threads_ = omp_get_max_threads();
+    omp_set_num_threads(num_threads);
+#elif defined(PADDLE_USE_OPENBLAS)
+    prev_threads_ = openblas_get_num_threads();
+    openblas_set_num_threads(num_threads);
+#endif
+  }
+
+  ~ScopedCpuMathThreads() {
+#if defined(PADDLE_WITH_MKLML)
+    phi::dynload::MKL_Set_Num_Threads_Local(prev_threads_);
+    omp_set_num_threads(prev_omp_threads_);
+#elif defined(PADDLE_USE_OPENBLAS)
+    openblas_set_num_threads(prev_threads_);
+#endif
+  }
+
+ private:
+  int prev_threads_{0};
+  int prev_omp_threads_{0};
+};
+
+// The thread numbers tried when tuning: powers of 2 below max_threads, and
+// max_threads itself.
+inline std::vector<int> CpuThreadsCandidates(int max_threads) {
+  std::vector<int> candidates;
+  for (int num_threads = 1; num_threads < max_threads; num_threads *= 2) {
+    candidates.push_back(num_threads);
+  }
+  candidates.push_back(max_threads > 1 ? max_threads : 1);
+  return candidates;
+}
+
+// Identify the environment the cpu autotune results are valid for: the cpu
+// model, the number of hardware threads, the math library and its default
+// thread number, and the compiler, whose std::hash builds the keys. It is
+// computed once per process.
+inline const std::string& CpuAutoTuneFingerprint() {
+  static const std::string fingerprint = [] {
+    std::string cpu_model = "unknown";
+#ifdef __linux__
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+      if (line.compare(0, 10, "model name") == 0) {
+        cpu_model = line.substr(line.find(':') + 1);
+        break;
+      }
+    }
+#endif
+    std::ostringstream out;
+    out << "cpu:" << cpu_model
+        << " hardware_threads:" << std::thread::hardware_concurrency();
+#if defined(PADDLE_WITH_MKLML)
+    out << " math:mklml";
+#elif defined(PADDLE_USE_OPENBLAS)
+    out << " math:openblas";
+#else
+    out << " math:none";
+#endif
+    out << " math_threads:" << GetCpuMathThreads();
+#ifdef __VERSION__
+    out << " compiler:" << __VERSION__;
+#endif
+    return out.str();
+  }();
+  return fingerprint;
+}
+
+// Whether keys are tuned since the cache is loaded or saved last time.
+inline std::atomic<bool>& CpuAutoTuneCacheDirty() {
+  static std::atomic<bool> dirty{false};
+  return dirty;
+}
+
+// Save the cache to FLAGS_cpu_autotune_cache_file if new keys are tuned
+// since the last save. It is called at exit, and can be called explicitly
+// (e.g. after warming up a predictor) to share the results earlier. Return
+// false if nothing is saved.
+inline bool SaveCpuAutoTuneCache() {
+  if (FLAGS_cpu_autotune_cache_file.empty() ||
+      !CpuAutoTuneCacheDirty().exchange(false)) {
+    return false;
+  }
+  return AutoTuneCache::Instance().Save(FLAGS_cpu_autotune_cache_file,
+                                        CpuAutoTuneFingerprint());
+}
+
+// Load the results tuned by former processes from
+// FLAGS_cpu_autotune_cache_file, once per process, and save the cache at
+// exit.
+inline void LoadCpuAutoTuneCache() {
+  static std::once_flag load_flag;
+  std::call_once(load_flag, [] {
+    // constructed before the exit handler is registered, so that they are
+    // destroyed after it runs
+    auto& cache = AutoTuneCache::Instance();
+    auto& fingerprint = CpuAutoTuneFingerprint();
+    CpuAutoTuneCacheDirty();
+    if (!FLAGS_cpu_autotune_cache_file.empty()) {
+      cache.Load(FLAGS_cpu_autotune_cache_file, fingerprint);
+    }
+    std::atexit([] { SaveCpuAutoTuneCache(); });
+  });
+}
+
+// The timed runs of every candidate thread number, after one run which warms
+// up the threads and the caches. The fastest of them counts, since the noise
+// of a busy machine only makes a run slower.
+constexpr int kCpuAutoTuneRepeats = 3;
+
+// Run fn with the number of cpu math library threads tuned for key. The
+// first time a key is met, fn is timed kCpuAutoTuneRepeats times with every
+// candidate thread number and the fastest one is cached in AutoTuneCache
+// under algo_type, so fn must be safe to run repeatedly (e.g. write but not
+// accumulate into its output). Small layers usually prefer fewer threads
+// than large ones, which a single global thread number can not satisfy. If
+// FLAGS_cpu_autotune_cache_file is set, the cache is loaded from it before
+// the first lookup and saved to it by SaveCpuAutoTuneCache, so that new
+// processes on the same machine skip the tuning.
+template <typename Fn>
+void RunWithTunedCpuThreads(const CPUContext& dev_ctx,
+                            const std::string& algo_type,
+                            size_t key,
+                            Fn&& fn) {
+  if (!FLAGS_use_cpu_autotune) {
+    fn();
+    return;
+  }
+  LoadCpuAutoTuneCache();
+  auto& cache = AutoTuneCache::Instance().RegisterOrGet(algo_type);
+  if (cache.Find(key)) {
+    ScopedCpuMathThreads guard(static_cast<int>(cache.Get(key)));
+    fn();
+    return;
+  }
+
+  auto candidates = CpuThreadsCandidates(GetCpuMathThreads());
+  int best_threads = candidates.back();
+  if (candidates.size() > 1) {
+    CpuTimer timer;
+    float min_time = std::numeric_limits<float>::max();
+    for (auto num_threads : candidates) {
+      ScopedCpuMathThreads guard(num_threads);
+      fn();
+      float time = std::numeric_limits<float>::max();
+      for (int i = 0; i < kCpuAutoTuneRepeats; ++i) {
+        timer.Start();
+        fn();
+        timer.Stop();
+        time = std::min(time, timer.ElapsedTime());
+      }
+      VLOG(3) << algo_type << " with " << num_threads
+              << " threads: time cost is " << time;
+      if (time < min_time) {
+        min_time = time;
+        best_threads = num_threads;
+      }
+    }
+  } else {
+    fn();
+  }
+  VLOG(3) << algo_type << " best thread number is " << best_threads;
+  cache.Set(key, best_threads);
+  CpuAutoTuneCacheDirty() = true;
+}
+
+// Kernels shared by cpu and other devices call this directly, it only tunes
+// on cpu.
+template <typename Context, typename Fn>
+void RunWithTunedCpuThreads(const Context& dev_ctx,
+                            const std::string& algo_type,
+                            size_t key,
+                            Fn&& fn) {
+  fn();
+}
+
+}  // namespace autotune
+}  // namespace phi
@@ -0,0 +1,94 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/autotune/cpu_auto_tune.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+TEST(CpuAutoTune, ThreadsCandidates) {
+  EXPECT_EQ(phi::autotune::CpuThreadsCandidates(1), std::vector<int>({1}));
+  EXPECT_EQ(phi::autotune::CpuThreadsCandidates(6),
+            std::vector<int>({1, 2, 4, 6}));
+  EXPECT_EQ(phi::autotune::CpuThreadsCandidates(8),
+            std::vector<int>({1, 2, 4, 8}));
+}
+
+TEST(CpuAutoTune, RunWithTunedCpuThreads) {
+  phi::CPUContext dev_ctx;
+  auto& cache =
+      phi::autotune::AutoTuneCache::Instance().RegisterOrGet("cpu_test");
+  const size_t key = 42;
+  int run_num = 0;
+  int threads = 0;
+  auto fn = [&] {
+    ++run_num;
+    threads = phi::autotune::GetCpuMathThreads();
+  };
+
+  FLAGS_use_cpu_autotune = false;
+  phi::autotune::RunWithTunedCpuThreads(dev_ctx, "cpu_test", key, fn);
+  EXPECT_EQ(run_num, 1);
+  EXPECT_FALSE(cache.Find(key));
+
+  // each candidate runs once to warm up and then kCpuAutoTuneRepeats times
+  FLAGS_use_cpu_autotune = true;
+  int max_threads = phi::autotune::GetCpuMathThreads();
+  auto candidates = phi::autotune::CpuThreadsCandidates(max_threads);
+  run_num = 0;
+  phi::autotune::RunWithTunedCpuThreads(dev_ctx, "cpu_test", key, fn);
+  int expected_run_num =
+      candidates.size() > 1
+          ? static_cast<int>(candidates.size()) *
+                (1 + phi::autotune::kCpuAutoTuneRepeats)
+          : 1;
+  EXPECT_EQ(run_num, expected_run_num);
+  ASSERT_TRUE(cache.Find(key));
+  EXPECT_EQ(phi::autotune::GetCpuMathThreads(), max_threads);
+
+  // the tuned thread number is used without tuning again
+  run_num = 0;
+  phi::autotune::RunWithTunedCpuThreads(dev_ctx, "cpu_test", key, fn);
+  EXPECT_EQ(run_num, 1);
+  EXPECT_EQ(threads, static_cast<int>(cache.Get(key)));
+  EXPECT_EQ(phi::autotune::GetCpuMathThreads(), max_threads);
+  FLAGS_use_cpu_autotune = false;
+}
+
+TEST(CpuAutoTune, SaveCacheFile) {
+  phi::CPUContext dev_ctx;
+  auto fn = [] {};
+  FLAGS_use_cpu_autotune = true;
+  std::string path = "cpu_autotune_cache_test.txt";
+  std::remove(path.c_str());
+  FLAGS_cpu_autotune_cache_file = path;
+
+  // the cache is not written in the kernel call
+  phi::autotune::RunWithTunedCpuThreads(dev_ctx, "cpu_save_test", 1, fn);
+  EXPECT_FALSE(static_cast<bool>(std::ifstream(path)));
+  EXPECT_TRUE(phi::autotune::SaveCpuAutoTuneCache());
+  EXPECT_TRUE(static_cast<bool>(std::ifstream(path)));
+  // nothing new to save
+  EXPECT_FALSE(phi::autotune::SaveCpuAutoTuneCache());
+  std::remove(path.c_str());
+
+  // a cache file which can not be written does not fail the kernel
+  FLAGS_cpu_autotune_cache_file = "not_exist_dir/" + path;
+  phi::autotune::RunWithTunedCpuThreads(dev_ctx, "cpu_save_test", 2, fn);
+  EXPECT_FALSE(phi::autotune::SaveCpuAutoTuneCache());
+  FLAGS_cpu_autotune_cache_file = "";
+  FLAGS_use_cpu_autotune = false;
+}
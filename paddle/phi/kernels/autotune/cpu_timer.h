@@ -0,0 +1,39 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>  // NOLINT
+
+namespace phi {
+
+// Wall-clock timer used to tune cpu kernels, it has the same interface as
+// GpuTimer except that no stream is needed.
+class CpuTimer {
+ public:
+  void Start() { start_ = std::chrono::steady_clock::now(); }
+
+  void Stop() { stop_ = std::chrono::steady_clock::now(); }
+
+  // Return the elapsed time between Start and Stop in milliseconds.
+  float ElapsedTime() {
+    return std::chrono::duration<float, std::milli>(stop_ - start_).count();
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point stop_;
+};
+
+}  // namespace phi
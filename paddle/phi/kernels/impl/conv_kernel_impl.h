@@ -16,6 +16,7 @@
 
 #include "paddle/fluid/operators/math/im2col.h"
 #include "paddle/fluid/operators/math/vol2col.h"
+#include "paddle/phi/kernels/autotune/cpu_auto_tune.h"
 #include "paddle/phi/kernels/conv_kernel.h"
 #include "paddle/phi/kernels/cpu/conv_util.h"
 #include "paddle/phi/kernels/funcs/batch_norm_utils.h"
@@ -142,39 +143,55 @@ void ConvKernel(const Context& dev_ctx,
           im2col;
 
   auto blas = phi::funcs::GetBlas<Context, T>(dev_ctx);
-  for (int i = 0; i < batch_size; i++) {
-    DenseTensor in_batch =
-        transformed_input.Slice(i, i + 1).Resize(in_matrix_shape);
-    DenseTensor out_batch =
-        transformed_output.Slice(i, i + 1).Resize(output_matrix_shape);
-
-    for (int g = 0; g < groups; g++) {
-      DenseTensor in_slice = in_batch.Slice(g * in_step, (g + 1) * in_step);
-
-      if (!is_expand) {
-        col.ShareDataWith(in_slice);
-        col_matrix.ShareDataWith(col);
-        col_matrix.Resize(col_matrix_shape);
-      } else if (data_dim == 2U) {
-        im2col(dev_ctx,
-               in_slice,
-               dilations,
-               strides,
-               std::vector<int>{
-                   paddings[0], paddings[2], paddings[1], paddings[3]},
-               &col);
-
-      } else if (data_dim == 3U) {
-        vol2col(dev_ctx, in_slice, dilations, strides, paddings, &col);
+  auto key = autotune::GetKey(vectorize(transformed_input.dims()),
+                              filter_shape_vec,
+                              strides,
+                              paddings,
+                              dilations,
+                              groups,
+                              static_cast<int64_t>(input.dtype()));
+  autotune::RunWithTunedCpuThreads(dev_ctx, "conv_cpu_threads", key, [&]() {
+    for (int i = 0; i < batch_size; i++) {
+      DenseTensor in_batch =
+          transformed_input.Slice(i, i + 1).Resize(in_matrix_shape);
+      DenseTensor out_batch =
+          transformed_output.Slice(i, i + 1).Resize(output_matrix_shape);
+
+      for (int g = 0; g < groups; g++) {
+        DenseTensor in_slice = in_batch.Slice(g * in_step, (g + 1) * in_step);
+
+        if (!is_expand) {
+          col.ShareDataWith(in_slice);
+          col_matrix.ShareDataWith(col);
+          col_matrix.Resize(col_matrix_shape);
+        } else if (data_dim == 2U) {
+          im2col(dev_ctx,
+                 in_slice,
+                 dilations,
+                 strides,
+                 std::vector<int>{
+                     paddings[0], paddings[2], paddings[1], paddings[3]},
+                 &col);
+
+        } else if (data_dim == 3U) {
+          vol2col(dev_ctx, in_slice, dilations, strides, paddings, &col);
+        }
+
+        // gemm
+        DenseTensor out_slice =
+            out_batch.Slice(g * out_step, (g + 1) * out_step);
+        DenseTensor filter_slice =
+            filter.Slice(g * out_step, (g + 1) * out_step);
+        blas.MatMul(filter_slice,
+                    false,
+                    col_matrix,
+                    false,
+                    T(1.0),
+                    &out_slice,
+                    T(0.0));
       }
-
-      // gemm
-      DenseTensor out_slice = out_batch.Slice(g * out_step, (g + 1) * out_step);
-      DenseTensor filter_slice = filter.Slice(g * out_step, (g + 1) * out_step);
-      blas.MatMul(
-          filter_slice, false, col_matrix, false, T(1.0), &out_slice, T(0.0));
     }
-  }
+  });
   if (channel_last) {
     TransToChannelLast<Context, T>(dev_ctx, &transformed_output, output);
   }
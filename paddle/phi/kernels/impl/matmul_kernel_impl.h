@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include "paddle/phi/kernels/autotune/cpu_auto_tune.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/complex_functors.h"
 
@@ -503,7 +504,14 @@ void MatmulKernel(const Context& dev_ctx,
       0,
       phi::errors::InvalidArgument("The Input(Y) dims size must not be equal 0,"
                                    " but reviced dims size is 0. "));
-  MatMulFunction<Context, T>(dev_ctx, x, y, out, transpose_x, transpose_y);
+  auto key = autotune::GetKey(vectorize(x.dims()),
+                              vectorize(y.dims()),
+                              transpose_x,
+                              transpose_y,
+                              static_cast<int64_t>(x.dtype()));
+  autotune::RunWithTunedCpuThreads(dev_ctx, "matmul_cpu_threads", key, [&]() {
+    MatMulFunction<Context, T>(dev_ctx, x, y, out, transpose_x, transpose_y);
+  });
 }
 
 template <typename T, typename Context>
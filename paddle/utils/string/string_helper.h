@@ -16,7 +16,9 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <cstdlib>
 #include <cstring>
 #include <sstream>
 #include <string>
@@ -100,6 +102,119 @@ inline int str_to_float(const char* str, float* v) {
   return index;
 }
 
+// The fast_* parsers below never read beyond end, and fall back to the libc
+// functions for the inputs they do not handle, so that their results and
+// endptr are the same as the libc ones. str must still be terminated by '\0'
+// for the fallback.
+inline bool fast_is_digit(char c) {
+  return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline const char* fast_skip_spaces(const char* str, const char* end) {
+  while (str < end && (*str == ' ' || *str == '\t')) {
+    ++str;
+  }
+  return str;
+}
+
+// Parses the digits at str into *value, and returns the end of the digits.
+// Eight digits are checked and converted at once, within a register.
+inline const char* fast_parse_digits(const char* str, const char* end,
+                                     uint64_t* value) {
+  uint64_t v = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  // at most 16 digits, 10^16 * 10^8 overflows
+  for (int k = 0; k < 2 && end - str >= 8; ++k) {
+    uint64_t chunk;
+    memcpy(&chunk, str, 8);
+    uint64_t high = chunk & 0xF0F0F0F0F0F0F0F0ULL;
+    uint64_t carry = (chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL;
+    if ((high | (carry >> 4)) != 0x3333333333333333ULL) {
+      break;
+    }
+    chunk -= 0x3030303030303030ULL;
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FFULL) *
+              (1 + (10000ULL << 32)))) >>
+            32;
+    v = v * 100000000ULL + chunk;
+    str += 8;
+  }
+#endif
+  while (str < end && fast_is_digit(*str)) {
+    v = v * 10 + (*str - '0');
+    ++str;
+  }
+  *value = v;
+  return str;
+}
+
+// The same as strtoull(str, endptr, 10).
+inline uint64_t fast_strtoull(const char* str, const char* end,
+                              char** endptr) {
+  const char* head = fast_skip_spaces(str, end);
+  uint64_t value = 0;
+  const char* cursor = fast_parse_digits(head, end, &value);
+  // 19 digits never overflow
+  if (cursor == head || cursor - head > 19) {
+    return std::strtoull(str, endptr, 10);
+  }
+  *endptr = const_cast<char*>(cursor);
+  return value;
+}
+
+// The same as strtof(str, endptr) for the plain decimals whose digits and
+// power of 10 are exact in float, which are then divided with one rounding.
+inline float fast_strtof(const char* str, const char* end, char** endptr) {
+  static const float kPow10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+  const char* head = fast_skip_spaces(str, end);
+  const char* cursor = head;
+  bool negative = cursor < end && *cursor == '-';
+  if (negative) {
+    ++cursor;
+  }
+  uint64_t mantissa = 0;
+  const char* int_end = fast_parse_digits(cursor, end, &mantissa);
+  size_t digit_num = int_end - cursor;
+  size_t frac_num = 0;
+  cursor = int_end;
+  if (cursor < end && *cursor == '.') {
+    uint64_t frac = 0;
+    const char* frac_end = fast_parse_digits(cursor + 1, end, &frac);
+    frac_num = frac_end - cursor - 1;
+    digit_num += frac_num;
+    if (frac_num < sizeof(kPow10) / sizeof(kPow10[0])) {
+      mantissa = mantissa * static_cast<uint64_t>(kPow10[frac_num]) + frac;
+    }
+    cursor = frac_end;
+  }
+  bool plain = cursor == end || (*cursor != 'e' && *cursor != 'E' &&
+                                 *cursor != 'x' && *cursor != 'X' &&
+                                 !fast_is_digit(*cursor));
+  if (digit_num == 0 || digit_num > 16 || !plain ||
+      frac_num >= sizeof(kPow10) / sizeof(kPow10[0]) ||
+      mantissa > (1ULL << 24)) {
+    return std::strtof(str, endptr);
+  }
+  float value = static_cast<float>(mantissa) / kPow10[frac_num];
+  *endptr = const_cast<char*>(cursor);
+  return negative ? -value : value;
+}
+
+// Skips num tokens separated by spaces, and returns the end of the last one.
+inline const char* skip_tokens(const char* str, const char* end, int num) {
+  for (int i = 0; i < num && str < end; ++i) {
+    while (str < end && *str == ' ') {
+      ++str;
+    }
+    auto* space = static_cast<const char*>(memchr(str, ' ', end - str));
+    str = space == NULL ? end : space;
+  }
+  return str;
+}
+
 // checks whether the test string is a suffix of the input string.
 bool ends_with(std::string const& input, std::string const& test);
 
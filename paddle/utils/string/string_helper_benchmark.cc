@@ -0,0 +1,139 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the fast parsers of string_helper with strtoull and strtof on
+// MultiSlot text lines, where each slot is a count followed by its values.
+
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/utils/string/string_helper.h"
+
+DEFINE_int32(line_num, 10000, "The number of lines.");
+DEFINE_int32(uint64_slot_num, 100, "The number of uint64 slots per line.");
+DEFINE_int32(float_slot_num, 10, "The number of float slots per line.");
+DEFINE_int32(max_slot_size, 5, "The max number of values per slot.");
+DEFINE_int32(repeat, 10, "Repeat times.");
+
+static std::vector<std::string> GenerateLines() {
+  std::mt19937_64 rng(0);
+  std::vector<std::string> lines;
+  for (int i = 0; i < FLAGS_line_num; ++i) {
+    std::string line;
+    for (int j = 0; j < FLAGS_uint64_slot_num + FLAGS_float_slot_num; ++j) {
+      int num = rng() % FLAGS_max_slot_size + 1;
+      line += std::to_string(num);
+      for (int k = 0; k < num; ++k) {
+        line += " ";
+        if (j < FLAGS_uint64_slot_num) {
+          // feasigns are hashes of 16 to 20 digits
+          line += std::to_string(rng() >> (rng() % 8));
+        } else {
+          line += std::to_string(rng() % 100) + "." +
+                  std::to_string(rng() % 1000000);
+        }
+      }
+      line += " ";
+    }
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+template <bool kFast>
+static double ParseLines(const std::vector<std::string>& lines,
+                         uint64_t* checksum) {
+  auto start = std::chrono::steady_clock::now();
+  for (auto& line : lines) {
+    const char* str = line.c_str();
+    const char* end = str + line.size();
+    char* endptr = const_cast<char*>(str);
+    for (int j = 0; j < FLAGS_uint64_slot_num + FLAGS_float_slot_num; ++j) {
+      int num = strtol(endptr, &endptr, 10);
+      for (int k = 0; k < num; ++k) {
+        if (j < FLAGS_uint64_slot_num) {
+          *checksum += kFast ? paddle::string::fast_strtoull(endptr, end,
+                                                             &endptr)
+                             : strtoull(endptr, &endptr, 10);
+        } else {
+          float value = kFast
+                            ? paddle::string::fast_strtof(endptr, end, &endptr)
+                            : strtof(endptr, &endptr);
+          *checksum += static_cast<uint64_t>(value * 1000);
+        }
+      }
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+template <bool kFast>
+static double SkipLines(const std::vector<std::string>& lines,
+                        uint64_t* checksum) {
+  auto start = std::chrono::steady_clock::now();
+  for (auto& line : lines) {
+    const char* str = line.c_str();
+    const char* end = str + line.size();
+    size_t pos = 0;
+    for (int j = 0; j < FLAGS_uint64_slot_num + FLAGS_float_slot_num; ++j) {
+      char* endptr = nullptr;
+      int num = strtol(str + pos, &endptr, 10);
+      if (kFast) {
+        pos = paddle::string::skip_tokens(str + pos, end, num + 1) - str;
+      } else {
+        for (int k = 0; k <= num; ++k) {
+          pos = line.find_first_of(' ', pos + 1);
+        }
+      }
+    }
+    *checksum += pos;
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  auto lines = GenerateLines();
+  double bytes = 0;
+  for (auto& line : lines) {
+    bytes += line.size();
+  }
+  double mb = bytes * FLAGS_repeat / 1024 / 1024;
+
+  double parse_time[2] = {0, 0};
+  double skip_time[2] = {0, 0};
+  uint64_t checksum[2] = {0, 0};
+  for (int i = 0; i < FLAGS_repeat; ++i) {
+    parse_time[0] += ParseLines<false>(lines, &checksum[0]);
+    parse_time[1] += ParseLines<true>(lines, &checksum[1]);
+    skip_time[0] += SkipLines<false>(lines, &checksum[0]);
+    skip_time[1] += SkipLines<true>(lines, &checksum[1]);
+  }
+  if (checksum[0] != checksum[1]) {
+    std::cerr << "The fast parsers give different results." << std::endl;
+    return 1;
+  }
+  std::cout << "parse values, strtoull/strtof: " << mb / parse_time[0]
+            << " MB/s, fast: " << mb / parse_time[1] << " MB/s" << std::endl;
+  std::cout << "skip slots, find_first_of: " << mb / skip_time[0]
+            << " MB/s, skip_tokens: " << mb / skip_time[1] << " MB/s"
+            << std::endl;
+  return 0;
+}
@@ -14,7 +14,9 @@
 
 #include "paddle/utils/string/string_helper.h"
 
+#include <random>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -63,3 +65,58 @@ TEST(StringHelper, JoinStringsWithConversion) {
       paddle::string::join_strings(v, ",", [](int x) { return x * x; });
   EXPECT_EQ(result, "4,9");
 }
+
+TEST(StringHelper, FastStrtoull) {
+  std::vector<std::string> inputs = {
+      "0",        " 42 7",   "\t123abc", "18446744073709551615",
+      "12345678", "1234567890123456789 1", "18446744073709551616",
+      "99999999999999999999", "-5", "+5", "abc", "", " ", "\n9"};
+  std::mt19937_64 rng(0);
+  for (int i = 0; i < 1000; ++i) {
+    inputs.push_back(" " + std::to_string(rng() >> (rng() % 64)) + " 1");
+  }
+  for (auto& input : inputs) {
+    const char* str = input.c_str();
+    char* expected_end = nullptr;
+    char* end = nullptr;
+    uint64_t expected = strtoull(str, &expected_end, 10);
+    EXPECT_EQ(paddle::string::fast_strtoull(str, str + input.size(), &end),
+              expected)
+        << input;
+    EXPECT_EQ(end, expected_end) << input;
+  }
+}
+
+TEST(StringHelper, FastStrtof) {
+  std::vector<std::string> inputs = {
+      "0",     "-0",         " 1.5 2",      "5.",       ".5",
+      "-.25",  "0.1",        "3.14159",     "16777216", "16777217",
+      "1e3",   "1.5E-3",     "0x1p3",       "inf",      "nan",
+      "-",     ".",          "1.2.3",       "abc",      "",
+      "0.000000001", "123456789012345678", "0.30000001192092896"};
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int> digits(0, 99999999);
+  for (int i = 0; i < 1000; ++i) {
+    inputs.push_back(std::to_string(digits(rng) % 1000) + "." +
+                     std::to_string(digits(rng) >> (i % 24)));
+  }
+  for (auto& input : inputs) {
+    const char* str = input.c_str();
+    char* expected_end = nullptr;
+    char* end = nullptr;
+    float expected = strtof(str, &expected_end);
+    float value = paddle::string::fast_strtof(str, str + input.size(), &end);
+    EXPECT_EQ(memcmp(&value, &expected, sizeof(float)), 0) << input;
+    EXPECT_EQ(end, expected_end) << input;
+  }
+}
+
+TEST(StringHelper, SkipTokens) {
+  std::string line = "2 11 12  1 21";
+  const char* str = line.c_str();
+  const char* end = str + line.size();
+  EXPECT_EQ(paddle::string::skip_tokens(str, end, 3), str + 7);
+  EXPECT_EQ(paddle::string::skip_tokens(str + 7, end, 2), end);
+  EXPECT_EQ(paddle::string::skip_tokens(str, end, 10), end);
+  EXPECT_EQ(paddle::string::skip_tokens(str, end, 0), str);
+}
@@ -936,6 +936,82 @@ class InMemoryDataset(DatasetBase):
         self.dataset.wait_preload_done()
         self.dataset.destroy_preload_readers()
 
+    def save_into_binary_files(self, path_prefix):
+        """
+        :api_attr: Static Graph
+
+        Save the parsed data in memory into binary files named
+        path_prefix-00000, path_prefix-00001 ..., one file per thread. The
+        files can be loaded by load_from_binary_files later without parsing
+        the text data again. Only local files are supported.
+
+        Args:
+            path_prefix(str): the path prefix of the binary files
+
+        Examples:
+            .. code-block:: python
+
+                import paddle
+                paddle.enable_static()
+
+                dataset = paddle.distributed.InMemoryDataset()
+                slots = ["slot1", "slot2", "slot3", "slot4"]
+                slots_vars = []
+                for slot in slots:
+                    var = paddle.static.data(
+                        name=slot, shape=[None, 1], dtype="int64", lod_level=1)
+                    slots_vars.append(var)
+                dataset.init(
+                    batch_size=1,
+                    thread_num=2,
+                    input_type=1,
+                    pipe_command="cat",
+                    use_var=slots_vars)
+                filelist = ["a.txt", "b.txt"]
+                dataset.set_filelist(filelist)
+                dataset.load_into_memory()
+                dataset.save_into_binary_files("./binary_data")
+        """
+        self.dataset.save_into_binary_files(path_prefix)
+
+    def load_from_binary_files(self, filelist):
+        """
+        :api_attr: Static Graph
+
+        Load the binary files saved by save_into_binary_files into memory,
+        instead of load_into_memory. The dataset must be initialized with the
+        same used slots, in the same order, as the dataset which saved the
+        files, otherwise a ValueError is raised.
+
+        Args:
+            filelist(list[str]): the binary files
+
+        Examples:
+            .. code-block:: python
+
+                import paddle
+                paddle.enable_static()
+
+                dataset = paddle.distributed.InMemoryDataset()
+                slots = ["slot1", "slot2", "slot3", "slot4"]
+                slots_vars = []
+                for slot in slots:
+                    var = paddle.static.data(
+                        name=slot, shape=[None, 1], dtype="int64", lod_level=1)
+                    slots_vars.append(var)
+                dataset.init(
+                    batch_size=1,
+                    thread_num=2,
+                    input_type=1,
+                    pipe_command="cat",
+                    use_var=slots_vars)
+                filelist = ["binary_data-00000", "binary_data-00001"]
+                dataset.set_filelist(filelist)
+                dataset.load_from_binary_files(filelist)
+        """
+        self._prepare_to_run()
+        self.dataset.load_from_binary_files(filelist)
+
     def local_shuffle(self):
         """
         :api_attr: Static Graph
@@ -976,6 +1052,8 @@ class InMemoryDataset(DatasetBase):
         Global shuffle can be used only in distributed mode. i.e. multiple
         processes on single machine or multiple machines training together.
         If you run in distributed mode, you should pass fleet instead of None.
+        If it is called right after preload_into_memory, the instances are
+        shuffled and sent while they are still being loaded.
 
         Examples:
             .. code-block:: python
@@ -1007,15 +1085,18 @@ class InMemoryDataset(DatasetBase):
 
         """
         trainer_num = 1
+        trainer_id = 0
         if fleet is not None:
             fleet._role_maker.barrier_worker()
             trainer_num = fleet.worker_num()
+            trainer_id = fleet.worker_index()
         if self.fleet_send_batch_size is None:
             self.fleet_send_batch_size = 1024
         if self.fleet_send_sleep_seconds is None:
             self.fleet_send_sleep_seconds = 0
         self.dataset.register_client2client_msg_handler()
         self.dataset.set_trainer_num(trainer_num)
+        self.dataset.set_trainer_id(trainer_id)
         self.dataset.set_fleet_send_batch_size(self.fleet_send_batch_size)
         self.dataset.set_fleet_send_sleep_seconds(self.fleet_send_sleep_seconds)
         if fleet is not None:
@@ -870,6 +870,9 @@ class InMemoryDataset(DatasetBase):
                 fleet._role_maker.barrier_worker()
             if self.trainer_num == -1:
                 self.trainer_num = fleet.worker_num()
+            self.dataset.set_trainer_id(fleet.worker_index())
+        elif self.trainer_num == 1:
+            self.dataset.set_trainer_id(0)
         if self.fleet_send_batch_size is None:
             self.fleet_send_batch_size = 1024
         if self.fleet_send_sleep_seconds is None:
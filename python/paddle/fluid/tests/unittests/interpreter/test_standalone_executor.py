@@ -185,6 +185,27 @@ class SwitchExecutorInterfaceTestCase(MultiStreamModelTestCase):
         return outs
 
 
+class CriticalPathScheduleTestCase(MultiStreamModelTestCase):
+    def setUp(self):
+        # run more steps than the profiled ones, so that the later steps are
+        # scheduled by critical path.
+        self.iter_n = 4
+        self.place = paddle.CUDAPlace(0) if core.is_compiled_with_cuda(
+        ) else paddle.CPUPlace()
+
+    def run_new_executor(self):
+        paddle.fluid.set_flags({
+            'FLAGS_new_executor_use_critical_path_schedule': True,
+            'FLAGS_new_executor_cost_profile_steps': 2
+        })
+        res = super(CriticalPathScheduleTestCase, self).run_new_executor()
+        paddle.fluid.set_flags({
+            'FLAGS_new_executor_use_critical_path_schedule': False,
+            'FLAGS_new_executor_cost_profile_steps': 3
+        })
+        return res
+
+
 class SwitchExecutorInterfaceWithFeed(unittest.TestCase):
     def setUp(self):
         self.place = paddle.CUDAPlace(0) if core.is_compiled_with_cuda(
@@ -91,6 +91,67 @@ class TestProcessGroupFp32(unittest.TestCase):
 
             print("test allreduce max api ok")
 
+            # test async allreduce
+            # the allreduces run on the communication thread in order, and
+            # each of them is done when its task is waited
+            xs = [
+                np.random.random(self.shape).astype(self.dtype)
+                for _ in range(4)
+            ]
+            ys = [
+                np.random.random(self.shape).astype(self.dtype)
+                for _ in range(4)
+            ]
+            tensors = [
+                paddle.to_tensor(x if rank == 0 else y)
+                for x, y in zip(xs, ys)
+            ]
+            tasks = [pg.allreduce(tensor) for tensor in tensors]
+            for task, tensor, x, y in zip(tasks, tensors, xs, ys):
+                task.wait()
+                assert task.is_completed()
+                assert np.array_equal(tensor, x + y)
+
+            print("test async allreduce api ok")
+
+            # test allreduce sum in float16 and bfloat16 on the wire
+            for comm_dtype, rtol in [("float16", 2e-3), ("bfloat16", 2e-2)]:
+                paddle.set_flags({
+                    "FLAGS_gloo_allreduce_comm_dtype": comm_dtype
+                })
+                x = np.random.random(self.shape).astype(self.dtype)
+                y = np.random.random(self.shape).astype(self.dtype)
+                tensor = paddle.to_tensor(x if rank == 0 else y)
+                task = pg.allreduce(tensor)
+                task.wait()
+                np.testing.assert_allclose(tensor.numpy(), x + y, rtol=rtol)
+            paddle.set_flags({"FLAGS_gloo_allreduce_comm_dtype": ""})
+
+            print("test compressed allreduce api ok")
+
+            # test top-k sparse gradients of the reducer with error feedback
+            paddle.set_flags({"FLAGS_eager_reducer_topk_ratio": 0.25})
+            w = paddle.create_parameter([8], "float32")
+            group_indices = core.eager_assign_group_by_size([w], [False],
+                                                            [1024 * 1024])
+            reducer = core.EagerReducer([w], group_indices, [False], pg,
+                                        [1024 * 1024], False)
+            # each rank sends its 2 gradients of the largest magnitudes,
+            # divided by nranks
+            grads = [[8, 6, 1, 0, 0, 0, 0, 0], [0, 0, 0, 0, 0, 2, 4, -10]]
+            for step, expected in enumerate([[4, 3, 0, 0, 0, 0, 2, -5],
+                                             [0, 0, 0.5, 0, 0, 1, 0, 0]]):
+                # the second step sends only what the first one left out
+                coeff = grads[rank] if step == 0 else [0] * 8
+                y = w * paddle.to_tensor(np.array(coeff, dtype="float32"))
+                reducer.prepare_for_backward([y])
+                y.sum().backward()
+                np.testing.assert_allclose(w.grad.numpy(), expected)
+                w.clear_gradient()
+            paddle.set_flags({"FLAGS_eager_reducer_topk_ratio": 0.0})
+
+            print("test top-k reducer ok")
+
             # test broadcast
             # rank 0
             x = np.random.random(self.shape).astype(self.dtype)
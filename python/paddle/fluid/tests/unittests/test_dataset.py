@@ -275,6 +275,84 @@ class TestDataset(unittest.TestCase):
         os.remove("./test_in_memory_dataset_run_a.txt")
         os.remove("./test_in_memory_dataset_run_b.txt")
 
+    def test_in_memory_dataset_binary_files(self):
+        """
+        Testcase for InMemoryDataset saved into and loaded from binary files.
+        """
+        with open("test_in_memory_dataset_binary_a.txt", "w") as f:
+            data = "1 1 2 3 3 4 5 5 5 5 1 1\n"
+            data += "1 2 2 3 4 4 6 6 6 6 1 2\n"
+            data += "1 3 2 3 5 4 7 7 7 7 1 3\n"
+            f.write(data)
+        with open("test_in_memory_dataset_binary_b.txt", "w") as f:
+            data = "1 4 2 3 3 4 5 5 5 5 1 4\n"
+            data += "1 5 2 3 4 4 6 6 6 6 1 5\n"
+            f.write(data)
+
+        slots = ["slot1", "slot2", "slot3", "slot4"]
+        slots_vars = []
+        for slot in slots:
+            var = fluid.layers.data(
+                name=slot, shape=[1], dtype="int64", lod_level=1)
+            slots_vars.append(var)
+
+        dataset = paddle.distributed.InMemoryDataset()
+        dataset.init(
+            batch_size=32, thread_num=2, pipe_command="cat", use_var=slots_vars)
+        dataset.set_filelist([
+            "test_in_memory_dataset_binary_a.txt",
+            "test_in_memory_dataset_binary_b.txt"
+        ])
+        dataset.load_into_memory()
+        dataset.save_into_binary_files("./test_in_memory_dataset_binary")
+        binary_files = [
+            "./test_in_memory_dataset_binary-00000",
+            "./test_in_memory_dataset_binary-00001"
+        ]
+
+        dataset2 = paddle.distributed.InMemoryDataset()
+        dataset2.init(
+            batch_size=32, thread_num=2, pipe_command="cat", use_var=slots_vars)
+        dataset2.set_filelist(binary_files)
+        dataset2.load_from_binary_files(binary_files)
+        self.assertEqual(dataset2.get_memory_data_size(), 5)
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(fluid.default_startup_program())
+        exe.train_from_dataset(fluid.default_main_program(), dataset2)
+
+        # after training the instances are moved out of the input channel
+        dataset2.save_into_binary_files("./test_in_memory_dataset_binary2")
+        binary_files2 = [
+            "./test_in_memory_dataset_binary2-00000",
+            "./test_in_memory_dataset_binary2-00001"
+        ]
+        dataset3 = paddle.distributed.InMemoryDataset()
+        dataset3.init(
+            batch_size=32, thread_num=2, pipe_command="cat", use_var=slots_vars)
+        dataset3.set_filelist(binary_files2)
+        dataset3.load_from_binary_files(binary_files2)
+        self.assertEqual(dataset3.get_memory_data_size(), 5)
+
+        # the files can not be loaded by a dataset of other slots
+        dataset4 = paddle.distributed.InMemoryDataset()
+        dataset4.init(
+            batch_size=32,
+            thread_num=2,
+            pipe_command="cat",
+            use_var=slots_vars[:3])
+        dataset4.set_filelist(binary_files)
+        with self.assertRaises(ValueError):
+            dataset4.load_from_binary_files(binary_files)
+
+        dataset.release_memory()
+        dataset2.release_memory()
+        dataset3.release_memory()
+        dataset4.release_memory()
+        os.remove("./test_in_memory_dataset_binary_a.txt")
+        os.remove("./test_in_memory_dataset_binary_b.txt")
+        for f in binary_files + binary_files2:
+            os.remove(f)
+
     def test_in_memory_dataset_masterpatch(self):
         """
         Testcase for InMemoryDataset from create to run.
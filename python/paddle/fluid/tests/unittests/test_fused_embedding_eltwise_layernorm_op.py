@@ -0,0 +1,141 @@
+#   Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle
+import paddle.nn.functional as F
+from paddle.fluid.layer_helper import LayerHelper
+
+paddle.enable_static()
+
+
+def fused_embedding_eltwise_layernorm(ids, embs, scale, bias, epsilon):
+    helper = LayerHelper('fused_embedding_eltwise_layernorm')
+    out = helper.create_variable_for_type_inference(embs[0].dtype)
+    helper.append_op(
+        type='fused_embedding_eltwise_layernorm',
+        inputs={'Ids': ids,
+                'Embs': embs,
+                'Bias': bias,
+                'Scale': scale},
+        outputs={'Out': out},
+        attrs={'epsilon': epsilon})
+    return out
+
+
+class TestFusedEmbeddingEltwiseLayerNormOpCPU(unittest.TestCase):
+    """Compare the CPU kernel of fused_embedding_eltwise_layernorm with the
+    lookup_table_v2 + elementwise_add + layer_norm subgraph which
+    embedding_eltwise_layernorm_fuse_pass replaces."""
+
+    def config(self):
+        self.batch_size = 2
+        self.seq_len = 16
+        self.hidden = 64
+        self.vocab_sizes = [100, 32, 4]
+        self.epsilon = 1e-5
+
+    def setUp(self):
+        self.config()
+        np.random.seed(123)
+
+    def test_compare_with_unfused(self):
+        feed = {}
+        for i, vocab_size in enumerate(self.vocab_sizes):
+            feed['ids%d' % i] = np.random.randint(
+                0, vocab_size,
+                [self.batch_size, self.seq_len]).astype('int64')
+            feed['emb%d' % i] = np.random.uniform(
+                -1, 1, [vocab_size, self.hidden]).astype('float32')
+        feed['scale'] = np.random.uniform(0.5, 1.5,
+                                          [self.hidden]).astype('float32')
+        feed['bias'] = np.random.uniform(-0.5, 0.5,
+                                         [self.hidden]).astype('float32')
+
+        main = paddle.static.Program()
+        startup = paddle.static.Program()
+        with paddle.static.program_guard(main, startup):
+            ids = []
+            embs = []
+            for i, vocab_size in enumerate(self.vocab_sizes):
+                ids.append(
+                    paddle.static.data('ids%d' % i,
+                                       [self.batch_size, self.seq_len],
+                                       'int64'))
+                embs.append(
+                    paddle.static.data('emb%d' % i, [vocab_size, self.hidden],
+                                       'float32'))
+            scale = paddle.static.data('scale', [self.hidden], 'float32')
+            bias = paddle.static.data('bias', [self.hidden], 'float32')
+            emb_sum = F.embedding(ids[0], embs[0])
+            for i in range(1, len(ids)):
+                emb_sum = paddle.add(emb_sum, F.embedding(ids[i], embs[i]))
+            unfused = F.layer_norm(
+                emb_sum, [self.hidden],
+                weight=scale,
+                bias=bias,
+                epsilon=self.epsilon)
+            fused = fused_embedding_eltwise_layernorm(ids, embs, scale, bias,
+                                                      self.epsilon)
+        exe = paddle.static.Executor(paddle.CPUPlace())
+        unfused_out, fused_out = exe.run(main,
+                                         feed=feed,
+                                         fetch_list=[unfused, fused])
+        self.assertEqual(fused_out.shape, unfused_out.shape)
+        np.testing.assert_allclose(fused_out, unfused_out, rtol=1e-5, atol=1e-5)
+
+    def test_ids_out_of_range(self):
+        main = paddle.static.Program()
+        startup = paddle.static.Program()
+        with paddle.static.program_guard(main, startup):
+            ids = [
+                paddle.static.data('ids%d' % i, [1, 2], 'int64')
+                for i in range(2)
+            ]
+            embs = [
+                paddle.static.data('emb%d' % i, [4, 8], 'float32')
+                for i in range(2)
+            ]
+            scale = paddle.static.data('scale', [8], 'float32')
+            bias = paddle.static.data('bias', [8], 'float32')
+            out = fused_embedding_eltwise_layernorm(ids, embs, scale, bias,
+                                                    1e-5)
+        feed = {
+            'ids0': np.array([[0, 1]]).astype('int64'),
+            'ids1': np.array([[2, 4]]).astype('int64'),
+            'emb0': np.ones([4, 8]).astype('float32'),
+            'emb1': np.ones([4, 8]).astype('float32'),
+            'scale': np.ones([8]).astype('float32'),
+            'bias': np.zeros([8]).astype('float32'),
+        }
+        exe = paddle.static.Executor(paddle.CPUPlace())
+        with self.assertRaises(ValueError):
+            exe.run(main, feed=feed, fetch_list=[out])
+
+
+class TestFusedEmbeddingEltwiseLayerNormOpCPUTwoInputs(
+        TestFusedEmbeddingEltwiseLayerNormOpCPU):
+    def config(self):
+        self.batch_size = 3
+        self.seq_len = 7
+        self.hidden = 48
+        self.vocab_sizes = [50, 20]
+        self.epsilon = 1e-3
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -32,8 +32,6 @@ def stable_softmax(x):
     return exps / np.sum(exps)
 
 
-@unittest.skipIf(not core.is_compiled_with_cuda(),
-                 "Paddle core is not compiled with CUDA")
 class TestFusedMultiheadMatmulOp(OpTest):
     def config(self):
         self.seq_len = 128
@@ -62,9 +60,12 @@ class TestFusedMultiheadMatmulOp(OpTest):
         self.BiasK = np.random.random((1, w)).astype("float32")
         self.BiasV = np.random.random((1, w)).astype("float32")
         self.CombinedB = np.vstack((self.BiasQ, self.BiasK, self.BiasV))
-        self.BiasQK = np.random.random(
-            (self.batch_size, self.head_number, self.seq_len,
-             self.seq_len)).astype("float32")
+        if getattr(self, "broadcast_bias_qk", False):
+            bias_qk_shape = (self.batch_size, 1, 1, self.seq_len)
+        else:
+            bias_qk_shape = (self.batch_size, self.head_number, self.seq_len,
+                             self.seq_len)
+        self.BiasQK = np.random.random(bias_qk_shape).astype("float32")
         # Compute Q path
         fc_q = self.Q + self.BiasQ
         reshape_q = np.reshape(fc_q, (self.batch_size, self.seq_len,
@@ -107,10 +108,16 @@ class TestFusedMultiheadMatmulOp(OpTest):
         }
         self.outputs = {"Out": reshape_qkv}
 
+    @unittest.skipIf(not core.is_compiled_with_cuda(),
+                     "Paddle core is not compiled with CUDA")
     def test_check_output(self):
         place = core.CUDAPlace(0)
         self.check_output_with_place(place, atol=2e-3)
 
+    def test_check_output_cpu(self):
+        place = core.CPUPlace()
+        self.check_output_with_place(place, atol=2e-3)
+
 
 class TestFusedMultiHeadMatmulOp2(TestFusedMultiheadMatmulOp):
     def config(self):
@@ -121,5 +128,15 @@ class TestFusedMultiHeadMatmulOp2(TestFusedMultiheadMatmulOp):
         self.scale = 0.125
 
 
+class TestFusedMultiHeadMatmulOpBroadcastBiasQK(TestFusedMultiheadMatmulOp):
+    def config(self):
+        self.seq_len = 64
+        self.size_per_head = 32
+        self.head_number = 4
+        self.batch_size = 2
+        self.scale = 0.125
+        self.broadcast_bias_qk = True
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,101 @@
+#   Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle
+import paddle.nn.functional as F
+from paddle.fluid.layer_helper import LayerHelper
+
+paddle.enable_static()
+
+
+def skip_layernorm(x, y, scale, bias, epsilon, begin_norm_axis):
+    helper = LayerHelper('skip_layernorm')
+    out = helper.create_variable_for_type_inference(x.dtype)
+    helper.append_op(
+        type='skip_layernorm',
+        inputs={'X': x,
+                'Y': y,
+                'Scale': scale,
+                'Bias': bias},
+        outputs={'Out': out},
+        attrs={'epsilon': epsilon,
+               'begin_norm_axis': begin_norm_axis})
+    return out
+
+
+class TestSkipLayerNormOpCPU(unittest.TestCase):
+    """Compare the CPU kernel of skip_layernorm with the elementwise_add +
+    layer_norm subgraph which skip_layernorm_fuse_pass replaces."""
+
+    def config(self):
+        self.shape = [2, 16, 64]
+        self.begin_norm_axis = 2
+        self.epsilon = 1e-5
+
+    def setUp(self):
+        self.config()
+        np.random.seed(123)
+
+    def test_compare_with_unfused(self):
+        norm_shape = self.shape[self.begin_norm_axis:]
+        hidden = int(np.prod(norm_shape))
+        feed = {
+            'x': np.random.uniform(-1, 1, self.shape).astype('float32'),
+            'y': np.random.uniform(-1, 1, self.shape).astype('float32'),
+            'scale': np.random.uniform(0.5, 1.5, [hidden]).astype('float32'),
+            'bias': np.random.uniform(-0.5, 0.5, [hidden]).astype('float32'),
+        }
+        main = paddle.static.Program()
+        startup = paddle.static.Program()
+        with paddle.static.program_guard(main, startup):
+            x = paddle.static.data('x', self.shape, 'float32')
+            y = paddle.static.data('y', self.shape, 'float32')
+            scale = paddle.static.data('scale', [hidden], 'float32')
+            bias = paddle.static.data('bias', [hidden], 'float32')
+            unfused = F.layer_norm(
+                paddle.add(x, y),
+                norm_shape,
+                weight=scale,
+                bias=bias,
+                epsilon=self.epsilon)
+            fused = skip_layernorm(x, y, scale, bias, self.epsilon,
+                                   self.begin_norm_axis)
+        exe = paddle.static.Executor(paddle.CPUPlace())
+        unfused_out, fused_out = exe.run(main,
+                                         feed=feed,
+                                         fetch_list=[unfused, fused])
+        self.assertEqual(fused_out.shape, unfused_out.shape)
+        np.testing.assert_allclose(fused_out, unfused_out, rtol=1e-5, atol=1e-5)
+
+
+class TestSkipLayerNormOpCPU2D(TestSkipLayerNormOpCPU):
+    def config(self):
+        self.shape = [32, 128]
+        self.begin_norm_axis = 1
+        self.epsilon = 1e-5
+
+
+class TestSkipLayerNormOpCPUNormTwoAxes(TestSkipLayerNormOpCPU):
+    def config(self):
+        self.shape = [2, 4, 8, 16]
+        self.begin_norm_axis = 2
+        self.epsilon = 1e-3
+
+
+if __name__ == '__main__':
+    unittest.main()
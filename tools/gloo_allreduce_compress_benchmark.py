@@ -0,0 +1,139 @@
+# Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""
+Compares the compressed gradient exchanges of the dygraph DataParallel on
+CPU, by training an MLP in several local processes over loopback with
+ProcessGroupGloo, and reports the step time and the bytes each rank sends
+per step in each mode. The bytes are estimated from the sizes of the
+gradients and the ring algorithms, not measured on the wire.
+
+Usage:
+    python tools/gloo_allreduce_compress_benchmark.py --nranks 2
+"""
+
+import argparse
+import datetime
+import multiprocessing
+import time
+
+import numpy as np
+
+MODES = ["float32", "float16", "bfloat16", "topk"]
+
+
+def estimated_wire_bytes(numel, nranks, mode, topk_ratio):
+    # the ring allreduce sends 2 * (n - 1) / n of the buffer and the ring
+    # allgather n - 1 times the buffer of one rank
+    if mode == "topk":
+        k = max(1, int(np.ceil(numel * topk_ratio)))
+        return (nranks - 1) * k * (4 + 4)
+    elem_size = 4 if mode == "float32" else 2
+    return 2.0 * (nranks - 1) / nranks * numel * elem_size
+
+
+def train(rank, args, mode, port, results):
+    import paddle
+    from paddle.fluid import core
+    from paddle.fluid.framework import _test_eager_guard
+
+    paddle.set_device("cpu")
+    if mode in ("float16", "bfloat16"):
+        paddle.set_flags({"FLAGS_gloo_allreduce_comm_dtype": mode})
+    elif mode == "topk":
+        paddle.set_flags({"FLAGS_eager_reducer_topk_ratio": args.topk_ratio})
+
+    with _test_eager_guard():
+        store = core.TCPStore("127.0.0.1", port, rank == 0, args.nranks,
+                              datetime.timedelta(0))
+        pg = core.ProcessGroupGloo(store, rank, args.nranks)
+
+        paddle.seed(2022)
+        layers = []
+        for _ in range(args.layer_num):
+            layers += [
+                paddle.nn.Linear(args.hidden_size, args.hidden_size),
+                paddle.nn.ReLU()
+            ]
+        model = paddle.nn.Sequential(*layers)
+        params = [p for p in model.parameters() if p.trainable]
+        group_size = int(args.comm_buffer_size * 1024 * 1024)
+        group_indices = core.eager_assign_group_by_size(
+            params, [False] * len(params), [group_size])
+        reducer = core.EagerReducer(params,
+                                    list(reversed(group_indices)),
+                                    [False] * len(params), pg, [group_size],
+                                    False)
+        optimizer = paddle.optimizer.SGD(learning_rate=0.001,
+                                         parameters=params)
+
+        np.random.seed(rank)
+        x = paddle.to_tensor(
+            np.random.rand(args.batch_size, args.hidden_size).astype(
+                "float32"))
+        for step in range(args.warmup_steps + args.steps):
+            if step == args.warmup_steps:
+                start = time.time()
+            y = model(x)
+            reducer.prepare_for_backward([y])
+            loss = y.mean()
+            loss.backward()
+            optimizer.step()
+            optimizer.clear_grad()
+        step_time = (time.time() - start) / args.steps
+
+        numel = sum(int(np.prod(p.shape)) for p in params)
+        if rank == 0:
+            sent = estimated_wire_bytes(numel, args.nranks, mode,
+                                        args.topk_ratio)
+            results[mode] = (step_time, sent, float(loss.numpy()))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--nranks", type=int, default=2)
+    parser.add_argument("--hidden_size", type=int, default=1024)
+    parser.add_argument("--layer_num", type=int, default=8)
+    parser.add_argument("--batch_size", type=int, default=32)
+    parser.add_argument("--comm_buffer_size", type=float, default=25)
+    parser.add_argument("--topk_ratio", type=float, default=0.01)
+    parser.add_argument("--warmup_steps", type=int, default=2)
+    parser.add_argument("--steps", type=int, default=10)
+    parser.add_argument("--port", type=int, default=6380)
+    args = parser.parse_args()
+
+    manager = multiprocessing.Manager()
+    results = manager.dict()
+    for i, mode in enumerate(MODES):
+        procs = [
+            multiprocessing.Process(
+                target=train,
+                args=(rank, args, mode, args.port + i, results))
+            for rank in range(args.nranks)
+        ]
+        for proc in procs:
+            proc.start()
+        for proc in procs:
+            proc.join()
+            assert proc.exitcode == 0, "The %s run failed." % mode
+
+    print("%-10s %14s %18s %12s" %
+          ("mode", "step time(ms)", "est. MB sent/step", "last loss"))
+    for mode in MODES:
+        step_time, sent, loss = results[mode]
+        print("%-10s %14.2f %18.2f %12.6f" %
+              (mode, step_time * 1000, sent / 1024 / 1024, loss))
+
+
+if __name__ == "__main__":
+    main()